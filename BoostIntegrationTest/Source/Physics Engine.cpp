@@ -528,4 +528,35 @@ BOOST_AUTO_TEST_CASE(PhysicsResourceIntegration)
 }
 #pragma endregion
 
+#pragma region // ## Step 6 ## //
+BOOST_AUTO_TEST_CASE(PhysicsSharedVolumeIntegration)
+{
+	BOOST_MESSAGE(testId + "Testing to share a loaded bounding volume between physics instances");
+	IPhysics *library = IPhysics::createPhysics();
+	library->initialize(false, 1.f / 60.f);
+	IPhysics *physics = IPhysics::createPhysics();
+	physics->initialize(false, 1.f / 60.f);
+
+	BOOST_MESSAGE(testId + "Loading bounding volume into the first instance");
+	BOOST_REQUIRE(library->createBV("Barrel1", "assets/volumes/CB_Barrel1.txc"));
+	BOOST_CHECK(!physics->copyBV("Missing", library));
+
+	BOOST_MESSAGE(testId + "Copying bounding volume to the second instance");
+	BOOST_REQUIRE(physics->copyBV("Barrel1", library));
+	BOOST_CHECK(library->releaseBV("Barrel1"));
+	BOOST_MESSAGE(testId + "Creating an instance from the copy, after the original is released");
+	BodyHandle barrel = physics->createBVInstance("Barrel1");
+	BOOST_CHECK(barrel != 0);
+	physics->releaseBody(barrel);
+
+	BOOST_CHECK(physics->releaseBV("Barrel1"));
+	IPhysics::deletePhysics(physics);
+	IPhysics::deletePhysics(library);
+	Body::resetBodyHandleCounter();
+	BOOST_MESSAGE(testId + "Shared volume integration test completed");
+	BOOST_MESSAGE("");
+	BOOST_MESSAGE("");
+}
+#pragma endregion
+
 BOOST_AUTO_TEST_SUITE_END()
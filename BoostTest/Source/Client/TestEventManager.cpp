@@ -431,4 +431,21 @@ BOOST_AUTO_TEST_CASE(RemoveActorEventDataTest)
 	BOOST_CHECK(newEventData->getActorId() == actorId);
 }
 
+BOOST_AUTO_TEST_CASE(ChangeBodyEventDataTest)
+{
+	BodyHandle oldBody = 1;
+	BodyHandle newBody = 2;
+	std::shared_ptr<ChangeBodyEventData> eventData(new ChangeBodyEventData(oldBody, newBody));
+
+	BOOST_CHECK(eventData->getName() == "ChangeBodyEvent");
+	BOOST_CHECK(eventData->getEventType() == 0x2d7e64b1);
+
+	BOOST_CHECK(eventData->getOldBody() == oldBody);
+	BOOST_CHECK(eventData->getNewBody() == newBody);
+
+	std::shared_ptr<ChangeBodyEventData> newEventData = std::static_pointer_cast<ChangeBodyEventData>(eventData->copy());
+	BOOST_CHECK(newEventData->getOldBody() == oldBody);
+	BOOST_CHECK(newEventData->getNewBody() == newBody);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/BufferPool.h"
+#include "../../../Network/Source/Packages.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+namespace
+{
+	std::atomic<bool> g_CountAllocations(false);
+	std::atomic<size_t> g_NumAllocations(0);
+
+	void* countedAllocate(size_t p_Size)
+	{
+		if (g_CountAllocations)
+		{
+			++g_NumAllocations;
+		}
+
+		void* memory = std::malloc(p_Size ? p_Size : 1);
+		if (!memory)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+
+	/**
+	 * Counts every heap allocation in the process while alive.
+	 */
+	class AllocationCounter
+	{
+	public:
+		AllocationCounter()
+		{
+			g_NumAllocations = 0;
+			g_CountAllocations = true;
+		}
+
+		~AllocationCounter()
+		{
+			g_CountAllocations = false;
+		}
+
+		size_t getCount() const
+		{
+			return g_NumAllocations;
+		}
+	};
+
+	UpdateObjects createUpdatePackage()
+	{
+		UpdateObjects package;
+		for (uint32_t i = 0; i < 20; ++i)
+		{
+			UpdateObjectData data;
+			data.m_Id = i;
+			data.m_Position = Vector3(1.f * i, 2.f, 3.f);
+			data.m_Rotation = Vector3(0.f, 0.5f, 0.f);
+			data.m_Velocity = Vector3(4.f, 0.f, 0.f);
+			data.m_RotationVelocity = Vector3(0.f, 0.f, 0.f);
+			package.m_Object1.push_back(data);
+		}
+		return package;
+	}
+}
+
+void* operator new(size_t p_Size)
+{
+	return countedAllocate(p_Size);
+}
+
+void* operator new[](size_t p_Size)
+{
+	return countedAllocate(p_Size);
+}
+
+void operator delete(void* p_Memory)
+{
+	std::free(p_Memory);
+}
+
+void operator delete[](void* p_Memory)
+{
+	std::free(p_Memory);
+}
+
+BOOST_AUTO_TEST_SUITE(TestBufferPool)
+
+BOOST_AUTO_TEST_CASE(TestPoolReusesReleasedStorage)
+{
+	BufferPool pool(2);
+
+	std::shared_ptr<Buffer::Storage> first = pool.acquire();
+	first->assign(100, 'a');
+	const char* firstData = first->data();
+	Buffer held(first);
+	first.reset();
+
+	// Still referenced by a buffer, so a new storage is needed.
+	std::shared_ptr<Buffer::Storage> second = pool.acquire();
+	BOOST_CHECK_EQUAL(pool.getNumCreated(), 2);
+	BOOST_CHECK_EQUAL(held.size(), 100);
+	BOOST_CHECK_EQUAL(held.data()[99], 'a');
+	second.reset();
+
+	held = Buffer();
+	std::shared_ptr<Buffer::Storage> reused = pool.acquire();
+	std::shared_ptr<Buffer::Storage> reused2 = pool.acquire();
+	BOOST_CHECK_EQUAL(pool.getNumCreated(), 2);
+	BOOST_CHECK(reused->empty());
+	BOOST_CHECK(reused->data() == firstData || reused2->data() == firstData);
+}
+
+BOOST_AUTO_TEST_CASE(TestBufferViews)
+{
+	std::shared_ptr<Buffer::Storage> storage(new Buffer::Storage(10, 'x'));
+	(*storage)[4] = 'y';
+
+	Buffer part(storage, 4, 3);
+	BOOST_CHECK_EQUAL(part.size(), 3);
+	BOOST_CHECK_EQUAL(part.str(), "yxx");
+
+	Buffer copy = Buffer::copyOf("data");
+	BOOST_CHECK_EQUAL(copy.str(), "data");
+	BOOST_CHECK(Buffer().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkPackageAllocations)
+{
+	static const size_t numPackets = 1000;
+
+	UpdateObjects package = createUpdatePackage();
+	UpdateObjects prototype;
+
+	size_t legacyAllocations = 0;
+	{
+		AllocationCounter counter;
+		for (size_t i = 0; i < numPackets; ++i)
+		{
+			// Serialize, copy into the write queue and again into the write buffer.
+			std::ostringstream ostream;
+			{
+				boost::archive::binary_oarchive oarchive(ostream, boost::archive::no_header);
+				oarchive << package;
+			}
+			std::string data = ostream.str();
+			std::string queued(data);
+			std::string writeBuffer(queued);
+
+			// Copy out of the read buffer and decode through a string stream.
+			std::string received(writeBuffer);
+			std::istringstream stream(received);
+			boost::archive::binary_iarchive archive(stream, boost::archive::no_header);
+			std::unique_ptr<UpdateObjects> result(new UpdateObjects);
+			archive >> *result;
+		}
+		legacyAllocations = counter.getCount();
+	}
+
+	BufferPool pool;
+	size_t pooledAllocations = 0;
+	size_t numDecoded = 0;
+	{
+		AllocationCounter counter;
+		for (size_t i = 0; i < numPackets; ++i)
+		{
+			std::shared_ptr<Buffer::Storage> storage = pool.acquire();
+			package.writeData(*storage);
+			Buffer queued(storage);
+			storage.reset();
+			Buffer writeBuffer(queued);
+
+			PackageBase::ptr result(prototype.createPackage(writeBuffer.data(), writeBuffer.size()));
+			numDecoded += static_cast<UpdateObjects*>(result.get())->m_Object1.size();
+		}
+		pooledAllocations = counter.getCount();
+	}
+
+	BOOST_TEST_MESSAGE("Allocations per packet, copying: " << (float)legacyAllocations / numPackets
+		<< ", pooled: " << (float)pooledAllocations / numPackets);
+
+	BOOST_CHECK_EQUAL(numDecoded, numPackets * package.m_Object1.size());
+	BOOST_CHECK_EQUAL(pool.getNumCreated(), 1);
+	BOOST_CHECK_LT(pooledAllocations, legacyAllocations);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,135 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/Connection.h"
+
+#include <chrono>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(TestConnection)
+
+namespace
+{
+	/**
+	 * Two connections over a loopback socket pair, with an io service run on a background thread once started.
+	 */
+	class ConnectionPair
+	{
+	public:
+		boost::asio::io_service m_IO_Service;
+		std::shared_ptr<Connection> m_Sender;
+		std::shared_ptr<Connection> m_Receiver;
+
+		std::mutex m_Lock;
+		std::vector<std::pair<uint16_t, std::string>> m_Received;
+
+	private:
+		std::unique_ptr<boost::asio::io_service::work> m_Work;
+		boost::thread m_Thread;
+
+	public:
+		ConnectionPair()
+		{
+			using boost::asio::ip::tcp;
+
+			tcp::acceptor acceptor(m_IO_Service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+			tcp::socket sendSocket(m_IO_Service);
+			tcp::socket receiveSocket(m_IO_Service);
+			sendSocket.connect(acceptor.local_endpoint());
+			acceptor.accept(receiveSocket);
+
+			m_Sender.reset(new Connection(std::move(sendSocket)));
+			m_Receiver.reset(new Connection(std::move(receiveSocket)));
+			m_Receiver->setSaveData([this] (uint16_t p_ID, const Buffer& p_Data)
+			{
+				std::lock_guard<std::mutex> lock(m_Lock);
+				m_Received.push_back(std::make_pair(p_ID, p_Data.str()));
+			});
+			m_Receiver->startReading();
+		}
+
+		void start()
+		{
+			m_Work.reset(new boost::asio::io_service::work(m_IO_Service));
+			m_Thread = boost::thread([this] () { m_IO_Service.run(); });
+		}
+
+		~ConnectionPair()
+		{
+			m_Sender->disconnect();
+			m_Receiver->disconnect();
+			m_Work.reset();
+			m_IO_Service.stop();
+			if (m_Thread.joinable())
+			{
+				m_Thread.join();
+			}
+		}
+
+		bool waitForPackages(size_t p_NumPackages)
+		{
+			for (int i = 0; i < 400; ++i)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_Lock);
+					if (m_Received.size() >= p_NumPackages)
+					{
+						return true;
+					}
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+			return false;
+		}
+	};
+}
+
+BOOST_AUTO_TEST_CASE(TestWritesAreCoalescedInOrder)
+{
+	ConnectionPair pair;
+
+	// The burst is queued before the io service runs, so only the first package is written on its own.
+	static const unsigned int numPackages = 200;
+	for (unsigned int i = 0; i < numPackages; ++i)
+	{
+		pair.m_Sender->writeData(Buffer::copyOf("Package " + std::to_string(i)), (uint16_t)(i % 7));
+	}
+	pair.start();
+
+	BOOST_REQUIRE(pair.waitForPackages(numPackages));
+	for (unsigned int i = 0; i < numPackages; ++i)
+	{
+		BOOST_CHECK_EQUAL(pair.m_Received[i].first, i % 7);
+		BOOST_CHECK_EQUAL(pair.m_Received[i].second, "Package " + std::to_string(i));
+	}
+
+	const WriteStatistics statistics = pair.m_Sender->getWriteStatistics();
+	BOOST_TEST_MESSAGE("Burst of " << numPackages << " packages written in " << statistics.m_NumWrites
+		<< " writes, " << statistics.getPackagesPerWrite() << " packages per write");
+	BOOST_CHECK_EQUAL(statistics.m_NumPackages, numPackages);
+	BOOST_CHECK_LE(statistics.m_NumWrites, 2);
+	// Everything after the first package waited in the queue at once.
+	BOOST_CHECK_GE(statistics.m_MaxQueuedPackages, numPackages - 1);
+	BOOST_CHECK_GT(statistics.m_MaxQueuedBytes, statistics.m_MaxQueuedPackages);
+}
+
+BOOST_AUTO_TEST_CASE(TestLargePackagesAreWrittenAlone)
+{
+	ConnectionPair pair;
+
+	const std::string large(Connection::maxWriteSize + 100, 'x');
+	pair.m_Sender->writeData(Buffer::copyOf("small"), 1);
+	pair.m_Sender->writeData(Buffer::copyOf(large), 2);
+	pair.m_Sender->writeData(Buffer::copyOf(large), 3);
+	pair.m_Sender->writeData(Buffer::copyOf(std::string()), 4);
+	pair.start();
+
+	BOOST_REQUIRE(pair.waitForPackages(4));
+	BOOST_CHECK_EQUAL(pair.m_Received[0].second, "small");
+	BOOST_CHECK(pair.m_Received[1].second == large);
+	BOOST_CHECK(pair.m_Received[2].second == large);
+	BOOST_CHECK(pair.m_Received[3].second.empty());
+
+	// Packages beyond the write budget are never gathered together.
+	BOOST_CHECK_GE(pair.m_Sender->getWriteStatistics().m_NumWrites, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
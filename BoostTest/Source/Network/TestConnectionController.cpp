@@ -11,7 +11,7 @@ public:
 	bool isConnected() const override { return true; }
 	void disconnect() override {};
 	bool hasError() const override { return false; }
-	void writeData(const std::string& p_Buffer, uint16_t p_ID) override
+	void writeData(const Buffer& p_Buffer, uint16_t p_ID) override
 	{
 		if (m_SaveData)
 		{
@@ -24,6 +24,7 @@ public:
 	}
 	void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) override {}
 	void startReading() override {}
+	WriteStatistics getWriteStatistics() const override { return WriteStatistics(); }
 };
 
 BOOST_AUTO_TEST_CASE(TestReceivePackage)
@@ -40,7 +41,7 @@ BOOST_AUTO_TEST_CASE(TestReceivePackage)
 	static const uint32_t testId = 123;
 	package.m_Object1.push_back(std::make_pair(testDesc, testId));
 
-	conn->writeData(package.getData(), (uint16_t)PackageType::CREATE_OBJECTS);
+	conn->writeData(Buffer::copyOf(package.getData()), (uint16_t)PackageType::CREATE_OBJECTS);
 
 	BOOST_REQUIRE_EQUAL(controller.getNumPackages(), 1);
 	
@@ -59,6 +60,68 @@ BOOST_AUTO_TEST_CASE(TestReceivePackage)
 	BOOST_CHECK_EQUAL(controller.getNumPackages(), 0);
 }
 
+static void countReceived(IConnectionController* p_Connection, void* p_UserData)
+{
+	++*static_cast<int*>(p_UserData);
+}
+
+BOOST_AUTO_TEST_CASE(TestPackagesReceivedCallback)
+{
+	IConnection::ptr conn(new ConnectionStub);
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new RemoveObjects));
+
+	ConnectionController controller(conn, prototypes);
+
+	int numCalls = 0;
+	controller.setPackagesReceivedCallback(&countReceived, &numCalls);
+
+	RemoveObjects package;
+	package.m_Object1.push_back(1);
+	conn->writeData(Buffer::copyOf(package.getData()), (uint16_t)PackageType::REMOVE_OBJECTS);
+	BOOST_CHECK_EQUAL(numCalls, 1);
+
+	// Internally handled packages are not reported.
+	controller.sendPing();
+	BOOST_CHECK_EQUAL(numCalls, 1);
+
+	controller.setPackagesReceivedCallback(nullptr, nullptr);
+	conn->writeData(Buffer::copyOf(package.getData()), (uint16_t)PackageType::REMOVE_OBJECTS);
+	BOOST_CHECK_EQUAL(numCalls, 1);
+
+	BOOST_CHECK_EQUAL(controller.getNumPackages(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestReplayPackageData)
+{
+	IConnection::ptr conn(new ConnectionStub);
+	IConnection::ptr replayConn(new ConnectionStub);
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new JoinGame));
+
+	ConnectionController controller(conn, prototypes);
+	ConnectionController replayController(replayConn, prototypes);
+
+	controller.sendJoinGame("TestLevel", "TestUser", "TestCharacter", "TestStyle");
+	BOOST_REQUIRE_EQUAL(controller.getNumPackages(), 1);
+
+	std::vector<char> recorded;
+	controller.writePackageData(controller.getPackage(0), recorded);
+	BOOST_REQUIRE(!recorded.empty());
+
+	replayController.receivePackageData(PackageType::JOIN_GAME, recorded.data(), recorded.size());
+	BOOST_REQUIRE_EQUAL(replayController.getNumPackages(), 1);
+
+	Package packageRef = replayController.getPackage(0);
+	BOOST_CHECK_EQUAL((uint16_t)replayController.getPackageType(packageRef), (uint16_t)PackageType::JOIN_GAME);
+	BOOST_CHECK_EQUAL(replayController.getJoinGameName(packageRef), "TestLevel");
+	BOOST_CHECK_EQUAL(replayController.getJoinGameUsername(packageRef), "TestUser");
+	BOOST_CHECK_EQUAL(replayController.getJoinGameCharacterName(packageRef), "TestCharacter");
+	BOOST_CHECK_EQUAL(replayController.getJoinGameCharacterStyle(packageRef), "TestStyle");
+}
+
 BOOST_AUTO_TEST_CASE(TestSendUpdate)
 {
 	IConnection::ptr conn(new ConnectionStub);
@@ -74,10 +137,15 @@ BOOST_AUTO_TEST_CASE(TestSendUpdate)
 	data.m_Rotation = Vector3(6.f, 7.f, 8.f);
 	data.m_RotationVelocity = Vector3(9.f, 10.f, 11.f);
 	data.m_Velocity = Vector3(12.f, 13.f, 14.f);
-	std::string extraData("TestExtraData");
-	const char* cExtraData = extraData.c_str();
+	ObjectLookData look;
+	look.m_Id = 1;
+	look.m_Forward = Vector3(0.f, 0.f, 1.f);
+	look.m_Up = Vector3(0.f, 1.f, 0.f);
+	ObjectColorData color;
+	color.m_Id = 2;
+	color.m_Color = Vector3(0.5f, 0.25f, 1.f);
 
-	controller.sendUpdateObjects(&data, 1, &cExtraData, 1);
+	controller.sendUpdateObjects(&data, 1, &look, 1, &color, 1);
 
 	BOOST_REQUIRE_EQUAL(controller.getNumPackages(), 1);
 
@@ -92,10 +160,18 @@ BOOST_AUTO_TEST_CASE(TestSendUpdate)
 	BOOST_CHECK_EQUAL(recData.m_RotationVelocity, data.m_RotationVelocity);
 	BOOST_CHECK_EQUAL(recData.m_Velocity, data.m_Velocity);
 
-	BOOST_REQUIRE_EQUAL(controller.getNumUpdateObjectExtraData(packageRef), 1);
-	const char* recExtraData = controller.getUpdateObjectExtraData(packageRef, 0);
+	BOOST_REQUIRE_EQUAL(controller.getNumUpdateObjectLooks(packageRef), 1);
+	const ObjectLookData& recLook = controller.getUpdateObjectLooks(packageRef)[0];
+
+	BOOST_CHECK_EQUAL(recLook.m_Id, look.m_Id);
+	BOOST_CHECK_EQUAL(recLook.m_Forward, look.m_Forward);
+	BOOST_CHECK_EQUAL(recLook.m_Up, look.m_Up);
+
+	BOOST_REQUIRE_EQUAL(controller.getNumUpdateObjectColors(packageRef), 1);
+	const ObjectColorData& recColor = controller.getUpdateObjectColors(packageRef)[0];
 
-	BOOST_CHECK_EQUAL(recExtraData, extraData);
+	BOOST_CHECK_EQUAL(recColor.m_Id, color.m_Id);
+	BOOST_CHECK_EQUAL(recColor.m_Color, color.m_Color);
 }
 
 BOOST_AUTO_TEST_CASE(TestSendCreateObjects)
@@ -149,6 +225,39 @@ BOOST_AUTO_TEST_CASE(TestSendGameResult)
 	BOOST_CHECK_EQUAL(recData, testExtraData);
 }
 
+BOOST_AUTO_TEST_CASE(TestSendRacePosition)
+{
+	IConnection::ptr conn(new ConnectionStub);
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new GamePositions));
+
+	ConnectionController controller(conn, prototypes);
+
+	RacePositionData positions[2];
+	positions[0].m_Place = 3;
+	positions[0].m_HasTime = false;
+	positions[0].m_Time = 0.f;
+	positions[1].m_Place = 2;
+	positions[1].m_HasTime = true;
+	positions[1].m_Time = 4.5f;
+
+	controller.sendRacePosition(positions, 2);
+
+	BOOST_REQUIRE_EQUAL(controller.getNumPackages(), 1);
+
+	Package packageRef = controller.getPackage(0);
+	BOOST_REQUIRE_EQUAL((uint16_t)controller.getPackageType(packageRef), (uint16_t)PackageType::GAME_POSITIONS);
+	BOOST_REQUIRE_EQUAL(controller.getNumRacePositionsData(packageRef), 2);
+	const RacePositionData* recData = controller.getRacePositionsData(packageRef);
+
+	BOOST_CHECK_EQUAL(recData[0].m_Place, 3);
+	BOOST_CHECK(!recData[0].m_HasTime);
+	BOOST_CHECK_EQUAL(recData[1].m_Place, 2);
+	BOOST_CHECK(recData[1].m_HasTime);
+	BOOST_CHECK_EQUAL(recData[1].m_Time, 4.5f);
+}
+
 BOOST_AUTO_TEST_CASE(TestSendLevelData)
 {
 	IConnection::ptr conn(new ConnectionStub);
@@ -275,4 +384,126 @@ BOOST_AUTO_TEST_CASE(TestSendRemoveObjects)
 	BOOST_CHECK_EQUAL(controller.getRemoveObjectRefs(packageRef)[0], testObjectId);
 }
 
+BOOST_AUTO_TEST_CASE(TestSendFrameToManyConnections)
+{
+	static const unsigned int numConnections = 4;
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new ObjectAction));
+
+	std::vector<std::unique_ptr<ConnectionController>> controllers;
+	std::vector<const char*> sentData;
+	for (unsigned int i = 0; i < numConnections; ++i)
+	{
+		std::shared_ptr<ConnectionStub> conn(new ConnectionStub);
+		controllers.push_back(std::unique_ptr<ConnectionController>(new ConnectionController(conn, prototypes)));
+
+		IConnection::saveDataFunction receive = conn->m_SaveData;
+		conn->m_SaveData = [&sentData, receive] (uint16_t p_ID, const Buffer& p_Data)
+		{
+			sentData.push_back(p_Data.data());
+			receive(p_ID, p_Data);
+		};
+	}
+
+	static const uint32_t testObjectId = 4321;
+	static const std::string testAction("Broadcast action");
+
+	SharedFrame frame = controllers[0]->encodeObjectAction(testObjectId, testAction.c_str());
+	for (auto& controller : controllers)
+	{
+		controller->sendFrame(frame);
+	}
+
+	BOOST_REQUIRE_EQUAL(sentData.size(), numConnections);
+	for (unsigned int i = 0; i < numConnections; ++i)
+	{
+		// Every connection shares the data that was encoded once.
+		BOOST_CHECK(sentData[i] == sentData[0]);
+
+		ConnectionController& controller = *controllers[i];
+		BOOST_REQUIRE_EQUAL(controller.getNumPackages(), 1);
+		Package packageRef = controller.getPackage(0);
+		BOOST_REQUIRE_EQUAL((uint16_t)controller.getPackageType(packageRef), (uint16_t)PackageType::OBJECT_ACTION);
+		BOOST_CHECK_EQUAL(controller.getObjectActionId(packageRef), testObjectId);
+		BOOST_CHECK_EQUAL(controller.getObjectActionAction(packageRef), testAction);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricsCountPackagesPerType)
+{
+	IConnection::ptr conn(new ConnectionStub);
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new ObjectAction));
+
+	ConnectionController controller(conn, prototypes);
+
+	static const std::string testAction("Counted action");
+	controller.sendObjectAction(1, testAction.c_str());
+	controller.sendObjectAction(2, testAction.c_str());
+
+	const ConnectionMetrics metrics = controller.getMetrics();
+	BOOST_CHECK_EQUAL(metrics.m_NumConnections, 1);
+
+	// The stub delivers every sent package back to the controller.
+	const PackageTypeMetrics& action = metrics.m_Types[(uint16_t)PackageType::OBJECT_ACTION];
+	BOOST_CHECK_EQUAL(action.m_PackagesSent, 2);
+	BOOST_CHECK_EQUAL(action.m_PackagesReceived, 2);
+	BOOST_CHECK_GT(action.m_BytesSent, 2 * testAction.size());
+	BOOST_CHECK_EQUAL(action.m_BytesSent, action.m_BytesReceived);
+	BOOST_CHECK_GE(action.m_EncodeSeconds, 0.0);
+	BOOST_CHECK_GE(action.m_DecodeSeconds, 0.0);
+
+	const PackageTypeMetrics& control = metrics.m_Types[(uint16_t)PackageType::PLAYER_CONTROL];
+	BOOST_CHECK_EQUAL(control.m_PackagesSent, 0);
+	BOOST_CHECK_EQUAL(control.m_PackagesReceived, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestPingMeasuresRoundTrip)
+{
+	IConnection::ptr conn(new ConnectionStub);
+	std::vector<PackageBase::ptr> prototypes;
+	ConnectionController controller(conn, prototypes);
+
+	BOOST_CHECK_EQUAL(controller.getMetrics().m_NumRoundTrips, 0);
+
+	// The stub answers the ping immediately, with the pong handled internally.
+	controller.sendPing();
+	controller.sendPing();
+
+	const ConnectionMetrics metrics = controller.getMetrics();
+	BOOST_CHECK_EQUAL(metrics.m_NumRoundTrips, 2);
+	BOOST_CHECK_GE(metrics.m_RoundTripTime, 0.f);
+	BOOST_CHECK_LT(metrics.m_RoundTripTime, 1.f);
+	BOOST_CHECK_EQUAL(metrics.m_Types[(uint16_t)PackageType::PING].m_PackagesSent, 2);
+	BOOST_CHECK_EQUAL(metrics.m_Types[(uint16_t)PackageType::PONG].m_PackagesReceived, 2);
+	BOOST_CHECK_EQUAL(controller.getNumPackages(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestCombinedMetrics)
+{
+	ConnectionMetrics total = ConnectionMetrics();
+	ConnectionMetrics first = ConnectionMetrics();
+	first.m_NumConnections = 1;
+	first.m_Types[(uint16_t)PackageType::PLAYER_CONTROL].m_PackagesSent = 3;
+	first.m_MaxQueuedPackages = 5;
+	first.m_NumRoundTrips = 1;
+	first.m_RoundTripTime = 0.1f;
+
+	ConnectionMetrics second = first;
+	second.m_MaxQueuedPackages = 2;
+	second.m_NumRoundTrips = 3;
+	second.m_RoundTripTime = 0.5f;
+
+	addConnectionMetrics(total, first);
+	addConnectionMetrics(total, second);
+
+	BOOST_CHECK_EQUAL(total.m_NumConnections, 2);
+	BOOST_CHECK_EQUAL(total.m_Types[(uint16_t)PackageType::PLAYER_CONTROL].m_PackagesSent, 6);
+	BOOST_CHECK_EQUAL(total.m_MaxQueuedPackages, 5);
+	BOOST_CHECK_EQUAL(total.m_NumRoundTrips, 4);
+	BOOST_CHECK_CLOSE(total.m_RoundTripTime, 0.4f, 0.01f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
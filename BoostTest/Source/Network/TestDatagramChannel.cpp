@@ -0,0 +1,401 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/ConnectionController.h"
+#include "../../../Network/Source/DatagramSocket.h"
+#include "../../../Network/Source/WireFormat.h"
+
+#include <boost/thread.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(TestDatagramChannel)
+
+namespace
+{
+	const boost::asio::ip::udp::endpoint anyLoopback(boost::asio::ip::address_v4::loopback(), 0);
+
+	/**
+	 * Runs an io service on a background thread for the duration of a test.
+	 */
+	class IORunner
+	{
+	public:
+		boost::asio::io_service m_IO_Service;
+
+	private:
+		std::unique_ptr<boost::asio::io_service::work> m_Work;
+		boost::thread m_Thread;
+
+	public:
+		IORunner()
+			:	m_Work(new boost::asio::io_service::work(m_IO_Service))
+		{
+			m_Thread = boost::thread([this] () { m_IO_Service.run(); });
+		}
+
+		~IORunner()
+		{
+			m_Work.reset();
+			m_IO_Service.stop();
+			m_Thread.join();
+		}
+	};
+
+	/**
+	 * Collects the counters received on a channel.
+	 */
+	class Receiver
+	{
+	public:
+		std::mutex m_Lock;
+		std::vector<uint32_t> m_Values;
+
+		void receive(uint16_t /*p_ID*/, const Buffer& p_Data)
+		{
+			WireReader reader(p_Data.data(), p_Data.size());
+			const uint32_t value = reader.readUint32();
+
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Values.push_back(value);
+		}
+
+		std::vector<uint32_t> getValues()
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			return m_Values;
+		}
+	};
+
+	Buffer counterBuffer(uint32_t p_Value)
+	{
+		std::shared_ptr<Buffer::Storage> storage(new Buffer::Storage);
+		WireWriter writer(*storage);
+		writer.writeUint32(p_Value);
+		return Buffer(storage);
+	}
+
+	template <typename Condition>
+	bool waitFor(Condition p_Condition)
+	{
+		for (int i = 0; i < 400; ++i)
+		{
+			if (p_Condition())
+			{
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return p_Condition();
+	}
+
+	bool isIncreasing(const std::vector<uint32_t>& p_Values)
+	{
+		for (size_t i = 1; i < p_Values.size(); ++i)
+		{
+			if (p_Values[i] <= p_Values[i - 1])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Reliable connection stub delivering written packages directly to a peer.
+	 */
+	class LinkedConnectionStub : public IConnection
+	{
+	public:
+		LinkedConnectionStub* m_Peer;
+		IConnection::saveDataFunction m_SaveData;
+		std::mutex m_Lock;
+		std::map<uint16_t, unsigned int> m_NumWritten;
+
+		LinkedConnectionStub() : m_Peer(nullptr) {}
+
+		bool isConnected() const override { return true; }
+		void disconnect() override {}
+		bool hasError() const override { return false; }
+		void writeData(const Buffer& p_Buffer, uint16_t p_ID) override
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Lock);
+				++m_NumWritten[p_ID];
+			}
+			if (m_Peer && m_Peer->m_SaveData)
+			{
+				m_Peer->m_SaveData(p_ID, p_Buffer);
+			}
+		}
+		void setSaveData(saveDataFunction p_SaveData) override
+		{
+			m_SaveData = p_SaveData;
+		}
+		void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) override {}
+		void startReading() override {}
+		WriteStatistics getWriteStatistics() const override { return WriteStatistics(); }
+
+		unsigned int getNumWritten(PackageType p_Type)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			return m_NumWritten[(uint16_t)p_Type];
+		}
+	};
+}
+
+BOOST_AUTO_TEST_CASE(TestDatagramRoundTrip)
+{
+	IORunner runner;
+	DatagramSocket::ptr serverSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	DatagramSocket::ptr clientSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	serverSocket->startReceiving();
+	clientSocket->startReceiving();
+
+	static const uint32_t token = 1234;
+	DatagramChannel::ptr serverChannel = serverSocket->createChannel(token);
+	DatagramChannel::ptr clientChannel = clientSocket->createChannel(token);
+	DatagramChannel::ptr otherChannel = serverSocket->createChannel(token + 1);
+
+	Receiver serverReceiver;
+	Receiver clientReceiver;
+	Receiver otherReceiver;
+	serverChannel->setSaveData(std::bind(&Receiver::receive, &serverReceiver, std::placeholders::_1, std::placeholders::_2));
+	clientChannel->setSaveData(std::bind(&Receiver::receive, &clientReceiver, std::placeholders::_1, std::placeholders::_2));
+	otherChannel->setSaveData(std::bind(&Receiver::receive, &otherReceiver, std::placeholders::_1, std::placeholders::_2));
+
+	// The server learns the client address from the first datagram.
+	BOOST_CHECK(!serverChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(1)));
+
+	clientChannel->setRemote(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), serverSocket->getLocalPort()));
+	static const uint32_t numPackages = 20;
+	for (uint32_t i = 1; i <= numPackages; ++i)
+	{
+		BOOST_CHECK(clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(i)));
+	}
+
+	BOOST_REQUIRE(waitFor([&] () { return serverReceiver.getValues().size() == numPackages; }));
+	BOOST_CHECK(isIncreasing(serverReceiver.getValues()));
+	BOOST_CHECK(otherReceiver.getValues().empty());
+
+	BOOST_REQUIRE(serverChannel->hasRemote());
+	BOOST_CHECK(serverChannel->send((uint16_t)PackageType::OBJECT_SNAPSHOT, counterBuffer(7)));
+	BOOST_REQUIRE(waitFor([&] () { return clientReceiver.getValues().size() == 1; }));
+	BOOST_CHECK_EQUAL(clientReceiver.getValues()[0], 7);
+
+	// Packages that would be fragmented are left to the reliable connection.
+	std::shared_ptr<Buffer::Storage> large(new Buffer::Storage(DatagramChannel::maxPayloadSize + 1));
+	BOOST_CHECK(!clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, Buffer(large)));
+
+	serverSocket->close();
+	clientSocket->close();
+}
+
+BOOST_AUTO_TEST_CASE(TestDatagramLossSimulation)
+{
+	IORunner runner;
+	DatagramSocket::ptr serverSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	DatagramSocket::ptr clientSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	serverSocket->startReceiving();
+	clientSocket->setSimulator(std::make_shared<LinkSimulator>(0.3f, 0, 0, 5));
+
+	DatagramChannel::ptr serverChannel = serverSocket->createChannel(1);
+	DatagramChannel::ptr clientChannel = clientSocket->createChannel(1);
+	clientChannel->setRemote(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), serverSocket->getLocalPort()));
+
+	Receiver receiver;
+	serverChannel->setSaveData(std::bind(&Receiver::receive, &receiver, std::placeholders::_1, std::placeholders::_2));
+
+	static const uint32_t numPackages = 500;
+	for (uint32_t i = 1; i <= numPackages; ++i)
+	{
+		clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(i));
+		if (i % 50 == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	BOOST_REQUIRE(waitFor([&] () { return receiver.getValues().size() >= numPackages / 2; }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	const std::vector<uint32_t> values = receiver.getValues();
+	BOOST_TEST_MESSAGE("Received " << values.size() << " of " << numPackages << " datagrams with 30% simulated loss");
+	BOOST_CHECK_LT(values.size(), numPackages * 8 / 10);
+	BOOST_CHECK_GT(values.size(), numPackages * 6 / 10);
+	BOOST_CHECK(isIncreasing(values));
+
+	serverSocket->close();
+	clientSocket->close();
+}
+
+BOOST_AUTO_TEST_CASE(TestDatagramLatencyDropsStale)
+{
+	IORunner runner;
+	DatagramSocket::ptr serverSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	DatagramSocket::ptr clientSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	serverSocket->startReceiving();
+	clientSocket->setSimulator(std::make_shared<LinkSimulator>(0.f, 10, 20, 7));
+
+	DatagramChannel::ptr serverChannel = serverSocket->createChannel(1);
+	DatagramChannel::ptr clientChannel = clientSocket->createChannel(1);
+	clientChannel->setRemote(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), serverSocket->getLocalPort()));
+
+	Receiver receiver;
+	serverChannel->setSaveData(std::bind(&Receiver::receive, &receiver, std::placeholders::_1, std::placeholders::_2));
+
+	static const uint32_t numPackages = 100;
+	for (uint32_t i = 1; i <= numPackages; ++i)
+	{
+		clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(i));
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// Jitter reorders the datagrams, the older ones are dropped on arrival.
+	BOOST_REQUIRE(waitFor([&] () { return serverChannel->getNumReceived() + serverChannel->getNumStale() == numPackages; }));
+	BOOST_TEST_MESSAGE("Dropped " << serverChannel->getNumStale() << " of " << numPackages << " reordered datagrams as stale");
+	BOOST_CHECK_GT(serverChannel->getNumStale(), 0);
+	BOOST_CHECK(isIncreasing(receiver.getValues()));
+	BOOST_CHECK_EQUAL(receiver.getValues().back(), numPackages);
+
+	serverSocket->close();
+	clientSocket->close();
+}
+
+BOOST_AUTO_TEST_CASE(TestMalformedDatagramKeepsReceiving)
+{
+	IORunner runner;
+	DatagramSocket::ptr serverSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	DatagramSocket::ptr clientSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	serverSocket->startReceiving();
+
+	DatagramChannel::ptr serverChannel = serverSocket->createChannel(1);
+	DatagramChannel::ptr clientChannel = clientSocket->createChannel(1);
+	clientChannel->setRemote(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), serverSocket->getLocalPort()));
+
+	Receiver receiver;
+	serverChannel->setSaveData(std::bind(&Receiver::receive, &receiver, std::placeholders::_1, std::placeholders::_2));
+
+	// Too short for the counter, so decoding it throws on the receiving io thread.
+	std::shared_ptr<Buffer::Storage> truncated(new Buffer::Storage(2));
+	BOOST_CHECK(clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, Buffer(truncated)));
+	BOOST_REQUIRE(waitFor([&] () { return serverChannel->getNumReceived() == 1; }));
+	BOOST_CHECK(receiver.getValues().empty());
+
+	BOOST_CHECK(clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(3)));
+	BOOST_REQUIRE(waitFor([&] () { return receiver.getValues().size() == 1; }));
+	BOOST_CHECK_EQUAL(receiver.getValues()[0], 3);
+
+	serverSocket->close();
+	clientSocket->close();
+}
+
+BOOST_AUTO_TEST_CASE(TestDatagramFromOtherAddressIsDropped)
+{
+	IORunner runner;
+	DatagramSocket::ptr serverSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	DatagramSocket::ptr clientSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	DatagramSocket::ptr otherSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	serverSocket->startReceiving();
+
+	const boost::asio::ip::udp::endpoint server(boost::asio::ip::address_v4::loopback(), serverSocket->getLocalPort());
+	DatagramChannel::ptr serverChannel = serverSocket->createChannel(1);
+	DatagramChannel::ptr clientChannel = clientSocket->createChannel(1);
+	DatagramChannel::ptr otherChannel = otherSocket->createChannel(1);
+	clientChannel->setRemote(server);
+	otherChannel->setRemote(server);
+
+	Receiver receiver;
+	serverChannel->setSaveData(std::bind(&Receiver::receive, &receiver, std::placeholders::_1, std::placeholders::_2));
+
+	BOOST_CHECK(clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(1)));
+	BOOST_REQUIRE(waitFor([&] () { return receiver.getValues().size() == 1; }));
+
+	// Same token, but not from the address the channel learnt first.
+	BOOST_CHECK(otherChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(2)));
+	BOOST_REQUIRE(waitFor([&] () { return serverChannel->getNumRejected() == 1; }));
+
+	BOOST_CHECK(clientChannel->send((uint16_t)PackageType::PLAYER_CONTROL, counterBuffer(3)));
+	BOOST_REQUIRE(waitFor([&] () { return receiver.getValues().size() == 2; }));
+	BOOST_CHECK_EQUAL(receiver.getValues()[1], 3);
+
+	serverSocket->close();
+	clientSocket->close();
+	otherSocket->close();
+}
+
+BOOST_AUTO_TEST_CASE(TestStatePackagesUseDatagramChannel)
+{
+	IORunner runner;
+	DatagramSocket::ptr serverSocket(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+	serverSocket->startReceiving();
+	DatagramSocket::ptr clientSocket;
+
+	std::shared_ptr<LinkedConnectionStub> serverConn(new LinkedConnectionStub);
+	std::shared_ptr<LinkedConnectionStub> clientConn(new LinkedConnectionStub);
+	serverConn->m_Peer = clientConn.get();
+	clientConn->m_Peer = serverConn.get();
+
+	DatagramChannel::ptr clientChannel;
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new PlayerControl));
+	prototypes.push_back(PackageBase::ptr(new LeaveGame));
+	ConnectionController serverController(serverConn, prototypes);
+	ConnectionController clientController(clientConn, prototypes);
+
+	clientController.setDatagramOfferCallback([&] (uint32_t p_Token, uint16_t p_Port)
+	{
+		clientSocket.reset(new DatagramSocket(runner.m_IO_Service, anyLoopback));
+		clientSocket->startReceiving();
+		clientChannel = clientSocket->createChannel(p_Token);
+		clientChannel->setRemote(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), p_Port));
+		clientController.setDatagramChannel(clientChannel);
+	});
+
+	serverController.offerDatagramChannel(serverSocket->createChannel(42), serverSocket->getLocalPort());
+	BOOST_REQUIRE(waitFor([&] () { return clientController.isDatagramChannelReady(); }));
+	BOOST_CHECK(serverController.isDatagramChannelReady());
+
+	PlayerControlData control;
+	control.m_Position = Vector3(1.f, 2.f, 3.f);
+	control.m_Velocity = Vector3(0.f, 0.f, 0.f);
+	control.m_Rotation = Vector3(0.f, 0.f, 0.f);
+	control.m_Forward = Vector3(0.f, 0.f, 1.f);
+	control.m_Up = Vector3(0.f, 1.f, 0.f);
+	clientController.sendPlayerControl(control);
+	BOOST_REQUIRE(waitFor([&] () { return serverController.getNumPackages() == 1; }));
+	BOOST_CHECK_EQUAL(serverController.getPlayerControlData(0).m_Position, control.m_Position);
+	BOOST_CHECK_EQUAL(clientConn->getNumWritten(PackageType::PLAYER_CONTROL), 0);
+
+	UpdateObjectData object;
+	object.m_Id = 5;
+	object.m_Position = Vector3(10.f, 20.f, 30.f);
+	object.m_Velocity = Vector3(0.f, 0.f, 0.f);
+	object.m_Rotation = Vector3(0.f, 0.f, 0.f);
+	object.m_RotationVelocity = Vector3(0.f, 0.f, 0.f);
+	serverController.sendUpdateObjects(&object, 1, nullptr, 0, nullptr, 0);
+	BOOST_REQUIRE(waitFor([&] () { return clientController.getNumPackages() == 1; }));
+	BOOST_CHECK_EQUAL(clientController.getNumUpdateObjectData(0), 1);
+	BOOST_CHECK_EQUAL(serverConn->getNumWritten(PackageType::OBJECT_SNAPSHOT), 0);
+
+	// Events stay on the reliable connection.
+	serverController.sendLeaveGame();
+	BOOST_CHECK_EQUAL(serverConn->getNumWritten(PackageType::LEAVE_GAME), 1);
+
+	// Events arriving as datagrams are dropped, the state after them is still received.
+	BOOST_CHECK(clientChannel->send((uint16_t)PackageType::LEAVE_GAME, Buffer()));
+	clientController.sendPlayerControl(control);
+	BOOST_REQUIRE(waitFor([&] () { return serverController.getNumPackages() == 2; }));
+	BOOST_CHECK(serverController.getPackageType(1) == PackageType::PLAYER_CONTROL);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	BOOST_CHECK_EQUAL(serverController.getNumPackages(), 2);
+
+	serverSocket->close();
+	if (clientSocket)
+	{
+		clientSocket->close();
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
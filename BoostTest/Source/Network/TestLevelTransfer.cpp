@@ -0,0 +1,350 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/Compression.h"
+#include "../../../Network/Source/ConnectionController.h"
+#include "../../../Network/Source/LevelTransfer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <random>
+
+BOOST_AUTO_TEST_SUITE(TestLevelTransfer)
+
+namespace
+{
+	/**
+	 * Level-like data: repeated model names and transforms with some noise.
+	 */
+	std::string createLevel(size_t p_NumInstances)
+	{
+		std::mt19937 random(7);
+		std::uniform_int_distribution<int> model(0, 9);
+		std::uniform_int_distribution<int> coordinate(-5000, 5000);
+
+		std::string level;
+		for (size_t i = 0; i < p_NumInstances; ++i)
+		{
+			level += "Model" + std::to_string(model(random)) + ".btx";
+			const float values[] = { (float)coordinate(random), 0.f, (float)coordinate(random), 0.f, 90.f, 0.f, 1.f, 1.f, 1.f };
+			level.append((const char*)values, sizeof(values));
+		}
+		return level;
+	}
+
+	void checkRoundTrip(const std::string& p_Data)
+	{
+		std::vector<char> compressed;
+		Compression::compress(p_Data.data(), p_Data.size(), compressed);
+
+		std::string result(p_Data.size(), '\0');
+		Compression::decompress(compressed.data(), compressed.size(), p_Data.empty() ? nullptr : &result[0], result.size());
+		BOOST_CHECK(result == p_Data);
+	}
+
+	/**
+	 * Connection queuing written packages until pumped to the other end.
+	 */
+	class QueuedConnectionStub : public IConnection
+	{
+	public:
+		IConnection::saveDataFunction m_SaveData;
+		QueuedConnectionStub* m_Peer;
+		std::deque<std::pair<uint16_t, Buffer>> m_Outgoing;
+		std::map<uint16_t, unsigned int> m_NumSent;
+		unsigned int m_NumChunksToCorrupt;
+		bool m_Disconnected;
+
+		QueuedConnectionStub()
+			:	m_Peer(nullptr),
+				m_NumChunksToCorrupt(0),
+				m_Disconnected(false)
+		{
+		}
+
+		bool isConnected() const override { return !m_Disconnected; }
+		void disconnect() override { m_Disconnected = true; }
+		bool hasError() const override { return false; }
+		void writeData(const Buffer& p_Buffer, uint16_t p_ID) override
+		{
+			m_Outgoing.push_back(std::make_pair(p_ID, p_Buffer));
+			++m_NumSent[p_ID];
+		}
+		void setSaveData(saveDataFunction p_SaveData) override
+		{
+			m_SaveData = p_SaveData;
+		}
+		void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) override {}
+		void startReading() override {}
+		WriteStatistics getWriteStatistics() const override { return WriteStatistics(); }
+
+		bool deliverOne()
+		{
+			if (m_Outgoing.empty())
+			{
+				return false;
+			}
+			std::pair<uint16_t, Buffer> package = m_Outgoing.front();
+			m_Outgoing.pop_front();
+			if (package.first == (uint16_t)PackageType::LEVEL_CHUNK && m_NumChunksToCorrupt > 0)
+			{
+				// Cut the compressed data short, keeping the chunk header.
+				--m_NumChunksToCorrupt;
+				const char* data = package.second.data();
+				std::shared_ptr<const Buffer::Storage> storage(
+					new Buffer::Storage(data, data + LevelTransfer::chunkHeaderSize + 1));
+				package.second = Buffer(storage);
+			}
+			m_Peer->m_SaveData(package.first, package.second);
+			return true;
+		}
+
+		/**
+		 * @return the number of packages waiting to be delivered.
+		 */
+		size_t getQueued() const
+		{
+			return m_Outgoing.size();
+		}
+	};
+
+	/**
+	 * A server and a client controller connected through queued stubs.
+	 */
+	class ControllerPair
+	{
+	public:
+		std::vector<PackageBase::ptr> m_Prototypes;
+		std::shared_ptr<QueuedConnectionStub> m_ServerConnection;
+		std::shared_ptr<QueuedConnectionStub> m_ClientConnection;
+		std::unique_ptr<ConnectionController> m_Server;
+		std::unique_ptr<ConnectionController> m_Client;
+
+		ControllerPair()
+			:	m_ServerConnection(new QueuedConnectionStub),
+				m_ClientConnection(new QueuedConnectionStub)
+		{
+			m_Prototypes.push_back(PackageBase::ptr(new LevelData));
+			m_Prototypes.push_back(PackageBase::ptr(new AssignPlayer));
+			m_Prototypes.push_back(PackageBase::ptr(new ObjectAction));
+
+			m_ServerConnection->m_Peer = m_ClientConnection.get();
+			m_ClientConnection->m_Peer = m_ServerConnection.get();
+			m_Server.reset(new ConnectionController(m_ServerConnection, m_Prototypes));
+			m_Client.reset(new ConnectionController(m_ClientConnection, m_Prototypes));
+		}
+
+		/**
+		 * Deliver packages both ways, one at a time, until nothing is queued.
+		 *
+		 * @return the largest number of packages waiting on the server side.
+		 */
+		size_t pumpAll()
+		{
+			size_t maxQueued = 0;
+			bool delivered = true;
+			while (delivered)
+			{
+				maxQueued = std::max(maxQueued, m_ServerConnection->getQueued());
+				delivered = m_ServerConnection->deliverOne();
+				delivered = m_ClientConnection->deliverOne() || delivered;
+			}
+			return maxQueued;
+		}
+	};
+}
+
+BOOST_AUTO_TEST_CASE(TestCompressionRoundTrip)
+{
+	checkRoundTrip(std::string());
+	checkRoundTrip("a");
+	checkRoundTrip("abcdefghijklmnopqrstuvwxyz");
+	checkRoundTrip(std::string(100000, 'x'));
+	checkRoundTrip(createLevel(2000));
+
+	std::mt19937 random(3);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::string noise(70000, '\0');
+	for (char& c : noise)
+	{
+		c = (char)byte(random);
+	}
+	checkRoundTrip(noise);
+	// Matches further away than the largest offset.
+	checkRoundTrip(noise + noise);
+}
+
+BOOST_AUTO_TEST_CASE(TestCompressionRatio)
+{
+	const std::string level = createLevel(5000);
+	std::vector<char> compressed;
+	Compression::compress(level.data(), level.size(), compressed);
+
+	BOOST_TEST_MESSAGE("Level-like data of " << level.size() << " bytes compressed to " << compressed.size() << " bytes");
+	BOOST_CHECK_LT(compressed.size() * 2, level.size());
+}
+
+BOOST_AUTO_TEST_CASE(TestCorruptCompressedData)
+{
+	const std::string data = createLevel(100);
+	std::vector<char> compressed;
+	Compression::compress(data.data(), data.size(), compressed);
+
+	std::string result(data.size(), '\0');
+	BOOST_CHECK_THROW(Compression::decompress(compressed.data(), compressed.size() / 2, &result[0], result.size()), NetworkError);
+	BOOST_CHECK_THROW(Compression::decompress(compressed.data(), compressed.size(), &result[0], result.size() - 1), NetworkError);
+
+	// An offset pointing before the start of the output.
+	const char badOffset[] = { 0x10, 'a', 0x05, 0x00 };
+	char out[16];
+	BOOST_CHECK_THROW(Compression::decompress(badOffset, sizeof(badOffset), out, 5), NetworkError);
+}
+
+BOOST_AUTO_TEST_CASE(TestChunksAssembleInAnyOrder)
+{
+	const std::string level = createLevel(10000);
+	LevelTransfer transfer(level.data(), level.size());
+
+	BOOST_REQUIRE_EQUAL(transfer.getNumChunks(), LevelTransfer::getNumChunks(level.size()));
+	BOOST_REQUIRE_GT(transfer.getNumChunks(), 4);
+	BOOST_CHECK_EQUAL(transfer.getHash(), hashLevelData(level.data(), level.size()));
+
+	LevelAssembler assembler(transfer.getHash(), transfer.getSize(), transfer.getNumChunks());
+	for (uint32_t i = transfer.getNumChunks(); i > 0; --i)
+	{
+		BOOST_CHECK(!assembler.isComplete());
+		const Buffer& chunk = transfer.getChunk(i - 1);
+		uint32_t index = 0;
+		BOOST_CHECK(assembler.addChunk(chunk.data(), chunk.size(), index));
+		BOOST_CHECK_EQUAL(index, i - 1);
+	}
+	BOOST_REQUIRE(assembler.isComplete());
+	BOOST_CHECK(assembler.takeLevel() == level);
+
+	// Chunks of another level are ignored.
+	const std::string other = createLevel(10);
+	LevelTransfer otherTransfer(other.data(), other.size());
+	LevelAssembler otherAssembler(otherTransfer.getHash(), otherTransfer.getSize(), otherTransfer.getNumChunks());
+	uint32_t index = 0;
+	BOOST_CHECK(!otherAssembler.addChunk(transfer.getChunk(0).data(), transfer.getChunk(0).size(), index));
+
+	BOOST_CHECK_THROW(LevelAssembler(1, 100000, 1), NetworkError);
+}
+
+BOOST_AUTO_TEST_CASE(TestLevelCache)
+{
+	const std::string level = createLevel(100);
+	const uint64_t hash = hashLevelData(level.data(), level.size());
+	LevelCache cache(".");
+
+	std::string loaded;
+	std::remove(cache.getPath(hash).c_str());
+	BOOST_CHECK(!cache.load(hash, level.size(), loaded));
+
+	cache.store(hash, level);
+	BOOST_REQUIRE(cache.load(hash, level.size(), loaded));
+	BOOST_CHECK(loaded == level);
+
+	// A file with the wrong content is not used.
+	cache.store(hash, level.substr(1) + "x");
+	BOOST_CHECK(!cache.load(hash, level.size(), loaded));
+
+	std::remove(cache.getPath(hash).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestLevelDownloadIsChunkedAndOrdered)
+{
+	ControllerPair pair;
+	const std::string level = createLevel(20000);
+	static const uint32_t testPlayer = 17;
+
+	SharedFrame frame = pair.m_Server->encodeLevelData(level.data(), level.size());
+	pair.m_Server->sendFrame(frame);
+	pair.m_Server->sendAssignPlayer(testPlayer);
+	pair.m_Server->sendObjectAction(testPlayer, "Interleaved");
+	const size_t maxQueued = pair.pumpAll();
+
+	const unsigned int numChunks = pair.m_ServerConnection->m_NumSent[(uint16_t)PackageType::LEVEL_CHUNK];
+	BOOST_CHECK_EQUAL(numChunks, LevelTransfer::getNumChunks(level.size()));
+	BOOST_CHECK_EQUAL(pair.m_ServerConnection->m_NumSent[(uint16_t)PackageType::LEVEL_DATA], 0);
+	// Never more than the window of chunks ahead of other packages.
+	BOOST_CHECK_LE(maxQueued, (size_t)LevelTransfer::chunkWindow + 2);
+
+	// The level is delivered in the place it was sent, before the packages after it.
+	BOOST_REQUIRE_EQUAL(pair.m_Client->getNumPackages(), 3);
+	BOOST_REQUIRE_EQUAL((uint16_t)pair.m_Client->getPackageType(0), (uint16_t)PackageType::LEVEL_DATA);
+	BOOST_REQUIRE_EQUAL(pair.m_Client->getLevelDataSize(0), level.size());
+	BOOST_CHECK(std::string(pair.m_Client->getLevelData(0), level.size()) == level);
+	BOOST_CHECK_EQUAL((uint16_t)pair.m_Client->getPackageType(1), (uint16_t)PackageType::ASSIGN_PLAYER);
+	BOOST_CHECK_EQUAL(pair.m_Client->getAssignPlayerObject(1), testPlayer);
+	BOOST_CHECK_EQUAL((uint16_t)pair.m_Client->getPackageType(2), (uint16_t)PackageType::OBJECT_ACTION);
+}
+
+BOOST_AUTO_TEST_CASE(TestCachedLevelIsNotDownloaded)
+{
+	const std::string level = createLevel(20000);
+	std::shared_ptr<LevelCache> cache(new LevelCache("."));
+	const std::string cacheFile = cache->getPath(hashLevelData(level.data(), level.size()));
+	std::remove(cacheFile.c_str());
+
+	{
+		ControllerPair first;
+		first.m_Client->setLevelCache(cache);
+		first.m_Server->sendLevelData(level.data(), level.size());
+		first.pumpAll();
+		BOOST_CHECK_GT(first.m_ServerConnection->m_NumSent[(uint16_t)PackageType::LEVEL_CHUNK], 0);
+		BOOST_REQUIRE_EQUAL(first.m_Client->getNumPackages(), 1);
+	}
+
+	ControllerPair returning;
+	returning.m_Client->setLevelCache(cache);
+	returning.m_Server->sendLevelData(level.data(), level.size());
+	returning.m_Server->sendAssignPlayer(1);
+	returning.pumpAll();
+
+	BOOST_CHECK_EQUAL(returning.m_ServerConnection->m_NumSent[(uint16_t)PackageType::LEVEL_CHUNK], 0);
+	BOOST_CHECK_EQUAL(returning.m_ClientConnection->m_NumSent[(uint16_t)PackageType::LEVEL_REQUEST], 0);
+	BOOST_REQUIRE_EQUAL(returning.m_Client->getNumPackages(), 2);
+	BOOST_REQUIRE_EQUAL((uint16_t)returning.m_Client->getPackageType(0), (uint16_t)PackageType::LEVEL_DATA);
+	BOOST_CHECK(std::string(returning.m_Client->getLevelData(0), returning.m_Client->getLevelDataSize(0)) == level);
+
+	std::remove(cacheFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestCorruptChunkRestartsDownload)
+{
+	ControllerPair pair;
+	pair.m_ServerConnection->m_NumChunksToCorrupt = 1;
+	const std::string level = createLevel(20000);
+
+	pair.m_Server->sendLevelData(level.data(), level.size());
+	pair.m_Server->sendAssignPlayer(1);
+	pair.pumpAll();
+
+	BOOST_CHECK_EQUAL(pair.m_ClientConnection->m_NumSent[(uint16_t)PackageType::LEVEL_REQUEST], 2);
+	BOOST_CHECK(!pair.m_ClientConnection->m_Disconnected);
+	BOOST_REQUIRE_EQUAL(pair.m_Client->getNumPackages(), 2);
+	BOOST_REQUIRE_EQUAL((uint16_t)pair.m_Client->getPackageType(0), (uint16_t)PackageType::LEVEL_DATA);
+	BOOST_CHECK(std::string(pair.m_Client->getLevelData(0), pair.m_Client->getLevelDataSize(0)) == level);
+	BOOST_CHECK_EQUAL((uint16_t)pair.m_Client->getPackageType(1), (uint16_t)PackageType::ASSIGN_PLAYER);
+}
+
+BOOST_AUTO_TEST_CASE(TestRepeatedlyCorruptLevelDisconnects)
+{
+	ControllerPair pair;
+	pair.m_ServerConnection->m_NumChunksToCorrupt = 1000;
+	const std::string level = createLevel(20000);
+
+	pair.m_Server->sendLevelData(level.data(), level.size());
+	pair.m_Server->sendAssignPlayer(1);
+	pair.pumpAll();
+
+	BOOST_CHECK_EQUAL(pair.m_ClientConnection->m_NumSent[(uint16_t)PackageType::LEVEL_REQUEST], (unsigned int)LevelAssembler::maxAttempts);
+	BOOST_CHECK(pair.m_ClientConnection->m_Disconnected);
+	BOOST_CHECK(!pair.m_Client->isConnected());
+	// The packages held back for the level are still delivered.
+	BOOST_REQUIRE_EQUAL(pair.m_Client->getNumPackages(), 1);
+	BOOST_CHECK_EQUAL((uint16_t)pair.m_Client->getPackageType(0), (uint16_t)PackageType::ASSIGN_PLAYER);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,284 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/ConnectionController.h"
+#include "../../../Network/Source/SPSCQueue.h"
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(TestSPSCQueue)
+
+namespace
+{
+	class InstanceCounter
+	{
+	public:
+		static int s_NumInstances;
+
+		InstanceCounter()
+		{
+			++s_NumInstances;
+		}
+
+		~InstanceCounter()
+		{
+			--s_NumInstances;
+		}
+	};
+
+	int InstanceCounter::s_NumInstances = 0;
+
+	class ConnectionStub : public IConnection
+	{
+	public:
+		IConnection::saveDataFunction m_SaveData;
+
+		bool isConnected() const override { return true; }
+		void disconnect() override {};
+		bool hasError() const override { return false; }
+		void writeData(const Buffer& p_Buffer, uint16_t p_ID) override {}
+		void setSaveData(saveDataFunction p_SaveData) override
+		{
+			m_SaveData = p_SaveData;
+		}
+		void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) override {}
+		void startReading() override {}
+		WriteStatistics getWriteStatistics() const override { return WriteStatistics(); }
+	};
+
+	/**
+	 * The received package list as it was before the lock-free queue,
+	 * with every accessor taking the same lock as the io thread.
+	 */
+	class LockedPackageList
+	{
+	private:
+		std::vector<PackageBase::ptr> m_Packages;
+		std::mutex m_Lock;
+
+	public:
+		void push(PackageBase::ptr p_Package)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Packages.push_back(std::move(p_Package));
+		}
+
+		unsigned int getNumPackages()
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			return m_Packages.size();
+		}
+
+		PackageType getPackageType(Package p_Package)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			return m_Packages[p_Package]->getType();
+		}
+
+		uint32_t getObjectActionId(Package p_Package)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			return static_cast<ObjectAction*>(m_Packages[p_Package].get())->m_Object1;
+		}
+
+		const char* getObjectActionAction(Package p_Package)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			return static_cast<ObjectAction*>(m_Packages[p_Package].get())->m_Object2.c_str();
+		}
+
+		void clearPackages(unsigned int p_NumPackages)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Packages.erase(m_Packages.begin(), m_Packages.begin() + p_NumPackages);
+		}
+	};
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	/**
+	 * Read every package like the game loop does, until all have been read.
+	 *
+	 * @param p_BusyTime set to the time spent reading packages, not counting empty polls.
+	 * @return the number of polls with at least one package.
+	 */
+	template <typename Controller>
+	unsigned int consumePackages(Controller& p_Controller, uint32_t p_NumPackages, bool& p_InOrder, Clock::duration& p_BusyTime)
+	{
+		uint32_t expectedId = 0;
+		unsigned int numBatches = 0;
+		size_t actionLength = 0;
+		p_BusyTime = Clock::duration(0);
+		while (expectedId < p_NumPackages)
+		{
+			const Clock::time_point start = Clock::now();
+			const unsigned int numPackages = p_Controller.getNumPackages();
+			if (numPackages == 0)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			++numBatches;
+			for (unsigned int i = 0; i < numPackages; ++i)
+			{
+				if (p_Controller.getPackageType(i) == PackageType::OBJECT_ACTION)
+				{
+					p_InOrder = p_InOrder && p_Controller.getObjectActionId(i) == expectedId;
+					actionLength += std::strlen(p_Controller.getObjectActionAction(i));
+					++expectedId;
+				}
+			}
+			p_Controller.clearPackages(numPackages);
+			p_BusyTime += Clock::now() - start;
+		}
+		BOOST_CHECK_EQUAL(actionLength, p_NumPackages * 6);
+		return numBatches;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestTakeAllInOrder)
+{
+	SPSCQueue<int> queue;
+	std::vector<int> taken;
+
+	BOOST_CHECK(queue.empty());
+	BOOST_CHECK_EQUAL(queue.takeAll(taken), 0);
+
+	for (int round = 0; round < 3; ++round)
+	{
+		for (int i = 0; i < 10; ++i)
+		{
+			queue.push(round * 10 + i);
+		}
+		BOOST_CHECK(!queue.empty());
+		BOOST_CHECK_EQUAL(queue.takeAll(taken), 10);
+		BOOST_CHECK(queue.empty());
+	}
+
+	BOOST_REQUIRE_EQUAL(taken.size(), 30);
+	for (int i = 0; i < 30; ++i)
+	{
+		BOOST_CHECK_EQUAL(taken[i], i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestQueuedValuesAreDestroyed)
+{
+	{
+		SPSCQueue<std::unique_ptr<InstanceCounter>> queue;
+		std::vector<std::unique_ptr<InstanceCounter>> taken;
+
+		queue.push(std::unique_ptr<InstanceCounter>(new InstanceCounter));
+		queue.push(std::unique_ptr<InstanceCounter>(new InstanceCounter));
+		queue.takeAll(taken);
+		queue.push(std::unique_ptr<InstanceCounter>(new InstanceCounter));
+
+		BOOST_CHECK_EQUAL(InstanceCounter::s_NumInstances, 3);
+		taken.clear();
+		BOOST_CHECK_EQUAL(InstanceCounter::s_NumInstances, 1);
+	}
+
+	BOOST_CHECK_EQUAL(InstanceCounter::s_NumInstances, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestProducerAndConsumerThreads)
+{
+	static const unsigned int numValues = 200000;
+
+	SPSCQueue<unsigned int> queue;
+	std::thread producer([&queue] ()
+	{
+		for (unsigned int i = 0; i < numValues; ++i)
+		{
+			queue.push(i);
+		}
+	});
+
+	std::vector<unsigned int> taken;
+	taken.reserve(numValues);
+	while (taken.size() < numValues)
+	{
+		if (queue.takeAll(taken) == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	bool inOrder = true;
+	for (unsigned int i = 0; i < numValues; ++i)
+	{
+		inOrder = inOrder && taken[i] == i;
+	}
+	BOOST_CHECK(inOrder);
+	BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkReceivedPackageContention)
+{
+	static const uint32_t numPackages = 100000;
+
+	std::vector<PackageBase::ptr> prototypes;
+	prototypes.push_back(PackageBase::ptr(new ObjectAction));
+
+	std::vector<Buffer> encoded;
+	encoded.reserve(numPackages);
+	for (uint32_t i = 0; i < numPackages; ++i)
+	{
+		ObjectAction package;
+		package.m_Object1 = i;
+		package.m_Object2 = "Action";
+		encoded.push_back(Buffer::copyOf(package.getData()));
+	}
+
+	// Locking list, as before.
+	LockedPackageList lockedList;
+	bool lockedInOrder = true;
+	unsigned int lockedBatches = 0;
+	Clock::duration lockedTime;
+	{
+		std::thread producer([&] ()
+		{
+			for (const Buffer& data : encoded)
+			{
+				lockedList.push(prototypes[0]->createPackage(data.data(), data.size()));
+			}
+		});
+		lockedBatches = consumePackages(lockedList, numPackages, lockedInOrder, lockedTime);
+		producer.join();
+	}
+
+	// Lock-free queue in the connection controller.
+	std::shared_ptr<ConnectionStub> conn(new ConnectionStub);
+	ConnectionController controller(conn, prototypes);
+	bool queueInOrder = true;
+	unsigned int queueBatches = 0;
+	Clock::duration queueTime;
+	{
+		std::thread producer([&] ()
+		{
+			for (const Buffer& data : encoded)
+			{
+				conn->m_SaveData((uint16_t)PackageType::OBJECT_ACTION, data);
+			}
+		});
+		queueBatches = consumePackages(controller, numPackages, queueInOrder, queueTime);
+		producer.join();
+	}
+
+	BOOST_CHECK(lockedInOrder);
+	BOOST_CHECK(queueInOrder);
+	BOOST_CHECK_EQUAL(controller.getNumPackages(), 0);
+
+	std::ostringstream message;
+	message << "Game thread time reading " << numPackages << " packages while they arrive, locked list: "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(lockedTime).count() << " us in "
+		<< lockedBatches << " batches, lock-free queue: "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(queueTime).count() << " us in "
+		<< queueBatches << " batches";
+	BOOST_TEST_MESSAGE(message.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,227 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/Snapshot.h"
+
+BOOST_AUTO_TEST_SUITE(TestSnapshot)
+
+namespace
+{
+	std::vector<UpdateObjectData> createObjects(unsigned int p_NumObjects)
+	{
+		std::vector<UpdateObjectData> objects;
+		for (unsigned int i = 0; i < p_NumObjects; ++i)
+		{
+			UpdateObjectData data;
+			data.m_Id = 100 + i * 3;
+			data.m_Position = Vector3(10.f * i, 100.f, -20.5f);
+			data.m_Velocity = Vector3(0.f, 0.f, 0.f);
+			data.m_Rotation = Vector3(0.f, 1.25f, 0.f);
+			data.m_RotationVelocity = Vector3(0.f, 0.f, 0.f);
+			objects.push_back(data);
+		}
+		return objects;
+	}
+
+	std::unique_ptr<UpdateObjects> transfer(SnapshotEncoder& p_Encoder, SnapshotDecoder& p_Decoder,
+		const std::vector<UpdateObjectData>& p_Objects, size_t& p_Bytes, bool p_Acknowledge)
+	{
+		std::vector<char> data;
+		p_Encoder.encode(p_Objects.data(), p_Objects.size(), nullptr, 0, nullptr, 0, data);
+		p_Bytes = data.size();
+
+		uint32_t sequence = 0;
+		std::unique_ptr<UpdateObjects> result = p_Decoder.decode(data.data(), data.size(), sequence);
+		if (result && p_Acknowledge)
+		{
+			p_Encoder.acknowledge(sequence);
+		}
+		return result;
+	}
+
+	void checkObjects(const std::vector<UpdateObjectData>& p_Expected, const UpdateObjects& p_Actual)
+	{
+		BOOST_REQUIRE_EQUAL(p_Actual.m_Object1.size(), p_Expected.size());
+		for (size_t i = 0; i < p_Expected.size(); ++i)
+		{
+			const UpdateObjectData& actual = p_Actual.m_Object1[i];
+			BOOST_CHECK_EQUAL(actual.m_Id, p_Expected[i].m_Id);
+			BOOST_CHECK_CLOSE(actual.m_Position.x + 1000.f, p_Expected[i].m_Position.x + 1000.f, 0.001f);
+			BOOST_CHECK_CLOSE(actual.m_Position.y, p_Expected[i].m_Position.y, 0.001f);
+			BOOST_CHECK_CLOSE(actual.m_Position.z, p_Expected[i].m_Position.z, 0.001f);
+			BOOST_CHECK_CLOSE(actual.m_Velocity.x + 1000.f, p_Expected[i].m_Velocity.x + 1000.f, 0.001f);
+			BOOST_CHECK_CLOSE(actual.m_Rotation.y, p_Expected[i].m_Rotation.y, 0.001f);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestSnapshotSendsOnlyChanges)
+{
+	SnapshotEncoder encoder;
+	SnapshotDecoder decoder;
+	std::vector<UpdateObjectData> objects = createObjects(10);
+
+	size_t fullBytes = 0;
+	std::unique_ptr<UpdateObjects> first = transfer(encoder, decoder, objects, fullBytes, true);
+	BOOST_REQUIRE(first);
+	checkObjects(objects, *first);
+	BOOST_CHECK_EQUAL(encoder.getAckedSequence(), 1);
+
+	// Nothing changed, only the header and empty lists are sent.
+	size_t idleBytes = 0;
+	std::unique_ptr<UpdateObjects> idle = transfer(encoder, decoder, objects, idleBytes, true);
+	BOOST_REQUIRE(idle);
+	checkObjects(objects, *idle);
+	BOOST_CHECK_LT(idleBytes, 20);
+
+	// Changes below the precision are not replicated.
+	objects[4].m_Position.x += 0.001f;
+	size_t jitterBytes = 0;
+	transfer(encoder, decoder, objects, jitterBytes, true);
+	BOOST_CHECK_EQUAL(jitterBytes, idleBytes);
+
+	objects[4].m_Position.x += 5.f;
+	objects[7].m_Velocity = Vector3(-3.f, 0.f, 1.f);
+	size_t changedBytes = 0;
+	std::unique_ptr<UpdateObjects> changed = transfer(encoder, decoder, objects, changedBytes, true);
+	BOOST_REQUIRE(changed);
+	checkObjects(objects, *changed);
+	BOOST_CHECK_GT(changedBytes, idleBytes);
+	BOOST_CHECK_LT(changedBytes, fullBytes / 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestSnapshotAddsAndRemovesObjects)
+{
+	SnapshotEncoder encoder;
+	SnapshotDecoder decoder;
+	std::vector<UpdateObjectData> objects = createObjects(4);
+
+	size_t bytes = 0;
+	transfer(encoder, decoder, objects, bytes, true);
+
+	objects.erase(objects.begin() + 1);
+	UpdateObjectData added = createObjects(1)[0];
+	added.m_Id = 1;
+	objects.insert(objects.begin(), added);
+
+	std::unique_ptr<UpdateObjects> result = transfer(encoder, decoder, objects, bytes, true);
+	BOOST_REQUIRE(result);
+	checkObjects(objects, *result);
+}
+
+BOOST_AUTO_TEST_CASE(TestSnapshotRecordsAreSentUntilAcknowledged)
+{
+	SnapshotEncoder encoder;
+	SnapshotDecoder decoder;
+	std::vector<UpdateObjectData> objects = createObjects(2);
+
+	ObjectLookData looks[2];
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		looks[i].m_Id = objects[i].m_Id;
+		looks[i].m_Forward = Vector3(0.f, 0.f, 1.f);
+		looks[i].m_Up = Vector3(0.f, 1.f, 0.f);
+	}
+	ObjectColorData color;
+	color.m_Id = 7;
+	color.m_Color = Vector3(1.f, 0.5f, 0.f);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		std::vector<char> data;
+		encoder.encode(objects.data(), objects.size(), looks, 2, &color, 1, data);
+		uint32_t sequence = 0;
+		std::unique_ptr<UpdateObjects> result = decoder.decode(data.data(), data.size(), sequence);
+		BOOST_REQUIRE(result);
+		BOOST_REQUIRE_EQUAL(result->m_Object2.size(), 2);
+		BOOST_CHECK_EQUAL(result->m_Object2[1].m_Id, looks[1].m_Id);
+		BOOST_CHECK_EQUAL(result->m_Object2[1].m_Forward, looks[1].m_Forward);
+		BOOST_CHECK_EQUAL(result->m_Object2[1].m_Up, looks[1].m_Up);
+		BOOST_REQUIRE_EQUAL(result->m_Object3.size(), 1);
+		BOOST_CHECK_EQUAL(result->m_Object3[0].m_Color, color.m_Color);
+	}
+
+	encoder.acknowledge(2);
+
+	// Only the look that changed since the acknowledged snapshot is sent again.
+	looks[0].m_Forward = Vector3(1.f, 0.f, 0.f);
+	std::vector<char> data;
+	encoder.encode(objects.data(), objects.size(), looks, 2, &color, 1, data);
+	uint32_t sequence = 0;
+	std::unique_ptr<UpdateObjects> result = decoder.decode(data.data(), data.size(), sequence);
+	BOOST_REQUIRE(result);
+	BOOST_REQUIRE_EQUAL(result->m_Object2.size(), 1);
+	BOOST_CHECK_EQUAL(result->m_Object2[0].m_Forward, looks[0].m_Forward);
+	BOOST_CHECK(result->m_Object3.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestSnapshotResyncsWhenBaselineIsLost)
+{
+	SnapshotEncoder encoder;
+	SnapshotDecoder decoder;
+	std::vector<UpdateObjectData> objects = createObjects(10);
+
+	size_t fullBytes = 0;
+	transfer(encoder, decoder, objects, fullBytes, true);
+
+	// Without acknowledgements the baseline eventually falls out of the history.
+	size_t bytes = 0;
+	for (size_t i = 0; i < SnapshotEncoder::maxHistory + 1; ++i)
+	{
+		objects[0].m_Position.y += 1.f;
+		std::unique_ptr<UpdateObjects> result = transfer(encoder, decoder, objects, bytes, false);
+		BOOST_REQUIRE(result);
+	}
+	BOOST_CHECK_GE(bytes, fullBytes);
+
+	// A receiver that lost the baseline drops the snapshot instead of applying it.
+	SnapshotDecoder freshDecoder;
+	encoder.acknowledge(encoder.getAckedSequence() + SnapshotEncoder::maxHistory + 1);
+	objects[0].m_Position.y += 1.f;
+	std::vector<char> data;
+	encoder.encode(objects.data(), objects.size(), nullptr, 0, nullptr, 0, data);
+	uint32_t sequence = 0;
+	BOOST_CHECK(!freshDecoder.decode(data.data(), data.size(), sequence));
+
+	// Changing the precision starts over with a full snapshot.
+	encoder.setPrecision(0.25f);
+	std::unique_ptr<UpdateObjects> resynced = transfer(encoder, freshDecoder, objects, bytes, true);
+	BOOST_REQUIRE(resynced);
+	checkObjects(objects, *resynced);
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkSnapshotBandwidth)
+{
+	static const unsigned int numObjects = 32;
+	static const unsigned int numMoving = 4;
+	static const unsigned int numTicks = 250;
+
+	SnapshotEncoder encoder;
+	SnapshotDecoder decoder;
+	std::vector<UpdateObjectData> objects = createObjects(numObjects);
+
+	size_t fullBytes = 0;
+	size_t snapshotBytes = 0;
+	for (unsigned int tick = 0; tick < numTicks; ++tick)
+	{
+		for (unsigned int i = 0; i < numMoving; ++i)
+		{
+			objects[i].m_Position.x += 2.f;
+			objects[i].m_Velocity.x = 100.f;
+		}
+
+		UpdateObjects full;
+		full.m_Object1 = objects;
+		std::vector<char> fullData;
+		full.writeData(fullData);
+		fullBytes += fullData.size();
+
+		size_t bytes = 0;
+		transfer(encoder, decoder, objects, bytes, true);
+		snapshotBytes += bytes;
+	}
+
+	BOOST_TEST_MESSAGE("Bytes per tick, " << numObjects << " objects with " << numMoving << " moving, full: "
+		<< fullBytes / numTicks << ", snapshot: " << snapshotBytes / numTicks);
+	BOOST_CHECK_LT(snapshotBytes * 4, fullBytes);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,347 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Network/Source/Packages.h"
+
+#include <XMLHelper.h>
+
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(TestWireFormat)
+
+namespace
+{
+	UpdateObjects createUpdatePackage(uint32_t p_NumObjects)
+	{
+		UpdateObjects package;
+		for (uint32_t i = 0; i < p_NumObjects; ++i)
+		{
+			UpdateObjectData data;
+			data.m_Id = i + 1;
+			data.m_Position = Vector3(1.5f * i, -2.f, 3.25f);
+			data.m_Velocity = Vector3(4.f, 0.f, -1.f);
+			data.m_Rotation = Vector3(0.f, 0.5f * i, 0.f);
+			data.m_RotationVelocity = Vector3(0.1f, 0.f, 0.f);
+			package.m_Object1.push_back(data);
+		}
+		return package;
+	}
+
+	PlayerControl createControlPackage()
+	{
+		PlayerControl package;
+		package.m_Object1.m_Position = Vector3(100.f, 200.f, -300.f);
+		package.m_Object1.m_Velocity = Vector3(1.f, 2.f, 3.f);
+		package.m_Object1.m_Rotation = Vector3(0.f, 3.14f, 0.f);
+		package.m_Object1.m_Forward = Vector3(0.f, 0.f, 1.f);
+		package.m_Object1.m_Up = Vector3(0.f, 1.f, 0.f);
+		return package;
+	}
+
+	void checkEqual(const Vector3& p_Left, const Vector3& p_Right)
+	{
+		BOOST_CHECK_EQUAL(p_Left.x, p_Right.x);
+		BOOST_CHECK_EQUAL(p_Left.y, p_Right.y);
+		BOOST_CHECK_EQUAL(p_Left.z, p_Right.z);
+	}
+
+	struct BenchmarkResult
+	{
+		size_t bytes;
+		double encodeNanoseconds;
+		double decodeNanoseconds;
+	};
+
+	template <typename Package>
+	BenchmarkResult benchmarkBoost(const Package& p_Package, size_t p_Iterations)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		BenchmarkResult result;
+		std::vector<char> data;
+
+		const Clock::time_point encodeStart = Clock::now();
+		for (size_t i = 0; i < p_Iterations; ++i)
+		{
+			data.clear();
+			VectorOutputBuffer buffer(data);
+			boost::archive::binary_oarchive archive(buffer, boost::archive::no_header);
+			archive << p_Package;
+		}
+		const Clock::time_point decodeStart = Clock::now();
+		for (size_t i = 0; i < p_Iterations; ++i)
+		{
+			Package decoded;
+			MemoryInputBuffer buffer(data.data(), data.size());
+			boost::archive::binary_iarchive archive(buffer, boost::archive::no_header);
+			archive >> decoded;
+		}
+		const Clock::time_point end = Clock::now();
+
+		result.bytes = data.size();
+		result.encodeNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(decodeStart - encodeStart).count() / p_Iterations;
+		result.decodeNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - decodeStart).count() / p_Iterations;
+		return result;
+	}
+
+	template <typename Package>
+	BenchmarkResult benchmarkCompact(const Package& p_Package, size_t p_Iterations)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		BenchmarkResult result;
+		std::vector<char> data;
+
+		const Clock::time_point encodeStart = Clock::now();
+		for (size_t i = 0; i < p_Iterations; ++i)
+		{
+			data.clear();
+			PackageCodec<Package>::write(p_Package, data);
+		}
+		const Clock::time_point decodeStart = Clock::now();
+		for (size_t i = 0; i < p_Iterations; ++i)
+		{
+			Package decoded;
+			PackageCodec<Package>::read(data.data(), data.size(), decoded);
+		}
+		const Clock::time_point end = Clock::now();
+
+		result.bytes = data.size();
+		result.encodeNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(decodeStart - encodeStart).count() / p_Iterations;
+		result.decodeNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - decodeStart).count() / p_Iterations;
+		return result;
+	}
+
+	std::vector<ObjectLookData> createLooks(uint32_t p_NumPlayers)
+	{
+		std::vector<ObjectLookData> looks;
+		for (uint32_t i = 0; i < p_NumPlayers; ++i)
+		{
+			ObjectLookData look;
+			look.m_Id = 1000 + i;
+			look.m_Forward = Vector3(0.707f, 0.f, -0.707f * i);
+			look.m_Up = Vector3(0.f, 1.f, 0.001f * i);
+			looks.push_back(look);
+		}
+		return looks;
+	}
+
+	/**
+	 * Look directions sent the way they were before typed records: an XML
+	 * document per player, carried as strings in the update package.
+	 */
+	BenchmarkResult benchmarkLookXML(const std::vector<ObjectLookData>& p_Looks, size_t p_Iterations)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		BenchmarkResult result;
+		std::vector<char> data;
+		float checksum = 0.f;
+
+		const Clock::time_point encodeStart = Clock::now();
+		for (size_t i = 0; i < p_Iterations; ++i)
+		{
+			data.clear();
+			WireWriter writer(data);
+			writer.writeUint32((uint32_t)p_Looks.size());
+			for (const ObjectLookData& look : p_Looks)
+			{
+				tinyxml2::XMLPrinter printer;
+				printer.OpenElement("ObjectUpdate");
+				printer.PushAttribute("ActorId", look.m_Id);
+				printer.PushAttribute("Type", "Look");
+				printer.OpenElement("Look");
+				pushVector(printer, "OffsetPosition", Vector3(0.f, -10.f, 7.f));
+				pushVector(printer, "Forward", look.m_Forward);
+				pushVector(printer, "Up", look.m_Up);
+				printer.CloseElement();
+				printer.CloseElement();
+				writer.writeString(printer.CStr());
+			}
+		}
+		const Clock::time_point decodeStart = Clock::now();
+		for (size_t i = 0; i < p_Iterations; ++i)
+		{
+			WireReader reader(data.data(), data.size());
+			const uint32_t numLooks = reader.readUint32();
+			for (uint32_t j = 0; j < numLooks; ++j)
+			{
+				const std::string extra = reader.readString();
+				tinyxml2::XMLDocument document;
+				document.Parse(extra.c_str());
+				const tinyxml2::XMLElement* object = document.FirstChildElement("ObjectUpdate");
+				uint32_t id = 0;
+				object->QueryAttribute("ActorId", &id);
+				const tinyxml2::XMLElement* look = object->FirstChildElement("Look");
+				Vector3 forward(0.f, 0.f, 1.f);
+				Vector3 up(0.f, 1.f, 0.f);
+				queryVector(look->FirstChildElement("Forward"), forward);
+				queryVector(look->FirstChildElement("Up"), up);
+				checksum += forward.x + up.y + id;
+			}
+		}
+		const Clock::time_point end = Clock::now();
+
+		BOOST_CHECK_GT(checksum, 0.f);
+		result.bytes = data.size();
+		result.encodeNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(decodeStart - encodeStart).count() / p_Iterations;
+		result.decodeNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - decodeStart).count() / p_Iterations;
+		return result;
+	}
+
+	void reportBenchmark(const std::string& p_Name, const BenchmarkResult& p_Boost, const BenchmarkResult& p_Compact)
+	{
+		BOOST_TEST_MESSAGE(p_Name << " boost: " << p_Boost.bytes << " bytes, "
+			<< p_Boost.encodeNanoseconds << " ns encode, " << p_Boost.decodeNanoseconds << " ns decode");
+		BOOST_TEST_MESSAGE(p_Name << " compact: " << p_Compact.bytes << " bytes, "
+			<< p_Compact.encodeNanoseconds << " ns encode, " << p_Compact.decodeNanoseconds << " ns decode");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestWireWriterIsLittleEndian)
+{
+	std::vector<char> data;
+	WireWriter writer(data);
+	writer.writeUint16(0x0102);
+	writer.writeUint32(0x03040506);
+	writer.writeFloat(1.f);
+
+	BOOST_REQUIRE_EQUAL(data.size(), 10);
+	BOOST_CHECK_EQUAL(data[0], 0x02);
+	BOOST_CHECK_EQUAL(data[1], 0x01);
+	BOOST_CHECK_EQUAL(data[2], 0x06);
+	BOOST_CHECK_EQUAL(data[5], 0x03);
+	BOOST_CHECK_EQUAL((unsigned char)data[9], 0x3f);
+	BOOST_CHECK_EQUAL((unsigned char)data[8], 0x80);
+
+	WireReader reader(data.data(), data.size());
+	BOOST_CHECK_EQUAL(reader.readUint16(), 0x0102);
+	BOOST_CHECK_EQUAL(reader.readUint32(), 0x03040506u);
+	BOOST_CHECK_EQUAL(reader.readFloat(), 1.f);
+	BOOST_CHECK_EQUAL(reader.remaining(), 0);
+	BOOST_CHECK_THROW(reader.readUint8(), NetworkError);
+}
+
+BOOST_AUTO_TEST_CASE(TestUpdateObjectsRoundTrip)
+{
+	UpdateObjects package = createUpdatePackage(3);
+	package.m_Object2 = createLooks(2);
+	ObjectColorData color;
+	color.m_Id = 7;
+	color.m_Color = Vector3(1.f, 0.5f, 0.25f);
+	package.m_Object3.push_back(color);
+
+	std::vector<char> data;
+	package.writeData(data);
+	BOOST_CHECK_EQUAL(data.size(), 1 + 4 + 3 * PackageCodec<UpdateObjects>::objectSize
+		+ 4 + 2 * PackageCodec<UpdateObjects>::lookSize + 4 + PackageCodec<UpdateObjects>::colorSize);
+
+	PackageBase::ptr decoded = package.createPackage(data.data(), data.size());
+	UpdateObjects* result = static_cast<UpdateObjects*>(decoded.get());
+
+	BOOST_REQUIRE_EQUAL(result->m_Object1.size(), package.m_Object1.size());
+	for (size_t i = 0; i < package.m_Object1.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(result->m_Object1[i].m_Id, package.m_Object1[i].m_Id);
+		checkEqual(result->m_Object1[i].m_Position, package.m_Object1[i].m_Position);
+		checkEqual(result->m_Object1[i].m_Velocity, package.m_Object1[i].m_Velocity);
+		checkEqual(result->m_Object1[i].m_Rotation, package.m_Object1[i].m_Rotation);
+		checkEqual(result->m_Object1[i].m_RotationVelocity, package.m_Object1[i].m_RotationVelocity);
+	}
+	BOOST_REQUIRE_EQUAL(result->m_Object2.size(), package.m_Object2.size());
+	for (size_t i = 0; i < package.m_Object2.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(result->m_Object2[i].m_Id, package.m_Object2[i].m_Id);
+		checkEqual(result->m_Object2[i].m_Forward, package.m_Object2[i].m_Forward);
+		checkEqual(result->m_Object2[i].m_Up, package.m_Object2[i].m_Up);
+	}
+	BOOST_REQUIRE_EQUAL(result->m_Object3.size(), 1);
+	BOOST_CHECK_EQUAL(result->m_Object3[0].m_Id, color.m_Id);
+	checkEqual(result->m_Object3[0].m_Color, color.m_Color);
+
+	// The string path uses the same encoding.
+	PackageBase::ptr fromString = package.createPackage(package.getData());
+	BOOST_CHECK_EQUAL(static_cast<UpdateObjects*>(fromString.get())->m_Object1.size(), 3);
+
+	BOOST_CHECK_THROW(package.createPackage(data.data(), data.size() - 1), NetworkError);
+	data[0] = 1;
+	BOOST_CHECK_THROW(package.createPackage(data.data(), data.size()), NetworkError);
+}
+
+BOOST_AUTO_TEST_CASE(TestGamePositionsRoundTrip)
+{
+	GamePositions package;
+	RacePositionData position;
+	position.m_Place = 4;
+	position.m_HasTime = true;
+	position.m_Time = -1.5f;
+	package.m_Object1.push_back(position);
+
+	std::vector<char> data;
+	package.writeData(data);
+	BOOST_CHECK_EQUAL(data.size(), 4 + PackageCodec<GamePositions>::positionSize);
+
+	PackageBase::ptr decoded = package.createPackage(data.data(), data.size());
+	const std::vector<RacePositionData>& result = static_cast<GamePositions*>(decoded.get())->m_Object1;
+	BOOST_REQUIRE_EQUAL(result.size(), 1);
+	BOOST_CHECK_EQUAL(result[0].m_Place, position.m_Place);
+	BOOST_CHECK(result[0].m_HasTime);
+	BOOST_CHECK_EQUAL(result[0].m_Time, position.m_Time);
+
+	BOOST_CHECK_THROW(package.createPackage(data.data(), data.size() - 1), NetworkError);
+}
+
+BOOST_AUTO_TEST_CASE(TestPlayerControlRoundTrip)
+{
+	PlayerControl package = createControlPackage();
+
+	std::vector<char> data;
+	package.writeData(data);
+	BOOST_CHECK_EQUAL(data.size(), (size_t)PackageCodec<PlayerControl>::size);
+
+	PackageBase::ptr decoded = package.createPackage(data.data(), data.size());
+	const PlayerControlData& result = static_cast<PlayerControl*>(decoded.get())->m_Object1;
+	checkEqual(result.m_Position, package.m_Object1.m_Position);
+	checkEqual(result.m_Velocity, package.m_Object1.m_Velocity);
+	checkEqual(result.m_Rotation, package.m_Object1.m_Rotation);
+	checkEqual(result.m_Forward, package.m_Object1.m_Forward);
+	checkEqual(result.m_Up, package.m_Object1.m_Up);
+
+	BOOST_CHECK_THROW(package.createPackage(data.data(), data.size() - 1), NetworkError);
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkHotPackets)
+{
+	static const size_t iterations = 2000;
+
+	const UpdateObjects update = createUpdatePackage(16);
+	const BenchmarkResult updateBoost = benchmarkBoost(update, iterations);
+	const BenchmarkResult updateCompact = benchmarkCompact(update, iterations);
+	reportBenchmark("UpdateObjects(16)", updateBoost, updateCompact);
+
+	const PlayerControl control = createControlPackage();
+	const BenchmarkResult controlBoost = benchmarkBoost(control, iterations);
+	const BenchmarkResult controlCompact = benchmarkCompact(control, iterations);
+	reportBenchmark("PlayerControl", controlBoost, controlCompact);
+
+	BOOST_CHECK_LE(updateCompact.bytes, updateBoost.bytes);
+	BOOST_CHECK_LE(controlCompact.bytes, controlBoost.bytes);
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkLookRecordsPerTick)
+{
+	static const size_t iterations = 2000;
+	static const uint32_t numPlayers = 8;
+
+	UpdateObjects update;
+	update.m_Object2 = createLooks(numPlayers);
+
+	const BenchmarkResult xml = benchmarkLookXML(update.m_Object2, iterations);
+	const BenchmarkResult typed = benchmarkCompact(update, iterations);
+	BOOST_TEST_MESSAGE("Looks of " << numPlayers << " players per tick, xml: " << xml.bytes << " bytes, "
+		<< xml.encodeNanoseconds << " ns encode, " << xml.decodeNanoseconds << " ns decode");
+	BOOST_TEST_MESSAGE("Looks of " << numPlayers << " players per tick, typed: " << typed.bytes << " bytes, "
+		<< typed.encodeNanoseconds << " ns encode, " << typed.decodeNanoseconds << " ns decode");
+
+	BOOST_CHECK_LT(typed.bytes, xml.bytes);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,6 @@
 #include <boost\test\unit_test.hpp>
 #include "..\..\Physics\Source\Body.h"
+#include "..\..\Physics\Source\BodyIntegrator.h"
 #include "..\..\Physics\Source\PhysicsExceptions.h"
 #include "..\..\Physics\include\BoundingVolume.h"
 
@@ -223,4 +224,68 @@ BOOST_AUTO_TEST_CASE(BodyTest_Gets_Sets)
 
 }
 
+BOOST_AUTO_TEST_CASE(BodyTest_BatchedIntegration)
+{
+	static const size_t numBodies = 7;
+	static const int numSteps = 120;
+	const float timestep = 1.f / 60.f;
+
+	std::vector<Body> reference;
+	std::vector<Body> batched;
+	for (size_t i = 0; i < numBodies; ++i)
+	{
+		const float mass = i == 3 ? 0.f : 1.f + i;
+		const bool immovable = i == 5;
+		const DirectX::XMFLOAT4 position(i * 2.f, 1.f, -1.f * i, 1.f);
+		const DirectX::XMFLOAT4 force(i * 0.5f, 2.f, -3.f, 0.f);
+		const DirectX::XMFLOAT4 velocity(1.f, i * 0.25f, 0.f, 0.f);
+
+		reference.push_back(Body(mass, BoundingVolume::ptr(new Sphere(0.5f, position)), immovable, false));
+		batched.push_back(Body(mass, BoundingVolume::ptr(new Sphere(0.5f, position)), immovable, false));
+		Body* bodies[] = { &reference.back(), &batched.back() };
+		for (Body* body : bodies)
+		{
+			body->setGravity(9.82f);
+			body->addForce(force);
+			body->setVelocity(velocity);
+		}
+	}
+
+	std::vector<Body*> batchedBodies;
+	for (Body& body : batched)
+		batchedBodies.push_back(&body);
+
+	BodyIntegrator integrator;
+	for (int step = 0; step < numSteps; ++step)
+	{
+		for (Body& body : reference)
+			body.update(timestep);
+		integrator.integrate(batchedBodies, timestep);
+	}
+
+	for (size_t i = 0; i < numBodies; ++i)
+	{
+		const DirectX::XMFLOAT4 refPos = reference[i].getPosition();
+		const DirectX::XMFLOAT4 pos = batched[i].getPosition();
+		const DirectX::XMFLOAT4 refVel = reference[i].getVelocity();
+		const DirectX::XMFLOAT4 vel = batched[i].getVelocity();
+		const DirectX::XMFLOAT4 refAcc = reference[i].getACC();
+		const DirectX::XMFLOAT4 acc = batched[i].getACC();
+		const DirectX::XMFLOAT4 volumePos = batched[i].getVolume()->getPosition();
+
+		BOOST_CHECK_SMALL(refPos.x - pos.x, 1e-4f);
+		BOOST_CHECK_SMALL(refPos.y - pos.y, 1e-4f);
+		BOOST_CHECK_SMALL(refPos.z - pos.z, 1e-4f);
+		BOOST_CHECK_SMALL(refVel.x - vel.x, 1e-4f);
+		BOOST_CHECK_SMALL(refVel.y - vel.y, 1e-4f);
+		BOOST_CHECK_SMALL(refVel.z - vel.z, 1e-4f);
+		BOOST_CHECK_SMALL(refAcc.x - acc.x, 1e-4f);
+		BOOST_CHECK_SMALL(refAcc.y - acc.y, 1e-4f);
+		BOOST_CHECK_SMALL(refAcc.z - acc.z, 1e-4f);
+		BOOST_CHECK_SMALL(volumePos.x - pos.x, 1e-4f);
+		BOOST_CHECK_SMALL(volumePos.y - pos.y, 1e-4f);
+		BOOST_CHECK_SMALL(volumePos.z - pos.z, 1e-4f);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -84,4 +84,36 @@ BOOST_AUTO_TEST_CASE(setPosition)
 
 
 
+	BOOST_AUTO_TEST_CASE(SharedMeshInstances)
+	{
+		std::vector<Triangle> triangles;
+		float size = 1.f;
+		triangles.push_back(Triangle(Vector4( -size,  -size, -size, 1.f), Vector4(-size, size, -size, 1.f), Vector4(size,	size, -size, 1.f)));
+		triangles.push_back(Triangle(Vector4( -size,  -size, -size, 1.f), Vector4( size, size, -size, 1.f), Vector4(size, -size, -size, 1.f)));
+
+		HullMesh::ptr mesh = std::make_shared<HullMesh>(triangles);
+		Hull h1(mesh);
+		Hull h2(mesh);
+
+		BOOST_CHECK(h1.getMesh() == h2.getMesh());
+		BOOST_CHECK_EQUAL(h1.getTriangleListSize(), 2);
+
+		h1.scale(DirectX::XMVectorSet(2.f, 2.f, 2.f, 0.f));
+		h1.setPosition(DirectX::XMVectorSet(10.f, 0.f, 0.f, 1.f));
+		h2.setRotation(DirectX::XMMatrixRotationY(DirectX::XM_PI));
+
+		Triangle tri = h1.getTriangleInWorldCoord(0);
+		BOOST_CHECK_CLOSE(tri.corners[0].x, 8.f, 0.001f);
+		BOOST_CHECK_CLOSE(tri.corners[0].y, -2.f, 0.001f);
+		BOOST_CHECK_CLOSE(tri.corners[0].z, -2.f, 0.001f);
+		BOOST_CHECK_CLOSE(h1.getSphere().getRadius(), sqrtf(12.f), 0.001f);
+
+		tri = h2.getTriangleInWorldCoord(0);
+		BOOST_CHECK_CLOSE(tri.corners[0].x, 1.f, 0.001f);
+		BOOST_CHECK_CLOSE(tri.corners[0].z, 1.f, 0.001f);
+		BOOST_CHECK_CLOSE(h2.getSphere().getRadius(), sqrtf(3.f), 0.001f);
+
+		BOOST_CHECK_EQUAL(mesh->getTriangleAt(0).corners[0].x, -1.f);
+	}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -3,7 +3,9 @@
 #include "..\..\Physics\include\Sphere.h"
 
 #include <iterator>
+#include <random>
 #include <set>
+#include <vector>
 
 using namespace DirectX;
 
@@ -80,14 +82,14 @@ BOOST_AUTO_TEST_CASE(TestOctreeRemoveBody)
 	tree.addBody(0, &sphere);
 	BOOST_CHECK_EQUAL(tree.getBodyCount(), 1);
 
-	tree.removeBody(0, &sphere);
+	tree.removeBody(0);
 	BOOST_CHECK_EQUAL(tree.getBodyCount(), 0);
 
 	tree.addBody(1, &sphere);
 	tree.addBody(2, &sphere2);
 	BOOST_CHECK_EQUAL(tree.getBodyCount(), 2);
 
-	tree.removeBody(2, &sphere2);
+	tree.removeBody(2);
 	BOOST_CHECK_EQUAL(tree.getBodyCount(), 1);
 }
 
@@ -109,4 +111,98 @@ BOOST_AUTO_TEST_CASE(TestOctreeFind)
 	BOOST_CHECK(potentialColliders.find(1) != potentialColliders.end());
 }
 
+BOOST_AUTO_TEST_CASE(TestOctreeUpdateBody)
+{
+	Octree tree;
+
+	std::default_random_engine randomEngine(7);
+	std::uniform_real_distribution<float> positionDistribution(-100.f, 100.f);
+	std::vector<Sphere> spheres(100);
+	for (size_t i = 0; i < spheres.size(); ++i)
+	{
+		spheres[i] = Sphere(2.f, XMFLOAT4(positionDistribution(randomEngine), positionDistribution(randomEngine),
+			positionDistribution(randomEngine), 1.f));
+		tree.addBody(i + 1, &spheres[i]);
+	}
+
+	Sphere& moving = spheres[0];
+	moving.setPosition(XMVectorSet(50.f, 50.f, 50.f, 1.f));
+	tree.updateBody(1, &moving);
+
+	// Small moves stay within the loose bounds and leave the tree as it is.
+	const Octree::Statistics before = tree.getStatistics();
+	moving.setPosition(XMVectorSet(50.2f, 50.f, 50.f, 1.f));
+	tree.updateBody(1, &moving);
+	const Octree::Statistics after = tree.getStatistics();
+	BOOST_CHECK_EQUAL(before.nodeCount, after.nodeCount);
+	BOOST_CHECK_EQUAL(before.bodyReferences, after.bodyReferences);
+
+	std::set<Octree::BodyHandle> found;
+	tree.findPotentialIntersections(&moving, std::inserter(found, found.end()));
+	BOOST_CHECK(found.count(1) == 1);
+
+	Sphere oldPlace(2.f, XMFLOAT4(50.f, 50.f, 50.f, 1.f));
+	moving.setPosition(XMVectorSet(-60.f, 10.f, -20.f, 1.f));
+	tree.updateBody(1, &moving);
+
+	found.clear();
+	tree.findPotentialIntersections(&moving, std::inserter(found, found.end()));
+	BOOST_CHECK(found.count(1) == 1);
+
+	found.clear();
+	tree.findPotentialIntersections(&oldPlace, std::inserter(found, found.end()));
+	BOOST_CHECK(found.count(1) == 0);
+
+	// Moving outside the tree grows it.
+	moving.setPosition(XMVectorSet(1000.f, 0.f, 0.f, 1.f));
+	tree.updateBody(1, &moving);
+	BOOST_CHECK_GE(tree.getMaxPos().x, 1000.f);
+
+	found.clear();
+	tree.findPotentialIntersections(&moving, std::inserter(found, found.end()));
+	BOOST_CHECK(found.count(1) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestOctreeMergesAndShrinks)
+{
+	Octree tree;
+	BOOST_CHECK_EQUAL(tree.getStatistics().nodeCount, 0);
+
+	std::default_random_engine randomEngine(11);
+	std::uniform_real_distribution<float> positionDistribution(-100.f, 100.f);
+	std::vector<Sphere> spheres(200);
+	for (size_t i = 0; i < spheres.size(); ++i)
+	{
+		spheres[i] = Sphere(1.f, XMFLOAT4(positionDistribution(randomEngine), positionDistribution(randomEngine),
+			positionDistribution(randomEngine), 1.f));
+		tree.addBody(i + 1, &spheres[i]);
+	}
+
+	const Octree::Statistics full = tree.getStatistics();
+	BOOST_CHECK_GT(full.depth, 1);
+	BOOST_CHECK_GT(full.leafCount, 1);
+	BOOST_CHECK_GE(full.bodyReferences, spheres.size());
+	BOOST_CHECK_LE(full.maxBodiesPerLeaf, 16);
+	BOOST_CHECK_GT(full.averageBodiesPerLeaf, 0.f);
+
+	for (size_t i = 1; i < spheres.size(); ++i)
+	{
+		tree.removeBody(i + 1);
+	}
+
+	const Octree::Statistics single = tree.getStatistics();
+	BOOST_CHECK_EQUAL(single.nodeCount, 1);
+	BOOST_CHECK_EQUAL(single.depth, 1);
+	BOOST_CHECK_EQUAL(single.bodyReferences, 1);
+	BOOST_CHECK_EQUAL(tree.getBodyCount(), 1);
+
+	std::set<Octree::BodyHandle> found;
+	tree.findPotentialIntersections(&spheres[0], std::inserter(found, found.end()));
+	BOOST_CHECK(found.count(1) == 1);
+
+	tree.removeBody(1);
+	BOOST_CHECK_EQUAL(tree.getBodyCount(), 0);
+	BOOST_CHECK_EQUAL(tree.getStatistics().nodeCount, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
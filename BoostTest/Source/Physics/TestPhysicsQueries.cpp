@@ -0,0 +1,236 @@
+#include <boost\test\unit_test.hpp>
+#include "..\..\Physics\Source\Collision.h"
+#include "..\..\Physics\Source\Physics.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace DirectX;
+
+BOOST_AUTO_TEST_SUITE(TestPhysicsQueries)
+
+namespace
+{
+	struct QueryScene
+	{
+		IPhysics* physics;
+		BodyHandle box;
+		BodyHandle sphere;
+		BodyHandle edge;
+		BodyHandle mover;
+
+		QueryScene()
+		{
+			physics = IPhysics::createPhysics();
+			physics->initialize(true, 1.f / 60.f);
+
+			box = physics->createOBB(1.f, true, Vector3(0.f, 0.f, 0.f), Vector3(100.f, 100.f, 100.f), false);
+			sphere = physics->createSphere(1.f, true, Vector3(500.f, 0.f, 0.f), 50.f);
+			edge = physics->createAABB(1.f, true, Vector3(0.f, 0.f, -500.f), Vector3(50.f, 50.f, 50.f), true);
+			mover = physics->createSphere(1.f, false, Vector3(-300.f, 0.f, 0.f), 50.f);
+		}
+
+		~QueryScene()
+		{
+			IPhysics::deletePhysics(physics);
+		}
+	};
+}
+
+BOOST_AUTO_TEST_CASE(TestRayCastBatch)
+{
+	QueryScene scene;
+
+	std::vector<RayQuery> rays;
+	rays.push_back(RayQuery(Vector3(-500.f, 0.f, 0.f), Vector3(2.f, 0.f, 0.f), 10000.f));
+	rays.push_back(RayQuery(Vector3(500.f, -500.f, 0.f), Vector3(0.f, 1.f, 0.f), 10000.f));
+	rays.push_back(RayQuery(Vector3(0.f, 500.f, 0.f), Vector3(1.f, 0.f, 0.f), 10000.f));
+	rays.push_back(RayQuery(Vector3(-500.f, 0.f, 0.f), Vector3(1.f, 0.f, 0.f), 300.f));
+	rays.push_back(RayQuery(Vector3(0.f, 0.f, -1000.f), Vector3(0.f, 0.f, 1.f), 10000.f));
+	RayQuery unlimited;
+	unlimited.origin = Vector3(-5000.f, 0.f, 0.f);
+	unlimited.direction = Vector3(1.f, 0.f, 0.f);
+	rays.push_back(unlimited);
+	std::vector<QueryHit> hits(rays.size());
+
+	scene.physics->rayCast(rays.data(), rays.size(), hits.data());
+
+	// Movable bodies are not part of the query, the ray passes through the mover.
+	BOOST_CHECK_EQUAL(hits[0].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[0].distance, 400.f, 0.01f);
+	BOOST_CHECK_CLOSE(hits[0].point.x, -100.f, 0.01f);
+	BOOST_CHECK_CLOSE(hits[0].normal.x, -1.f, 0.01f);
+
+	BOOST_CHECK_EQUAL(hits[1].body, scene.sphere);
+	BOOST_CHECK_CLOSE(hits[1].distance, 450.f, 0.01f);
+	BOOST_CHECK_CLOSE(hits[1].point.y, -50.f, 0.01f);
+	BOOST_CHECK_CLOSE(hits[1].normal.y, -1.f, 0.01f);
+
+	BOOST_CHECK_EQUAL(hits[2].body, 0);
+	BOOST_CHECK_EQUAL(hits[3].body, 0);
+
+	// Edge bodies are skipped, the ray hits the box behind it.
+	BOOST_CHECK_EQUAL(hits[4].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[4].distance, 900.f, 0.01f);
+
+	// Without a maximum distance the ray is not limited.
+	BOOST_CHECK_EQUAL(hits[5].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[5].distance, 4900.f, 0.01f);
+
+	// The single ray only hits hulls and spheres, it passes through the box to the sphere.
+	BOOST_CHECK_EQUAL(scene.physics->rayCast(XMFLOAT4(1.f, 0.f, 0.f, 0.f), XMFLOAT4(-500.f, 0.f, 0.f, 1.f)), scene.sphere);
+	BOOST_CHECK_EQUAL(scene.physics->rayCast(XMFLOAT4(0.f, 1.f, 0.f, 0.f), XMFLOAT4(0.f, -500.f, 0.f, 1.f)), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestSphereOverlapBatch)
+{
+	QueryScene scene;
+
+	std::vector<SphereQuery> spheres;
+	spheres.push_back(SphereQuery(Vector3(0.f, 140.f, 0.f), 50.f));
+	spheres.push_back(SphereQuery(Vector3(500.f, 0.f, 90.f), 50.f));
+	spheres.push_back(SphereQuery(Vector3(250.f, 0.f, 0.f), 50.f));
+	std::vector<QueryHit> hits(spheres.size());
+
+	scene.physics->sphereOverlap(spheres.data(), spheres.size(), hits.data());
+
+	BOOST_CHECK_EQUAL(hits[0].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[0].distance, 10.f, 0.1f);
+	BOOST_CHECK_CLOSE(hits[0].normal.y, 1.f, 0.01f);
+	BOOST_CHECK_CLOSE(hits[0].point.y, 100.f, 0.01f);
+
+	BOOST_CHECK_EQUAL(hits[1].body, scene.sphere);
+	BOOST_CHECK_CLOSE(hits[1].distance, 10.f, 0.1f);
+	BOOST_CHECK_CLOSE(hits[1].normal.z, 1.f, 0.01f);
+
+	BOOST_CHECK_EQUAL(hits[2].body, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestSweptSphereBatch)
+{
+	QueryScene scene;
+
+	std::vector<SweptSphereQuery> sweeps;
+	sweeps.push_back(SweptSphereQuery(Vector3(-500.f, 0.f, 0.f), Vector3(0.f, 0.f, 0.f), 50.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(500.f, 500.f, 0.f), Vector3(500.f, -500.f, 0.f), 20.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(-500.f, 500.f, 0.f), Vector3(500.f, 500.f, 0.f), 50.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(0.f, 120.f, 0.f), Vector3(0.f, 500.f, 0.f), 50.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(-50000.f, 0.f, 0.f), Vector3(50000.f, 0.f, 0.f), 1.f));
+	std::vector<QueryHit> hits(sweeps.size());
+
+	scene.physics->sweptSphere(sweeps.data(), sweeps.size(), hits.data());
+
+	BOOST_CHECK_EQUAL(hits[0].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[0].distance, 350.f, 0.5f);
+	BOOST_CHECK_CLOSE(hits[0].normal.x, -1.f, 0.01f);
+
+	BOOST_CHECK_EQUAL(hits[1].body, scene.sphere);
+	BOOST_CHECK_CLOSE(hits[1].distance, 430.f, 0.5f);
+	BOOST_CHECK_CLOSE(hits[1].normal.y, 1.f, 0.1f);
+
+	BOOST_CHECK_EQUAL(hits[2].body, 0);
+
+	// Starting inside a body is a hit at the start.
+	BOOST_CHECK_EQUAL(hits[3].body, scene.box);
+	BOOST_CHECK_EQUAL(hits[3].distance, 0.f);
+
+	// A small sphere on a long path does not step over the box.
+	BOOST_CHECK_EQUAL(hits[4].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[4].distance, 49899.f, 0.01f);
+}
+
+BOOST_AUTO_TEST_CASE(TestSweptSphereDoesNotPassBetweenSteps)
+{
+	QueryScene scene;
+
+	std::vector<SweptSphereQuery> sweeps;
+	// Passes one centimeter into the sphere, between where steps of the radius would be.
+	sweeps.push_back(SweptSphereQuery(Vector3(225.f, 99.f, 0.f), Vector3(800.f, 99.f, 0.f), 50.f));
+	// Passes one centimeter beside it.
+	sweeps.push_back(SweptSphereQuery(Vector3(225.f, 101.f, 0.f), Vector3(800.f, 101.f, 0.f), 50.f));
+	std::vector<QueryHit> hits(sweeps.size());
+
+	scene.physics->sweptSphere(sweeps.data(), sweeps.size(), hits.data());
+
+	const float touchX = 500.f - sqrtf(100.f * 100.f - 99.f * 99.f);
+	BOOST_CHECK_EQUAL(hits[0].body, scene.sphere);
+	BOOST_CHECK_CLOSE(hits[0].distance, touchX - 225.f, 0.5f);
+
+	BOOST_CHECK_EQUAL(hits[1].body, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestSweptSphereLimitsSteps)
+{
+	QueryScene scene;
+
+	std::vector<SweptSphereQuery> sweeps;
+	// Would take 10^34 steps of the radius.
+	sweeps.push_back(SweptSphereQuery(Vector3(-50000.f, 0.f, 0.f), Vector3(50000.f, 0.f, 0.f), 1e-30f));
+	sweeps.push_back(SweptSphereQuery(Vector3(-500.f, 0.f, 0.f), Vector3(-500.f, 0.f, 0.f), 50.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(0.f, 0.f, 0.f), Vector3(0.f, 0.f, 0.f), 50.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(-500.f, 0.f, 0.f), Vector3(0.f, 0.f, 0.f), std::numeric_limits<float>::quiet_NaN()));
+	sweeps.push_back(SweptSphereQuery(Vector3(-500.f, 0.f, 0.f), Vector3(std::numeric_limits<float>::infinity(), 0.f, 0.f), 50.f));
+	sweeps.push_back(SweptSphereQuery(Vector3(-500.f, 0.f, 0.f), Vector3(-500.f, 0.f, 0.f), 0.f));
+	std::vector<QueryHit> hits(sweeps.size());
+
+	scene.physics->sweptSphere(sweeps.data(), sweeps.size(), hits.data());
+
+	BOOST_CHECK_EQUAL(hits[0].body, scene.box);
+	BOOST_CHECK_CLOSE(hits[0].distance, 49900.f, 0.01f);
+
+	// Without a path, the sphere only touches what it starts in.
+	BOOST_CHECK_EQUAL(hits[1].body, 0);
+	BOOST_CHECK_EQUAL(hits[2].body, scene.box);
+	BOOST_CHECK_EQUAL(hits[2].distance, 0.f);
+
+	BOOST_CHECK_EQUAL(hits[3].body, 0);
+	BOOST_CHECK_EQUAL(hits[4].body, 0);
+	BOOST_CHECK_EQUAL(hits[5].body, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestQueriesDoNotDependOnThreads)
+{
+	QueryScene serial;
+	QueryScene threaded;
+	threaded.physics->setNumWorkerThreads(4);
+
+	std::vector<RayQuery> rays;
+	for (int i = 0; i < 200; ++i)
+	{
+		rays.push_back(RayQuery(Vector3(-1000.f, (i % 20) * 15.f - 150.f, (i / 20) * 15.f - 75.f), Vector3(1.f, 0.01f * (i % 7), 0.f), 5000.f));
+	}
+	std::vector<QueryHit> serialHits(rays.size());
+	std::vector<QueryHit> threadedHits(rays.size());
+
+	serial.physics->rayCast(rays.data(), rays.size(), serialHits.data());
+	threaded.physics->rayCast(rays.data(), rays.size(), threadedHits.data());
+
+	for (size_t i = 0; i < rays.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(serialHits[i].body, threadedHits[i].body);
+		BOOST_CHECK_EQUAL(serialHits[i].distance, threadedHits[i].distance);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestRayVsHullNormal)
+{
+	std::vector<Triangle> triangles;
+	triangles.push_back(Triangle(Vector4(-1.f, 0.f, -1.f, 1.f), Vector4(1.f, 0.f, -1.f, 1.f), Vector4(-1.f, 0.f, 1.f, 1.f)));
+	triangles.push_back(Triangle(Vector4(1.f, 0.f, -1.f, 1.f), Vector4(1.f, 0.f, 1.f, 1.f), Vector4(-1.f, 0.f, 1.f, 1.f)));
+	Hull hull(triangles);
+	hull.setPosition(XMVectorSet(0.f, 2.f, 0.f, 1.f));
+
+	XMFLOAT4 normal;
+	const float dist = Collision::rayVsBoundingVolume(hull, XMFLOAT4(0.f, -1.f, 0.f, 0.f), XMFLOAT4(0.5f, 5.f, 0.5f, 1.f), normal);
+	BOOST_CHECK_CLOSE(dist, 3.f, 0.01f);
+	BOOST_CHECK_CLOSE(normal.y, 1.f, 0.01f);
+
+	const float below = Collision::rayVsBoundingVolume(hull, XMFLOAT4(0.f, 1.f, 0.f, 0.f), XMFLOAT4(0.5f, 0.f, 0.5f, 1.f), normal);
+	BOOST_CHECK_CLOSE(below, 2.f, 0.01f);
+	BOOST_CHECK_CLOSE(normal.y, -1.f, 0.01f);
+
+	BOOST_CHECK_LT(Collision::rayVsBoundingVolume(hull, XMFLOAT4(0.f, -1.f, 0.f, 0.f), XMFLOAT4(5.f, 5.f, 0.f, 1.f), normal), 0.f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
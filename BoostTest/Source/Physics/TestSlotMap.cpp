@@ -0,0 +1,142 @@
+#include <boost\test\unit_test.hpp>
+#include "..\..\Physics\Source\SlotMap.h"
+#include "..\..\Physics\Source\Physics.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(TestSlotMap)
+
+BOOST_AUTO_TEST_CASE(TestSlotMapInsertFindErase)
+{
+	SlotMap<std::string> map;
+	BOOST_CHECK(map.empty());
+
+	SlotMap<std::string>::Handle first = map.insert(std::string("first"));
+	SlotMap<std::string>::Handle second = map.insert(std::string("second"));
+	BOOST_CHECK_EQUAL(first, 1);
+	BOOST_CHECK_EQUAL(map.size(), 2);
+	BOOST_REQUIRE(map.find(second));
+	BOOST_CHECK_EQUAL(*map.find(second), "second");
+	BOOST_CHECK(!map.find(0));
+
+	BOOST_CHECK(map.erase(first));
+	BOOST_CHECK(!map.erase(first));
+	BOOST_CHECK(!map.find(first));
+	BOOST_CHECK_EQUAL(map.size(), 1);
+
+	SlotMap<std::string>::Handle reused = map.insert(std::string("reused"));
+	BOOST_CHECK_NE(reused, first);
+	BOOST_CHECK_EQUAL(SlotMap<std::string>::getIndex(reused), SlotMap<std::string>::getIndex(first));
+	BOOST_CHECK(!map.find(first));
+	BOOST_CHECK_EQUAL(*map.find(reused), "reused");
+
+	map.clear();
+	BOOST_CHECK(!map.find(reused));
+	BOOST_CHECK_EQUAL(map.insert(std::string("again")), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestSlotMapStableAddresses)
+{
+	SlotMap<int> map;
+	SlotMap<int>::Handle handle = map.insert(42);
+	const int* value = map.find(handle);
+
+	std::vector<SlotMap<int>::Handle> handles;
+	for (int i = 0; i < 10000; ++i)
+	{
+		handles.push_back(map.insert(int(i)));
+	}
+
+	BOOST_CHECK_EQUAL(map.find(handle), value);
+	BOOST_CHECK_EQUAL(*value, 42);
+
+	for (size_t i = 0; i < handles.size(); i += 2)
+	{
+		map.erase(handles[i]);
+	}
+
+	int count = 0;
+	int previous = -1;
+	for (SlotMap<int>::iterator it = map.begin(); it != map.end(); ++it)
+	{
+		BOOST_CHECK_EQUAL(map.find(it.getHandle()), &*it);
+		if (*it != 42)
+		{
+			BOOST_CHECK_GT(*it, previous);
+			previous = *it;
+		}
+		++count;
+	}
+	BOOST_CHECK_EQUAL(count, 5001);
+}
+
+BOOST_AUTO_TEST_CASE(TestSlotMapRetiresExhaustedSlot)
+{
+	SlotMap<int> map;
+
+	// A slot has 4096 generations, every one of them gives a new handle.
+	std::vector<SlotMap<int>::Handle> handles;
+	for (int i = 0; i < 4096; ++i)
+	{
+		SlotMap<int>::Handle handle = map.insert(int(i));
+		BOOST_REQUIRE_EQUAL(SlotMap<int>::getIndex(handle), 0u);
+		handles.push_back(handle);
+		map.erase(handle);
+	}
+	std::sort(handles.begin(), handles.end());
+	BOOST_CHECK(std::adjacent_find(handles.begin(), handles.end()) == handles.end());
+
+	SlotMap<int>::Handle next = map.insert(4096);
+	BOOST_CHECK_EQUAL(SlotMap<int>::getIndex(next), 1u);
+	BOOST_CHECK(std::find(handles.begin(), handles.end(), next) == handles.end());
+	for (size_t i = 0; i < handles.size(); ++i)
+	{
+		BOOST_CHECK(!map.find(handles[i]));
+	}
+	BOOST_CHECK_EQUAL(map.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestSlotMapThrowsWhenIndicesRunOut)
+{
+	SlotMap<char> map;
+	SlotMap<char>::Handle last = 0;
+	for (unsigned int i = 0; i < (1u << 20) - 1; ++i)
+	{
+		last = map.insert(char(i));
+	}
+	BOOST_CHECK_EQUAL(SlotMap<char>::getIndex(last), (1u << 20) - 2);
+	BOOST_CHECK_THROW(map.insert('x'), PhysicsException);
+	BOOST_CHECK_EQUAL(map.size(), (1u << 20) - 1);
+
+	// An erased slot can still be reused.
+	map.erase(last);
+	BOOST_CHECK(map.find(map.insert('y')));
+}
+
+BOOST_AUTO_TEST_CASE(TestReleasedBodyHandleStaysInvalid)
+{
+	IPhysics* physics = IPhysics::createPhysics();
+	physics->initialize(true, 1.f / 60.f);
+
+	BodyHandle body1 = physics->createSphere(50.f, false, Vector3(0.f, 0.f, 0.f), 50.f);
+	BodyHandle body2 = physics->createSphere(50.f, true, Vector3(1000.f, 0.f, 0.f), 50.f);
+
+	physics->releaseBody(body1);
+	BOOST_CHECK(!physics->validBody(body1));
+
+	BodyHandle body3 = physics->createSphere(50.f, false, Vector3(0.f, 500.f, 0.f), 50.f);
+	BOOST_CHECK_NE(body3, body1);
+	BOOST_CHECK(!physics->validBody(body1));
+	BOOST_CHECK(physics->validBody(body2));
+	BOOST_CHECK(physics->validBody(body3));
+	BOOST_CHECK_CLOSE(physics->getBodyPosition(body3).y, 500.f, 0.01f);
+
+	physics->update(2.f / 60.f, 2);
+	BOOST_CHECK_LT(physics->getBodyPosition(body3).y, 500.f);
+
+	IPhysics::deletePhysics(physics);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
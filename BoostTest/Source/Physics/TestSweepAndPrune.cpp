@@ -0,0 +1,206 @@
+#include <boost\test\unit_test.hpp>
+#include "..\..\Physics\Source\SweepAndPrune.h"
+#include "..\..\Physics\Source\Collision.h"
+#include "..\..\Physics\Source\Physics.h"
+#include "..\..\Physics\include\Sphere.h"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace DirectX;
+
+BOOST_AUTO_TEST_SUITE(TestSweepAndPrune)
+
+BOOST_AUTO_TEST_CASE(TestSweepAndPruneAddRemove)
+{
+	SweepAndPrune broadphase;
+	BOOST_CHECK_EQUAL(broadphase.getBodyCount(), 0);
+
+	Sphere sphere(1.f, XMFLOAT4(0.f, 0.f, 0.f, 1.f));
+	Sphere sphere2(1.f, XMFLOAT4(10.f, 0.f, 0.f, 1.f));
+
+	broadphase.addBody(1, &sphere);
+	broadphase.addBody(2, &sphere2);
+	BOOST_CHECK_EQUAL(broadphase.getBodyCount(), 2);
+
+	broadphase.removeBody(1);
+	BOOST_CHECK_EQUAL(broadphase.getBodyCount(), 1);
+
+	broadphase.reset();
+	BOOST_CHECK_EQUAL(broadphase.getBodyCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestSweepAndPruneFindPairsOnce)
+{
+	SweepAndPrune broadphase;
+
+	Sphere sphere(1.f, XMFLOAT4(0.f, 0.f, 0.f, 1.f));
+	Sphere sphere2(1.f, XMFLOAT4(1.5f, 0.f, 0.f, 1.f));
+	Sphere sphere3(1.f, XMFLOAT4(1.5f, 5.f, 0.f, 1.f));
+
+	broadphase.addBody(3, &sphere);
+	broadphase.addBody(1, &sphere2);
+	broadphase.addBody(2, &sphere3);
+
+	std::vector<SweepAndPrune::BodyPair> pairs;
+	broadphase.findOverlappingPairs(pairs);
+
+	BOOST_REQUIRE_EQUAL(pairs.size(), 1);
+	BOOST_CHECK_EQUAL(pairs[0].first, 1);
+	BOOST_CHECK_EQUAL(pairs[0].second, 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestSweepAndPruneFollowsMovingBodies)
+{
+	SweepAndPrune broadphase;
+
+	Sphere sphere(1.f, XMFLOAT4(0.f, 0.f, 0.f, 1.f));
+	Sphere sphere2(1.f, XMFLOAT4(10.f, 0.f, 0.f, 1.f));
+
+	broadphase.addBody(1, &sphere);
+	broadphase.addBody(2, &sphere2);
+
+	std::vector<SweepAndPrune::BodyPair> pairs;
+	broadphase.findOverlappingPairs(pairs);
+	BOOST_CHECK(pairs.empty());
+
+	sphere2.setPosition(XMVectorSet(-1.f, 0.5f, 0.f, 1.f));
+	broadphase.findOverlappingPairs(pairs);
+	BOOST_REQUIRE_EQUAL(pairs.size(), 1);
+	BOOST_CHECK_EQUAL(pairs[0].first, 1);
+	BOOST_CHECK_EQUAL(pairs[0].second, 2);
+
+	sphere2.setPosition(XMVectorSet(-10.f, 0.f, 0.f, 1.f));
+	broadphase.findOverlappingPairs(pairs);
+	BOOST_CHECK(pairs.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestSweepAndPruneMatchesBruteForce)
+{
+	static const size_t numBodies = 200;
+	std::default_random_engine randomEngine(1337);
+	std::uniform_real_distribution<float> positionDistribution(-20.f, 20.f);
+
+	std::vector<Sphere> spheres(numBodies);
+	SweepAndPrune broadphase;
+	for (size_t i = 0; i < numBodies; ++i)
+	{
+		spheres[i] = Sphere(1.f, XMFLOAT4(positionDistribution(randomEngine), positionDistribution(randomEngine),
+			positionDistribution(randomEngine), 1.f));
+		broadphase.addBody(i + 1, &spheres[i]);
+	}
+
+	std::vector<SweepAndPrune::BodyPair> pairs;
+	broadphase.findOverlappingPairs(pairs);
+
+	size_t sphereOverlaps = 0;
+	for (size_t i = 0; i < numBodies; ++i)
+	{
+		for (size_t j = i + 1; j < numBodies; ++j)
+		{
+			if (!Collision::surroundingSphereVsSphere(spheres[i], spheres[j]))
+				continue;
+
+			++sphereOverlaps;
+			BOOST_CHECK(std::binary_search(pairs.begin(), pairs.end(), SweepAndPrune::BodyPair(i + 1, j + 1)));
+		}
+	}
+
+	BOOST_CHECK_GE(pairs.size(), sphereOverlaps);
+}
+
+BOOST_AUTO_TEST_CASE(TestMovablePairReportsBothHits)
+{
+	IPhysics* physics = IPhysics::createPhysics();
+	physics->initialize(true, 1.f / 60.f);
+
+	BodyHandle body1 = physics->createSphere(50.f, false, Vector3(0.f, 0.f, 0.f), 50.f);
+	BodyHandle body2 = physics->createSphere(50.f, false, Vector3(60.f, 0.f, 0.f), 50.f);
+
+	physics->update(1.f / 60.f, 1);
+
+	BOOST_REQUIRE_EQUAL(physics->getHitDataSize(), 2);
+	HitData hit1 = physics->getHitDataAt(0);
+	HitData hit2 = physics->getHitDataAt(1);
+	BOOST_CHECK_EQUAL(hit1.collider, body1);
+	BOOST_CHECK_EQUAL(hit1.collisionVictim, body2);
+	BOOST_CHECK_EQUAL(hit2.collider, body2);
+	BOOST_CHECK_EQUAL(hit2.collisionVictim, body1);
+	BOOST_CHECK_CLOSE(hit1.colNorm.x, -1.f, 0.01f);
+	BOOST_CHECK_CLOSE(hit2.colNorm.x, 1.f, 0.01f);
+	BOOST_CHECK_CLOSE(hit1.colLength, hit2.colLength, 0.01f);
+
+	IPhysics::deletePhysics(physics);
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkSweepAndPruneScaling)
+{
+	static const size_t bodyCounts[] = { 10, 100, 1000 };
+	static const unsigned int numSteps = 60;
+
+	for (size_t numBodies : bodyCounts)
+	{
+		// Keep the density constant, roughly like players spread over a level.
+		const float halfSize = 5.f * powf((float)numBodies, 1.f / 3.f);
+		std::default_random_engine randomEngine(42);
+		std::uniform_real_distribution<float> positionDistribution(-halfSize, halfSize);
+		std::uniform_real_distribution<float> velocityDistribution(-0.1f, 0.1f);
+
+		std::vector<Sphere> spheres(numBodies);
+		std::vector<XMFLOAT4> velocities(numBodies);
+		SweepAndPrune broadphase;
+		for (size_t i = 0; i < numBodies; ++i)
+		{
+			spheres[i] = Sphere(0.5f, XMFLOAT4(positionDistribution(randomEngine), positionDistribution(randomEngine),
+				positionDistribution(randomEngine), 1.f));
+			velocities[i] = XMFLOAT4(velocityDistribution(randomEngine), velocityDistribution(randomEngine),
+				velocityDistribution(randomEngine), 0.f);
+			broadphase.addBody(i + 1, &spheres[i]);
+		}
+
+		std::chrono::high_resolution_clock::duration bruteForceTime(0);
+		std::chrono::high_resolution_clock::duration sweepTime(0);
+		size_t bruteForcePairs = 0;
+		size_t sweepPairs = 0;
+		std::vector<SweepAndPrune::BodyPair> pairs;
+
+		for (unsigned int step = 0; step < numSteps; ++step)
+		{
+			for (size_t i = 0; i < numBodies; ++i)
+			{
+				spheres[i].setPosition(XMLoadFloat4(&spheres[i].getPosition()) + XMLoadFloat4(&velocities[i]));
+			}
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (size_t i = 0; i < numBodies; ++i)
+			{
+				for (size_t j = 0; j < numBodies; ++j)
+				{
+					if (i != j && Collision::surroundingSphereVsSphere(spheres[i], spheres[j]))
+						++bruteForcePairs;
+				}
+			}
+			auto mid = std::chrono::high_resolution_clock::now();
+			broadphase.findOverlappingPairs(pairs);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			sweepPairs += pairs.size();
+			bruteForceTime += mid - start;
+			sweepTime += end - mid;
+		}
+
+		BOOST_CHECK_GE(sweepPairs * 2, bruteForcePairs);
+
+		std::ostringstream message;
+		message << numBodies << " movers: all pairs "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(bruteForceTime).count() / numSteps
+			<< " us/step, sweep and prune "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(sweepTime).count() / numSteps
+			<< " us/step";
+		BOOST_TEST_MESSAGE(message.str());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
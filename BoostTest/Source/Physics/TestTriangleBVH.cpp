@@ -0,0 +1,249 @@
+#include <boost\test\unit_test.hpp>
+#include "..\..\Physics\Source\BVLoader.h"
+#include "..\..\Physics\Source\Collision.h"
+#include "..\..\Physics\include\Hull.h"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	/**
+	 * A bumpy terrain of p_Size * p_Size quads, one unit each, centered on origo.
+	 */
+	std::vector<Triangle> createTerrain(unsigned int p_Size)
+	{
+		std::default_random_engine randomEngine(7);
+		std::uniform_real_distribution<float> heightDistribution(-0.5f, 0.5f);
+
+		std::vector<float> heights((p_Size + 1) * (p_Size + 1));
+		for (auto& height : heights)
+			height = heightDistribution(randomEngine);
+
+		const float offset = p_Size * 0.5f;
+		std::vector<Triangle> triangles;
+		for (unsigned int z = 0; z < p_Size; z++)
+		{
+			for (unsigned int x = 0; x < p_Size; x++)
+			{
+				Vector4 c00(x - offset, heights[z * (p_Size + 1) + x], z - offset, 1.f);
+				Vector4 c10(x + 1 - offset, heights[z * (p_Size + 1) + x + 1], z - offset, 1.f);
+				Vector4 c01(x - offset, heights[(z + 1) * (p_Size + 1) + x], z + 1 - offset, 1.f);
+				Vector4 c11(x + 1 - offset, heights[(z + 1) * (p_Size + 1) + x + 1], z + 1 - offset, 1.f);
+				triangles.push_back(Triangle(c00, c01, c11));
+				triangles.push_back(Triangle(c00, c11, c10));
+			}
+		}
+		return triangles;
+	}
+
+	/**
+	 * Load the triangles of a bounding volume file the way Physics::createBV does,
+	 * scaled from centimeters to meters.
+	 */
+	std::vector<Triangle> loadVolume(const std::string& p_FilePath)
+	{
+		BVLoader loader;
+		BOOST_REQUIRE_MESSAGE(loader.loadBinaryFile(p_FilePath), "Failed to load " + p_FilePath);
+		const std::vector<BVLoader::BoundingVolume>& vertices = loader.getBoundingVolumes();
+
+		std::vector<Triangle> triangles;
+		for (size_t i = 0; i + 2 < vertices.size(); i += 3)
+		{
+			Vector4 corners[3];
+			for (int j = 0; j < 3; j++)
+			{
+				const XMFLOAT4& position = vertices[i + j].m_Postition;
+				corners[j] = Vector4(position.x * 0.01f, position.y * 0.01f, position.z * 0.01f, position.w);
+			}
+			triangles.push_back(Triangle(corners[0], corners[1], corners[2]));
+		}
+		return triangles;
+	}
+
+	float closestDistanceBruteForce(const Hull& p_Hull, const Sphere& p_Sphere)
+	{
+		XMVECTOR spherePos = XMLoadFloat4(&p_Sphere.getPosition());
+		float distance = FLT_MAX;
+		for (unsigned int i = 0; i < p_Hull.getTriangleListSize(); i++)
+		{
+			XMVECTOR v = p_Hull.findClosestPointOnTriangle(p_Sphere.getPosition(), i) - spherePos;
+			distance = std::min(distance, XMVectorGetX(XMVector4Dot(v, v)));
+		}
+		return sqrtf(distance);
+	}
+
+	/**
+	 * Time sphere queries against a hull, once testing every triangle and once through the BVH.
+	 */
+	void benchmarkHull(const std::string& p_Name, const Hull& p_Hull, const std::vector<Sphere>& p_Spheres)
+	{
+		int bruteForceHits = 0;
+		int bvhHits = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (const Sphere& sphere : p_Spheres)
+		{
+			if (closestDistanceBruteForce(p_Hull, sphere) <= sphere.getRadius())
+				++bruteForceHits;
+		}
+		auto mid = std::chrono::high_resolution_clock::now();
+		for (const Sphere& sphere : p_Spheres)
+		{
+			if (Collision::HullVsSphere(p_Hull, sphere).intersect)
+				++bvhHits;
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		BOOST_CHECK_EQUAL(bruteForceHits, bvhHits);
+
+		std::ostringstream message;
+		message << p_Name << ", " << p_Hull.getTriangleListSize() << " triangles, "
+			<< bvhHits << "/" << p_Spheres.size() << " hits: all triangles "
+			<< std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count() / p_Spheres.size()
+			<< " ns/query, bvh "
+			<< std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count() / p_Spheres.size()
+			<< " ns/query";
+		BOOST_TEST_MESSAGE(message.str());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(TestTriangleBVH)
+
+BOOST_AUTO_TEST_CASE(TestTriangleBVHFindOverlapping)
+{
+	std::vector<Triangle> triangles = createTerrain(16);
+	TriangleBVH bvh(triangles);
+	BOOST_CHECK_GT(bvh.getNodeCount(), 1);
+
+	XMFLOAT3 boxMin(-2.5f, -1.f, 3.5f);
+	XMFLOAT3 boxMax(0.5f, 1.f, 4.5f);
+	std::vector<unsigned int> result;
+	bvh.findOverlapping(boxMin, boxMax, result);
+
+	std::vector<unsigned int> expected;
+	for (unsigned int i = 0; i < triangles.size(); i++)
+	{
+		const Triangle& tri = triangles[i];
+		float minX = std::min(std::min(tri.corners[0].x, tri.corners[1].x), tri.corners[2].x);
+		float maxX = std::max(std::max(tri.corners[0].x, tri.corners[1].x), tri.corners[2].x);
+		float minZ = std::min(std::min(tri.corners[0].z, tri.corners[1].z), tri.corners[2].z);
+		float maxZ = std::max(std::max(tri.corners[0].z, tri.corners[1].z), tri.corners[2].z);
+		if (minX <= boxMax.x && maxX >= boxMin.x && minZ <= boxMax.z && maxZ >= boxMin.z)
+			expected.push_back(i);
+	}
+
+	BOOST_CHECK_LT(result.size(), triangles.size() / 4);
+	for (unsigned int index : expected)
+		BOOST_CHECK(std::binary_search(result.begin(), result.end(), index));
+}
+
+BOOST_AUTO_TEST_CASE(TestTriangleBVHMatchesBruteForce)
+{
+	Hull hull(createTerrain(16));
+	hull.scale(XMVectorSet(2.f, 1.f, 0.5f, 0.f));
+	hull.setRotation(XMMatrixRotationY(0.3f));
+	hull.setPosition(XMVectorSet(10.f, 0.f, -5.f, 1.f));
+
+	std::default_random_engine randomEngine(3);
+	std::uniform_real_distribution<float> positionDistribution(-8.f, 8.f);
+	std::uniform_real_distribution<float> heightDistribution(-1.f, 1.f);
+
+	for (int i = 0; i < 200; i++)
+	{
+		Sphere sphere(0.75f, XMFLOAT4(10.f + positionDistribution(randomEngine), heightDistribution(randomEngine),
+			-5.f + positionDistribution(randomEngine), 1.f));
+
+		HitData hit = Collision::HullVsSphere(hull, sphere);
+		float distance = closestDistanceBruteForce(hull, sphere);
+
+		BOOST_CHECK_EQUAL(hit.intersect, distance <= sphere.getRadius());
+		if (hit.intersect)
+			BOOST_CHECK_CLOSE(hit.colLength, sphere.getRadius() - distance, 0.01f);
+	}
+
+	XMFLOAT4 down(0.f, -1.f, 0.f, 0.f);
+	XMFLOAT4 origin(10.f, 5.f, -5.f, 1.f);
+	float rayDistance = Collision::rayTriangleIntersect(hull, down, origin);
+	BOOST_CHECK_GT(rayDistance, 4.f);
+	BOOST_CHECK_LT(rayDistance, 6.f);
+
+	XMFLOAT4 away(0.f, 1.f, 0.f, 0.f);
+	BOOST_CHECK_EQUAL(Collision::rayTriangleIntersect(hull, away, origin), -1.f);
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkTriangleBVH)
+{
+	static const unsigned int terrainSizes[] = { 8, 32, 128 };
+	static const int numQueries = 1000;
+
+	for (unsigned int terrainSize : terrainSizes)
+	{
+		std::default_random_engine randomEngine(11);
+		std::uniform_real_distribution<float> positionDistribution(-0.5f * terrainSize, 0.5f * terrainSize);
+		std::vector<Sphere> spheres;
+		for (int i = 0; i < numQueries; i++)
+		{
+			spheres.push_back(Sphere(0.5f, XMFLOAT4(positionDistribution(randomEngine), 0.f, positionDistribution(randomEngine), 1.f)));
+		}
+
+		std::ostringstream name;
+		name << "Terrain " << terrainSize << "x" << terrainSize;
+		benchmarkHull(name.str(), Hull(createTerrain(terrainSize)), spheres);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BenchmarkTriangleBVHGameVolumes)
+{
+	// The smallest and the largest collision volumes shipped with the game.
+	static const char* const volumes[] =
+	{
+		"CB_Barrel1",
+		"CB_Crate1",
+		"CB_CastleWall1",
+		"CB_CastleWall5",
+		"CB_House3",
+		"CB_Park1Part2",
+		"CB_Island3Top1Part2",
+	};
+	static const int numQueries = 1000;
+
+	for (const char* volume : volumes)
+	{
+		Hull hull(loadVolume(std::string("../../Client/Bin/assets/volumes/") + volume + ".txc"));
+
+		XMFLOAT3 boundsMin(FLT_MAX, FLT_MAX, FLT_MAX);
+		XMFLOAT3 boundsMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (unsigned int i = 0; i < hull.getTriangleListSize(); i++)
+		{
+			const Triangle triangle = hull.getTriangleInWorldCoord(i);
+			for (const Vector4& corner : triangle.corners)
+			{
+				boundsMin = XMFLOAT3(std::min(boundsMin.x, corner.x), std::min(boundsMin.y, corner.y), std::min(boundsMin.z, corner.z));
+				boundsMax = XMFLOAT3(std::max(boundsMax.x, corner.x), std::max(boundsMax.y, corner.y), std::max(boundsMax.z, corner.z));
+			}
+		}
+
+		// Spheres a tenth of the volume size, spread over the bounds, about as
+		// large relative to the volume as a player is to a house.
+		const float radius = 0.1f * std::max(std::max(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y), boundsMax.z - boundsMin.z);
+		std::default_random_engine randomEngine(13);
+		std::uniform_real_distribution<float> xDistribution(boundsMin.x - radius, boundsMax.x + radius);
+		std::uniform_real_distribution<float> yDistribution(boundsMin.y - radius, boundsMax.y + radius);
+		std::uniform_real_distribution<float> zDistribution(boundsMin.z - radius, boundsMax.z + radius);
+		std::vector<Sphere> spheres;
+		for (int i = 0; i < numQueries; i++)
+		{
+			spheres.push_back(Sphere(radius, XMFLOAT4(xDistribution(randomEngine), yDistribution(randomEngine), zDistribution(randomEngine), 1.f)));
+		}
+
+		benchmarkHull(volume, hull, spheres);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
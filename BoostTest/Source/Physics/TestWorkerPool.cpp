@@ -0,0 +1,124 @@
+#include <boost\test\unit_test.hpp>
+#include "..\..\Physics\Source\WorkerPool.h"
+#include "..\..\Physics\Source\Physics.h"
+
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(TestWorkerPool)
+
+BOOST_AUTO_TEST_CASE(TestWorkerPoolRunsEveryIndexOnce)
+{
+	static const size_t numTasks = 1000;
+
+	WorkerPool pool(4);
+	BOOST_CHECK_EQUAL(pool.getWorkerCount(), 4);
+
+	for (int run = 0; run < 10; ++run)
+	{
+		std::vector<std::atomic<int>> counts(numTasks);
+		for (auto& count : counts)
+			count = 0;
+
+		pool.run(numTasks, [&counts] (size_t p_Index, unsigned int p_Worker)
+		{
+			BOOST_REQUIRE_LT(p_Worker, 4u);
+			++counts[p_Index];
+		});
+
+		for (auto& count : counts)
+			BOOST_REQUIRE_EQUAL(count.load(), 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestWorkerPoolRethrowsTaskException)
+{
+	static const size_t numTasks = 1000;
+
+	WorkerPool pool(4);
+	std::atomic<int> numRun(0);
+	BOOST_CHECK_THROW(pool.run(numTasks, [&numRun] (size_t p_Index, unsigned int)
+		{
+			++numRun;
+			if (p_Index == numTasks / 2)
+				throw std::runtime_error("Task failed");
+		}), std::runtime_error);
+	BOOST_CHECK_LE(numRun.load(), (int)numTasks);
+
+	// The pool is still usable after a failed run.
+	numRun = 0;
+	pool.run(numTasks, [&numRun] (size_t, unsigned int) { ++numRun; });
+	BOOST_CHECK_EQUAL(numRun.load(), (int)numTasks);
+}
+
+namespace
+{
+	std::vector<BodyHandle> createScene(IPhysics* p_Physics)
+	{
+		std::default_random_engine randomEngine(1337);
+		std::uniform_real_distribution<float> positionDistribution(-800.f, 800.f);
+
+		p_Physics->createAABB(1.f, true, Vector3(0.f, -100.f, 0.f), Vector3(2000.f, 100.f, 2000.f), false);
+		for (int i = 0; i < 20; ++i)
+		{
+			p_Physics->createOBB(1.f, true, Vector3(positionDistribution(randomEngine), 50.f, positionDistribution(randomEngine)),
+				Vector3(60.f, 50.f, 60.f), false);
+		}
+
+		std::vector<BodyHandle> movers;
+		for (int i = 0; i < 200; ++i)
+		{
+			// Tightly packed in height, so many of them end up touching each other.
+			movers.push_back(p_Physics->createSphere(50.f, false,
+				Vector3(positionDistribution(randomEngine) * 0.3f, 40.f + (i % 5) * 30.f, positionDistribution(randomEngine) * 0.3f), 40.f));
+		}
+		return movers;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestMultithreadedStepIsDeterministic)
+{
+	IPhysics* serial = IPhysics::createPhysics();
+	IPhysics* threaded = IPhysics::createPhysics();
+	serial->initialize(false, 1.f / 60.f);
+	threaded->initialize(false, 1.f / 60.f);
+	threaded->setNumWorkerThreads(4);
+
+	const std::vector<BodyHandle> serialMovers = createScene(serial);
+	const std::vector<BodyHandle> threadedMovers = createScene(threaded);
+	BOOST_REQUIRE(serialMovers == threadedMovers);
+
+	for (int step = 0; step < 60; ++step)
+	{
+		serial->update(1.f / 60.f, 1);
+		threaded->update(1.f / 60.f, 1);
+
+		BOOST_REQUIRE_EQUAL(serial->getHitDataSize(), threaded->getHitDataSize());
+		for (unsigned int i = 0; i < serial->getHitDataSize(); ++i)
+		{
+			const HitData serialHit = serial->getHitDataAt(i);
+			const HitData threadedHit = threaded->getHitDataAt(i);
+			BOOST_CHECK_EQUAL(serialHit.collider, threadedHit.collider);
+			BOOST_CHECK_EQUAL(serialHit.collisionVictim, threadedHit.collisionVictim);
+			BOOST_CHECK_EQUAL(serialHit.IDInBody, threadedHit.IDInBody);
+			BOOST_CHECK_EQUAL(serialHit.colLength, threadedHit.colLength);
+		}
+	}
+
+	for (BodyHandle mover : serialMovers)
+	{
+		const Vector3 serialPosition = serial->getBodyPosition(mover);
+		const Vector3 threadedPosition = threaded->getBodyPosition(mover);
+		BOOST_CHECK_EQUAL(serialPosition.x, threadedPosition.x);
+		BOOST_CHECK_EQUAL(serialPosition.y, threadedPosition.y);
+		BOOST_CHECK_EQUAL(serialPosition.z, threadedPosition.z);
+		BOOST_CHECK_EQUAL(serial->getBodyOnSomething(mover), threaded->getBodyOnSomething(mover));
+	}
+
+	IPhysics::deletePhysics(serial);
+	IPhysics::deletePhysics(threaded);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
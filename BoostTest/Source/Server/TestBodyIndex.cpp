@@ -0,0 +1,109 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Server/Source/BodyIndex.h"
+
+#include <ActorFactory.h>
+#include <EventData.h>
+#include <IPhysics.h>
+
+BOOST_AUTO_TEST_SUITE(TestBodyIndex)
+
+namespace
+{
+	Actor::ptr createSphereActor(ActorFactory& p_Factory)
+	{
+		static const char* sphereDesc =
+			"<Object>"
+			"	<SpherePhysics Immovable=\"true\" Radius=\"50\" />"
+			"</Object>";
+		tinyxml2::XMLDocument doc;
+		doc.Parse(sphereDesc);
+
+		return p_Factory.createActor(doc.FirstChildElement("Object"));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestFindAddedActor)
+{
+	IPhysics* physics = IPhysics::createPhysics();
+	physics->initialize(false, 1.f / 60.f);
+	ActorFactory factory(0);
+	factory.setPhysics(physics);
+
+	Actor::ptr first = createSphereActor(factory);
+	Actor::ptr second = createSphereActor(factory);
+	BOOST_REQUIRE_EQUAL(first->getBodyHandles().size(), 1u);
+	BOOST_REQUIRE_EQUAL(second->getBodyHandles().size(), 1u);
+	const BodyHandle firstBody = first->getBodyHandles()[0];
+	const BodyHandle secondBody = second->getBodyHandles()[0];
+
+	BodyIndex index;
+	BOOST_CHECK(!index.findActor(firstBody));
+
+	index.addActor(first);
+	index.addActor(second);
+	BOOST_CHECK(index.findActor(firstBody) == first);
+	BOOST_CHECK(index.findActor(secondBody) == second);
+	BOOST_CHECK(!index.findPlayer(firstBody));
+
+	index.removeActor(first);
+	BOOST_CHECK(!index.findActor(firstBody));
+	BOOST_CHECK(index.findActor(secondBody) == second);
+
+	index.clear();
+	BOOST_CHECK(!index.findActor(secondBody));
+
+	first.reset();
+	second.reset();
+	IPhysics::deletePhysics(physics);
+}
+
+BOOST_AUTO_TEST_CASE(TestChangedBodyKeepsOwner)
+{
+	IPhysics* physics = IPhysics::createPhysics();
+	physics->initialize(false, 1.f / 60.f);
+	ActorFactory factory(0);
+	factory.setPhysics(physics);
+
+	Actor::ptr actor = createSphereActor(factory);
+	const BodyHandle oldBody = actor->getBodyHandles()[0];
+	const BodyHandle newBody = physics->createSphere(0.f, true, Vector3(0.f, 0.f, 0.f), 100.f);
+
+	BodyIndex index;
+	index.addActor(actor);
+	index.changeBody(IEventData::Ptr(new ChangeBodyEventData(oldBody, newBody)));
+	BOOST_CHECK(!index.findActor(oldBody));
+	BOOST_CHECK(index.findActor(newBody) == actor);
+
+	// A change of a body that is not indexed is left for addActor to pick up.
+	const BodyHandle otherBody = physics->createSphere(0.f, true, Vector3(0.f, 0.f, 0.f), 100.f);
+	index.changeBody(IEventData::Ptr(new ChangeBodyEventData(oldBody, otherBody)));
+	BOOST_CHECK(!index.findActor(otherBody));
+	BOOST_CHECK(index.findActor(newBody) == actor);
+
+	actor.reset();
+	IPhysics::deletePhysics(physics);
+}
+
+BOOST_AUTO_TEST_CASE(TestExpiredOwnerIsNotFound)
+{
+	IPhysics* physics = IPhysics::createPhysics();
+	physics->initialize(false, 1.f / 60.f);
+	ActorFactory factory(0);
+	factory.setPhysics(physics);
+
+	Actor::ptr actor = createSphereActor(factory);
+	const BodyHandle body = actor->getBodyHandles()[0];
+
+	BodyIndex index;
+	index.addActor(actor);
+	BOOST_CHECK(index.findActor(body) == actor);
+
+	// The index does not keep the actor alive, and a destroyed actor is never returned.
+	actor.reset();
+	BOOST_CHECK(!index.findActor(body));
+	BOOST_CHECK(!index.findPlayer(body));
+
+	IPhysics::deletePhysics(physics);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
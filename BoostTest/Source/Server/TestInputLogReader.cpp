@@ -0,0 +1,139 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Server/Source/InputLogFormat.h"
+#include "../../../Server/Source/InputLogReader.h"
+#include "../../../Server/Source/ServerExceptions.h"
+
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(TestInputLogReader)
+
+namespace
+{
+	template <typename T>
+	void write(std::ostream& p_Output, T p_Value)
+	{
+		p_Output.write(reinterpret_cast<const char*>(&p_Value), sizeof(p_Value));
+	}
+
+	void writeString(std::ostream& p_Output, const std::string& p_String)
+	{
+		write(p_Output, (uint32_t)p_String.size());
+		p_Output.write(p_String.data(), p_String.size());
+	}
+
+	void writeHeader(std::ostream& p_Output, uint16_t p_NumPlayers)
+	{
+		write(p_Output, InputLog::fileId);
+		write(p_Output, InputLog::fileVersion);
+		writeString(p_Output, "TestRace");
+		writeString(p_Output, "assets/levels/Level1.2.btxl");
+		write(p_Output, (uint32_t)1234);
+		write(p_Output, p_NumPlayers);
+		for (uint16_t i = 0; i < p_NumPlayers; ++i)
+		{
+			writeString(p_Output, "Player" + std::to_string(i));
+			writeString(p_Output, "Dzala");
+			writeString(p_Output, "Green");
+		}
+	}
+
+	void writeTick(std::ostream& p_Output, float p_DeltaTime)
+	{
+		write(p_Output, InputLog::Record::TICK);
+		write(p_Output, p_DeltaTime);
+	}
+
+	void writePackage(std::ostream& p_Output, uint16_t p_Player, const std::string& p_Data)
+	{
+		write(p_Output, InputLog::Record::PACKAGE);
+		write(p_Output, p_Player);
+		write(p_Output, (uint16_t)PackageType::PLAYER_CONTROL);
+		write(p_Output, (uint32_t)p_Data.size());
+		p_Output.write(p_Data.data(), p_Data.size());
+	}
+
+	void writeLeave(std::ostream& p_Output, uint16_t p_Player)
+	{
+		write(p_Output, InputLog::Record::LEAVE);
+		write(p_Output, p_Player);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestReadHeader)
+{
+	std::stringstream log(std::ios::in | std::ios::out | std::ios::binary);
+	writeHeader(log, 2);
+
+	InputLogReader reader(log);
+	BOOST_CHECK_EQUAL(reader.getGameType(), "TestRace");
+	BOOST_CHECK_EQUAL(reader.getLevelPath(), "assets/levels/Level1.2.btxl");
+	BOOST_CHECK_EQUAL(reader.getSeed(), 1234u);
+	BOOST_REQUIRE_EQUAL(reader.getPlayers().size(), 2u);
+	BOOST_CHECK_EQUAL(reader.getPlayers()[1].username, "Player1");
+	BOOST_CHECK_EQUAL(reader.getPlayers()[1].characterName, "Dzala");
+	BOOST_CHECK_EQUAL(reader.getPlayers()[1].characterStyle, "Green");
+
+	InputLogReader::Tick tick;
+	BOOST_CHECK(!reader.readTick(tick));
+}
+
+BOOST_AUTO_TEST_CASE(TestLeaveIsReadWithPackagesOfItsTick)
+{
+	// Player 1 sends input and disconnects while the second tick is running,
+	// the round handles the input before it notices the player is gone.
+	std::stringstream log(std::ios::in | std::ios::out | std::ios::binary);
+	writeHeader(log, 2);
+	writeTick(log, 0.01f);
+	writePackage(log, 0, "a");
+	writeTick(log, 0.02f);
+	writePackage(log, 0, "b");
+	writePackage(log, 1, "c");
+	writeLeave(log, 1);
+	writeTick(log, 0.03f);
+	writePackage(log, 0, "d");
+
+	InputLogReader reader(log);
+	InputLogReader::Tick tick;
+
+	BOOST_REQUIRE(reader.readTick(tick));
+	BOOST_CHECK_EQUAL(tick.deltaTime, 0.01f);
+	BOOST_CHECK_EQUAL(tick.packages.size(), 1u);
+	BOOST_CHECK(tick.leaves.empty());
+
+	BOOST_REQUIRE(reader.readTick(tick));
+	BOOST_CHECK_EQUAL(tick.deltaTime, 0.02f);
+	BOOST_REQUIRE_EQUAL(tick.packages.size(), 2u);
+	BOOST_CHECK_EQUAL(tick.packages[1].player, 1u);
+	BOOST_CHECK(tick.packages[1].type == PackageType::PLAYER_CONTROL);
+	BOOST_CHECK_EQUAL(std::string(tick.packages[1].data.begin(), tick.packages[1].data.end()), "c");
+	BOOST_REQUIRE_EQUAL(tick.leaves.size(), 1u);
+	BOOST_CHECK_EQUAL(tick.leaves[0], 1u);
+
+	BOOST_REQUIRE(reader.readTick(tick));
+	BOOST_CHECK_EQUAL(tick.deltaTime, 0.03f);
+	BOOST_REQUIRE_EQUAL(tick.packages.size(), 1u);
+	BOOST_CHECK_EQUAL(tick.packages[0].player, 0u);
+	BOOST_CHECK(tick.leaves.empty());
+
+	BOOST_CHECK(!reader.readTick(tick));
+}
+
+BOOST_AUTO_TEST_CASE(TestRejectCorruptLog)
+{
+	std::stringstream notALog(std::ios::in | std::ios::out | std::ios::binary);
+	writeString(notALog, "Not an input log");
+	BOOST_CHECK_THROW(InputLogReader reader(notALog), ServerException);
+
+	std::stringstream truncated(std::ios::in | std::ios::out | std::ios::binary);
+	writeHeader(truncated, 1);
+	writeTick(truncated, 0.01f);
+	write(truncated, InputLog::Record::PACKAGE);
+	write(truncated, (uint16_t)0);
+
+	InputLogReader reader(truncated);
+	InputLogReader::Tick tick;
+	BOOST_CHECK_THROW(reader.readTick(tick), ServerException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Server/Source/InterestManager.h"
+
+#include <algorithm>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(TestInterestManager)
+
+namespace
+{
+	const uint32_t viewerId = 1;
+
+	UpdateObjectData createObject(uint32_t p_Id, const Vector3& p_Position)
+	{
+		UpdateObjectData data;
+		data.m_Id = p_Id;
+		data.m_Position = p_Position;
+		data.m_Velocity = Vector3(0.f, 0.f, 0.f);
+		data.m_Rotation = Vector3(0.f, 0.f, 0.f);
+		data.m_RotationVelocity = Vector3(0.f, 0.f, 0.f);
+		return data;
+	}
+
+	InterestManager::Settings createSettings()
+	{
+		InterestManager::Settings settings;
+		settings.relevantDistance = 1000.f;
+		settings.fullRateDistance = 200.f;
+		settings.viewConeCos = 0.5f;
+		settings.outOfViewFactor = 0.25f;
+		settings.minPriority = 0.0625f;
+		return settings;
+	}
+
+	bool isSelected(const std::vector<UpdateObjectData>& p_Selected, uint32_t p_Id)
+	{
+		return std::any_of(p_Selected.begin(), p_Selected.end(),
+			[p_Id] (const UpdateObjectData& p_Object) { return p_Object.m_Id == p_Id; });
+	}
+
+	/**
+	 * Count how many of some ticks an object is selected on, looking along +x from origo.
+	 */
+	unsigned int countSelected(InterestManager& p_Manager, InterestManager::ClientState& p_Client,
+		const std::vector<UpdateObjectData>& p_Objects, uint32_t p_Id, unsigned int p_NumTicks)
+	{
+		std::vector<UpdateObjectData> selected;
+		unsigned int numSelected = 0;
+		for (unsigned int i = 0; i < p_NumTicks; ++i)
+		{
+			p_Manager.update(p_Objects);
+			p_Manager.selectRelevant(p_Client, Vector3(0.f, 0.f, 0.f), Vector3(1.f, 0.f, 0.f), viewerId, selected);
+			if (isSelected(selected, p_Id))
+			{
+				++numSelected;
+			}
+		}
+		return numSelected;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestCellKey)
+{
+	BOOST_CHECK_EQUAL(InterestManager::cellKey(0, 0, 0), 0);
+
+	// Every cell around origo, negative coordinates included, has its own key.
+	std::vector<uint64_t> keys;
+	for (int x = -1; x <= 1; ++x)
+	{
+		for (int y = -1; y <= 1; ++y)
+		{
+			for (int z = -1; z <= 1; ++z)
+			{
+				keys.push_back(InterestManager::cellKey(x, y, z));
+			}
+		}
+	}
+	std::sort(keys.begin(), keys.end());
+	BOOST_CHECK(std::unique(keys.begin(), keys.end()) == keys.end());
+
+	BOOST_CHECK_EQUAL(InterestManager::cellKey(-1, 0, 0), InterestManager::cellKey((1 << 21) - 1, 0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(TestSelectRelevantFiltersByRadius)
+{
+	InterestManager manager;
+	manager.setSettings(createSettings());
+	InterestManager::ClientState client;
+
+	std::vector<UpdateObjectData> objects;
+	objects.push_back(createObject(viewerId, Vector3(50000.f, 0.f, 0.f)));
+	objects.push_back(createObject(2, Vector3(100.f, 0.f, 0.f)));
+	objects.push_back(createObject(3, Vector3(-150.f, 0.f, 0.f)));
+	objects.push_back(createObject(4, Vector3(0.f, 1500.f, 0.f)));
+	manager.update(objects);
+
+	std::vector<UpdateObjectData> selected;
+	for (int i = 0; i < 8; ++i)
+	{
+		manager.selectRelevant(client, Vector3(0.f, 0.f, 0.f), Vector3(1.f, 0.f, 0.f), viewerId, selected);
+
+		// The viewer's own object is always sent, wherever it is.
+		BOOST_CHECK(isSelected(selected, viewerId));
+		// Within the full rate distance, also across a cell border.
+		BOOST_CHECK(isSelected(selected, 2));
+		BOOST_CHECK(isSelected(selected, 3));
+		// Beyond the relevant distance.
+		BOOST_CHECK(!isSelected(selected, 4));
+	}
+
+	// Selected objects keep the order of the update.
+	manager.selectRelevant(client, Vector3(0.f, 0.f, 0.f), Vector3(1.f, 0.f, 0.f), viewerId, selected);
+	BOOST_REQUIRE_GE(selected.size(), 3);
+	BOOST_CHECK_EQUAL(selected[0].m_Id, viewerId);
+	BOOST_CHECK_EQUAL(selected[1].m_Id, 2);
+	BOOST_CHECK_EQUAL(selected[2].m_Id, 3);
+}
+
+BOOST_AUTO_TEST_CASE(TestPriorityAccumulation)
+{
+	InterestManager manager;
+	manager.setSettings(createSettings());
+
+	// Halfway out, in view: priority 0.5, sent every second tick.
+	{
+		InterestManager::ClientState client;
+		std::vector<UpdateObjectData> objects(1, createObject(2, Vector3(600.f, 0.f, 0.f)));
+		BOOST_CHECK_EQUAL(countSelected(manager, client, objects, 2, 16), 8);
+	}
+
+	// Halfway out, behind the viewer: 0.5 * 0.25, sent every eighth tick.
+	{
+		InterestManager::ClientState client;
+		std::vector<UpdateObjectData> objects(1, createObject(2, Vector3(-600.f, 0.f, 0.f)));
+		BOOST_CHECK_EQUAL(countSelected(manager, client, objects, 2, 16), 2);
+	}
+
+	// At the edge, behind the viewer: the minimum priority still sends it every sixteenth tick.
+	{
+		InterestManager::ClientState client;
+		std::vector<UpdateObjectData> objects(1, createObject(2, Vector3(-990.f, 0.f, 0.f)));
+		BOOST_CHECK_EQUAL(countSelected(manager, client, objects, 2, 15), 0);
+		BOOST_CHECK_EQUAL(countSelected(manager, client, objects, 2, 1), 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TestPriorityResetsWhenLeaving)
+{
+	InterestManager manager;
+	manager.setSettings(createSettings());
+	InterestManager::ClientState client;
+
+	std::vector<UpdateObjectData> inside(1, createObject(2, Vector3(600.f, 0.f, 0.f)));
+	std::vector<UpdateObjectData> outside(1, createObject(2, Vector3(5000.f, 0.f, 0.f)));
+
+	// Half the priority needed is built up, then lost when the object leaves.
+	BOOST_CHECK_EQUAL(countSelected(manager, client, inside, 2, 1), 0);
+	BOOST_CHECK_EQUAL(countSelected(manager, client, outside, 2, 1), 0);
+	BOOST_CHECK_EQUAL(countSelected(manager, client, inside, 2, 1), 0);
+	BOOST_CHECK_EQUAL(countSelected(manager, client, inside, 2, 1), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
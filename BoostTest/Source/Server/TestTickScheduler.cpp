@@ -0,0 +1,115 @@
+#include <boost/test/unit_test.hpp>
+#include "../../../Server/Source/TickScheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const std::chrono::milliseconds tickLength(10);
+
+	double toSeconds(Clock::duration p_Duration)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double>>(p_Duration).count();
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(TestTickScheduler)
+
+BOOST_AUTO_TEST_CASE(TestTickCountFollowsElapsedTime)
+{
+	std::atomic<unsigned int> numTicks(0);
+
+	TickScheduler scheduler(tickLength, 1);
+	const Clock::time_point start = Clock::now();
+	scheduler.start(1);
+	TickScheduler::TaskPtr task = scheduler.addTask([&] (float) { ++numTicks; return true; });
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	scheduler.stop();
+	const double elapsedTicks = toSeconds(Clock::now() - start) / toSeconds(tickLength);
+
+	const TickStatistics statistics = task->getStatistics();
+	BOOST_CHECK_EQUAL(statistics.m_NumTicks, numTicks.load());
+	// Deadlines are on a fixed grid, so the ticks never get ahead of the clock.
+	// A deadline missed on a busy machine is counted as an overrun instead.
+	const double numDeadlines = (double)(statistics.m_NumTicks + statistics.m_NumOverruns);
+	BOOST_CHECK_LE(numDeadlines, elapsedTicks + 1.0);
+	BOOST_CHECK_GE(numDeadlines, elapsedTicks * 0.8);
+	BOOST_CHECK_LE(statistics.m_NumOverruns, statistics.m_NumTicks / 4);
+	BOOST_CHECK(task->isFinished());
+}
+
+BOOST_AUTO_TEST_CASE(TestSlowTaskCountsOverruns)
+{
+	std::vector<float> deltaTimes;
+	std::vector<Clock::time_point> startTimes;
+
+	TickScheduler scheduler(tickLength, 1);
+	scheduler.start(2);
+	TickScheduler::TaskPtr task = scheduler.addTask([&] (float p_DeltaTime)
+	{
+		deltaTimes.push_back(p_DeltaTime);
+		startTimes.push_back(Clock::now());
+		std::this_thread::sleep_for(tickLength * 3 + std::chrono::milliseconds(5));
+		return true;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	scheduler.stop();
+
+	const TickStatistics statistics = task->getStatistics();
+	BOOST_REQUIRE_GT(statistics.m_NumTicks, 1);
+	BOOST_CHECK_EQUAL(statistics.m_NumTicks, deltaTimes.size());
+	// Every tick takes more than three periods, so deadlines pass while it runs.
+	BOOST_CHECK_GE(statistics.m_NumOverruns, statistics.m_NumTicks);
+	for (unsigned int i = 0; TickStatistics::getBucketLimit(i) >= 0.0 && TickStatistics::getBucketLimit(i) < 0.03; ++i)
+	{
+		BOOST_CHECK_EQUAL(statistics.m_Buckets[i], 0);
+	}
+
+	// The time steps are whole periods covering the skipped deadlines, so they
+	// add up to the time between the ticks, apart from how late the ticks start.
+	double totalTime = 0.0;
+	for (size_t i = 1; i < deltaTimes.size(); ++i)
+	{
+		BOOST_CHECK_GT(deltaTimes[i], toSeconds(tickLength) * 1.5);
+		totalTime += deltaTimes[i];
+	}
+	const double elapsed = toSeconds(startTimes.back() - startTimes.front());
+	BOOST_CHECK_SMALL(totalTime - elapsed, statistics.m_MaxStartDelay + 0.002);
+}
+
+BOOST_AUTO_TEST_CASE(TestFinishedTaskIsRemoved)
+{
+	std::atomic<unsigned int> numTicks(0);
+
+	TickScheduler scheduler(tickLength, 4);
+	scheduler.start(1);
+	TickScheduler::TaskPtr task = scheduler.addTask([&] (float) { return ++numTicks < 3; });
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	BOOST_CHECK(task->isFinished());
+	BOOST_CHECK_EQUAL(numTicks.load(), 3);
+	BOOST_CHECK_EQUAL(scheduler.getNumTasks(), 0);
+	scheduler.stop();
+}
+
+BOOST_AUTO_TEST_CASE(TestPrintStatistics)
+{
+	TickStatistics statistics = TickStatistics();
+	statistics.addTick(0.0015, 0.0);
+	statistics.addTick(0.2, 0.003);
+	++statistics.m_NumOverruns;
+
+	std::ostringstream out;
+	statistics.print(out);
+
+	BOOST_CHECK_EQUAL(out.str(), "2 ticks, 1 overruns, tick mean 100.75 ms, max 200.00 ms, max start delay 3.00 ms\n"
+		"  tick times <=1 ms: 0, <=2 ms: 1, <=5 ms: 0, <=10 ms: 0, <=20 ms: 0, <=50 ms: 0, <=100 ms: 0, >100 ms: 1");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
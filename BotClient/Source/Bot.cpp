@@ -0,0 +1,274 @@
+#include "Bot.h"
+
+#include <cmath>
+
+namespace
+{
+	enum ConnectResult
+	{
+		PENDING,
+		CONNECTED,
+		CONNECTION_LOST,
+	};
+}
+
+Bot::Bot(unsigned int p_Index, const Settings& p_Settings)
+	:	m_Network(nullptr),
+		m_Settings(p_Settings),
+		m_ConnectResult(PENDING),
+		m_State(State::CONNECTING),
+		m_ActorId(0),
+		m_HasCenter(false),
+		m_Center(0.f, 0.f, 0.f),
+		m_Angle(p_Index * 0.7f),
+		m_TimeToSpell(p_Settings.m_SpellInterval * (1 + p_Index % 10) / 10.f)
+{
+	m_Statistics.m_Name = "Bot" + std::to_string(p_Index);
+	m_Statistics.m_ConnectTime = -1.f;
+	m_Statistics.m_GameListTime = -1.f;
+	m_Statistics.m_JoinTime = -1.f;
+	m_Statistics.m_ControlsSent = 0;
+	m_Statistics.m_SpellsSent = 0;
+	m_Statistics.m_PackagesReceived = 0;
+	m_Statistics.m_UpdatesReceived = 0;
+	m_Statistics.m_PlayTime = 0.f;
+}
+
+Bot::~Bot()
+{
+	if (m_Network)
+	{
+		m_Network->disconnectFromServer();
+		INetwork::deleteNetwork(m_Network);
+	}
+}
+
+void Bot::connect()
+{
+	m_Network = INetwork::createNetwork();
+	m_Network->setLogFunction(m_Settings.m_LogFunction);
+	m_Network->initialize();
+
+	m_StartTime = Clock::now();
+	m_Network->connectToServer(m_Settings.m_Host.c_str(), m_Settings.m_Port, &Bot::connectedCallback, this);
+}
+
+void Bot::update(float p_DeltaTime)
+{
+	const int connectResult = m_ConnectResult.load();
+	if (m_State == State::CONNECTING)
+	{
+		if (connectResult == PENDING)
+		{
+			return;
+		}
+		if (connectResult != CONNECTED)
+		{
+			m_State = State::FAILED;
+			return;
+		}
+
+		m_Statistics.m_ConnectTime = getSecondsSince(m_StartTime);
+		m_State = State::LOBBY;
+		m_RequestTime = Clock::now();
+		m_Network->getConnectionToServer()->sendRequestGames();
+	}
+
+	if (m_State == State::DISCONNECTED || m_State == State::FAILED)
+	{
+		return;
+	}
+
+	IConnectionController* conn = m_Network->getConnectionToServer();
+	if (connectResult == CONNECTION_LOST || !conn || !conn->isConnected())
+	{
+		if (m_State == State::PLAYING)
+		{
+			m_Statistics.m_PlayTime = getSecondsSince(m_PlayStartTime);
+		}
+		m_State = State::DISCONNECTED;
+		return;
+	}
+
+	handlePackages(conn);
+
+	if (m_State == State::PLAYING && m_HasCenter)
+	{
+		sendControl(conn, p_DeltaTime);
+	}
+}
+
+Bot::State Bot::getState() const
+{
+	return m_State;
+}
+
+BotStatistics Bot::getStatistics() const
+{
+	BotStatistics statistics(m_Statistics);
+	statistics.m_State = getStateName(m_State);
+	if (m_State == State::PLAYING)
+	{
+		statistics.m_PlayTime = getSecondsSince(m_PlayStartTime);
+	}
+	return statistics;
+}
+
+const char* Bot::getStateName(State p_State)
+{
+	switch (p_State)
+	{
+	case State::CONNECTING:		return "Connecting";
+	case State::LOBBY:			return "Lobby";
+	case State::JOINING:		return "Joining";
+	case State::PLAYING:		return "Playing";
+	case State::DISCONNECTED:	return "Disconnected";
+	case State::FAILED:			return "Failed";
+	default:					return "Unknown";
+	}
+}
+
+void Bot::connectedCallback(Result p_Result, void* p_UserData)
+{
+	Bot* self = static_cast<Bot*>(p_UserData);
+	self->m_ConnectResult.store(p_Result == Result::SUCCESS ? CONNECTED : CONNECTION_LOST);
+}
+
+void Bot::handlePackages(IConnectionController* p_Connection)
+{
+	const unsigned int numPackages = p_Connection->getNumPackages();
+	for (unsigned int i = 0; i < numPackages; ++i)
+	{
+		Package package = p_Connection->getPackage(i);
+		++m_Statistics.m_PackagesReceived;
+
+		switch (p_Connection->getPackageType(package))
+		{
+		case PackageType::GAME_LIST:
+			if (m_State == State::LOBBY)
+			{
+				m_Statistics.m_GameListTime = getSecondsSince(m_RequestTime);
+
+				m_State = State::JOINING;
+				m_RequestTime = Clock::now();
+				p_Connection->sendJoinGame(m_Settings.m_LevelName.c_str(), m_Statistics.m_Name.c_str(),
+					m_Settings.m_CharacterName.c_str(), m_Settings.m_CharacterStyle.c_str());
+			}
+			break;
+
+		case PackageType::ASSIGN_PLAYER:
+			m_ActorId = p_Connection->getAssignPlayerObject(package);
+			if (m_State == State::JOINING)
+			{
+				m_Statistics.m_JoinTime = getSecondsSince(m_RequestTime);
+				m_State = State::PLAYING;
+				m_PlayStartTime = Clock::now();
+			}
+			p_Connection->sendDoneLoading();
+			break;
+
+		case PackageType::SET_SPAWN:
+			m_Center = p_Connection->getSetSpawnPositionData(package);
+			m_HasCenter = true;
+			break;
+
+		case PackageType::UPDATE_OBJECTS:
+			++m_Statistics.m_UpdatesReceived;
+			if (m_State == State::PLAYING)
+			{
+				measureLatency(p_Connection->getUpdateObjectData(package), p_Connection->getNumUpdateObjectData(package));
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	p_Connection->clearPackages(numPackages);
+}
+
+void Bot::sendControl(IConnectionController* p_Connection, float p_DeltaTime)
+{
+	m_Angle += m_Settings.m_CircleSpeed * p_DeltaTime;
+
+	const Vector3 outward(std::sin(m_Angle), 0.f, std::cos(m_Angle));
+	const Vector3 forward(std::cos(m_Angle), 0.f, -std::sin(m_Angle));
+
+	PlayerControlData data;
+	data.m_Position = m_Center + outward * m_Settings.m_CircleRadius;
+	data.m_Velocity = forward * (m_Settings.m_CircleRadius * m_Settings.m_CircleSpeed);
+	data.m_Rotation = Vector3(std::atan2(forward.x, forward.z), 0.f, 0.f);
+	data.m_Forward = forward;
+	data.m_Up = Vector3(0.f, 1.f, 0.f);
+
+	p_Connection->sendPlayerControl(data);
+	++m_Statistics.m_ControlsSent;
+
+	const Clock::time_point now = Clock::now();
+	ControlSample sample;
+	sample.m_Time = now;
+	sample.m_Position = data.m_Position;
+	m_SentControls.push_back(sample);
+	while (!m_SentControls.empty() && now - m_SentControls.front().m_Time > std::chrono::milliseconds((long long)maxLatencyMilliseconds))
+	{
+		m_SentControls.pop_front();
+	}
+
+	if (m_Settings.m_SpellInterval > 0.f)
+	{
+		m_TimeToSpell -= p_DeltaTime;
+		if (m_TimeToSpell <= 0.f)
+		{
+			m_TimeToSpell += m_Settings.m_SpellInterval;
+			p_Connection->sendThrowSpell(m_Settings.m_SpellName.c_str(), data.m_Position + Vector3(0.f, 150.f, 0.f), forward);
+			++m_Statistics.m_SpellsSent;
+		}
+	}
+}
+
+void Bot::measureLatency(const UpdateObjectData* p_Objects, unsigned int p_NumObjects)
+{
+	for (unsigned int i = 0; i < p_NumObjects; ++i)
+	{
+		if (p_Objects[i].m_Id != m_ActorId)
+		{
+			continue;
+		}
+
+		const Vector3 position = p_Objects[i].m_Position;
+		if (!m_HasCenter)
+		{
+			m_Center = position;
+			m_HasCenter = true;
+			return;
+		}
+
+		// The server applies the latest control it has received, so the
+		// closest sent position tells which control the update echoes.
+		const ControlSample* closest = nullptr;
+		float closestDistance = (float)(maxEchoDistance * maxEchoDistance);
+		for (const ControlSample& sample : m_SentControls)
+		{
+			const Vector3 diff = sample.m_Position - position;
+			const float distance = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+			if (distance <= closestDistance)
+			{
+				closest = &sample;
+				closestDistance = distance;
+			}
+		}
+
+		if (closest && closest->m_Time > m_LastEchoTime)
+		{
+			m_Statistics.m_Latencies.push_back(getSecondsSince(closest->m_Time));
+			m_LastEchoTime = closest->m_Time;
+		}
+		return;
+	}
+}
+
+float Bot::getSecondsSince(Clock::time_point p_Time) const
+{
+	return std::chrono::duration_cast<std::chrono::duration<float>>(Clock::now() - p_Time).count();
+}
@@ -0,0 +1,156 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include "BotStatistics.h"
+
+#include <INetwork.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+
+/**
+ * A simulated player. The bot connects to a server, requests the game
+ * list and joins a level like the client does, then runs in circles
+ * around its spawn position sending player control and throwing spells
+ * on a fixed schedule, while measuring how the server responds.
+ *
+ * Each bot has its own network instance and network thread.
+ * All other functions are to be called from a single thread.
+ */
+class Bot
+{
+public:
+	/**
+	 * Bot state, in the order the states are normally passed.
+	 */
+	enum class State
+	{
+		CONNECTING,		/// Waiting for the connection to the server
+		LOBBY,			/// Connected, waiting for the game list
+		JOINING,		/// Joined a level, waiting for a player to be assigned
+		PLAYING,		/// Assigned a player, sending player control
+		DISCONNECTED,	/// Lost the connection after connecting
+		FAILED,			/// Could not connect to the server
+	};
+
+	/**
+	 * What the bots connect to and how they play.
+	 */
+	struct Settings
+	{
+		std::string m_Host;
+		unsigned short m_Port;
+		std::string m_LevelName;
+		std::string m_CharacterName;
+		std::string m_CharacterStyle;
+		std::string m_SpellName;
+		float m_SpellInterval;		/// Seconds between spells, 0 to never throw spells
+		float m_CircleRadius;		/// Radius of the circle run around the spawn position
+		float m_CircleSpeed;		/// Angular speed around the circle in radians per second
+		INetwork::clientLogCallback_t m_LogFunction;	/// Receives network log messages, may be null
+	};
+
+private:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	/**
+	 * A sent player control position, kept to match against object updates.
+	 */
+	struct ControlSample
+	{
+		Clock::time_point m_Time;
+		Vector3 m_Position;
+	};
+
+	/**
+	 * Sent positions older than this are not matched against object updates.
+	 */
+	static const unsigned int maxLatencyMilliseconds = 2000;
+	/**
+	 * The furthest an updated position may be from a sent position to be considered an echo of it.
+	 */
+	static const unsigned int maxEchoDistance = 50;
+
+	INetwork* m_Network;
+	Settings m_Settings;
+	std::atomic<int> m_ConnectResult;
+	State m_State;
+
+	Clock::time_point m_StartTime;
+	Clock::time_point m_RequestTime;
+	Clock::time_point m_PlayStartTime;
+	Clock::time_point m_LastEchoTime;
+
+	uint32_t m_ActorId;
+	bool m_HasCenter;
+	Vector3 m_Center;
+	float m_Angle;
+	float m_TimeToSpell;
+	std::deque<ControlSample> m_SentControls;
+
+	BotStatistics m_Statistics;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_Index the number of the bot, used to name it and spread bots apart.
+	 * @param p_Settings what to connect to and how to play.
+	 */
+	Bot(unsigned int p_Index, const Settings& p_Settings);
+
+	/**
+	 * Destructor, disconnects from the server.
+	 */
+	~Bot();
+
+	/**
+	 * Start connecting to the server.
+	 */
+	void connect();
+
+	/**
+	 * Handle received packages and send player control if playing.
+	 *
+	 * @param p_DeltaTime the time in seconds since the last update.
+	 */
+	void update(float p_DeltaTime);
+
+	/**
+	 * Get the current state of the bot.
+	 *
+	 * @return the bot state.
+	 */
+	State getState() const;
+
+	/**
+	 * Get what the bot has measured so far.
+	 *
+	 * @return the bot statistics.
+	 */
+	BotStatistics getStatistics() const;
+
+	/**
+	 * Get a printable name of a state.
+	 *
+	 * @param p_State the state to name.
+	 * @return the name of the state.
+	 */
+	static const char* getStateName(State p_State);
+
+private:
+	Bot(const Bot&);
+	Bot& operator=(const Bot&);
+
+	static void connectedCallback(Result p_Result, void* p_UserData);
+
+	void handlePackages(IConnectionController* p_Connection);
+	void sendControl(IConnectionController* p_Connection, float p_DeltaTime);
+	void measureLatency(const UpdateObjectData* p_Objects, unsigned int p_NumObjects);
+	float getSecondsSince(Clock::time_point p_Time) const;
+};
@@ -0,0 +1,108 @@
+#include "BotStatistics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+namespace
+{
+	void printTimes(std::ostream& p_Out, const std::string& p_Name, std::vector<float> p_Times)
+	{
+		std::sort(p_Times.begin(), p_Times.end());
+
+		p_Out << "  " << std::left << std::setw(18) << p_Name << std::right;
+		if (p_Times.empty())
+		{
+			p_Out << "no samples" << std::endl;
+			return;
+		}
+
+		p_Out << std::fixed << std::setprecision(1)
+			<< "p50 " << LoadSummary::percentile(p_Times, 50.f) * 1000.f << " ms, "
+			<< "p95 " << LoadSummary::percentile(p_Times, 95.f) * 1000.f << " ms, "
+			<< "p99 " << LoadSummary::percentile(p_Times, 99.f) * 1000.f << " ms, "
+			<< "max " << p_Times.back() * 1000.f << " ms ("
+			<< p_Times.size() << " samples)" << std::endl;
+	}
+}
+
+void LoadSummary::addBot(const BotStatistics& p_Statistics)
+{
+	m_Bots.push_back(p_Statistics);
+}
+
+void LoadSummary::print(std::ostream& p_Out, float p_Duration) const
+{
+	std::map<std::string, unsigned int> states;
+	std::vector<float> connectTimes;
+	std::vector<float> gameListTimes;
+	std::vector<float> joinTimes;
+	std::vector<float> latencies;
+	uint64_t controlsSent = 0;
+	uint64_t spellsSent = 0;
+	uint64_t packagesReceived = 0;
+	uint64_t updatesReceived = 0;
+
+	for (const BotStatistics& bot : m_Bots)
+	{
+		++states[bot.m_State];
+		if (bot.m_ConnectTime >= 0.f)
+			connectTimes.push_back(bot.m_ConnectTime);
+		if (bot.m_GameListTime >= 0.f)
+			gameListTimes.push_back(bot.m_GameListTime);
+		if (bot.m_JoinTime >= 0.f)
+			joinTimes.push_back(bot.m_JoinTime);
+		latencies.insert(latencies.end(), bot.m_Latencies.begin(), bot.m_Latencies.end());
+
+		controlsSent += bot.m_ControlsSent;
+		spellsSent += bot.m_SpellsSent;
+		packagesReceived += bot.m_PackagesReceived;
+		updatesReceived += bot.m_UpdatesReceived;
+	}
+
+	p_Out << m_Bots.size() << " bots during " << p_Duration << " s" << std::endl;
+	for (const auto& state : states)
+	{
+		p_Out << "  " << std::left << std::setw(18) << state.first << std::right << state.second << std::endl;
+	}
+
+	printTimes(p_Out, "Connect", connectTimes);
+	printTimes(p_Out, "Game list", gameListTimes);
+	printTimes(p_Out, "Join", joinTimes);
+	printTimes(p_Out, "Control echo", latencies);
+
+	const float seconds = p_Duration > 0.f ? p_Duration : 1.f;
+	p_Out << std::fixed << std::setprecision(1)
+		<< "  Sent              " << controlsSent / seconds << " controls/s, " << spellsSent / seconds << " spells/s" << std::endl
+		<< "  Received          " << packagesReceived / seconds << " packages/s, " << updatesReceived / seconds << " updates/s" << std::endl;
+}
+
+void LoadSummary::writeCSV(std::ostream& p_Out) const
+{
+	p_Out << "bot,state,connect_ms,game_list_ms,join_ms,play_s,controls_sent,spells_sent,"
+		"packages_received,updates_received,latency_samples,latency_p50_ms,latency_p95_ms,latency_max_ms" << std::endl;
+
+	for (const BotStatistics& bot : m_Bots)
+	{
+		std::vector<float> latencies(bot.m_Latencies);
+		std::sort(latencies.begin(), latencies.end());
+
+		p_Out << bot.m_Name << ',' << bot.m_State << ','
+			<< bot.m_ConnectTime * 1000.f << ',' << bot.m_GameListTime * 1000.f << ',' << bot.m_JoinTime * 1000.f << ','
+			<< bot.m_PlayTime << ',' << bot.m_ControlsSent << ',' << bot.m_SpellsSent << ','
+			<< bot.m_PackagesReceived << ',' << bot.m_UpdatesReceived << ',' << latencies.size() << ','
+			<< percentile(latencies, 50.f) * 1000.f << ',' << percentile(latencies, 95.f) * 1000.f << ','
+			<< (latencies.empty() ? 0.f : latencies.back() * 1000.f) << std::endl;
+	}
+}
+
+float LoadSummary::percentile(const std::vector<float>& p_Samples, float p_Percentile)
+{
+	if (p_Samples.empty())
+	{
+		return 0.f;
+	}
+
+	const size_t index = (size_t)(p_Percentile / 100.f * (p_Samples.size() - 1) + 0.5f);
+	return p_Samples[std::min(index, p_Samples.size() - 1)];
+}
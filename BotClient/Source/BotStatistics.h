@@ -0,0 +1,69 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * What a single bot measured during a load run.
+ */
+struct BotStatistics
+{
+	std::string m_Name;
+	std::string m_State;
+	float m_ConnectTime;			/// Seconds until connected, negative if never connected
+	float m_GameListTime;			/// Seconds from requesting the game list until it arrived, negative if it never did
+	float m_JoinTime;				/// Seconds from joining until assigned a player, negative if never assigned
+	uint32_t m_ControlsSent;
+	uint32_t m_SpellsSent;
+	uint32_t m_PackagesReceived;
+	uint32_t m_UpdatesReceived;
+	float m_PlayTime;				/// Seconds spent in game, sending player control
+	std::vector<float> m_Latencies;	/// Player control echo latencies in seconds
+};
+
+/**
+ * Summary of the statistics of every bot in a load run.
+ */
+class LoadSummary
+{
+private:
+	std::vector<BotStatistics> m_Bots;
+
+public:
+	/**
+	 * Add the statistics of one bot.
+	 *
+	 * @param p_Statistics the final statistics of the bot.
+	 */
+	void addBot(const BotStatistics& p_Statistics);
+
+	/**
+	 * Print a human readable summary of all bots.
+	 *
+	 * @param p_Out the stream to print to.
+	 * @param p_Duration the length of the run in seconds.
+	 */
+	void print(std::ostream& p_Out, float p_Duration) const;
+
+	/**
+	 * Write one line per bot with comma separated values, after a header line.
+	 *
+	 * @param p_Out the stream to write to.
+	 */
+	void writeCSV(std::ostream& p_Out) const;
+
+	/**
+	 * Get a percentile of a set of samples.
+	 *
+	 * @param p_Samples the samples, sorted ascending.
+	 * @param p_Percentile the percentile, between 0 and 100.
+	 * @return the sample at the percentile, or 0 if there are no samples.
+	 */
+	static float percentile(const std::vector<float>& p_Samples, float p_Percentile);
+};
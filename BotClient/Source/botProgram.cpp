@@ -0,0 +1,206 @@
+#include "Bot.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	void printHelp()
+	{
+		static const std::string helpMessage =
+			"Usage: BotClient [options]\n"
+			"  --host <address>       Server to connect to (localhost)\n"
+			"  --port <port>          Server port (31415)\n"
+			"  --bots <count>         Number of simulated players (100)\n"
+			"  --level <name>         Level to join (serverLevel)\n"
+			"  --duration <seconds>   Length of the run, including ramp up (60)\n"
+			"  --ramp <seconds>       Time over which the bots connect (10)\n"
+			"  --rate <hz>            Player control packages per second and bot (30)\n"
+			"  --spell <seconds>      Time between spells per bot, 0 to disable (5)\n"
+			"  --csv <file>           Write per bot statistics to a file\n"
+			"  --help                 Print this message\n"
+			"Every bot has its own connection and network thread.\n";
+
+		std::cout << helpMessage;
+	}
+
+	void logNetwork(uint32_t p_Level, const char* p_Message)
+	{
+		// Warnings and worse, from any bot.
+		static const uint32_t minLevel = 3;
+		if (p_Level >= minLevel)
+		{
+			std::cerr << p_Message << std::endl;
+		}
+	}
+
+	void printProgress(const std::vector<std::unique_ptr<Bot>>& p_Bots, float p_Elapsed)
+	{
+		unsigned int states[(int)Bot::State::FAILED + 1] = {};
+		for (const auto& bot : p_Bots)
+		{
+			++states[(int)bot->getState()];
+		}
+
+		std::cout << (int)p_Elapsed << " s:";
+		for (int i = 0; i <= (int)Bot::State::FAILED; ++i)
+		{
+			if (states[i] > 0)
+			{
+				std::cout << ' ' << Bot::getStateName((Bot::State)i) << ' ' << states[i];
+			}
+		}
+		std::cout << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Bot::Settings settings;
+	settings.m_Host = "localhost";
+	settings.m_Port = 31415;
+	settings.m_LevelName = "serverLevel";
+	settings.m_CharacterName = "Dzala";
+	settings.m_CharacterStyle = "Black";
+	settings.m_SpellName = "TestSpell";
+	settings.m_SpellInterval = 5.f;
+	settings.m_CircleRadius = 300.f;
+	settings.m_CircleSpeed = 1.f;
+	settings.m_LogFunction = &logNetwork;
+
+	unsigned int numBots = 100;
+	float duration = 60.f;
+	float rampTime = 10.f;
+	float controlRate = 30.f;
+	std::string csvPath;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string option(argv[i]);
+		if (option == "--help")
+		{
+			printHelp();
+			return 0;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing value for " << option << std::endl;
+			return 1;
+		}
+		const std::string value(argv[++i]);
+
+		if (option == "--host")
+			settings.m_Host = value;
+		else if (option == "--port")
+			settings.m_Port = (unsigned short)std::atoi(value.c_str());
+		else if (option == "--bots")
+			numBots = (unsigned int)std::atoi(value.c_str());
+		else if (option == "--level")
+			settings.m_LevelName = value;
+		else if (option == "--duration")
+			duration = (float)std::atof(value.c_str());
+		else if (option == "--ramp")
+			rampTime = (float)std::atof(value.c_str());
+		else if (option == "--rate")
+			controlRate = (float)std::atof(value.c_str());
+		else if (option == "--spell")
+			settings.m_SpellInterval = (float)std::atof(value.c_str());
+		else if (option == "--csv")
+			csvPath = value;
+		else
+		{
+			std::cerr << "Unknown option " << option << ". Use '--help' for available options." << std::endl;
+			return 1;
+		}
+	}
+
+	if (controlRate <= 0.f)
+	{
+		std::cerr << "The control rate must be positive" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Running " << numBots << " bots against " << settings.m_Host << ":" << settings.m_Port
+		<< " for " << duration << " s" << std::endl;
+
+	std::vector<std::unique_ptr<Bot>> bots;
+	for (unsigned int i = 0; i < numBots; ++i)
+	{
+		bots.push_back(std::unique_ptr<Bot>(new Bot(i, settings)));
+	}
+
+	const Clock::duration tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.f / controlRate));
+	const Clock::time_point startTime = Clock::now();
+	Clock::time_point lastTick = startTime;
+	Clock::time_point nextTick = startTime;
+	float nextProgress = 5.f;
+	unsigned int numConnected = 0;
+
+	while (true)
+	{
+		const Clock::time_point now = Clock::now();
+		const float elapsed = std::chrono::duration_cast<std::chrono::duration<float>>(now - startTime).count();
+		if (elapsed >= duration)
+		{
+			break;
+		}
+
+		// Bots are connected evenly over the ramp time.
+		while (numConnected < numBots && (rampTime <= 0.f || elapsed >= rampTime * numConnected / numBots))
+		{
+			bots[numConnected++]->connect();
+		}
+
+		const float deltaTime = std::chrono::duration_cast<std::chrono::duration<float>>(now - lastTick).count();
+		lastTick = now;
+		for (auto& bot : bots)
+		{
+			bot->update(deltaTime);
+		}
+
+		if (elapsed >= nextProgress)
+		{
+			printProgress(bots, elapsed);
+			nextProgress += 5.f;
+		}
+
+		nextTick += tickLength;
+		if (nextTick < Clock::now())
+		{
+			// Running behind, do not try to catch up.
+			nextTick = Clock::now();
+		}
+		std::this_thread::sleep_until(nextTick);
+	}
+
+	LoadSummary summary;
+	for (const auto& bot : bots)
+	{
+		summary.addBot(bot->getStatistics());
+	}
+	bots.clear();
+
+	summary.print(std::cout, duration);
+
+	if (!csvPath.empty())
+	{
+		std::ofstream csvFile(csvPath, std::ofstream::trunc);
+		summary.writeCSV(csvFile);
+		if (!csvFile)
+		{
+			std::cerr << "Could not write " << csvPath << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
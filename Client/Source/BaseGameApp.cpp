@@ -7,6 +7,8 @@
 #include <TweakCommand.h>
 #include "../resource.h"
 
+#include <boost/filesystem.hpp>
+
 #include <iomanip>
 #include <memory>
 #include <sstream>
@@ -152,6 +154,18 @@ void BaseGameApp::init()
 	m_Network->setLogFunction(&Logger::logRaw);
 	m_Network->initialize();
 
+	const std::string levelCacheDirectory("cache/levels");
+	boost::system::error_code error;
+	boost::filesystem::create_directories(levelCacheDirectory, error);
+	if (error)
+	{
+		Logger::log(Logger::Level::WARNING, "Could not create level cache directory: " + error.message());
+	}
+	else
+	{
+		m_Network->setLevelCacheDirectory(levelCacheDirectory.c_str());
+	}
+
 	m_EventManager.reset(new EventManager());
 
 	m_EventManager->addListener(EventListenerDelegate(&m_InputQueue, &Input::lockMouse), MouseEventDataLock::sk_EventType);
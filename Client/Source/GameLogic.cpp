@@ -661,6 +661,22 @@ void GameLogic::handleNetwork()
 	if (m_Connected)
 	{
 		IConnectionController* conn = m_Network->getConnectionToServer();
+		if (!conn->isConnected())
+		{
+			// Also reached when the level could not be downloaded.
+			Logger::log(Logger::Level::WARNING, "Lost the connection to the server");
+			m_Connected = false;
+			if (m_InGame)
+			{
+				leaveGame();
+			}
+			else
+			{
+				m_EventManager->queueEvent(IEventData::Ptr(new QuitGameEventData));
+			}
+			return;
+		}
+
 		unsigned int numPackages = conn->getNumPackages();
 		for (unsigned int i = 0; i < numPackages; i++)
 		{
@@ -823,88 +839,68 @@ void GameLogic::handleNetwork()
 						}
 					}
 
-					unsigned int numberOfExtraData = conn->getNumUpdateObjectExtraData(package);
-					for(unsigned int i = 0; i < numberOfExtraData; i++)
+					const unsigned int numColors = conn->getNumUpdateObjectColors(package);
+					const ObjectColorData* colors = conn->getUpdateObjectColors(package);
+					for (unsigned int i = 0; i < numColors; ++i)
 					{
-						const char* updates = conn->getUpdateObjectExtraData(package, i);
-
-						tinyxml2::XMLDocument reader;
-						reader.Parse(updates);
-						tinyxml2::XMLElement* object = reader.FirstChildElement("ObjectUpdate");
-						Actor::Id actorId = -1;
-						object->QueryAttribute("ActorId", &actorId);
-
-						Actor::ptr actor = getActor(actorId);
+						const ObjectColorData& color = colors[i];
+						Actor::ptr actor = getActor(color.m_Id);
 						if (!actor)
 						{
-							Logger::log(Logger::Level::ERROR_L, "Could not find actor (" + std::to_string(actorId) + ")");
+							Logger::log(Logger::Level::ERROR_L, "Could not find actor (" + std::to_string(color.m_Id) + ")");
 							continue;
 						}
 
-						if(object->Attribute("Type", "Color"))
+						std::shared_ptr<ParticleInterface> particleComponent = actor->getComponent<ParticleInterface>(ParticleInterface::m_ComponentId).lock();
+						if (particleComponent)
 						{
-							object = object->FirstChildElement("SetColor");
-							if(!object)
-								Logger::log(Logger::Level::ERROR_L, "Could not find Object (" + std::to_string(actorId) + ")");
-							Vector3 color;
-							object->QueryAttribute("r", &color.x);
-							object->QueryAttribute("g", &color.y);
-							object->QueryAttribute("b", &color.z);
-							
-							std::shared_ptr<ParticleInterface> particleComponent = actor->getComponent<ParticleInterface>(ParticleInterface::m_ComponentId).lock();
-							if (particleComponent)
-							{
-								particleComponent->setBaseColor(Vector4(color, 1.0f));
-							}
+							particleComponent->setBaseColor(Vector4(color.m_Color, 1.0f));
+						}
 
-							std::shared_ptr<ModelInterface> modelComponent = actor->getComponent<ModelInterface>(ModelInterface::m_ComponentId).lock();
-							if (modelComponent)
-							{
-								modelComponent->setColorTone(color);
-							}
+						std::shared_ptr<ModelInterface> modelComponent = actor->getComponent<ModelInterface>(ModelInterface::m_ComponentId).lock();
+						if (modelComponent)
+						{
+							modelComponent->setColorTone(color.m_Color);
 						}
-						else if (object->Attribute("Type", "Look"))
+					}
+
+					const unsigned int numLooks = conn->getNumUpdateObjectLooks(package);
+					const ObjectLookData* looks = conn->getUpdateObjectLooks(package);
+					for (unsigned int i = 0; i < numLooks; ++i)
+					{
+						const ObjectLookData& look = looks[i];
+						Actor::ptr actor = getActor(look.m_Id);
+						if (!actor)
 						{
-							if (actor == m_Player.getActor().lock())
-							{
-								continue;
-							}
+							Logger::log(Logger::Level::ERROR_L, "Could not find actor (" + std::to_string(look.m_Id) + ")");
+							continue;
+						}
 
-							const tinyxml2::XMLElement* look = object->FirstChildElement("Look");
-							if (look)
-							{
-								std::shared_ptr<LookInterface> lookInt = actor->getComponent<LookInterface>(LookInterface::m_ComponentId).lock();
-								if (lookInt)
-								{
-									Vector3 forward(0.f, 0.f, 1.f);
-									Vector3 up(0.f, 1.f, 0.f);
-									queryVector(look->FirstChildElement("Forward"), forward);
-									queryVector(look->FirstChildElement("Up"), up);
+						if (actor == m_Player.getActor().lock())
+						{
+							continue;
+						}
 
-									lookInt->setLookForward(forward);
-									lookInt->setLookUp(up);
-								}
-							}
+						std::shared_ptr<LookInterface> lookInt = actor->getComponent<LookInterface>(LookInterface::m_ComponentId).lock();
+						if (lookInt)
+						{
+							lookInt->setLookForward(look.m_Forward);
+							lookInt->setLookUp(look.m_Up);
 						}
 					}
-							
 				}
 				break;
 			case PackageType::GAME_POSITIONS:
 				{
-					int numberOfData = conn->getNumRacePositionsData(package);
-					for(int i = 0; i < numberOfData; i++)
+					const unsigned int numberOfData = conn->getNumRacePositionsData(package);
+					const RacePositionData* positions = conn->getRacePositionsData(package);
+					for (unsigned int i = 0; i < numberOfData; i++)
 					{
-						const char* result = conn->getRacePositionsData(package, i);
-						tinyxml2::XMLDocument reader;
-						reader.Parse(result);
-						tinyxml2::XMLElement* object = reader.FirstChildElement("RacePositions");
-						if (object->QueryAttribute("Place", &m_PlayerPositionInRace) == tinyxml2::XML_NO_ERROR)
-						{
-							m_EventManager->queueEvent(IEventData::Ptr(new UpdatePlayerRaceEventData(m_PlayerPositionInRace)));
-						}
-						if (object->QueryAttribute("Time", &m_PlayerTimeDifference) == tinyxml2::XML_NO_ERROR)
+						m_PlayerPositionInRace = positions[i].m_Place;
+						m_EventManager->queueEvent(IEventData::Ptr(new UpdatePlayerRaceEventData(m_PlayerPositionInRace)));
+						if (positions[i].m_HasTime)
 						{
+							m_PlayerTimeDifference = positions[i].m_Time;
 							m_EventManager->queueEvent(IEventData::Ptr(new UpdatePlayerTimeEventData(m_PlayerTimeDifference)));
 						}
 					}
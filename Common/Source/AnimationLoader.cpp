@@ -103,6 +103,23 @@ bool AnimationLoader::loadAnimationDataResource(const char* p_ResourceName, cons
 	return true;
 }
 
+bool AnimationLoader::addAnimationData(const char* p_ResourceName, const char* p_FilePath, AnimationData::ptr p_Data)
+{
+	if (!p_Data)
+	{
+		return false;
+	}
+
+	LoadedAnimationData loadedData;
+	loadedData.animationData = p_Data;
+	loadedData.filename = p_FilePath;
+	loadedData.resourceName = p_ResourceName;
+
+	m_LoadedAnimations.push_back(loadedData);
+
+	return true;
+}
+
 bool AnimationLoader::releaseAnimationData(const char* p_ResourceName)
 {
 	auto it = std::remove_if(m_LoadedAnimations.begin(), m_LoadedAnimations.end(),
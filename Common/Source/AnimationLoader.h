@@ -47,6 +47,15 @@ public:
 	void clear();
 
 	bool loadAnimationDataResource(const char* p_resourceName, const char* p_FilePath);
+	/**
+	 * Add animation data that has already been loaded, such as data shared between several loaders.
+	 *
+	 * @param p_ResourceName the name of the animation resource
+	 * @param p_FilePath the path the data was loaded from
+	 * @param p_Data the loaded animation data
+	 * @return true if the data was added
+	 */
+	bool addAnimationData(const char* p_ResourceName, const char* p_FilePath, AnimationData::ptr p_Data);
 	bool releaseAnimationData(const char* p_FilePath);
 	AnimationData::ptr getAnimationData(const char* p_ResourceName) const;
 
@@ -588,11 +588,17 @@ public:
 	{
 		// Ugly fix for bad physics interface
 		//m_Physics->setBodyRotation(m_Body, p_Rotation - m_Owner->getRotation());
+		const BodyHandle oldBody = m_Body;
 		m_Physics->releaseBody(m_Body);
 		m_Body = m_Physics->createBVInstance(m_MeshName.c_str());
 		m_Physics->setBodyScale(m_Body, m_Scale);
 		m_Physics->setBodyRotation(m_Body, p_Rotation);
 		m_Physics->setBodyPosition(m_Body, m_Owner->getPosition());
+
+		if (m_Owner->getEventManager())
+		{
+			m_Owner->getEventManager()->triggerTriggerEvent(IEventData::Ptr(new ChangeBodyEventData(oldBody, m_Body)));
+		}
 	}
 
 	BodyHandle getBodyHandle() const override
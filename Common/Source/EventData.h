@@ -1089,6 +1089,55 @@ public:
 	}
 };
 
+/**
+ * Triggered when a component replaces the physics body of an actor,
+ * for anything keeping track of which actor a body belongs to.
+ */
+class ChangeBodyEventData : public BaseEventData
+{
+private:
+	BodyHandle m_OldBody;
+	BodyHandle m_NewBody;
+
+public:
+	static const Type sk_EventType = Type(0x2d7e64b1);
+
+	ChangeBodyEventData(BodyHandle p_OldBody, BodyHandle p_NewBody)
+		:	m_OldBody(p_OldBody),
+			m_NewBody(p_NewBody)
+	{
+	}
+
+	virtual const Type &getEventType(void) const override
+	{
+		return sk_EventType;
+	}
+
+	virtual Ptr copy(void) const override
+	{
+		return Ptr(new ChangeBodyEventData(m_OldBody, m_NewBody));
+	}
+
+	virtual void serialize(std::ostream &p_Out) const override
+	{
+	}
+
+	virtual const char *getName(void) const override
+	{
+		return "ChangeBodyEvent";
+	}
+
+	BodyHandle getOldBody() const
+	{
+		return m_OldBody;
+	}
+
+	BodyHandle getNewBody() const
+	{
+		return m_NewBody;
+	}
+};
+
 class UpdateGraphicalCountdownEventData : public BaseEventData
 {
 private:
@@ -227,7 +227,10 @@ public:
 
 	const AnimationPath getAnimationData(std::string p_AnimationId) const override
 	{
-		return m_Animation.getAnimationData().get()->animationPath[p_AnimationId];
+		// The animation data may be shared between threads, so it must not be modified by a lookup.
+		const std::map<std::string, AnimationPath>& paths = m_Animation.getAnimationData()->animationPath;
+		auto path = paths.find(p_AnimationId);
+		return path != paths.end() ? path->second : AnimationPath();
 	}
 
 	void playClimbAnimation(std::string p_ClimbID) override
@@ -247,7 +250,9 @@ public:
 	{
 		m_EdgeOrientation = p_EdgeOrientation;
 		m_CenterReachPos = p_CenterReachPos;
-		m_Shell = m_Animation.getAnimationData().get()->grabShells[grabName];
+		const std::map<std::string, IKGrabShell>& shells = m_Animation.getAnimationData()->grabShells;
+		auto shell = shells.find(grabName);
+		m_Shell = shell != shells.end() ? shell->second : IKGrabShell();
 		m_Shell.m_CurrentFrame = 1.0f;
 	}
 
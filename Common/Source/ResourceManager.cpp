@@ -31,6 +31,14 @@ ResourceManager::ResourceManager(const boost::filesystem::path& p_RootPath)
 {
 }
 
+ResourceManager::ResourceManager(const boost::filesystem::path& p_RootPath, const ResourceTranslator& p_ResourceTranslator)
+	:	m_NextID(0),
+		m_ResourceTranslator(p_ResourceTranslator),
+		m_ProjectDirectory(p_RootPath),
+		m_ReleaseImmediately(false)
+{
+}
+
 ResourceManager::~ResourceManager()
 {
 	for (auto& type : m_ResourceList)
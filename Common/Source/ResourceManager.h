@@ -52,6 +52,13 @@ protected:
 public:
 	ResourceManager();
 	ResourceManager(const boost::filesystem::path& p_RootPath);
+	/**
+	 * Create a resource manager with an already loaded list of resources,
+	 * instead of loading it with #loadDataFromFile.
+	 * @param p_RootPath the directory the resource paths are relative to
+	 * @param p_ResourceTranslator the loaded resource list
+	 */
+	ResourceManager(const boost::filesystem::path& p_RootPath, const ResourceTranslator& p_ResourceTranslator);
 	~ResourceManager();
 
 	
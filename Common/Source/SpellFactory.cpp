@@ -44,6 +44,18 @@ SpellDefinition::ptr SpellFactory::createSpellDefinition(const char* p_Spellname
 	return spell;
 }
 
+bool SpellFactory::addSpellDefinition(const char* p_Spellname, SpellDefinition::ptr p_Definition)
+{
+	if (!p_Definition)
+	{
+		return false;
+	}
+
+	m_SpellDefinitionMap[p_Spellname] = p_Definition;
+
+	return true;
+}
+
 bool SpellFactory::releaseSpellDefinition(const char *p_SpellId)
 {
 	return m_SpellDefinitionMap.erase(p_SpellId) != 0;
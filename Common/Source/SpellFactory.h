@@ -30,6 +30,15 @@ public:
 	 * @return a pointer to the new definition just added to the list
 	 */
 	virtual SpellDefinition::ptr createSpellDefinition(const char* p_Spellname, const char* p_Filename);
+
+	/**
+	 * Called to add a definition that has already been created, such as a definition shared between factories.
+	 * 
+	 * @param p_Spellname are what the definition are to be called
+	 * @param p_Definition the definition to add
+	 * @return true if the definition was added
+	 */
+	bool addSpellDefinition(const char* p_Spellname, SpellDefinition::ptr p_Definition);
 	
 	/**
 	 * Called to release a specified definition from the list.
@@ -0,0 +1,95 @@
+#include "BufferPool.h"
+
+Buffer::Buffer()
+	:	m_Offset(0),
+		m_Size(0)
+{
+}
+
+Buffer::Buffer(std::shared_ptr<const Storage> p_Storage, size_t p_Offset, size_t p_Size)
+	:	m_Storage(std::move(p_Storage)),
+		m_Offset(p_Offset),
+		m_Size(p_Size)
+{
+}
+
+Buffer::Buffer(std::shared_ptr<const Storage> p_Storage)
+	:	m_Storage(std::move(p_Storage)),
+		m_Offset(0),
+		m_Size(0)
+{
+	if (m_Storage)
+	{
+		m_Size = m_Storage->size();
+	}
+}
+
+Buffer Buffer::copyOf(const std::string& p_Data)
+{
+	return Buffer(std::make_shared<const Storage>(p_Data.begin(), p_Data.end()));
+}
+
+const char* Buffer::data() const
+{
+	if (!m_Storage || m_Storage->empty())
+	{
+		return nullptr;
+	}
+
+	return m_Storage->data() + m_Offset;
+}
+
+size_t Buffer::size() const
+{
+	return m_Size;
+}
+
+bool Buffer::empty() const
+{
+	return m_Size == 0;
+}
+
+std::string Buffer::str() const
+{
+	return std::string(data(), m_Size);
+}
+
+BufferPool::BufferPool(size_t p_MaxPooled)
+	:	m_NextStorage(0),
+		m_MaxPooled(p_MaxPooled),
+		m_NumCreated(0)
+{
+}
+
+std::shared_ptr<Buffer::Storage> BufferPool::acquire()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	// Storage only referenced by the pool can not be taken by anyone else while the lock is held.
+	for (size_t i = 0; i < m_Storage.size(); ++i)
+	{
+		std::shared_ptr<Buffer::Storage>& storage = m_Storage[m_NextStorage];
+		m_NextStorage = (m_NextStorage + 1) % m_Storage.size();
+
+		if (storage.use_count() == 1)
+		{
+			storage->clear();
+			return storage;
+		}
+	}
+
+	++m_NumCreated;
+	std::shared_ptr<Buffer::Storage> storage = std::make_shared<Buffer::Storage>();
+	if (m_Storage.size() < m_MaxPooled)
+	{
+		m_Storage.push_back(storage);
+	}
+
+	return storage;
+}
+
+size_t BufferPool::getNumCreated()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_NumCreated;
+}
@@ -0,0 +1,122 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A reference counted, read-only view of package data. Copying a buffer
+ * only shares the underlying storage, the data itself is never copied.
+ */
+class Buffer
+{
+public:
+	/**
+	 * Storage type shared by buffers.
+	 */
+	typedef std::vector<char> Storage;
+
+private:
+	std::shared_ptr<const Storage> m_Storage;
+	size_t m_Offset;
+	size_t m_Size;
+
+public:
+	/**
+	 * Create an empty buffer.
+	 */
+	Buffer();
+
+	/**
+	 * Create a view of a part of some storage.
+	 *
+	 * @param p_Storage the storage to share, must not be modified while the buffer exists.
+	 * @param p_Offset the offset of the first byte in the view.
+	 * @param p_Size the number of bytes in the view.
+	 */
+	Buffer(std::shared_ptr<const Storage> p_Storage, size_t p_Offset, size_t p_Size);
+
+	/**
+	 * Create a view of all of some storage.
+	 *
+	 * @param p_Storage the storage to share, must not be modified while the buffer exists.
+	 */
+	explicit Buffer(std::shared_ptr<const Storage> p_Storage);
+
+	/**
+	 * Create a buffer holding a copy of a string. Allocates new storage,
+	 * use a BufferPool on paths that run for every package.
+	 *
+	 * @param p_Data the data to copy.
+	 * @return a new buffer.
+	 */
+	static Buffer copyOf(const std::string& p_Data);
+
+	/**
+	 * @return the first byte of the view.
+	 */
+	const char* data() const;
+
+	/**
+	 * @return the number of bytes in the view.
+	 */
+	size_t size() const;
+
+	/**
+	 * @return true if the view is empty.
+	 */
+	bool empty() const;
+
+	/**
+	 * Copy the viewed data into a string.
+	 *
+	 * @return a copy of the data.
+	 */
+	std::string str() const;
+};
+
+/**
+ * Recycles package storage, so that sending and receiving packages does not
+ * allocate memory once the pool has warmed up. Storage is handed back to the
+ * pool automatically when the last buffer referencing it is released.
+ *
+ * Thread safe.
+ */
+class BufferPool
+{
+private:
+	std::mutex m_Lock;
+	std::vector<std::shared_ptr<Buffer::Storage>> m_Storage;
+	size_t m_NextStorage;
+	size_t m_MaxPooled;
+	size_t m_NumCreated;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_MaxPooled the maximum number of storages to keep for reuse.
+	 */
+	explicit BufferPool(size_t p_MaxPooled = 64);
+
+	/**
+	 * Get empty storage to fill, reusing released storage when there is any.
+	 * The capacity of reused storage is kept.
+	 *
+	 * @return storage only referenced by the caller and the pool.
+	 */
+	std::shared_ptr<Buffer::Storage> acquire();
+
+	/**
+	 * Get the number of storages that have been created because none could be reused.
+	 *
+	 * @return the number of created storages.
+	 */
+	size_t getNumCreated();
+};
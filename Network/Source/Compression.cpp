@@ -0,0 +1,187 @@
+#include "Compression.h"
+
+#include <NetworkExceptions.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	const size_t minMatch = 4;
+	// Matches never reach into the last bytes, which are always sent as literals.
+	const size_t lastLiterals = 5;
+	const size_t maxOffset = 0xffff;
+	const unsigned int hashBits = 14;
+
+	uint32_t load32(const unsigned char* p_In)
+	{
+		uint32_t value;
+		std::memcpy(&value, p_In, sizeof(value));
+		return value;
+	}
+
+	uint32_t hashSequence(uint32_t p_Sequence)
+	{
+		return (p_Sequence * 2654435761u) >> (32 - hashBits);
+	}
+
+	void writeLength(std::vector<char>& p_Output, size_t p_Length)
+	{
+		while (p_Length >= 255)
+		{
+			p_Output.push_back((char)255);
+			p_Length -= 255;
+		}
+		p_Output.push_back((char)p_Length);
+	}
+
+	void writeSequence(std::vector<char>& p_Output, const unsigned char* p_Literals, size_t p_NumLiterals,
+		size_t p_Offset, size_t p_MatchLength)
+	{
+		const size_t matchCode = p_MatchLength - minMatch;
+		const unsigned char token = (unsigned char)(((p_NumLiterals < 15 ? p_NumLiterals : 15) << 4)
+			| (matchCode < 15 ? matchCode : 15));
+		p_Output.push_back((char)token);
+		if (p_NumLiterals >= 15)
+		{
+			writeLength(p_Output, p_NumLiterals - 15);
+		}
+		p_Output.insert(p_Output.end(), p_Literals, p_Literals + p_NumLiterals);
+
+		p_Output.push_back((char)(p_Offset & 0xff));
+		p_Output.push_back((char)(p_Offset >> 8));
+		if (matchCode >= 15)
+		{
+			writeLength(p_Output, matchCode - 15);
+		}
+	}
+
+	void writeLastLiterals(std::vector<char>& p_Output, const unsigned char* p_Literals, size_t p_NumLiterals)
+	{
+		p_Output.push_back((char)((p_NumLiterals < 15 ? p_NumLiterals : 15) << 4));
+		if (p_NumLiterals >= 15)
+		{
+			writeLength(p_Output, p_NumLiterals - 15);
+		}
+		p_Output.insert(p_Output.end(), p_Literals, p_Literals + p_NumLiterals);
+	}
+
+	size_t readLength(const unsigned char*& p_In, const unsigned char* p_End)
+	{
+		size_t length = 0;
+		unsigned char value;
+		do
+		{
+			if (p_In == p_End)
+			{
+				throw NetworkError("Compressed data ended unexpectedly", __LINE__, __FILE__);
+			}
+			value = *p_In++;
+			length += value;
+		} while (value == 255);
+		return length;
+	}
+}
+
+void Compression::compress(const char* p_Data, size_t p_Size, std::vector<char>& p_Output)
+{
+	const unsigned char* in = (const unsigned char*)p_Data;
+	p_Output.reserve(p_Output.size() + p_Size / 2 + 16);
+
+	size_t anchor = 0;
+	if (p_Size > minMatch + lastLiterals)
+	{
+		// Positions are stored plus one, so that zero marks an empty slot.
+		std::vector<size_t> table((size_t)1 << hashBits, 0);
+		const size_t matchLimit = p_Size - lastLiterals;
+
+		size_t pos = 0;
+		while (pos + minMatch <= matchLimit)
+		{
+			const uint32_t sequence = load32(in + pos);
+			size_t& slot = table[hashSequence(sequence)];
+			const size_t candidate = slot;
+			slot = pos + 1;
+
+			if (candidate == 0 || pos - (candidate - 1) > maxOffset || load32(in + candidate - 1) != sequence)
+			{
+				++pos;
+				continue;
+			}
+
+			const size_t match = candidate - 1;
+			size_t length = minMatch;
+			while (pos + length < matchLimit && in[match + length] == in[pos + length])
+			{
+				++length;
+			}
+
+			writeSequence(p_Output, in + anchor, pos - anchor, pos - match, length);
+			pos += length;
+			anchor = pos;
+		}
+	}
+
+	writeLastLiterals(p_Output, in + anchor, p_Size - anchor);
+}
+
+void Compression::decompress(const char* p_Data, size_t p_Size, char* p_Output, size_t p_RawSize)
+{
+	const unsigned char* in = (const unsigned char*)p_Data;
+	const unsigned char* const inEnd = in + p_Size;
+	char* out = p_Output;
+	char* const outEnd = p_Output + p_RawSize;
+
+	while (in < inEnd)
+	{
+		const unsigned char token = *in++;
+
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15)
+		{
+			numLiterals += readLength(in, inEnd);
+		}
+		if (numLiterals > (size_t)(inEnd - in) || numLiterals > (size_t)(outEnd - out))
+		{
+			throw NetworkError("Compressed data is corrupt", __LINE__, __FILE__);
+		}
+		std::memcpy(out, in, numLiterals);
+		in += numLiterals;
+		out += numLiterals;
+
+		if (in == inEnd)
+		{
+			break;
+		}
+
+		if (inEnd - in < 2)
+		{
+			throw NetworkError("Compressed data ended unexpectedly", __LINE__, __FILE__);
+		}
+		const size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+
+		size_t length = (token & 15) + minMatch;
+		if ((token & 15) == 15)
+		{
+			length += readLength(in, inEnd);
+		}
+		if (offset == 0 || offset > (size_t)(out - p_Output) || length > (size_t)(outEnd - out))
+		{
+			throw NetworkError("Compressed data is corrupt", __LINE__, __FILE__);
+		}
+
+		// Byte by byte, as the match may overlap the bytes being written.
+		const char* match = out - offset;
+		for (size_t i = 0; i < length; ++i)
+		{
+			out[i] = match[i];
+		}
+		out += length;
+	}
+
+	if (out != outEnd)
+	{
+		throw NetworkError("Compressed data has the wrong size", __LINE__, __FILE__);
+	}
+}
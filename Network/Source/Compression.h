@@ -0,0 +1,41 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Fast byte-oriented LZ77 compression of blocks up to a few megabytes,
+ * used for large packages such as level data. Trades compression ratio
+ * for speed, decompression is a plain copy loop.
+ *
+ * Block layout: a sequence of a token byte, literal bytes, a two byte
+ * match offset and extra length bytes. The high nibble of the token holds
+ * the number of literals and the low nibble the match length minus four,
+ * where 15 means that more length bytes follow, each added until one is
+ * below 255. The last sequence has literals only.
+ */
+namespace Compression
+{
+	/**
+	 * Compress a block of memory.
+	 *
+	 * @param p_Data the first byte to compress.
+	 * @param p_Size the number of bytes to compress.
+	 * @param p_Output the vector to append the compressed block to.
+	 */
+	void compress(const char* p_Data, size_t p_Size, std::vector<char>& p_Output);
+
+	/**
+	 * Decompress a block of memory. Throws a NetworkError if the block is corrupt.
+	 *
+	 * @param p_Data the first byte of the compressed block.
+	 * @param p_Size the size of the compressed block in bytes.
+	 * @param p_Output the memory to decompress into.
+	 * @param p_RawSize the exact size of the decompressed data.
+	 */
+	void decompress(const char* p_Data, size_t p_Size, char* p_Output, size_t p_RawSize);
+}
@@ -3,9 +3,26 @@
 #include "NetworkExceptions.h"
 #include "NetworkLogger.h"
 
+double WriteStatistics::getWritesPerSecond() const
+{
+	return m_Seconds > 0.0 ? m_NumWrites / m_Seconds : 0.0;
+}
+
+double WriteStatistics::getPackagesPerWrite() const
+{
+	return m_NumWrites > 0 ? (double)m_NumPackages / m_NumWrites : 0.0;
+}
+
 Connection::Connection( boost::asio::ip::tcp::socket&& p_Socket) 
 		:   m_Socket(std::move(p_Socket)),
-			m_LockWriting(),
+			m_Writing(false),
+			m_Created(std::chrono::steady_clock::now()),
+			m_NumWrites(0),
+			m_NumPackagesWritten(0),
+			m_NumBytesWritten(0),
+			m_QueuedBytes(0),
+			m_MaxQueuedPackages(0),
+			m_MaxQueuedBytes(0),
 			m_ReadBuffer(sizeof(Header)),
 			m_SaveData(),
 			m_State(State::CONNECTED)
@@ -24,6 +41,10 @@ void Connection::disconnect()
 		m_SaveData = saveDataFunction();
 		m_State = State::UNCONNECTED;
 
+		const WriteStatistics statistics = getWriteStatistics();
+		NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Connection wrote " + std::to_string(statistics.m_NumPackages)
+			+ " packages in " + std::to_string(statistics.m_NumWrites) + " writes");
+
 		m_Socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
 		m_Socket.close();
 	}
@@ -34,18 +55,42 @@ bool Connection::hasError() const
 	return m_State == State::INVALID;
 }
 
-void Connection::doWrite(const Header& p_Header, const std::string& p_Buffer)
+void Connection::doWrite()
 {
 	NetworkLogger::log(NetworkLogger::Level::TRACE, "Starting a write on a connection");
 
-	m_WriteHeader = p_Header;
-	m_WriteBuffer = p_Buffer;
+	// Gather as many waiting packages as fit in one write, but always at least one.
+	size_t writeSize = 0;
+	while (!m_WaitingToWrite.empty())
+	{
+		const Header& header = m_WaitingToWrite.front().first;
+		if (!m_WritePackages.empty() && writeSize + header.m_Size > maxWriteSize)
+		{
+			break;
+		}
+
+		writeSize += header.m_Size;
+		m_QueuedBytes -= header.m_Size;
+		m_WritePackages.push_back(std::move(m_WaitingToWrite.front()));
+		m_WaitingToWrite.pop_front();
+	}
+
+	// The headers are referenced in place, so the package list must not change until the write is done.
+	m_WriteBuffers.clear();
+	for (const auto& package : m_WritePackages)
+	{
+		m_WriteBuffers.push_back(boost::asio::buffer(&package.first, sizeof(Header)));
+		if (!package.second.empty())
+		{
+			m_WriteBuffers.push_back(boost::asio::buffer(package.second.data(), package.second.size()));
+		}
+	}
 
-	std::vector<boost::asio::const_buffer> buffers;
-	buffers.push_back(boost::asio::buffer(&m_WriteHeader, sizeof(m_WriteHeader)));
-	buffers.push_back(boost::asio::buffer(m_WriteBuffer));
+	++m_NumWrites;
+	m_NumPackagesWritten += m_WritePackages.size();
+	m_NumBytesWritten += writeSize;
 
-	boost::asio::async_write(m_Socket, buffers,
+	boost::asio::async_write(m_Socket, m_WriteBuffers,
 		std::bind(&Connection::handleWrite, shared_from_this(), std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -67,14 +112,14 @@ void Connection::handleWrite(const boost::system::error_code& p_Error, std::size
 	}
 
 	std::lock_guard<std::mutex> lock(m_WriteQueueLock);
+	m_WritePackages.clear();
 	if (!m_WaitingToWrite.empty())
 	{
-		doWrite(m_WaitingToWrite[0].first, m_WaitingToWrite[0].second);
-		m_WaitingToWrite.erase(m_WaitingToWrite.begin());
+		doWrite();
 	}
 	else
 	{
-		m_LockWriting.clear();
+		m_Writing = false;
 	}
 }
 
@@ -119,13 +164,12 @@ void Connection::handleReadHeader(const boost::system::error_code& p_Error, std:
 	header = *((Header*)m_ReadBuffer.data());
 	size_t dataSize = header.m_Size - sizeof(Header);
 
-	if (m_ReadBuffer.size() < header.m_Size)
-	{
-		m_ReadBuffer.resize(header.m_Size);
-	}
+	// The package is read straight into pooled storage that is then handed on without copying.
+	m_ReadData = m_ReadPool.acquire();
+	m_ReadData->resize(dataSize);
 
 	boost::asio::async_read(m_Socket,
-		boost::asio::buffer(m_ReadBuffer.data() + sizeof(Header), dataSize),
+		boost::asio::buffer(m_ReadData->data(), dataSize),
 		std::bind(&Connection::handleReadData, shared_from_this(), std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -159,14 +203,14 @@ void Connection::handleReadData(const boost::system::error_code& p_Error, std::s
 	if (m_SaveData)
 	{
 		Header* header = (Header*)m_ReadBuffer.data();
-		std::string data(m_ReadBuffer.data() + sizeof(Header), header->m_Size - sizeof(Header));
-		m_SaveData(header->m_TypeID, data);
+		m_SaveData(header->m_TypeID, Buffer(m_ReadData));
 	}
+	m_ReadData.reset();
 
 	readHeader();
 }
 
-void Connection::writeData(const std::string& p_Buffer, uint16_t p_ID)
+void Connection::writeData(const Buffer& p_Buffer, uint16_t p_ID)
 {
 	NetworkLogger::log(NetworkLogger::Level::TRACE, "Connection received data to send");
 
@@ -174,14 +218,21 @@ void Connection::writeData(const std::string& p_Buffer, uint16_t p_ID)
 	header.m_Size = static_cast<uint32_t>(p_Buffer.size() + sizeof(Header));
 	header.m_TypeID = p_ID;
 
-	if(!m_LockWriting.test_and_set())
+	std::lock_guard<std::mutex> lock(m_WriteQueueLock);
+	m_WaitingToWrite.push_back(std::make_pair(header, p_Buffer));
+	m_QueuedBytes += header.m_Size;
+	if (m_WaitingToWrite.size() > m_MaxQueuedPackages)
 	{
-		doWrite(header, p_Buffer);
+		m_MaxQueuedPackages = m_WaitingToWrite.size();
 	}
-	else
+	if (m_QueuedBytes > m_MaxQueuedBytes)
+	{
+		m_MaxQueuedBytes = m_QueuedBytes;
+	}
+	if (!m_Writing)
 	{
-		std::lock_guard<std::mutex> lock(m_WriteQueueLock);
-		m_WaitingToWrite.push_back(std::make_pair(header, p_Buffer));
+		m_Writing = true;
+		doWrite();
 	}
 }
 
@@ -205,6 +256,18 @@ void Connection::startReading()
 	readHeader();
 }
 
+WriteStatistics Connection::getWriteStatistics() const
+{
+	WriteStatistics statistics;
+	statistics.m_NumWrites = m_NumWrites;
+	statistics.m_NumPackages = m_NumPackagesWritten;
+	statistics.m_NumBytes = m_NumBytesWritten;
+	statistics.m_MaxQueuedPackages = m_MaxQueuedPackages;
+	statistics.m_MaxQueuedBytes = m_MaxQueuedBytes;
+	statistics.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Created).count();
+	return statistics;
+}
+
 std::string Connection::formatError(const boost::system::error_code& p_Error)
 {
 	return "error: " + std::to_string(p_Error.value()) + ": " + p_Error.message();
@@ -9,7 +9,9 @@
 #include <atomic>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 
 /**
@@ -18,6 +20,13 @@
  */
 class Connection : public IConnection, public std::enable_shared_from_this<Connection>
 {
+public:
+	/**
+	 * Largest number of bytes to gather into one write. A single larger
+	 * package is still written in one go.
+	 */
+	static const size_t maxWriteSize = 64 * 1024;
+
 protected:
 #pragma pack(push, 1)
 	struct Header
@@ -31,14 +40,24 @@ protected:
 
 	boost::asio::ip::tcp::socket m_Socket;
 
-	std::atomic_flag m_LockWriting;
 	std::mutex m_WriteQueueLock;
+	bool m_Writing;
+	std::deque<std::pair<Header, Buffer>> m_WaitingToWrite;
+	std::vector<std::pair<Header, Buffer>> m_WritePackages;
+	std::vector<boost::asio::const_buffer> m_WriteBuffers;
 
-	Header m_WriteHeader;
-	std::string m_WriteBuffer;
-	std::vector<char> m_ReadBuffer;
+	std::chrono::steady_clock::time_point m_Created;
+	std::atomic<uint64_t> m_NumWrites;
+	std::atomic<uint64_t> m_NumPackagesWritten;
+	std::atomic<uint64_t> m_NumBytesWritten;
+	// Updated with the write queue lock held.
+	size_t m_QueuedBytes;
+	std::atomic<uint64_t> m_MaxQueuedPackages;
+	std::atomic<uint64_t> m_MaxQueuedBytes;
 
-	std::vector<std::pair<Header, std::string>> m_WaitingToWrite;
+	std::vector<char> m_ReadBuffer;
+	BufferPool m_ReadPool;
+	std::shared_ptr<Buffer::Storage> m_ReadData;
 
 	saveDataFunction m_SaveData;
 	disconnectedCallback_t m_Disconnected;
@@ -58,7 +77,7 @@ public:
 	void disconnect() override;
 	bool hasError() const override;
 
-	void writeData(const std::string& p_Buffer, uint16_t p_ID) override;
+	void writeData(const Buffer& p_Buffer, uint16_t p_ID) override;
 	void setSaveData(saveDataFunction p_SaveData) override;
 	void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) override;
 	void startReading() override;
@@ -70,8 +89,10 @@ public:
 	 */
 	virtual boost::asio::ip::tcp::socket& getSocket();
 
+	WriteStatistics getWriteStatistics() const override;
+
 private:
-	void doWrite(const Header& p_Header, const std::string& p_Buffer);
+	void doWrite();
 	void handleWrite(const boost::system::error_code& p_Error, std::size_t p_BytesTransferred);
 	void handleReadHeader(const boost::system::error_code& p_Error, std::size_t p_BytesTransferred);
 	void handleReadData(const boost::system::error_code& p_Error, std::size_t p_BytesTransferred);
@@ -2,9 +2,61 @@
 
 #include "NetworkLogger.h"
 
+#include <cmath>
+
+void addConnectionMetrics(ConnectionMetrics& p_Total, const ConnectionMetrics& p_Metrics)
+{
+	for (unsigned int i = 0; i < ConnectionMetrics::numPackageTypes; ++i)
+	{
+		PackageTypeMetrics& total = p_Total.m_Types[i];
+		const PackageTypeMetrics& type = p_Metrics.m_Types[i];
+		total.m_PackagesSent += type.m_PackagesSent;
+		total.m_BytesSent += type.m_BytesSent;
+		total.m_PackagesReceived += type.m_PackagesReceived;
+		total.m_BytesReceived += type.m_BytesReceived;
+		total.m_EncodeSeconds += type.m_EncodeSeconds;
+		total.m_DecodeSeconds += type.m_DecodeSeconds;
+	}
+
+	p_Total.m_NumConnections += p_Metrics.m_NumConnections;
+	if (p_Metrics.m_Seconds > p_Total.m_Seconds)
+		p_Total.m_Seconds = p_Metrics.m_Seconds;
+	p_Total.m_SocketWrites += p_Metrics.m_SocketWrites;
+	p_Total.m_SocketBytes += p_Metrics.m_SocketBytes;
+	if (p_Metrics.m_MaxQueuedPackages > p_Total.m_MaxQueuedPackages)
+		p_Total.m_MaxQueuedPackages = p_Metrics.m_MaxQueuedPackages;
+	if (p_Metrics.m_MaxQueuedBytes > p_Total.m_MaxQueuedBytes)
+		p_Total.m_MaxQueuedBytes = p_Metrics.m_MaxQueuedBytes;
+
+	const uint32_t numRoundTrips = p_Total.m_NumRoundTrips + p_Metrics.m_NumRoundTrips;
+	if (numRoundTrips > 0)
+	{
+		const float totalWeight = (float)p_Total.m_NumRoundTrips / numRoundTrips;
+		const float weight = (float)p_Metrics.m_NumRoundTrips / numRoundTrips;
+		p_Total.m_RoundTripTime = p_Total.m_RoundTripTime * totalWeight + p_Metrics.m_RoundTripTime * weight;
+		p_Total.m_RoundTripVariation = p_Total.m_RoundTripVariation * totalWeight + p_Metrics.m_RoundTripVariation * weight;
+	}
+	p_Total.m_NumRoundTrips = numRoundTrips;
+}
+
+PackageFrame::PackageFrame(uint16_t p_ID, const Buffer& p_Data)
+	:	m_ID(p_ID),
+		m_Data(p_Data)
+{
+}
+
 ConnectionController::ConnectionController(IConnection::ptr p_Connection, const std::vector<PackageBase::ptr>& p_Prototypes)
 	:	m_PackagePrototypes(p_Prototypes),
-		m_Connection(std::move(p_Connection))
+		m_Connection(std::move(p_Connection)),
+		m_LevelAttempts(0),
+		m_PackagesReceived(nullptr),
+		m_PackagesReceivedUserData(nullptr),
+		m_LastSnapshot(0),
+		m_DatagramsReady(false),
+		m_NextLevelChunk(0),
+		m_Metrics(),
+		m_PingSequence(0),
+		m_PingPending(false)
 {
 	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Creating a connection controller");
 
@@ -13,6 +65,24 @@ ConnectionController::ConnectionController(IConnection::ptr p_Connection, const
 
 ConnectionController::~ConnectionController()
 {
+	DatagramChannel::ptr channel = getDatagramChannel();
+	if (channel)
+	{
+		channel->setSaveData(IConnection::saveDataFunction());
+	}
+
+	const ConnectionMetrics metrics = getMetrics();
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+	for (const PackageTypeMetrics& type : metrics.m_Types)
+	{
+		bytesSent += type.m_BytesSent;
+		bytesReceived += type.m_BytesReceived;
+	}
+	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Connection sent " + std::to_string(bytesSent)
+		+ " bytes and received " + std::to_string(bytesReceived) + " bytes of packages, round trip time "
+		+ std::to_string((int)(metrics.m_RoundTripTime * 1000.f)) + " ms");
+
 	m_Connection->disconnect();
 }
 
@@ -33,7 +103,7 @@ void ConnectionController::startListening()
 
 unsigned int ConnectionController::getNumPackages()
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
+	m_IncomingPackages.takeAll(m_ReceivedPackages);
 	return m_ReceivedPackages.size();
 }
 
@@ -44,13 +114,76 @@ Package ConnectionController::getPackage(unsigned int p_Index)
 
 void ConnectionController::clearPackages(unsigned int p_NumPackages)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	m_ReceivedPackages.erase(m_ReceivedPackages.begin(), m_ReceivedPackages.begin() + p_NumPackages);
 }
 
+void ConnectionController::setPackagesReceivedCallback(packagesReceivedCallback_t p_ReceivedCallback, void* p_UserData)
+{
+	std::lock_guard<std::mutex> lock(m_ReceivedCallbackLock);
+	m_PackagesReceived = p_ReceivedCallback;
+	m_PackagesReceivedUserData = p_UserData;
+}
+
+void ConnectionController::writePackageData(Package p_Package, std::vector<char>& p_Output)
+{
+	m_ReceivedPackages[p_Package]->writeData(p_Output);
+}
+
+void ConnectionController::receivePackageData(PackageType p_Type, const char* p_Data, size_t p_Size)
+{
+	std::shared_ptr<const Buffer::Storage> storage(new Buffer::Storage(p_Data, p_Data + p_Size));
+	savePackageCallBack((uint16_t)p_Type, Buffer(storage));
+}
+
+void ConnectionController::sendFrame(const SharedFrame& p_Frame)
+{
+	if (p_Frame)
+	{
+		if (p_Frame->m_Level)
+		{
+			std::lock_guard<std::mutex> lock(m_LevelLock);
+			m_OfferedLevel = p_Frame->m_Level;
+			m_NextLevelChunk = 0;
+		}
+
+		writeData(p_Frame->m_Data, p_Frame->m_ID);
+	}
+}
+
+void ConnectionController::sendPing()
+{
+	Ping package;
+	{
+		std::lock_guard<std::mutex> lock(m_MetricsLock);
+		package.m_Object1 = ++m_PingSequence;
+		m_PingPending = true;
+		m_PingTime = Clock::now();
+	}
+
+	writePackage(package);
+}
+
+ConnectionMetrics ConnectionController::getMetrics() const
+{
+	ConnectionMetrics metrics;
+	{
+		std::lock_guard<std::mutex> lock(m_MetricsLock);
+		metrics = m_Metrics;
+	}
+
+	const WriteStatistics statistics = m_Connection->getWriteStatistics();
+	metrics.m_NumConnections = 1;
+	metrics.m_Seconds = statistics.m_Seconds;
+	metrics.m_SocketWrites = statistics.m_NumWrites;
+	metrics.m_SocketBytes = statistics.m_NumBytes;
+	metrics.m_MaxQueuedPackages = statistics.m_MaxQueuedPackages;
+	metrics.m_MaxQueuedBytes = statistics.m_MaxQueuedBytes;
+
+	return metrics;
+}
+
 PackageType ConnectionController::getPackageType(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	if (m_ReceivedPackages.size() > p_Package)
 		return m_ReceivedPackages[p_Package]->getType();
 	else
@@ -65,19 +198,28 @@ void ConnectionController::sendCreateObjects(const ObjectInstance* p_Instances,
 		package.m_Object1.push_back(std::make_pair(std::string(p_Instances[i].m_Description), p_Instances[i].m_Id));
 	}
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
+}
+
+SharedFrame ConnectionController::encodeCreateObjects(const ObjectInstance* p_Instances, unsigned int p_NumInstances)
+{
+	CreateObjects package;
+	for (unsigned int i = 0; i < p_NumInstances; ++i)
+	{
+		package.m_Object1.push_back(std::make_pair(std::string(p_Instances[i].m_Description), p_Instances[i].m_Id));
+	}
+
+	return encodePackage(package);
 }
 
 unsigned int ConnectionController::getNumCreateObjects(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	CreateObjects* createObjects = static_cast<CreateObjects*>(m_ReceivedPackages[p_Package].get());
 	return createObjects->m_Object1.size();
 }
 
 ObjectInstance ConnectionController::getCreateObjectDescription(Package p_Package, unsigned int p_Description)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	CreateObjects* createObjects = static_cast<CreateObjects*>(m_ReceivedPackages[p_Package].get());
 	ObjectInstance inst;
 	inst.m_Description = createObjects->m_Object1[p_Description].first.c_str();
@@ -85,44 +227,68 @@ ObjectInstance ConnectionController::getCreateObjectDescription(Package p_Packag
 	return inst;
 }
 
-void ConnectionController::sendUpdateObjects(const UpdateObjectData* p_ObjectData, unsigned int p_NumObjects, const char** p_ExtraData, unsigned int p_NumExtraData)
+void ConnectionController::sendUpdateObjects(const UpdateObjectData* p_ObjectData, unsigned int p_NumObjects,
+	const ObjectLookData* p_Looks, unsigned int p_NumLooks,
+	const ObjectColorData* p_Colors, unsigned int p_NumColors)
 {
-	UpdateObjects package;
-	for (unsigned int i = 0; i < p_NumExtraData; ++i)
+	if (p_NumObjects > 0)
 	{
-		package.m_Object2.push_back(std::string(p_ExtraData[i]));
+		const Clock::time_point start = Clock::now();
+		std::shared_ptr<Buffer::Storage> storage = m_WritePool.acquire();
+		m_SnapshotEncoder.encode(p_ObjectData, p_NumObjects, p_Looks, p_NumLooks, p_Colors, p_NumColors, *storage);
+		addEncodeTime((uint16_t)PackageType::OBJECT_SNAPSHOT, start);
+
+		writeState(Buffer(storage), (uint16_t)PackageType::OBJECT_SNAPSHOT);
+		return;
 	}
+
+	UpdateObjects package;
 	package.m_Object1.assign(p_ObjectData, p_ObjectData + p_NumObjects);
+	package.m_Object2.assign(p_Looks, p_Looks + p_NumLooks);
+	package.m_Object3.assign(p_Colors, p_Colors + p_NumColors);
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
+}
+
+void ConnectionController::setUpdatePrecision(float p_Precision)
+{
+	m_SnapshotEncoder.setPrecision(p_Precision);
 }
 
 unsigned int ConnectionController::getNumUpdateObjectData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	UpdateObjects* createObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
 	return createObjects->m_Object1.size();
 }
 
 const UpdateObjectData* ConnectionController::getUpdateObjectData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	UpdateObjects* createObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
 	return createObjects->m_Object1.data();
 }
 
-unsigned int ConnectionController::getNumUpdateObjectExtraData(Package p_Package)
+unsigned int ConnectionController::getNumUpdateObjectLooks(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
-	UpdateObjects* createObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
-	return createObjects->m_Object2.size();
+	UpdateObjects* updateObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
+	return updateObjects->m_Object2.size();
 }
 
-const char* ConnectionController::getUpdateObjectExtraData(Package p_Package, unsigned int p_ExtraData)
+const ObjectLookData* ConnectionController::getUpdateObjectLooks(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
-	UpdateObjects* createObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
-	return createObjects->m_Object2[p_ExtraData].c_str();
+	UpdateObjects* updateObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
+	return updateObjects->m_Object2.data();
+}
+
+unsigned int ConnectionController::getNumUpdateObjectColors(Package p_Package)
+{
+	UpdateObjects* updateObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
+	return updateObjects->m_Object3.size();
+}
+
+const ObjectColorData* ConnectionController::getUpdateObjectColors(Package p_Package)
+{
+	UpdateObjects* updateObjects = static_cast<UpdateObjects*>(m_ReceivedPackages[p_Package].get());
+	return updateObjects->m_Object3.data();
 }
 
 void ConnectionController::sendRemoveObjects(const uint32_t* p_Objects, unsigned int p_NumObjects)
@@ -130,19 +296,25 @@ void ConnectionController::sendRemoveObjects(const uint32_t* p_Objects, unsigned
 	RemoveObjects package;
 	package.m_Object1.assign(p_Objects, p_Objects + p_NumObjects);
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
+}
+
+SharedFrame ConnectionController::encodeRemoveObjects(const uint32_t* p_Objects, unsigned int p_NumObjects)
+{
+	RemoveObjects package;
+	package.m_Object1.assign(p_Objects, p_Objects + p_NumObjects);
+
+	return encodePackage(package);
 }
 
 unsigned int ConnectionController::getNumRemoveObjectRefs(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	RemoveObjects* removeObjects = static_cast<RemoveObjects*>(m_ReceivedPackages[p_Package].get());
 	return removeObjects->m_Object1.size();
 }
 
 const uint32_t* ConnectionController::getRemoveObjectRefs(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	RemoveObjects* removeObjects = static_cast<RemoveObjects*>(m_ReceivedPackages[p_Package].get());
 	return removeObjects->m_Object1.data();
 }
@@ -153,19 +325,26 @@ void ConnectionController::sendObjectAction(uint32_t p_ObjectId, const char* p_A
 	package.m_Object1 = p_ObjectId;
 	package.m_Object2 = p_Action;
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
+}
+
+SharedFrame ConnectionController::encodeObjectAction(uint32_t p_ObjectId, const char* p_Action)
+{
+	ObjectAction package;
+	package.m_Object1 = p_ObjectId;
+	package.m_Object2 = p_Action;
+
+	return encodePackage(package);
 }
 
 uint32_t ConnectionController::getObjectActionId(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ObjectAction* objectAction = static_cast<ObjectAction*>(m_ReceivedPackages[p_Package].get());
 	return objectAction->m_Object1;
 }
 
 const char* ConnectionController::getObjectActionAction(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ObjectAction* objectAction = static_cast<ObjectAction*>(m_ReceivedPackages[p_Package].get());
 	return objectAction->m_Object2.c_str();
 }
@@ -175,12 +354,11 @@ void ConnectionController::sendAssignPlayer(uint32_t p_ObjectId)
 	AssignPlayer package;
 	package.m_Object1 = p_ObjectId;
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 uint32_t ConnectionController::getAssignPlayerObject(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	AssignPlayer* assignPlayer = static_cast<AssignPlayer*>(m_ReceivedPackages[p_Package].get());
 	return assignPlayer->m_Object1;
 }
@@ -190,12 +368,11 @@ void ConnectionController::sendPlayerControl(PlayerControlData p_Data)
 	PlayerControl package;
 	package.m_Object1 = p_Data;
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writeStatePackage(package);
 }
 
 PlayerControlData ConnectionController::getPlayerControlData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	PlayerControl* playerControl = static_cast<PlayerControl*>(m_ReceivedPackages[p_Package].get());
 	return playerControl->m_Object1;
 }
@@ -203,7 +380,7 @@ PlayerControlData ConnectionController::getPlayerControlData(Package p_Package)
 void ConnectionController::sendDoneLoading()
 {
 	DoneLoading package;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 void ConnectionController::sendJoinGame(const char* p_Game, const char* p_Username, const char* p_CharacterName, const char* p_CharacterStyle)
@@ -214,73 +391,62 @@ void ConnectionController::sendJoinGame(const char* p_Game, const char* p_Userna
 	package.m_Object1.characterName = p_CharacterName;
 	package.m_Object1.characterStyle = p_CharacterStyle;
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 const char* ConnectionController::getJoinGameName(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	JoinGame* joinGame = static_cast<JoinGame*>(m_ReceivedPackages[p_Package].get());
 	return joinGame->m_Object1.game.c_str();
 }
 
 const char* ConnectionController::getJoinGameUsername(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	JoinGame* joinGame = static_cast<JoinGame*>(m_ReceivedPackages[p_Package].get());
 	return joinGame->m_Object1.username.c_str();
 }
 
 const char* ConnectionController::getJoinGameCharacterName(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	JoinGame* joinGame = static_cast<JoinGame*>(m_ReceivedPackages[p_Package].get());
 	return joinGame->m_Object1.characterName.c_str();
 }
 
 const char* ConnectionController::getJoinGameCharacterStyle(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	JoinGame* joinGame = static_cast<JoinGame*>(m_ReceivedPackages[p_Package].get());
 	return joinGame->m_Object1.characterStyle.c_str();
 }
 
 const char* ConnectionController::getLevelData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	LevelData* levelData = static_cast<LevelData*>(m_ReceivedPackages[p_Package].get());
 	return levelData->m_Object1.c_str();
 }
 
 const size_t ConnectionController::getLevelDataSize(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	LevelData* levelData = static_cast<LevelData*>(m_ReceivedPackages[p_Package].get());
 	return levelData->m_Object1.size();
 }
 
-void ConnectionController::sendRacePosition(const char** p_ExtraData, unsigned int p_NumExtraData)
+void ConnectionController::sendRacePosition(const RacePositionData* p_Positions, unsigned int p_NumPositions)
 {
 	GamePositions package;
-	for(unsigned int i = 0; i < p_NumExtraData; i++)
-	{
-		package.m_Object1.push_back(std::string(p_ExtraData[i]));
-	}
-	writeData(package.getData(), (uint16_t)package.getType());
+	package.m_Object1.assign(p_Positions, p_Positions + p_NumPositions);
+	writePackage(package);
 }
 
 unsigned int ConnectionController::getNumRacePositionsData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	GamePositions* createObjects = static_cast<GamePositions*>(m_ReceivedPackages[p_Package].get());
 	return createObjects->m_Object1.size();
 }
 
-const char* ConnectionController::getRacePositionsData(Package p_Package, unsigned int p_ExtraData)
+const RacePositionData* ConnectionController::getRacePositionsData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	GamePositions* createObjects = static_cast<GamePositions*>(m_ReceivedPackages[p_Package].get());
-	return createObjects->m_Object1[p_ExtraData].c_str();
+	return createObjects->m_Object1.data();
 }
 
 void ConnectionController::sendGameResult(const char** p_ExtraData, unsigned int p_NumExtraData)
@@ -290,19 +456,17 @@ void ConnectionController::sendGameResult(const char** p_ExtraData, unsigned int
 	{
 		package.m_Object1.push_back(std::string(p_ExtraData[i]));
 	}
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 unsigned int ConnectionController::getNumGameResultData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ResultData* createObjects = static_cast<ResultData*>(m_ReceivedPackages[p_Package].get());
 	return createObjects->m_Object1.size();
 }
 
 const char* ConnectionController::getGameResultData(Package p_Package, unsigned int p_ExtraData)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ResultData* createObjects = static_cast<ResultData*>(m_ReceivedPackages[p_Package].get());
 	return createObjects->m_Object1[p_ExtraData].c_str();
 }
@@ -311,12 +475,11 @@ void ConnectionController::sendNrOfCheckpoints(unsigned int p_NrOfCheckpoints)
 {
 	NumberOfCheckpoints package;
 	package.m_Object1 = p_NrOfCheckpoints;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 unsigned int ConnectionController::getNrOfCheckpoints(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	NumberOfCheckpoints* number = static_cast<NumberOfCheckpoints*>(m_ReceivedPackages[p_Package].get());
 	return number->m_Object1;
 }
@@ -325,33 +488,53 @@ void ConnectionController::sendTakenCheckpoints(unsigned int p_TakenChekpoints)
 {
 	TakenCheckpoints package;
 	package.m_Object1 = p_TakenChekpoints;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 unsigned int ConnectionController::getTakenCheckpoints(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	TakenCheckpoints* number = static_cast<TakenCheckpoints*>(m_ReceivedPackages[p_Package].get());
 	return number->m_Object1;
 }
 
 void ConnectionController::sendLevelData(const char* p_Stream, size_t p_Size)
 {
-	LevelData package;
-	package.m_Object1 = std::string(p_Stream, p_Size);
-	writeData(package.getData(), (uint16_t)package.getType());
+	sendFrame(encodeLevelData(p_Stream, p_Size));
+}
+
+SharedFrame ConnectionController::encodeLevelData(const char* p_Stream, size_t p_Size)
+{
+	// Compressing the level is counted as encoding the chunks.
+	const Clock::time_point start = Clock::now();
+	LevelTransfer::ptr level = std::make_shared<LevelTransfer>(p_Stream, p_Size);
+	addEncodeTime((uint16_t)PackageType::LEVEL_CHUNK, start);
+
+	std::string msg("Level of " + std::to_string(level->getSize()) + " bytes compressed to "
+		+ std::to_string(level->getCompressedSize()) + " bytes in " + std::to_string(level->getNumChunks()) + " chunks");
+	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, msg);
+
+	LevelInfo package;
+	package.m_Object1 = level->getHash();
+	package.m_Object2 = level->getSize();
+	package.m_Object3 = level->getNumChunks();
+
+	std::shared_ptr<Buffer::Storage> storage = m_WritePool.acquire();
+	package.writeData(*storage);
+
+	std::shared_ptr<PackageFrame> frame = std::make_shared<PackageFrame>((uint16_t)PackageType::LEVEL_INFO, Buffer(storage));
+	frame->m_Level = level;
+	return frame;
 }
 
 void ConnectionController::sendCurrentCheckpoint(Vector3 p_Position)
 {
 	CurrentCheckpoint package;
 	package.m_Object1 = p_Position;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 Vector3 ConnectionController::getCurrentCheckpoint(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	CurrentCheckpoint* checkpoint = static_cast<CurrentCheckpoint*>(m_ReceivedPackages[p_Package].get());
 	return checkpoint->m_Object1;
 }
@@ -359,19 +542,18 @@ Vector3 ConnectionController::getCurrentCheckpoint(Package p_Package)
 void ConnectionController::sendLeaveGame()
 {
 	LeaveGame package;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 void ConnectionController::sendSetSpawnPosition(Vector3 p_Position)
 {
 	SetSpawnPosition package;
 	package.m_Object1 = p_Position;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 Vector3 ConnectionController::getSetSpawnPositionData(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	SetSpawnPosition* setSpawn = static_cast<SetSpawnPosition*>(m_ReceivedPackages[p_Package].get());
 	return setSpawn->m_Object1;
 }
@@ -384,26 +566,23 @@ void ConnectionController::sendThrowSpell(const char* p_SpellName, Vector3 p_Sta
 	data.direction = p_Direction;
 	ThrowSpell package;
 	package.m_Object1 = data;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 const char* ConnectionController::getThrowSpellName(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ThrowSpell* throwSpell = static_cast<ThrowSpell*>(m_ReceivedPackages[p_Package].get());
 	return throwSpell->m_Object1.spellName.c_str();
 }
 
 Vector3 ConnectionController::getThrowSpellStartPosition(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ThrowSpell* throwSpell = static_cast<ThrowSpell*>(m_ReceivedPackages[p_Package].get());
 	return throwSpell->m_Object1.position;
 }
 
 Vector3 ConnectionController::getThrowSpellDirection(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	ThrowSpell* throwSpell = static_cast<ThrowSpell*>(m_ReceivedPackages[p_Package].get());
 	return throwSpell->m_Object1.direction;
 }
@@ -411,19 +590,19 @@ Vector3 ConnectionController::getThrowSpellDirection(Package p_Package)
 void ConnectionController::sendStartCountdown()
 {
 	StartCountdown package;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 void ConnectionController::sendDoneCountdown()
 {
 	DoneCountdown package;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 void ConnectionController::sendRequestGames()
 {
 	RequestGames package;
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 void ConnectionController::sendGameList(const AvailableGameData* p_Games, unsigned int p_NumGames)
@@ -441,19 +620,17 @@ void ConnectionController::sendGameList(const AvailableGameData* p_Games, unsign
 		package.m_Object1.push_back(data);
 	}
 
-	writeData(package.getData(), (uint16_t)package.getType());
+	writePackage(package);
 }
 
 unsigned int ConnectionController::getNumGameListGames(Package p_Package)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	GameList* gameList = static_cast<GameList*>(m_ReceivedPackages[p_Package].get());
 	return gameList->m_Object1.size();
 }
 
 AvailableGameData ConnectionController::getGameListGame(Package p_Package, unsigned int p_GameIdx)
 {
-	std::lock_guard<std::mutex> lock(m_ReceivedLock);
 	GameList* gameList = static_cast<GameList*>(m_ReceivedPackages[p_Package].get());
 	const AvailableGame& game = gameList->m_Object1[p_GameIdx];
 
@@ -470,23 +647,219 @@ void ConnectionController::setDisconnectedCallback(IConnection::disconnectedCall
 	m_Connection->setDisconnectedCallback(p_DisconnectCallback);
 }
 
-void ConnectionController::writeData(const std::string& p_Buffer, uint16_t p_ID)
+void ConnectionController::offerDatagramChannel(DatagramChannel::ptr p_Channel, uint16_t p_Port)
+{
+	setDatagramChannel(p_Channel);
+
+	DatagramOffer offer;
+	offer.m_Object1 = p_Channel->getToken();
+	offer.m_Object2 = p_Port;
+	writePackage(offer);
+}
+
+void ConnectionController::setDatagramOfferCallback(datagramOfferCallback_t p_OfferCallback)
+{
+	std::lock_guard<std::mutex> lock(m_DatagramLock);
+	m_DatagramOffered = p_OfferCallback;
+}
+
+void ConnectionController::setDatagramChannel(DatagramChannel::ptr p_Channel)
+{
+	p_Channel->setSaveData(std::bind(&ConnectionController::saveDatagramCallBack, this, std::placeholders::_1, std::placeholders::_2));
+
+	std::lock_guard<std::mutex> lock(m_DatagramLock);
+	m_Datagrams = p_Channel;
+	m_DatagramsReady = false;
+}
+
+bool ConnectionController::isDatagramChannelReady() const
+{
+	return m_DatagramsReady;
+}
+
+void ConnectionController::setLevelCache(std::shared_ptr<LevelCache> p_Cache)
+{
+	std::lock_guard<std::mutex> lock(m_LevelLock);
+	m_LevelCache = p_Cache;
+}
+
+void ConnectionController::writePackage(PackageBase& p_Package)
+{
+	const Clock::time_point start = Clock::now();
+	std::shared_ptr<Buffer::Storage> storage = m_WritePool.acquire();
+	p_Package.writeData(*storage);
+	addEncodeTime((uint16_t)p_Package.getType(), start);
+
+	writeData(Buffer(storage), (uint16_t)p_Package.getType());
+}
+
+SharedFrame ConnectionController::encodePackage(PackageBase& p_Package)
+{
+	const Clock::time_point start = Clock::now();
+	std::shared_ptr<Buffer::Storage> storage = m_WritePool.acquire();
+	p_Package.writeData(*storage);
+	addEncodeTime((uint16_t)p_Package.getType(), start);
+
+	return std::make_shared<PackageFrame>((uint16_t)p_Package.getType(), Buffer(storage));
+}
+
+void ConnectionController::writeData(const Buffer& p_Buffer, uint16_t p_ID)
 {
 	if (m_Connection)
 	{
+		countSent(p_ID, p_Buffer.size());
 		m_Connection->writeData(p_Buffer, p_ID);
 	}
 }
 
-void ConnectionController::savePackageCallBack(uint16_t p_ID, const std::string& p_Data)
+void ConnectionController::writeStatePackage(PackageBase& p_Package)
 {
+	const Clock::time_point start = Clock::now();
+	std::shared_ptr<Buffer::Storage> storage = m_WritePool.acquire();
+	p_Package.writeData(*storage);
+	addEncodeTime((uint16_t)p_Package.getType(), start);
+
+	writeState(Buffer(storage), (uint16_t)p_Package.getType());
+}
+
+void ConnectionController::writeState(const Buffer& p_Buffer, uint16_t p_ID)
+{
+	DatagramChannel::ptr channel = getDatagramChannel();
+	if (channel)
+	{
+		if (m_DatagramsReady)
+		{
+			if (channel->send(p_ID, p_Buffer))
+			{
+				countSent(p_ID, p_Buffer.size());
+				return;
+			}
+		}
+		else
+		{
+			// The hello may have been lost, repeat it until the channel is confirmed.
+			sendDatagramHello(channel);
+		}
+	}
+
+	writeData(p_Buffer, p_ID);
+}
+
+DatagramChannel::ptr ConnectionController::getDatagramChannel()
+{
+	std::lock_guard<std::mutex> lock(m_DatagramLock);
+	return m_Datagrams;
+}
+
+void ConnectionController::sendDatagramHello(const DatagramChannel::ptr& p_Channel)
+{
+	if (p_Channel->hasRemote())
+	{
+		p_Channel->send((uint16_t)PackageType::DATAGRAM_HELLO, Buffer());
+	}
+}
+
+void ConnectionController::receiveDatagramOffer(const Buffer& p_Data)
+{
+	DatagramOffer offer;
+	PackageCodec<DatagramOffer>::read(p_Data.data(), p_Data.size(), offer);
+
+	datagramOfferCallback_t offered;
+	{
+		std::lock_guard<std::mutex> lock(m_DatagramLock);
+		offered = m_DatagramOffered;
+	}
+	if (!offered)
+	{
+		return;
+	}
+
+	offered(offer.m_Object1, offer.m_Object2);
+
+	DatagramChannel::ptr channel = getDatagramChannel();
+	if (channel)
+	{
+		sendDatagramHello(channel);
+	}
+}
+
+void ConnectionController::savePackageCallBack(uint16_t p_ID, const Buffer& p_Data)
+{
+	countReceived(p_ID, p_Data.size());
+
+	switch ((PackageType)p_ID)
+	{
+	case PackageType::OBJECT_SNAPSHOT:
+		receiveSnapshot(p_Data);
+		return;
+
+	case PackageType::SNAPSHOT_ACK:
+		{
+			SnapshotAck ack;
+			PackageCodec<SnapshotAck>::read(p_Data.data(), p_Data.size(), ack);
+			m_SnapshotEncoder.acknowledge(ack.m_Object1);
+		}
+		return;
+
+	case PackageType::DATAGRAM_OFFER:
+		receiveDatagramOffer(p_Data);
+		return;
+
+	case PackageType::DATAGRAM_HELLO:
+		if (!m_DatagramsReady.exchange(true))
+		{
+			NetworkLogger::log(NetworkLogger::Level::INFO, "Datagram channel opened by client");
+
+			DatagramReady ready;
+			writePackage(ready);
+		}
+		return;
+
+	case PackageType::LEVEL_INFO:
+		receiveLevelInfo(p_Data);
+		return;
+
+	case PackageType::LEVEL_REQUEST:
+		receiveLevelRequest(p_Data);
+		return;
+
+	case PackageType::LEVEL_CHUNK:
+		receiveLevelChunk(p_Data);
+		return;
+
+	case PackageType::LEVEL_CHUNK_ACK:
+		receiveLevelChunkAck(p_Data);
+		return;
+
+	case PackageType::PING:
+		receivePing(p_Data);
+		return;
+
+	case PackageType::PONG:
+		receivePong(p_Data);
+		return;
+
+	case PackageType::DATAGRAM_READY:
+		if (getDatagramChannel())
+		{
+			NetworkLogger::log(NetworkLogger::Level::INFO, "Datagram channel confirmed by server");
+			m_DatagramsReady = true;
+		}
+		return;
+
+	default:
+		break;
+	}
+
 	for(const PackageBase::ptr& p : m_PackagePrototypes)
 	{
 		if(p->getType() == (PackageType)p_ID)
 		{
-			PackageBase::ptr package = p->createPackage(p_Data);
-			std::lock_guard<std::mutex> lock(m_ReceivedLock);
-			m_ReceivedPackages.push_back(std::move(package));
+			const Clock::time_point start = Clock::now();
+			PackageBase::ptr package = p->createPackage(p_Data.data(), p_Data.size());
+			addDecodeTime(p_ID, start);
+			std::lock_guard<std::mutex> lock(m_ProducerLock);
+			queueReceived(std::move(package));
 			return;
 		}
  	}
@@ -495,3 +868,362 @@ void ConnectionController::savePackageCallBack(uint16_t p_ID, const std::string&
 	NetworkLogger::log(NetworkLogger::Level::WARNING, msg);
 }
 
+void ConnectionController::saveDatagramCallBack(uint16_t p_ID, const Buffer& p_Data)
+{
+	// Only state replaced by later packages may arrive unreliably,
+	// everything else must come in order on the connection.
+	switch ((PackageType)p_ID)
+	{
+	case PackageType::PLAYER_CONTROL:
+	case PackageType::UPDATE_OBJECTS:
+	case PackageType::OBJECT_SNAPSHOT:
+	case PackageType::SNAPSHOT_ACK:
+	case PackageType::DATAGRAM_HELLO:
+		savePackageCallBack(p_ID, p_Data);
+		return;
+
+	default:
+		NetworkLogger::log(NetworkLogger::Level::WARNING, "Dropping datagram with package type " + std::to_string(p_ID)
+			+ ", which must be sent on the connection");
+		return;
+	}
+}
+
+void ConnectionController::receiveSnapshot(const Buffer& p_Data)
+{
+	uint32_t sequence = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_ProducerLock);
+		const Clock::time_point start = Clock::now();
+		std::unique_ptr<UpdateObjects> update = m_SnapshotDecoder.decode(p_Data.data(), p_Data.size(), sequence);
+		addDecodeTime((uint16_t)PackageType::OBJECT_SNAPSHOT, start);
+		// Snapshots sent as datagrams may arrive late, never go back to an older state.
+		if (!update || sequence <= m_LastSnapshot)
+		{
+			return;
+		}
+		m_LastSnapshot = sequence;
+
+		queueReceived(PackageBase::ptr(update.release()));
+	}
+
+	SnapshotAck ack;
+	ack.m_Object1 = sequence;
+	writeStatePackage(ack);
+}
+
+void ConnectionController::queueReceived(PackageBase::ptr p_Package)
+{
+	// Called with the producer lock held.
+	if (m_LevelAssembler)
+	{
+		m_HeldPackages.push_back(std::move(p_Package));
+	}
+	else
+	{
+		m_IncomingPackages.push(std::move(p_Package));
+		notifyReceived();
+	}
+}
+
+void ConnectionController::receiveLevelInfo(const Buffer& p_Data)
+{
+	LevelInfo info;
+	PackageCodec<LevelInfo>::read(p_Data.data(), p_Data.size(), info);
+	const uint64_t hash = info.m_Object1;
+	const uint32_t size = info.m_Object2;
+
+	std::shared_ptr<LevelCache> cache;
+	{
+		std::lock_guard<std::mutex> lock(m_LevelLock);
+		cache = m_LevelCache;
+	}
+
+	std::unique_ptr<LevelData> level(new LevelData);
+	if (size == 0 || (cache && cache->load(hash, size, level->m_Object1)))
+	{
+		if (size > 0)
+		{
+			NetworkLogger::log(NetworkLogger::Level::INFO, "Loaded level from cache");
+		}
+
+		std::lock_guard<std::mutex> lock(m_ProducerLock);
+		queueReceived(PackageBase::ptr(level.release()));
+		return;
+	}
+
+	NetworkLogger::log(NetworkLogger::Level::INFO, "Downloading level of " + std::to_string(size) + " bytes");
+	{
+		std::lock_guard<std::mutex> lock(m_ProducerLock);
+		if (m_LevelAssembler)
+		{
+			NetworkLogger::log(NetworkLogger::Level::WARNING, "Level announced before the previous level was received");
+			finishLevel(PackageBase::ptr());
+		}
+		m_LevelAssembler.reset(new LevelAssembler(hash, size, info.m_Object3));
+		m_LevelAttempts = 1;
+	}
+
+	LevelRequest request;
+	request.m_Object1 = hash;
+	writePackage(request);
+}
+
+void ConnectionController::receiveLevelRequest(const Buffer& p_Data)
+{
+	LevelRequest request;
+	PackageCodec<LevelRequest>::read(p_Data.data(), p_Data.size(), request);
+
+	LevelTransfer::ptr level;
+	uint32_t numChunks = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_LevelLock);
+		if (!m_OfferedLevel || m_OfferedLevel->getHash() != request.m_Object1)
+		{
+			NetworkLogger::log(NetworkLogger::Level::WARNING, "Received request for a level that is not offered");
+			return;
+		}
+
+		level = m_OfferedLevel;
+		numChunks = level->getNumChunks();
+		if (numChunks > LevelTransfer::chunkWindow)
+		{
+			numChunks = LevelTransfer::chunkWindow;
+		}
+		m_NextLevelChunk = numChunks;
+	}
+
+	// The remaining chunks are sent one at a time as these are acknowledged,
+	// so that other packages are never queued behind the whole level.
+	for (uint32_t i = 0; i < numChunks; ++i)
+	{
+		writeData(level->getChunk(i), (uint16_t)PackageType::LEVEL_CHUNK);
+	}
+}
+
+void ConnectionController::receiveLevelChunk(const Buffer& p_Data)
+{
+	LevelChunkAck ack;
+	PackageBase::ptr completed;
+	bool retry = false;
+	bool failed = false;
+	{
+		std::lock_guard<std::mutex> lock(m_ProducerLock);
+		if (!m_LevelAssembler)
+		{
+			return;
+		}
+
+		try
+		{
+			if (!m_LevelAssembler->addChunk(p_Data.data(), p_Data.size(), ack.m_Object2))
+			{
+				return;
+			}
+			ack.m_Object1 = m_LevelAssembler->getHash();
+
+			if (m_LevelAssembler->isComplete())
+			{
+				std::unique_ptr<LevelData> level(new LevelData);
+				level->m_Object1 = m_LevelAssembler->takeLevel();
+				completed.reset(level.release());
+			}
+		}
+		catch (NetworkError& err)
+		{
+			NetworkLogger::log(NetworkLogger::Level::ERROR_L, std::string("Level download failed: ") + err.what());
+			retry = m_LevelAttempts < LevelAssembler::maxAttempts;
+			if (retry)
+			{
+				++m_LevelAttempts;
+				ack.m_Object1 = m_LevelAssembler->getHash();
+				m_LevelAssembler->restart();
+			}
+			else
+			{
+				failed = true;
+				finishLevel(PackageBase::ptr());
+			}
+		}
+	}
+
+	if (failed)
+	{
+		// The game can not continue without the level, so leave the game
+		// the way a lost connection does instead of waiting for it forever.
+		NetworkLogger::log(NetworkLogger::Level::ERROR_L, "Giving up on the level after "
+			+ std::to_string(LevelAssembler::maxAttempts) + " attempts, disconnecting");
+		m_Connection->disconnect();
+		return;
+	}
+
+	if (retry)
+	{
+		// Chunks of the failed attempt still in flight are accepted again,
+		// as every chunk carries its index and the level hash.
+		NetworkLogger::log(NetworkLogger::Level::INFO, "Downloading the level again");
+		LevelRequest request;
+		request.m_Object1 = ack.m_Object1;
+		writePackage(request);
+		return;
+	}
+
+	writePackage(ack);
+
+	if (completed)
+	{
+		NetworkLogger::log(NetworkLogger::Level::INFO, "Level downloaded");
+
+		std::shared_ptr<LevelCache> cache;
+		{
+			std::lock_guard<std::mutex> lock(m_LevelLock);
+			cache = m_LevelCache;
+		}
+		if (cache)
+		{
+			cache->store(ack.m_Object1, static_cast<LevelData*>(completed.get())->m_Object1);
+		}
+
+		std::lock_guard<std::mutex> lock(m_ProducerLock);
+		finishLevel(std::move(completed));
+	}
+}
+
+void ConnectionController::receiveLevelChunkAck(const Buffer& p_Data)
+{
+	LevelChunkAck ack;
+	PackageCodec<LevelChunkAck>::read(p_Data.data(), p_Data.size(), ack);
+
+	Buffer chunk;
+	{
+		std::lock_guard<std::mutex> lock(m_LevelLock);
+		if (!m_OfferedLevel || m_OfferedLevel->getHash() != ack.m_Object1
+			|| m_NextLevelChunk >= m_OfferedLevel->getNumChunks())
+		{
+			return;
+		}
+
+		chunk = m_OfferedLevel->getChunk(m_NextLevelChunk++);
+	}
+
+	writeData(chunk, (uint16_t)PackageType::LEVEL_CHUNK);
+}
+
+void ConnectionController::finishLevel(PackageBase::ptr p_Level)
+{
+	// Called with the producer lock held.
+	m_LevelAssembler.reset();
+
+	const bool received = p_Level || !m_HeldPackages.empty();
+
+	if (p_Level)
+	{
+		m_IncomingPackages.push(std::move(p_Level));
+	}
+	for (PackageBase::ptr& package : m_HeldPackages)
+	{
+		m_IncomingPackages.push(std::move(package));
+	}
+	m_HeldPackages.clear();
+
+	if (received)
+	{
+		notifyReceived();
+	}
+}
+
+void ConnectionController::notifyReceived()
+{
+	std::lock_guard<std::mutex> lock(m_ReceivedCallbackLock);
+	if (m_PackagesReceived)
+	{
+		m_PackagesReceived(this, m_PackagesReceivedUserData);
+	}
+}
+
+void ConnectionController::receivePing(const Buffer& p_Data)
+{
+	Ping ping;
+	PackageCodec<Ping>::read(p_Data.data(), p_Data.size(), ping);
+
+	Pong pong;
+	pong.m_Object1 = ping.m_Object1;
+	writePackage(pong);
+}
+
+void ConnectionController::receivePong(const Buffer& p_Data)
+{
+	Pong pong;
+	PackageCodec<Pong>::read(p_Data.data(), p_Data.size(), pong);
+
+	std::lock_guard<std::mutex> lock(m_MetricsLock);
+	if (!m_PingPending || pong.m_Object1 != m_PingSequence)
+	{
+		return;
+	}
+	m_PingPending = false;
+
+	// Smoothed the same way as TCP retransmission timers, RFC 6298.
+	const float sample = std::chrono::duration_cast<std::chrono::duration<float>>(Clock::now() - m_PingTime).count();
+	if (m_Metrics.m_NumRoundTrips == 0)
+	{
+		m_Metrics.m_RoundTripTime = sample;
+		m_Metrics.m_RoundTripVariation = sample / 2.f;
+	}
+	else
+	{
+		m_Metrics.m_RoundTripVariation = 0.75f * m_Metrics.m_RoundTripVariation + 0.25f * std::abs(m_Metrics.m_RoundTripTime - sample);
+		m_Metrics.m_RoundTripTime = 0.875f * m_Metrics.m_RoundTripTime + 0.125f * sample;
+	}
+	++m_Metrics.m_NumRoundTrips;
+}
+
+void ConnectionController::countSent(uint16_t p_ID, size_t p_Size)
+{
+	if (p_ID >= ConnectionMetrics::numPackageTypes)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_MetricsLock);
+	PackageTypeMetrics& type = m_Metrics.m_Types[p_ID];
+	++type.m_PackagesSent;
+	type.m_BytesSent += p_Size;
+}
+
+void ConnectionController::countReceived(uint16_t p_ID, size_t p_Size)
+{
+	if (p_ID >= ConnectionMetrics::numPackageTypes)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_MetricsLock);
+	PackageTypeMetrics& type = m_Metrics.m_Types[p_ID];
+	++type.m_PackagesReceived;
+	type.m_BytesReceived += p_Size;
+}
+
+void ConnectionController::addEncodeTime(uint16_t p_ID, Clock::time_point p_Start)
+{
+	const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(Clock::now() - p_Start).count();
+	if (p_ID >= ConnectionMetrics::numPackageTypes)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_MetricsLock);
+	m_Metrics.m_Types[p_ID].m_EncodeSeconds += seconds;
+}
+
+void ConnectionController::addDecodeTime(uint16_t p_ID, Clock::time_point p_Start)
+{
+	const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(Clock::now() - p_Start).count();
+	if (p_ID >= ConnectionMetrics::numPackageTypes)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_MetricsLock);
+	m_Metrics.m_Types[p_ID].m_DecodeSeconds += seconds;
+}
@@ -4,13 +4,58 @@
 
 #pragma once
 
+#include "BufferPool.h"
+#include "DatagramSocket.h"
 #include "IConnection.h"
+#include "LevelTransfer.h"
 #include "Packages.h"
+#include "Snapshot.h"
+#include "SPSCQueue.h"
 
 #include <IConnectionController.h>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <mutex>
 
+/**
+ * A package encoded once and shared by every connection it is sent on.
+ */
+class PackageFrame
+{
+public:
+	/**
+	 * The package type id to send in the header.
+	 */
+	uint16_t m_ID;
+	/**
+	 * The encoded package data.
+	 */
+	Buffer m_Data;
+	/**
+	 * The level announced by the package, sent in chunks when requested.
+	 */
+	LevelTransfer::ptr m_Level;
+
+	/**
+	 * Constructor.
+	 *
+	 * @param p_ID the package type id.
+	 * @param p_Data the encoded package, shared and never modified.
+	 */
+	PackageFrame(uint16_t p_ID, const Buffer& p_Data);
+};
+
+/**
+ * Add the metrics of one set of connections to the metrics of another.
+ *
+ * @param p_Total the metrics to add to.
+ * @param p_Metrics the metrics to add.
+ */
+void addConnectionMetrics(ConnectionMetrics& p_Total, const ConnectionMetrics& p_Metrics);
+
 /**
  * Implementation of the IConnectionController interface.
  */
@@ -21,13 +66,56 @@ public:
 	 * Unique pointer for ConnectionController objects.
 	 */
 	typedef std::unique_ptr<ConnectionController> ptr;
+	/**
+	 * Callback type used to report that the remote side has offered a datagram channel.
+	 *
+	 * First argument is the channel token, second argument is the remote datagram port.
+	 */
+	typedef std::function<void(uint32_t, uint16_t)> datagramOfferCallback_t;
 
 private:
+	typedef std::chrono::high_resolution_clock Clock;
+
 	IConnection::ptr m_Connection;
 
 	const std::vector<PackageBase::ptr>& m_PackagePrototypes;
-	std::vector<PackageBase::ptr> m_ReceivedPackages;
-	std::mutex m_ReceivedLock;
+	// Decoded packages are handed from the io threads to the game thread without locking.
+	// The producer lock only serializes the io threads, as the reliable connection and
+	// the datagram channel may deliver packages on different threads.
+	SPSCQueue<PackageBase::ptr> m_IncomingPackages;
+	std::mutex m_ProducerLock;
+	// Packages taken by the game thread, only accessed by the game thread.
+	std::deque<PackageBase::ptr> m_ReceivedPackages;
+	// Packages received while a level is downloaded, queued after the level. Guarded by the producer lock.
+	std::vector<PackageBase::ptr> m_HeldPackages;
+	std::unique_ptr<LevelAssembler> m_LevelAssembler;
+	unsigned int m_LevelAttempts;
+	// Guards the callback, so that it is never called after being replaced.
+	std::mutex m_ReceivedCallbackLock;
+	packagesReceivedCallback_t m_PackagesReceived;
+	void* m_PackagesReceivedUserData;
+
+	BufferPool m_WritePool;
+
+	SnapshotEncoder m_SnapshotEncoder;
+	SnapshotDecoder m_SnapshotDecoder;
+	uint32_t m_LastSnapshot;
+
+	std::mutex m_DatagramLock;
+	DatagramChannel::ptr m_Datagrams;
+	std::atomic<bool> m_DatagramsReady;
+	datagramOfferCallback_t m_DatagramOffered;
+
+	std::mutex m_LevelLock;
+	LevelTransfer::ptr m_OfferedLevel;
+	uint32_t m_NextLevelChunk;
+	std::shared_ptr<LevelCache> m_LevelCache;
+
+	mutable std::mutex m_MetricsLock;
+	ConnectionMetrics m_Metrics;
+	uint32_t m_PingSequence;
+	bool m_PingPending;
+	Clock::time_point m_PingTime;
 
 public:
 	/**
@@ -51,24 +139,40 @@ public:
 	unsigned int getNumPackages() override;
 	Package getPackage(unsigned int p_Index) override;
 	void clearPackages(unsigned int p_NumPackages) override;
+	void setPackagesReceivedCallback(packagesReceivedCallback_t p_ReceivedCallback, void* p_UserData) override;
+	void writePackageData(Package p_Package, std::vector<char>& p_Output) override;
+	void receivePackageData(PackageType p_Type, const char* p_Data, size_t p_Size) override;
+
+	void sendFrame(const SharedFrame& p_Frame) override;
+
+	void sendPing() override;
+	ConnectionMetrics getMetrics() const override;
 
 	PackageType getPackageType(Package p_Package) override;
 
 	void sendCreateObjects(const ObjectInstance* p_Instances, unsigned int p_NumInstances) override;
+	SharedFrame encodeCreateObjects(const ObjectInstance* p_Instances, unsigned int p_NumInstances) override;
 	unsigned int getNumCreateObjects(Package p_Package) override;
 	ObjectInstance getCreateObjectDescription(Package p_Package, unsigned int p_Description) override;
 
-	void sendUpdateObjects(const UpdateObjectData* p_ObjectData, unsigned int p_NumObjects, const char** p_ExtraData, unsigned int p_NumExtraData) override;
+	void sendUpdateObjects(const UpdateObjectData* p_ObjectData, unsigned int p_NumObjects,
+		const ObjectLookData* p_Looks, unsigned int p_NumLooks,
+		const ObjectColorData* p_Colors, unsigned int p_NumColors) override;
+	void setUpdatePrecision(float p_Precision) override;
 	unsigned int getNumUpdateObjectData(Package p_Package) override;
 	const UpdateObjectData* getUpdateObjectData(Package p_Package) override;
-	unsigned int getNumUpdateObjectExtraData(Package p_Package) override;
-	const char* getUpdateObjectExtraData(Package p_Package, unsigned int p_ExtraData) override;
+	unsigned int getNumUpdateObjectLooks(Package p_Package) override;
+	const ObjectLookData* getUpdateObjectLooks(Package p_Package) override;
+	unsigned int getNumUpdateObjectColors(Package p_Package) override;
+	const ObjectColorData* getUpdateObjectColors(Package p_Package) override;
 
 	void sendRemoveObjects(const uint32_t* p_Objects, unsigned int p_NumObjects) override;
+	SharedFrame encodeRemoveObjects(const uint32_t* p_Objects, unsigned int p_NumObjects) override;
 	unsigned int getNumRemoveObjectRefs(Package p_Package) override;
 	const uint32_t* getRemoveObjectRefs(Package p_Package) override;
 
 	void sendObjectAction(uint32_t p_ObjectId, const char* p_Action) override;
+	SharedFrame encodeObjectAction(uint32_t p_ObjectId, const char* p_Action) override;
 	uint32_t getObjectActionId(Package p_Package) override;
 	const char* getObjectActionAction(Package p_Package) override;
 
@@ -86,9 +190,9 @@ public:
 	const char* getJoinGameCharacterName(Package p_Package) override;
 	const char* getJoinGameCharacterStyle(Package p_Package) override;
 
-	void sendRacePosition(const char** p_ExtraData, unsigned int p_NumExtraData) override;
+	void sendRacePosition(const RacePositionData* p_Positions, unsigned int p_NumPositions) override;
 	unsigned int getNumRacePositionsData(Package p_Package) override;
-	const char* getRacePositionsData(Package p_Package, unsigned int p_ExtraData) override;
+	const RacePositionData* getRacePositionsData(Package p_Package) override;
 
 	void sendGameResult(const char** p_ExtraData, unsigned int p_NumExtraData) override;
 	unsigned int getNumGameResultData(Package p_Package) override;
@@ -101,6 +205,7 @@ public:
 	unsigned int getTakenCheckpoints(Package p_Package) override;
 
 	void sendLevelData(const char* p_Stream, size_t p_Size) override;
+	SharedFrame encodeLevelData(const char* p_Stream, size_t p_Size) override;
 	const size_t getLevelDataSize(Package p_Package) override;
 	const char* getLevelData(Package p_Package) override;
 
@@ -137,7 +242,66 @@ public:
 	 */
 	void setDisconnectedCallback(IConnection::disconnectedCallback_t p_DisconnectCallback);
 
+	/**
+	 * Offer a datagram channel to the remote side. Once the remote side has
+	 * opened the channel, frequent state packages are sent as datagrams.
+	 *
+	 * @param p_Channel a channel without a known remote address.
+	 * @param p_Port the local port of the socket the channel belongs to.
+	 */
+	void offerDatagramChannel(DatagramChannel::ptr p_Channel, uint16_t p_Port);
+	/**
+	 * Set a callback to handle datagram channel offers. The callback
+	 * should create a channel and pass it to setDatagramChannel.
+	 *
+	 * @param p_OfferCallback a callback function, or the empty function to ignore offers.
+	 */
+	void setDatagramOfferCallback(datagramOfferCallback_t p_OfferCallback);
+	/**
+	 * Set the datagram channel to send state packages on once the remote side has confirmed it.
+	 *
+	 * @param p_Channel the channel, with the remote address set.
+	 */
+	void setDatagramChannel(DatagramChannel::ptr p_Channel);
+	/**
+	 * Check if state packages are sent as datagrams.
+	 *
+	 * @return true if the datagram channel is open in both directions.
+	 */
+	bool isDatagramChannelReady() const;
+
+	/**
+	 * Set the cache of received levels. Levels announced by the remote side
+	 * are loaded from the cache if present, otherwise they are downloaded
+	 * and stored in the cache.
+	 *
+	 * @param p_Cache the cache, or empty to always download levels.
+	 */
+	void setLevelCache(std::shared_ptr<LevelCache> p_Cache);
+
 protected:
-	void writeData(const std::string& p_Buffer, uint16_t p_ID);
-	void savePackageCallBack(uint16_t p_ID, const std::string& p_Data);
+	void writePackage(PackageBase& p_Package);
+	SharedFrame encodePackage(PackageBase& p_Package);
+	void writeData(const Buffer& p_Buffer, uint16_t p_ID);
+	void writeStatePackage(PackageBase& p_Package);
+	void writeState(const Buffer& p_Buffer, uint16_t p_ID);
+	DatagramChannel::ptr getDatagramChannel();
+	void sendDatagramHello(const DatagramChannel::ptr& p_Channel);
+	void receiveDatagramOffer(const Buffer& p_Data);
+	void savePackageCallBack(uint16_t p_ID, const Buffer& p_Data);
+	void saveDatagramCallBack(uint16_t p_ID, const Buffer& p_Data);
+	void receiveSnapshot(const Buffer& p_Data);
+	void queueReceived(PackageBase::ptr p_Package);
+	void receiveLevelInfo(const Buffer& p_Data);
+	void receiveLevelRequest(const Buffer& p_Data);
+	void receiveLevelChunk(const Buffer& p_Data);
+	void receiveLevelChunkAck(const Buffer& p_Data);
+	void finishLevel(PackageBase::ptr p_Level);
+	void notifyReceived();
+	void receivePing(const Buffer& p_Data);
+	void receivePong(const Buffer& p_Data);
+	void countSent(uint16_t p_ID, size_t p_Size);
+	void countReceived(uint16_t p_ID, size_t p_Size);
+	void addEncodeTime(uint16_t p_ID, Clock::time_point p_Start);
+	void addDecodeTime(uint16_t p_ID, Clock::time_point p_Start);
 };
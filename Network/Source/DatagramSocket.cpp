@@ -0,0 +1,321 @@
+#include "DatagramSocket.h"
+
+#include "NetworkLogger.h"
+#include "WireFormat.h"
+
+namespace
+{
+	const size_t maxDatagramSize = 65536;
+
+	bool isNewer(uint32_t p_Sequence, uint32_t p_Previous)
+	{
+		return (int32_t)(p_Sequence - p_Previous) > 0;
+	}
+}
+
+LinkSimulator::LinkSimulator(float p_LossRate, unsigned int p_LatencyMs, unsigned int p_JitterMs, unsigned int p_Seed)
+	:	m_Random(p_Seed),
+		m_LossRate(p_LossRate),
+		m_LatencyMs(p_LatencyMs),
+		m_JitterMs(p_JitterMs)
+{
+}
+
+bool LinkSimulator::simulate(unsigned int& p_DelayMs)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	std::uniform_real_distribution<float> loss(0.f, 1.f);
+	if (loss(m_Random) < m_LossRate)
+	{
+		return true;
+	}
+
+	p_DelayMs = m_LatencyMs;
+	if (m_JitterMs > 0)
+	{
+		std::uniform_int_distribution<unsigned int> jitter(0, m_JitterMs);
+		p_DelayMs += jitter(m_Random);
+	}
+	return false;
+}
+
+DatagramChannel::DatagramChannel(std::shared_ptr<DatagramSocket> p_Socket, uint32_t p_Token)
+	:	m_Socket(p_Socket),
+		m_Token(p_Token),
+		m_HasRemote(false),
+		m_NextSequence(1),
+		m_NumSent(0),
+		m_NumReceived(0),
+		m_NumStale(0),
+		m_NumRejected(0)
+{
+}
+
+uint32_t DatagramChannel::getToken() const
+{
+	return m_Token;
+}
+
+void DatagramChannel::setRemote(const boost::asio::ip::udp::endpoint& p_Remote)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Remote = p_Remote;
+	m_HasRemote = true;
+}
+
+bool DatagramChannel::hasRemote()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_HasRemote;
+}
+
+bool DatagramChannel::send(uint16_t p_ID, const Buffer& p_Data)
+{
+	if (p_Data.size() > maxPayloadSize)
+	{
+		return false;
+	}
+
+	boost::asio::ip::udp::endpoint remote;
+	uint32_t sequence;
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (!m_HasRemote)
+		{
+			return false;
+		}
+		remote = m_Remote;
+		sequence = m_NextSequence++;
+		++m_NumSent;
+	}
+
+	m_Socket->sendTo(remote, m_Token, sequence, p_ID, p_Data);
+	return true;
+}
+
+void DatagramChannel::setSaveData(IConnection::saveDataFunction p_SaveData)
+{
+	std::lock_guard<std::mutex> lock(m_SaveDataLock);
+	m_SaveData = p_SaveData;
+}
+
+void DatagramChannel::receive(const boost::asio::ip::udp::endpoint& p_From, uint16_t p_ID, uint32_t p_Sequence, const Buffer& p_Data)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (!m_HasRemote)
+		{
+			m_Remote = p_From;
+			m_HasRemote = true;
+		}
+		else if (p_From != m_Remote)
+		{
+			++m_NumRejected;
+			return;
+		}
+
+		std::map<uint16_t, uint32_t>::iterator last = m_LastReceived.find(p_ID);
+		if (last != m_LastReceived.end() && !isNewer(p_Sequence, last->second))
+		{
+			++m_NumStale;
+			return;
+		}
+		m_LastReceived[p_ID] = p_Sequence;
+		++m_NumReceived;
+	}
+
+	std::lock_guard<std::mutex> lock(m_SaveDataLock);
+	if (m_SaveData)
+	{
+		m_SaveData(p_ID, p_Data);
+	}
+}
+
+size_t DatagramChannel::getNumSent()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_NumSent;
+}
+
+size_t DatagramChannel::getNumReceived()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_NumReceived;
+}
+
+size_t DatagramChannel::getNumStale()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_NumStale;
+}
+
+size_t DatagramChannel::getNumRejected()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_NumRejected;
+}
+
+DatagramSocket::DatagramSocket(boost::asio::io_service& p_IO_Service, const boost::asio::ip::udp::endpoint& p_Local)
+	:	m_IO_Service(p_IO_Service),
+		m_Socket(p_IO_Service, p_Local),
+		m_ReceiveBuffer(maxDatagramSize)
+{
+	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Opened datagram socket on port " + std::to_string(getLocalPort()));
+}
+
+unsigned short DatagramSocket::getLocalPort() const
+{
+	boost::system::error_code error;
+	return m_Socket.local_endpoint(error).port();
+}
+
+void DatagramSocket::startReceiving()
+{
+	std::lock_guard<std::mutex> lock(m_SocketLock);
+	receiveNext();
+}
+
+void DatagramSocket::close()
+{
+	std::lock_guard<std::mutex> lock(m_SocketLock);
+	boost::system::error_code error;
+	m_Socket.close(error);
+}
+
+DatagramChannel::ptr DatagramSocket::createChannel(uint32_t p_Token)
+{
+	DatagramChannel::ptr channel(new DatagramChannel(shared_from_this(), p_Token));
+
+	std::lock_guard<std::mutex> lock(m_ChannelLock);
+	m_Channels[p_Token] = channel;
+	return channel;
+}
+
+void DatagramSocket::setSimulator(std::shared_ptr<LinkSimulator> p_Simulator)
+{
+	std::lock_guard<std::mutex> lock(m_ChannelLock);
+	m_Simulator = p_Simulator;
+}
+
+void DatagramSocket::sendTo(const boost::asio::ip::udp::endpoint& p_Remote, uint32_t p_Token, uint32_t p_Sequence,
+	uint16_t p_ID, const Buffer& p_Data)
+{
+	std::shared_ptr<Buffer::Storage> header = m_HeaderPool.acquire();
+	WireWriter writer(*header);
+	writer.writeUint32(p_Token);
+	writer.writeUint32(p_Sequence);
+	writer.writeUint16(p_ID);
+
+	std::shared_ptr<LinkSimulator> simulator;
+	{
+		std::lock_guard<std::mutex> lock(m_ChannelLock);
+		simulator = m_Simulator;
+	}
+
+	unsigned int delayMs = 0;
+	if (simulator && simulator->simulate(delayMs))
+	{
+		return;
+	}
+
+	if (delayMs == 0)
+	{
+		doSend(p_Remote, Buffer(header), p_Data);
+		return;
+	}
+
+	std::shared_ptr<boost::asio::deadline_timer> timer(
+		new boost::asio::deadline_timer(m_IO_Service, boost::posix_time::milliseconds(delayMs)));
+	std::shared_ptr<DatagramSocket> self = shared_from_this();
+	Buffer headerBuffer(header);
+	timer->async_wait([self, timer, p_Remote, headerBuffer, p_Data] (const boost::system::error_code& p_Error)
+	{
+		if (!p_Error)
+		{
+			self->doSend(p_Remote, headerBuffer, p_Data);
+		}
+	});
+}
+
+void DatagramSocket::doSend(const boost::asio::ip::udp::endpoint& p_Remote, const Buffer& p_Header, const Buffer& p_Data)
+{
+	std::vector<boost::asio::const_buffer> buffers;
+	buffers.push_back(boost::asio::buffer(p_Header.data(), p_Header.size()));
+	buffers.push_back(boost::asio::buffer(p_Data.data(), p_Data.size()));
+
+	// The buffers are kept alive by the handler until the send is done.
+	std::shared_ptr<DatagramSocket> self = shared_from_this();
+	std::lock_guard<std::mutex> lock(m_SocketLock);
+	m_Socket.async_send_to(buffers, p_Remote,
+		[self, p_Header, p_Data] (const boost::system::error_code& p_Error, std::size_t /*p_BytesTransferred*/)
+		{
+			if (p_Error && p_Error != boost::asio::error::operation_aborted)
+			{
+				NetworkLogger::log(NetworkLogger::Level::TRACE, "Failed to send datagram: " + p_Error.message());
+			}
+		});
+}
+
+void DatagramSocket::receiveNext()
+{
+	m_Socket.async_receive_from(boost::asio::buffer(m_ReceiveBuffer), m_ReceiveFrom,
+		std::bind(&DatagramSocket::handleReceive, shared_from_this(), std::placeholders::_1, std::placeholders::_2));
+}
+
+void DatagramSocket::handleReceive(const boost::system::error_code& p_Error, std::size_t p_BytesTransferred)
+{
+	if (p_Error == boost::asio::error::operation_aborted)
+	{
+		return;
+	}
+
+	// Errors on a datagram socket only concern single datagrams, such as
+	// ICMP port unreachable reported for an earlier send, so keep receiving.
+	if (!p_Error && p_BytesTransferred >= DatagramChannel::headerSize)
+	{
+		WireReader reader(m_ReceiveBuffer.data(), p_BytesTransferred);
+		const uint32_t token = reader.readUint32();
+		const uint32_t sequence = reader.readUint32();
+		const uint16_t id = reader.readUint16();
+
+		DatagramChannel::ptr channel;
+		{
+			std::lock_guard<std::mutex> lock(m_ChannelLock);
+			std::map<uint32_t, std::weak_ptr<DatagramChannel>>::iterator it = m_Channels.find(token);
+			if (it != m_Channels.end())
+			{
+				channel = it->second.lock();
+				if (!channel)
+				{
+					m_Channels.erase(it);
+				}
+			}
+		}
+
+		if (channel)
+		{
+			std::shared_ptr<Buffer::Storage> data = m_ReceivePool.acquire();
+			data->assign(m_ReceiveBuffer.data() + DatagramChannel::headerSize, m_ReceiveBuffer.data() + p_BytesTransferred);
+			// A malformed datagram must not stop the receive loop shared by every channel.
+			try
+			{
+				channel->receive(m_ReceiveFrom, id, sequence, Buffer(data));
+			}
+			catch (std::exception& err)
+			{
+				NetworkLogger::log(NetworkLogger::Level::WARNING, std::string("Dropping malformed datagram: ") + err.what());
+			}
+		}
+		else
+		{
+			NetworkLogger::log(NetworkLogger::Level::TRACE, "Dropping datagram with unknown token");
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_SocketLock);
+	if (m_Socket.is_open())
+	{
+		receiveNext();
+	}
+}
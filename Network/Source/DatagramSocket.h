@@ -0,0 +1,256 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include "BufferPool.h"
+#include "IConnection.h"
+
+#include <boost/asio.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+
+class DatagramSocket;
+
+/**
+ * Simulates a bad network link by dropping and delaying outgoing datagrams.
+ * Deterministic for a given seed.
+ *
+ * Thread safe.
+ */
+class LinkSimulator
+{
+private:
+	std::mutex m_Lock;
+	std::mt19937 m_Random;
+	float m_LossRate;
+	unsigned int m_LatencyMs;
+	unsigned int m_JitterMs;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_LossRate the fraction of datagrams to drop, between 0 and 1.
+	 * @param p_LatencyMs the delay added to every datagram in milliseconds.
+	 * @param p_JitterMs the maximum random extra delay in milliseconds.
+	 * @param p_Seed the seed of the random sequence.
+	 */
+	LinkSimulator(float p_LossRate, unsigned int p_LatencyMs, unsigned int p_JitterMs, unsigned int p_Seed);
+
+	/**
+	 * Decide the fate of a datagram about to be sent.
+	 *
+	 * @param p_DelayMs set to the delay before the datagram is sent, in milliseconds.
+	 * @return true if the datagram should be dropped, otherwise false.
+	 */
+	bool simulate(unsigned int& p_DelayMs);
+};
+
+/**
+ * An unreliable, unordered channel to one peer over a shared DatagramSocket.
+ * Each datagram carries the channel token, a sequence number and a package
+ * type id. Datagrams older than the newest one received with the same type
+ * are dropped as stale, so only state that is replaced by later packages
+ * should be sent over the channel.
+ *
+ * Thread safe.
+ */
+class DatagramChannel
+{
+public:
+	/**
+	 * Shared pointer type.
+	 */
+	typedef std::shared_ptr<DatagramChannel> ptr;
+
+	/**
+	 * Size in bytes of the header in front of every datagram.
+	 */
+	static const size_t headerSize = 10;
+	/**
+	 * Largest package sent as a datagram, larger packages must be sent
+	 * reliably to avoid IP fragmentation.
+	 */
+	static const size_t maxPayloadSize = 1200;
+
+private:
+	std::shared_ptr<DatagramSocket> m_Socket;
+	uint32_t m_Token;
+
+	std::mutex m_Lock;
+	boost::asio::ip::udp::endpoint m_Remote;
+	bool m_HasRemote;
+	uint32_t m_NextSequence;
+	std::map<uint16_t, uint32_t> m_LastReceived;
+	// Held while the callback runs, so that it is never called after being replaced.
+	// Separate from m_Lock, as the callback may send on the channel.
+	std::mutex m_SaveDataLock;
+	IConnection::saveDataFunction m_SaveData;
+
+	size_t m_NumSent;
+	size_t m_NumReceived;
+	size_t m_NumStale;
+	size_t m_NumRejected;
+
+public:
+	/**
+	 * Constructor, use DatagramSocket::createChannel.
+	 *
+	 * @param p_Socket the socket to send through.
+	 * @param p_Token the token identifying the channel on both sides.
+	 */
+	DatagramChannel(std::shared_ptr<DatagramSocket> p_Socket, uint32_t p_Token);
+
+	/**
+	 * @return the token identifying the channel.
+	 */
+	uint32_t getToken() const;
+
+	/**
+	 * Set the address of the peer. If not set, the address of the
+	 * first datagram received on the channel is used. Datagrams from
+	 * any other address are dropped.
+	 *
+	 * @param p_Remote the peer address.
+	 */
+	void setRemote(const boost::asio::ip::udp::endpoint& p_Remote);
+
+	/**
+	 * @return true if the address of the peer is known.
+	 */
+	bool hasRemote();
+
+	/**
+	 * Send a package as a datagram. Delivery is not guaranteed.
+	 *
+	 * @param p_ID the package type id.
+	 * @param p_Data the package data, shared until sent.
+	 * @return false if the package could not be sent, because
+	 *			the peer is unknown or the package is too large.
+	 */
+	bool send(uint16_t p_ID, const Buffer& p_Data);
+
+	/**
+	 * Set a callback to receive packages arriving on the channel.
+	 * Once replaced, the previous callback is no longer running.
+	 *
+	 * @param p_SaveData the callback, use the empty function to disable callback.
+	 */
+	void setSaveData(IConnection::saveDataFunction p_SaveData);
+
+	/**
+	 * Handle a received datagram. Called by the socket.
+	 *
+	 * @param p_From the sender of the datagram.
+	 * @param p_ID the package type id.
+	 * @param p_Sequence the sequence number of the datagram.
+	 * @param p_Data the package data.
+	 */
+	void receive(const boost::asio::ip::udp::endpoint& p_From, uint16_t p_ID, uint32_t p_Sequence, const Buffer& p_Data);
+
+	/**
+	 * @return the number of datagrams sent.
+	 */
+	size_t getNumSent();
+	/**
+	 * @return the number of datagrams received and delivered.
+	 */
+	size_t getNumReceived();
+	/**
+	 * @return the number of received datagrams dropped as stale.
+	 */
+	size_t getNumStale();
+	/**
+	 * @return the number of received datagrams dropped for coming from another address than the peer.
+	 */
+	size_t getNumRejected();
+};
+
+/**
+ * A UDP socket shared by any number of datagram channels. Incoming
+ * datagrams are routed to channels by their token.
+ */
+class DatagramSocket : public std::enable_shared_from_this<DatagramSocket>
+{
+public:
+	/**
+	 * Shared pointer type.
+	 */
+	typedef std::shared_ptr<DatagramSocket> ptr;
+
+private:
+	boost::asio::io_service& m_IO_Service;
+	std::mutex m_SocketLock;
+	boost::asio::ip::udp::socket m_Socket;
+	boost::asio::ip::udp::endpoint m_ReceiveFrom;
+	std::vector<char> m_ReceiveBuffer;
+	BufferPool m_ReceivePool;
+	BufferPool m_HeaderPool;
+
+	std::mutex m_ChannelLock;
+	std::map<uint32_t, std::weak_ptr<DatagramChannel>> m_Channels;
+
+	std::shared_ptr<LinkSimulator> m_Simulator;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_IO_Service the io service to run asynchronous operations on.
+	 * @param p_Local the local address to bind to, use port 0 for any free port.
+	 */
+	DatagramSocket(boost::asio::io_service& p_IO_Service, const boost::asio::ip::udp::endpoint& p_Local);
+
+	/**
+	 * @return the local port the socket is bound to.
+	 */
+	unsigned short getLocalPort() const;
+
+	/**
+	 * Start the receive loop. Should only be called once.
+	 */
+	void startReceiving();
+
+	/**
+	 * Close the socket, cancelling any pending operations.
+	 */
+	void close();
+
+	/**
+	 * Create a channel for datagrams with a token.
+	 *
+	 * @param p_Token the token, unique on this socket.
+	 * @return a new channel, routed to as long as it exists.
+	 */
+	DatagramChannel::ptr createChannel(uint32_t p_Token);
+
+	/**
+	 * Set a simulator for outgoing datagrams.
+	 *
+	 * @param p_Simulator the simulator, or empty to send datagrams directly.
+	 */
+	void setSimulator(std::shared_ptr<LinkSimulator> p_Simulator);
+
+	/**
+	 * Send a datagram. Used by channels.
+	 *
+	 * @param p_Remote the receiver.
+	 * @param p_Token the channel token.
+	 * @param p_Sequence the datagram sequence number.
+	 * @param p_ID the package type id.
+	 * @param p_Data the package data.
+	 */
+	void sendTo(const boost::asio::ip::udp::endpoint& p_Remote, uint32_t p_Token, uint32_t p_Sequence,
+		uint16_t p_ID, const Buffer& p_Data);
+
+private:
+	void doSend(const boost::asio::ip::udp::endpoint& p_Remote, const Buffer& p_Header, const Buffer& p_Data);
+	void receiveNext();
+	void handleReceive(const boost::system::error_code& p_Error, std::size_t p_BytesTransferred);
+};
@@ -4,10 +4,52 @@
 
 #pragma once
 
+#include "BufferPool.h"
+
 #include <cstdint>
 #include <functional>
 #include <memory>
 
+/**
+ * Counters for the writes made by a connection.
+ */
+struct WriteStatistics
+{
+	/**
+	 * Number of socket writes, each a single gather write of one or more packages.
+	 */
+	uint64_t m_NumWrites;
+	/**
+	 * Number of packages written.
+	 */
+	uint64_t m_NumPackages;
+	/**
+	 * Number of bytes written, including headers.
+	 */
+	uint64_t m_NumBytes;
+	/**
+	 * The most packages waiting to be written at once.
+	 */
+	uint64_t m_MaxQueuedPackages;
+	/**
+	 * The most bytes waiting to be written at once, including headers.
+	 */
+	uint64_t m_MaxQueuedBytes;
+	/**
+	 * Seconds since the connection was created.
+	 */
+	double m_Seconds;
+
+	/**
+	 * @return the average number of socket writes per second.
+	 */
+	double getWritesPerSecond() const;
+	/**
+	 * @return the average number of packages per socket write.
+	 */
+	double getPackagesPerWrite() const;
+};
+
 /**
  * Interface for a connetion to a remote computer.
  */
@@ -18,9 +60,9 @@ public:
 	 * Callback type used to report that a data package has been received.
 	 *
 	 * First argument is the id of the package, as read from the header.
-	 * Second argument is the data as a string of bytes.
+	 * Second argument is the data, only valid during the call unless the buffer is copied.
 	 */
-	typedef std::function<void(uint16_t, const std::string&)> saveDataFunction;
+	typedef std::function<void(uint16_t, const Buffer&)> saveDataFunction;
 	/**
 	 * Callback type used to report that the connection has been disconnected.
 	 */
@@ -67,11 +109,11 @@ public:
 	 * is busy, the data is buffered and sent when the stream has time.
 	 * Data is always sent in order, even when buffered.
 	 *
-	 * @param p_Buffer A buffer of data to send. The data is copied and stored
-	 *		internally. Therefore it is safe to delete the buffer afterwards.
+	 * @param p_Buffer A buffer of data to send. The buffer shares the data instead
+	 *		of copying it, so the storage must not be modified after the call.
 	 * @param p_ID The package ID to be associated with the data.
 	 */
-	virtual void writeData(const std::string& p_Buffer, uint16_t p_ID) = 0;
+	virtual void writeData(const Buffer& p_Buffer, uint16_t p_ID) = 0;
 
 	/**
 	 * Set a callback to handle data when received. Data is always a single complete package.
@@ -86,6 +128,13 @@ public:
 	 */
 	virtual void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) = 0;
 
+	/**
+	 * Get the write counters of the connection.
+	 *
+	 * @return the counters since the connection was created.
+	 */
+	virtual WriteStatistics getWriteStatistics() const = 0;
+
 	///**
 	// * Get the socket from the connection.
 	// *
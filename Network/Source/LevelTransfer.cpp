@@ -0,0 +1,204 @@
+#include "LevelTransfer.h"
+
+#include "Compression.h"
+#include "NetworkLogger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+uint64_t hashLevelData(const char* p_Data, size_t p_Size)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < p_Size; ++i)
+	{
+		hash ^= (unsigned char)p_Data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+LevelTransfer::LevelTransfer(const char* p_Data, size_t p_Size)
+	:	m_Hash(hashLevelData(p_Data, p_Size)),
+		m_Size((uint32_t)p_Size),
+		m_CompressedSize(0)
+{
+	const uint32_t numChunks = getNumChunks(m_Size);
+	m_Chunks.reserve(numChunks);
+	for (uint32_t i = 0; i < numChunks; ++i)
+	{
+		const size_t offset = i * chunkSize;
+		const size_t remaining = p_Size - offset;
+		const size_t size = remaining < chunkSize ? remaining : chunkSize;
+
+		std::shared_ptr<Buffer::Storage> storage(new Buffer::Storage);
+		WireWriter writer(*storage);
+		writer.writeUint32((uint32_t)(m_Hash & 0xffffffff));
+		writer.writeUint32((uint32_t)(m_Hash >> 32));
+		writer.writeUint32(i);
+		Compression::compress(p_Data + offset, size, *storage);
+
+		m_CompressedSize += storage->size();
+		m_Chunks.push_back(Buffer(storage));
+	}
+}
+
+uint64_t LevelTransfer::getHash() const
+{
+	return m_Hash;
+}
+
+uint32_t LevelTransfer::getSize() const
+{
+	return m_Size;
+}
+
+size_t LevelTransfer::getCompressedSize() const
+{
+	return m_CompressedSize;
+}
+
+uint32_t LevelTransfer::getNumChunks() const
+{
+	return m_Chunks.size();
+}
+
+const Buffer& LevelTransfer::getChunk(uint32_t p_Index) const
+{
+	return m_Chunks[p_Index];
+}
+
+uint32_t LevelTransfer::getNumChunks(uint32_t p_Size)
+{
+	return (uint32_t)((p_Size + chunkSize - 1) / chunkSize);
+}
+
+LevelAssembler::LevelAssembler(uint64_t p_Hash, uint32_t p_Size, uint32_t p_NumChunks)
+	:	m_Hash(p_Hash),
+		m_NumReceived(0)
+{
+	if (p_NumChunks != LevelTransfer::getNumChunks(p_Size))
+	{
+		throw NetworkError("Level chunk count does not match the level size", __LINE__, __FILE__);
+	}
+
+	m_Level.resize(p_Size);
+	m_Received.resize(p_NumChunks, false);
+}
+
+uint64_t LevelAssembler::getHash() const
+{
+	return m_Hash;
+}
+
+bool LevelAssembler::addChunk(const char* p_Data, size_t p_Size, uint32_t& p_Index)
+{
+	WireReader reader(p_Data, p_Size);
+	const uint64_t low = reader.readUint32();
+	const uint64_t high = reader.readUint32();
+	p_Index = reader.readUint32();
+	if ((low | (high << 32)) != m_Hash)
+	{
+		return false;
+	}
+
+	if (p_Index >= m_Received.size())
+	{
+		throw NetworkError("Level chunk index out of range", __LINE__, __FILE__);
+	}
+	if (m_Received[p_Index])
+	{
+		return true;
+	}
+
+	const size_t offset = p_Index * LevelTransfer::chunkSize;
+	const size_t remaining = m_Level.size() - offset;
+	const size_t size = remaining < LevelTransfer::chunkSize ? remaining : LevelTransfer::chunkSize;
+	Compression::decompress(p_Data + LevelTransfer::chunkHeaderSize, p_Size - LevelTransfer::chunkHeaderSize,
+		&m_Level[offset], size);
+
+	m_Received[p_Index] = true;
+	++m_NumReceived;
+	return true;
+}
+
+bool LevelAssembler::isComplete() const
+{
+	return m_NumReceived == m_Received.size();
+}
+
+std::string LevelAssembler::takeLevel()
+{
+	if (!isComplete() || hashLevelData(m_Level.data(), m_Level.size()) != m_Hash)
+	{
+		throw NetworkError("Assembled level does not match the content hash", __LINE__, __FILE__);
+	}
+
+	std::string level;
+	level.swap(m_Level);
+	return level;
+}
+
+void LevelAssembler::restart()
+{
+	std::fill(m_Received.begin(), m_Received.end(), false);
+	m_NumReceived = 0;
+}
+
+LevelCache::LevelCache(const std::string& p_Directory)
+	:	m_Directory(p_Directory)
+{
+}
+
+bool LevelCache::load(uint64_t p_Hash, uint32_t p_Size, std::string& p_Level) const
+{
+	std::ifstream file(getPath(p_Hash), std::ifstream::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::string level(p_Size, '\0');
+	if (p_Size > 0)
+	{
+		file.read(&level[0], p_Size);
+	}
+	// Exactly the expected size, with nothing after.
+	if (!file || file.peek() != std::ifstream::traits_type::eof())
+	{
+		return false;
+	}
+
+	if (hashLevelData(level.data(), level.size()) != p_Hash)
+	{
+		NetworkLogger::log(NetworkLogger::Level::WARNING, "Ignoring cached level that does not match its hash");
+		return false;
+	}
+
+	p_Level.swap(level);
+	return true;
+}
+
+void LevelCache::store(uint64_t p_Hash, const std::string& p_Level) const
+{
+	const std::string path = getPath(p_Hash);
+	std::ofstream file(path, std::ofstream::binary | std::ofstream::trunc);
+	file.write(p_Level.data(), p_Level.size());
+	if (!file)
+	{
+		NetworkLogger::log(NetworkLogger::Level::WARNING, "Could not store level in cache: " + path);
+	}
+}
+
+std::string LevelCache::getPath(uint64_t p_Hash) const
+{
+	std::ostringstream path;
+	path << m_Directory;
+	if (!m_Directory.empty() && m_Directory.back() != '/' && m_Directory.back() != '\\')
+	{
+		path << '/';
+	}
+	path << std::hex << std::setw(16) << std::setfill('0') << p_Hash << ".level";
+	return path.str();
+}
@@ -0,0 +1,220 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include "BufferPool.h"
+#include "Packages.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A package announcing the level of a round, with the content hash, the
+ * uncompressed size and the number of chunks. Sent in place of the level
+ * data, which is only transferred if the client asks for it.
+ */
+typedef Package3Obj<PackageType::LEVEL_INFO, uint64_t, uint32_t, uint32_t> LevelInfo;
+
+/**
+ * A package asking for the chunks of the level with a content hash.
+ */
+typedef Package1Obj<PackageType::LEVEL_REQUEST, uint64_t> LevelRequest;
+
+/**
+ * A package acknowledging a received level chunk, with the level content hash and the chunk index.
+ */
+typedef Package2Obj<PackageType::LEVEL_CHUNK_ACK, uint64_t, uint32_t> LevelChunkAck;
+
+/**
+ * Compute the content hash identifying a level, 64 bit FNV-1a.
+ *
+ * @param p_Data the first byte of the level data.
+ * @param p_Size the size of the level data in bytes.
+ * @return the content hash.
+ */
+uint64_t hashLevelData(const char* p_Data, size_t p_Size);
+
+/**
+ * A level split into separately compressed chunks, ready to be sent.
+ * Built once per level and shared by every connection it is sent on.
+ *
+ * Chunk package layout: level content hash as two 32 bit halves, low
+ * first, the chunk index and the compressed chunk up to the end.
+ */
+class LevelTransfer
+{
+public:
+	/**
+	 * Shared pointer type.
+	 */
+	typedef std::shared_ptr<const LevelTransfer> ptr;
+
+	/**
+	 * Uncompressed size of each chunk, except the last.
+	 */
+	static const size_t chunkSize = 16 * 1024;
+	/**
+	 * Number of chunks sent ahead of the acknowledgements. Limits how much
+	 * of the level is queued in front of other packages on the connection.
+	 */
+	static const unsigned int chunkWindow = 4;
+	/**
+	 * Size in bytes of the header in front of every chunk.
+	 */
+	static const size_t chunkHeaderSize = 12;
+
+private:
+	uint64_t m_Hash;
+	uint32_t m_Size;
+	std::vector<Buffer> m_Chunks;
+	size_t m_CompressedSize;
+
+public:
+	/**
+	 * Constructor, compresses the level.
+	 *
+	 * @param p_Data the first byte of the level data.
+	 * @param p_Size the size of the level data in bytes.
+	 */
+	LevelTransfer(const char* p_Data, size_t p_Size);
+
+	/**
+	 * @return the content hash of the level.
+	 */
+	uint64_t getHash() const;
+	/**
+	 * @return the uncompressed size of the level in bytes.
+	 */
+	uint32_t getSize() const;
+	/**
+	 * @return the total size of the chunk packages in bytes.
+	 */
+	size_t getCompressedSize() const;
+	/**
+	 * @return the number of chunks, zero for an empty level.
+	 */
+	uint32_t getNumChunks() const;
+	/**
+	 * Get an encoded LEVEL_CHUNK package.
+	 *
+	 * @param p_Index the index of the chunk, less than getNumChunks().
+	 * @return the package data.
+	 */
+	const Buffer& getChunk(uint32_t p_Index) const;
+
+	/**
+	 * Get the number of chunks a level of some size is split into.
+	 *
+	 * @param p_Size the uncompressed size of the level in bytes.
+	 * @return the number of chunks.
+	 */
+	static uint32_t getNumChunks(uint32_t p_Size);
+};
+
+/**
+ * Puts a level back together from chunks received in any order.
+ */
+class LevelAssembler
+{
+public:
+	/**
+	 * Number of times a download is tried before the level is given up on.
+	 */
+	static const unsigned int maxAttempts = 3;
+
+private:
+	uint64_t m_Hash;
+	std::string m_Level;
+	std::vector<bool> m_Received;
+	uint32_t m_NumReceived;
+
+public:
+	/**
+	 * Constructor. Throws a NetworkError if the chunk count does not match the size.
+	 *
+	 * @param p_Hash the content hash of the expected level.
+	 * @param p_Size the uncompressed size of the level in bytes.
+	 * @param p_NumChunks the number of chunks of the level.
+	 */
+	LevelAssembler(uint64_t p_Hash, uint32_t p_Size, uint32_t p_NumChunks);
+
+	/**
+	 * @return the content hash of the expected level.
+	 */
+	uint64_t getHash() const;
+
+	/**
+	 * Decompress a received chunk into place. Throws a NetworkError if the chunk is corrupt.
+	 *
+	 * @param p_Data the chunk package data.
+	 * @param p_Size the size of the chunk package in bytes.
+	 * @param p_Index set to the index of the chunk.
+	 * @return false if the chunk belongs to another level, otherwise true.
+	 */
+	bool addChunk(const char* p_Data, size_t p_Size, uint32_t& p_Index);
+
+	/**
+	 * @return true if every chunk has been received.
+	 */
+	bool isComplete() const;
+
+	/**
+	 * Take the assembled level. Throws a NetworkError if it does not match the content hash.
+	 *
+	 * @return the level data, the assembler is left empty.
+	 */
+	std::string takeLevel();
+
+	/**
+	 * Forget the received chunks, to download the level again after a corrupt chunk.
+	 */
+	void restart();
+};
+
+/**
+ * Levels received earlier, stored as files named by content hash,
+ * so that a returning client can skip the download.
+ */
+class LevelCache
+{
+private:
+	std::string m_Directory;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_Directory an existing directory to store levels in.
+	 */
+	explicit LevelCache(const std::string& p_Directory);
+
+	/**
+	 * Load a level from the cache. Files that do not match the hash are ignored.
+	 *
+	 * @param p_Hash the content hash of the level.
+	 * @param p_Size the uncompressed size of the level in bytes.
+	 * @param p_Level set to the level data if found.
+	 * @return true if the level was found, otherwise false.
+	 */
+	bool load(uint64_t p_Hash, uint32_t p_Size, std::string& p_Level) const;
+
+	/**
+	 * Store a level in the cache, replacing any earlier file.
+	 *
+	 * @param p_Hash the content hash of the level.
+	 * @param p_Level the level data.
+	 */
+	void store(uint64_t p_Hash, const std::string& p_Level) const;
+
+	/**
+	 * Get the file a level is stored in.
+	 *
+	 * @param p_Hash the content hash of the level.
+	 * @return the file path.
+	 */
+	std::string getPath(uint64_t p_Hash) const;
+};
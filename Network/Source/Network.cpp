@@ -11,6 +11,7 @@ Network::~Network()
 	NetworkLogger::log(NetworkLogger::Level::INFO, "Shutting down network");
 
 	m_ClientConnection.reset();
+	closeClientDatagrams();
 	m_IO_Service.stop();
 
 	if (m_IO_Thread.joinable())
@@ -47,6 +48,11 @@ void Network::startServer(unsigned int p_NumThreads)
 	m_ServerAcceptor->startServer(p_NumThreads);
 }
 
+void Network::setDatagramsEnabled(bool p_Enabled)
+{
+	m_ServerAcceptor->setDatagramsEnabled(p_Enabled);
+}
+
 void Network::setClientConnectedCallback(clientConnectedCallback_t p_ConnectCallback, void* p_UserData)
 {
 	m_ServerAcceptor->setConnectedCallback(p_ConnectCallback, p_UserData);
@@ -62,11 +68,70 @@ void Network::turnOffServer()
 	m_ServerAcceptor->stopServer();
 }
 
+ConnectionMetrics Network::getMetrics()
+{
+	ConnectionMetrics metrics = ConnectionMetrics();
+	if (m_ServerAcceptor)
+	{
+		metrics = m_ServerAcceptor->getMetrics();
+	}
+	if (m_ClientConnection)
+	{
+		addConnectionMetrics(metrics, m_ClientConnection->getMetrics());
+	}
+
+	return metrics;
+}
+
+const char* INetwork::getPackageTypeName(PackageType p_Type)
+{
+	switch (p_Type)
+	{
+	case PackageType::RESERVED:					return "RESERVED";
+	case PackageType::REQUEST_GAMES:			return "REQUEST_GAMES";
+	case PackageType::GAME_LIST:				return "GAME_LIST";
+	case PackageType::PLAYER_READY:				return "PLAYER_READY";
+	case PackageType::CREATE_OBJECTS:			return "CREATE_OBJECTS";
+	case PackageType::REMOVE_OBJECTS:			return "REMOVE_OBJECTS";
+	case PackageType::UPDATE_OBJECTS:			return "UPDATE_OBJECTS";
+	case PackageType::GAME_RESULT:				return "GAME_RESULT";
+	case PackageType::OBJECT_ACTION:			return "OBJECT_ACTION";
+	case PackageType::ASSIGN_PLAYER:			return "ASSIGN_PLAYER";
+	case PackageType::PLAYER_CONTROL:			return "PLAYER_CONTROL";
+	case PackageType::DONE_LOADING:				return "DONE_LOADING";
+	case PackageType::JOIN_GAME:				return "JOIN_GAME";
+	case PackageType::CURRENT_CHECKPOINT:		return "CURRENT_CHECKPOINT";
+	case PackageType::NUMBER_OF_CHECKPOINTS:	return "NUMBER_OF_CHECKPOINTS";
+	case PackageType::TAKEN_CHECKPOINTS:		return "TAKEN_CHECKPOINTS";
+	case PackageType::LEAVE_GAME:				return "LEAVE_GAME";
+	case PackageType::LEVEL_DATA:				return "LEVEL_DATA";
+	case PackageType::GAME_POSITIONS:			return "GAME_POSITIONS";
+	case PackageType::RESULT_GAME:				return "RESULT_GAME";
+	case PackageType::SET_SPAWN:				return "SET_SPAWN";
+	case PackageType::THROW_SPELL:				return "THROW_SPELL";
+	case PackageType::START_COUNTDOWN:			return "START_COUNTDOWN";
+	case PackageType::DONE_COUNTDOWN:			return "DONE_COUNTDOWN";
+	case PackageType::OBJECT_SNAPSHOT:			return "OBJECT_SNAPSHOT";
+	case PackageType::SNAPSHOT_ACK:				return "SNAPSHOT_ACK";
+	case PackageType::DATAGRAM_OFFER:			return "DATAGRAM_OFFER";
+	case PackageType::DATAGRAM_HELLO:			return "DATAGRAM_HELLO";
+	case PackageType::DATAGRAM_READY:			return "DATAGRAM_READY";
+	case PackageType::LEVEL_INFO:				return "LEVEL_INFO";
+	case PackageType::LEVEL_REQUEST:			return "LEVEL_REQUEST";
+	case PackageType::LEVEL_CHUNK:				return "LEVEL_CHUNK";
+	case PackageType::LEVEL_CHUNK_ACK:			return "LEVEL_CHUNK_ACK";
+	case PackageType::PING:						return "PING";
+	case PackageType::PONG:						return "PONG";
+	default:									return "UNKNOWN";
+	}
+}
+
 void Network::connectToServer(const char* p_URL, unsigned short p_Port, actionDoneCallback p_DoneHandler, void* p_UserData)
 {
 	NetworkLogger::log(NetworkLogger::Level::INFO, "Connecting to server");
 
 	m_ClientConnection.reset();
+	closeClientDatagrams();
 	m_ClientConnect.reset();
 	m_IO_Service.reset();
 
@@ -90,6 +155,7 @@ void Network::disconnectFromServer()
 	NetworkLogger::log(NetworkLogger::Level::INFO, "Disconnecting from server");
 
 	m_ClientConnection.reset();
+	closeClientDatagrams();
 	m_ClientConnect.reset();
 	m_IO_Service.reset();
 
@@ -104,6 +170,25 @@ IConnectionController* Network::getConnectionToServer()
 	return m_ClientConnection.get();
 }
 
+IConnectionController* Network::createOfflineConnection()
+{
+	IConnection::ptr connection(new OfflineConnection);
+	m_OfflineConnections.push_back(ConnectionController::ptr(new ConnectionController(connection, m_PackagePrototypes)));
+	return m_OfflineConnections.back().get();
+}
+
+void Network::setLevelCacheDirectory(const char* p_Directory)
+{
+	if (p_Directory)
+	{
+		m_LevelCache.reset(new LevelCache(p_Directory));
+	}
+	else
+	{
+		m_LevelCache.reset();
+	}
+}
+
 void Network::setLogFunction(clientLogCallback_t p_LogCallback)
 {
 	NetworkLogger::setLogFunction(p_LogCallback);
@@ -140,7 +225,8 @@ void Network::startIO()
 	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Starting a network IO thread for the client");
 
 	m_IO_Started = true;
-	m_IO_Thread.swap(boost::thread(std::bind(&Network::IO_Run, this)));
+	boost::thread ioThread(std::bind(&Network::IO_Run, this));
+	m_IO_Thread.swap(ioThread);
 }
 
 void Network::IO_Run()
@@ -172,8 +258,17 @@ void Network::IO_Run()
 
 void Network::clientConnectionDone(Result p_Result, actionDoneCallback p_DoneHandler, void* p_UserData)
 {
-	m_ClientConnection.reset(new ConnectionController(IConnection::ptr(new Connection(m_ClientConnect->releaseConnectedSocket())), m_PackagePrototypes));
+	boost::asio::ip::tcp::socket socket = m_ClientConnect->releaseConnectedSocket();
+	boost::system::error_code error;
+	const boost::asio::ip::address serverAddress = socket.remote_endpoint(error).address();
+
+	m_ClientConnection.reset(new ConnectionController(IConnection::ptr(new Connection(std::move(socket))), m_PackagePrototypes));
 	m_ClientConnection->setDisconnectedCallback(std::bind(&Network::clientDisconnected, this, p_DoneHandler, p_UserData));
+	m_ClientConnection->setLevelCache(m_LevelCache);
+	if (!error)
+	{
+		m_ClientConnection->setDatagramOfferCallback(std::bind(&Network::datagramsOffered, this, serverAddress, std::placeholders::_1, std::placeholders::_2));
+	}
 
 	if (p_DoneHandler)
 	{
@@ -184,6 +279,39 @@ void Network::clientConnectionDone(Result p_Result, actionDoneCallback p_DoneHan
 	m_ClientConnect.reset();
 }
 
+void Network::datagramsOffered(boost::asio::ip::address p_ServerAddress, uint32_t p_Token, uint16_t p_Port)
+{
+	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Server offered a datagram channel");
+
+	closeClientDatagrams();
+
+	try
+	{
+		const boost::asio::ip::udp::endpoint local(p_ServerAddress.is_v6() ? boost::asio::ip::udp::v6() : boost::asio::ip::udp::v4(), 0);
+		m_ClientDatagrams.reset(new DatagramSocket(m_IO_Service, local));
+		m_ClientDatagrams->startReceiving();
+	}
+	catch (boost::system::system_error& err)
+	{
+		NetworkLogger::log(NetworkLogger::Level::WARNING, std::string("Could not open datagram channel: ") + err.what());
+		m_ClientDatagrams.reset();
+		return;
+	}
+
+	DatagramChannel::ptr channel = m_ClientDatagrams->createChannel(p_Token);
+	channel->setRemote(boost::asio::ip::udp::endpoint(p_ServerAddress, p_Port));
+	m_ClientConnection->setDatagramChannel(channel);
+}
+
+void Network::closeClientDatagrams()
+{
+	if (m_ClientDatagrams)
+	{
+		m_ClientDatagrams->close();
+		m_ClientDatagrams.reset();
+	}
+}
+
 void Network::clientDisconnected(actionDoneCallback p_DoneHandler, void* p_UserData)
 {
 	if (p_DoneHandler)
@@ -7,6 +7,7 @@
 #include "ClientConnect.h"
 #include "ConnectionController.h"
 #include "NetworkExceptions.h"
+#include "OfflineConnection.h"
 #include "Packages.h"
 #include "ServerAccept.h"
 #include "../include/INetwork.h"
@@ -27,6 +28,10 @@ private:
 	std::unique_ptr<ClientConnect> m_ClientConnect;
 
 	ConnectionController::ptr m_ClientConnection;
+	DatagramSocket::ptr m_ClientDatagrams;
+	std::shared_ptr<LevelCache> m_LevelCache;
+
+	std::vector<ConnectionController::ptr> m_OfflineConnections;
 
 public:
 	/**
@@ -42,15 +47,19 @@ public:
 
 	void createServer(unsigned short p_Port) override;
 	void startServer(unsigned int p_NumThreads) override;
+	void setDatagramsEnabled(bool p_Enabled) override;
 
 	void setClientConnectedCallback(clientConnectedCallback_t p_ConnectCallback, void* p_UserData) override;
 	void setClientDisconnectedCallback(clientDisconnectedCallback_t p_DisconnectCallback, void* p_UserData) override;
 
 	void turnOffServer() override;
+	ConnectionMetrics getMetrics() override;
 	void connectToServer(const char* p_URL, unsigned short p_Port, actionDoneCallback p_DoneHandler, void* p_UserData) override;
 	void disconnectFromServer() override;
 
 	IConnectionController* getConnectionToServer() override;
+	IConnectionController* createOfflineConnection() override;
+	void setLevelCacheDirectory(const char* p_Directory) override;
 
 	void setLogFunction(clientLogCallback_t p_LogCallback) override;
 
@@ -61,4 +70,6 @@ private:
 	void IO_Run();
 	void clientConnectionDone(Result p_Result, actionDoneCallback p_DoneHandler, void* p_UserData);
 	void clientDisconnected(actionDoneCallback p_DoneHandler, void* p_UserData);
+	void datagramsOffered(boost::asio::ip::address p_ServerAddress, uint32_t p_Token, uint16_t p_Port);
+	void closeClientDatagrams();
 };
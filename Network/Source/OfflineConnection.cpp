@@ -0,0 +1,51 @@
+#include "OfflineConnection.h"
+
+OfflineConnection::OfflineConnection()
+	:	m_Statistics(),
+		m_Created(std::chrono::steady_clock::now())
+{
+}
+
+bool OfflineConnection::isConnected() const
+{
+	return true;
+}
+
+void OfflineConnection::disconnect()
+{
+}
+
+bool OfflineConnection::hasError() const
+{
+	return false;
+}
+
+void OfflineConnection::writeData(const Buffer& p_Buffer, uint16_t p_ID)
+{
+	std::lock_guard<std::mutex> lock(m_StatisticsLock);
+	++m_Statistics.m_NumWrites;
+	++m_Statistics.m_NumPackages;
+	m_Statistics.m_NumBytes += p_Buffer.size();
+}
+
+void OfflineConnection::setSaveData(saveDataFunction p_SaveData)
+{
+	// Nothing is ever received.
+}
+
+void OfflineConnection::setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback)
+{
+	// Never disconnected.
+}
+
+WriteStatistics OfflineConnection::getWriteStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_StatisticsLock);
+	WriteStatistics statistics = m_Statistics;
+	statistics.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Created).count();
+	return statistics;
+}
+
+void OfflineConnection::startReading()
+{
+}
@@ -0,0 +1,38 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include "IConnection.h"
+
+#include <chrono>
+#include <mutex>
+
+/**
+ * A connection without a remote side, for running code written for
+ * connections offline. Written data is counted and discarded, and
+ * nothing is ever received.
+ */
+class OfflineConnection : public IConnection
+{
+private:
+	mutable std::mutex m_StatisticsLock;
+	WriteStatistics m_Statistics;
+	std::chrono::steady_clock::time_point m_Created;
+
+public:
+	/**
+	 * constructor.
+	 */
+	OfflineConnection();
+
+	bool isConnected() const override;
+	void disconnect() override;
+	bool hasError() const override;
+	void writeData(const Buffer& p_Buffer, uint16_t p_ID) override;
+	void setSaveData(saveDataFunction p_SaveData) override;
+	void setDisconnectedCallback(disconnectedCallback_t p_DisconnectedCallback) override;
+	WriteStatistics getWriteStatistics() const override;
+	void startReading() override;
+};
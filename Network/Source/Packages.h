@@ -5,10 +5,14 @@
 
 #pragma once
 
+#include "WireFormat.h"
+
 #include <CommonTypes.h>
+#include <NetworkExceptions.h>
 
 #include <sstream>
 #include <memory>
+#include <streambuf>
 #include <vector>
 
 #pragma warning(push)
@@ -22,6 +26,104 @@
 #include <boost/serialization/vector.hpp>
 #pragma warning(pop)
 
+/**
+ * Read-only stream buffer over a block of memory, used to
+ * deserialize packages without copying the data first.
+ */
+class MemoryInputBuffer : public std::streambuf
+{
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_Data the first byte to read, must outlive the stream buffer.
+	 * @param p_Size the number of bytes available.
+	 */
+	MemoryInputBuffer(const char* p_Data, size_t p_Size)
+	{
+		char* data = const_cast<char*>(p_Data);
+		setg(data, data, data + p_Size);
+	}
+};
+
+/**
+ * Stream buffer appending everything written to a vector, used to
+ * serialize packages directly into pooled storage.
+ */
+class VectorOutputBuffer : public std::streambuf
+{
+private:
+	std::vector<char>& m_Output;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_Output the vector to append to, must outlive the stream buffer.
+	 */
+	explicit VectorOutputBuffer(std::vector<char>& p_Output)
+		: m_Output(p_Output)
+	{}
+
+protected:
+	int_type overflow(int_type p_Char) override
+	{
+		if (!traits_type::eq_int_type(p_Char, traits_type::eof()))
+		{
+			m_Output.push_back(traits_type::to_char_type(p_Char));
+		}
+		return traits_type::not_eof(p_Char);
+	}
+
+	std::streamsize xsputn(const char* p_Data, std::streamsize p_Size) override
+	{
+		m_Output.insert(m_Output.end(), p_Data, p_Data + p_Size);
+		return p_Size;
+	}
+
+private:
+	VectorOutputBuffer& operator=(const VectorOutputBuffer&);
+};
+
+/**
+ * Encodes and decodes the payload of a package type. The default uses
+ * boost::serialization, which is flexible but slow and verbose, and is
+ * kept for rarely sent packages. Frequently sent packages specialize
+ * this template with a compact layout written through WireWriter.
+ *
+ * @param <Package> the package type to encode.
+ */
+template <typename Package>
+struct PackageCodec
+{
+	/**
+	 * Append the serialized package to a vector.
+	 *
+	 * @param p_Package the package to serialize.
+	 * @param p_Output the vector to append the data to.
+	 */
+	static void write(const Package& p_Package, std::vector<char>& p_Output)
+	{
+		VectorOutputBuffer buffer(p_Output);
+		boost::archive::binary_oarchive archive(buffer, boost::archive::no_header);
+		archive << p_Package;
+	}
+
+	/**
+	 * Deserialize a package from a block of memory.
+	 *
+	 * @param p_Data the first byte of the serialized package.
+	 * @param p_Size the size of the serialized package in bytes.
+	 * @param p_Package the package to fill.
+	 */
+	static void read(const char* p_Data, size_t p_Size, Package& p_Package)
+	{
+		MemoryInputBuffer buffer(p_Data, p_Size);
+		boost::archive::binary_iarchive archive(buffer, boost::archive::no_header);
+		archive >> p_Package;
+	}
+};
+
 /**
  * Abstract base class for packages.
  */
@@ -40,20 +142,18 @@ protected:
 	PackageType m_ID;
 
 	/**
-	 * Create a package from a byte stream.
+	 * Create a package from a block of memory.
 	 *
 	 * @param <Package> the package type to create.
 	 * @param p_Data a serialized package of the target type.
+	 * @param p_Size the size of the serialized package in bytes.
 	 * @return a new package of the target type.
 	 */
 	template <typename Package>
-	PackageBase::ptr createPackageImp(const std::string& p_Data)
+	PackageBase::ptr createPackageImp(const char* p_Data, size_t p_Size)
 	{
 		std::unique_ptr<Package> res(new Package());
-
-		std::istringstream stream(p_Data);
-		boost::archive::binary_iarchive archive(stream, boost::archive::no_header);
-		archive >> *res;
+		PackageCodec<Package>::read(p_Data, p_Size, *res);
 
 		return PackageBase::ptr(res.release());
 	}
@@ -68,11 +168,23 @@ protected:
 	template <typename Package>
 	std::string getDataImp(const Package& p_Package)
 	{
-		std::ostringstream ostream;
-		boost::archive::binary_oarchive archive(ostream, boost::archive::no_header);
-		archive << p_Package;
+		std::vector<char> data;
+		PackageCodec<Package>::write(p_Package, data);
+
+		return std::string(data.begin(), data.end());
+	}
 
-		return ostream.str();
+	/**
+	 * Append the serialized package to a vector.
+	 *
+	 * @param <Package> the package type to serialize.
+	 * @param p_Package the package to serialize.
+	 * @param p_Output the vector to append the data to.
+	 */
+	template <typename Package>
+	void writeDataImp(const Package& p_Package, std::vector<char>& p_Output)
+	{
+		PackageCodec<Package>::write(p_Package, p_Output);
 	}
 
 public:
@@ -100,12 +212,28 @@ public:
 	 */
 	virtual PackageBase::ptr createPackage(const std::string& p_Data) = 0;
 
+	/**
+	 * Create a package of the same type from a block of memory.
+	 *
+	 * @param p_Data the first byte of the serialized package.
+	 * @param p_Size the size of the serialized package in bytes.
+	 * @return a new deserialized package.
+	 */
+	virtual PackageBase::ptr createPackage(const char* p_Data, size_t p_Size) = 0;
+
 	/**
 	 * Get the serialized data from the package.
 	 *
 	 * @return the serialized package.
 	 */
 	virtual std::string getData() = 0;
+
+	/**
+	 * Append the serialized data from the package to a vector.
+	 *
+	 * @param p_Output the vector to append the data to.
+	 */
+	virtual void writeData(std::vector<char>& p_Output) = 0;
 };
 
 /**
@@ -125,13 +253,23 @@ public:
 
 	PackageBase::ptr createPackage(const std::string& p_Data) override
 	{
-		return createPackageImp<Package>(p_Data);
+		return createPackageImp<Package>(p_Data.data(), p_Data.size());
+	}
+
+	PackageBase::ptr createPackage(const char* p_Data, size_t p_Size) override
+	{
+		return createPackageImp<Package>(p_Data, p_Size);
 	}
 
 	std::string getData() override
 	{
 		return getDataImp<Package>(*(Package*)this);
 	}
+
+	void writeData(std::vector<char>& p_Output) override
+	{
+		writeDataImp<Package>(*(Package*)this, p_Output);
+	}
 };
 
 /**
@@ -366,7 +504,7 @@ typedef Package1Obj<PackageType::CURRENT_CHECKPOINT, Vector3> CurrentCheckpoint;
 /**
  * A package representing the players positions.
  */
-typedef Package1Obj<PackageType::GAME_POSITIONS, std::vector<std::string>> GamePositions;
+typedef Package1Obj<PackageType::GAME_POSITIONS, std::vector<RacePositionData>> GamePositions;
 
 /**
  * A package representing the addition of new objects to the game world.
@@ -428,6 +566,9 @@ BOOST_CLASS_IMPLEMENTATION(GameList, boost::serialization::object_serializable)
 BOOST_CLASS_TRACKING(GameList, boost::serialization::track_never)
 
 BOOST_IS_BITWISE_SERIALIZABLE(UpdateObjectData)
+BOOST_IS_BITWISE_SERIALIZABLE(ObjectLookData)
+BOOST_IS_BITWISE_SERIALIZABLE(ObjectColorData)
+BOOST_IS_BITWISE_SERIALIZABLE(RacePositionData)
 
 struct JoinGameData
 {
@@ -452,11 +593,245 @@ struct JoinGameData
 typedef Package1Obj<PackageType::JOIN_GAME, JoinGameData> JoinGame;
 
 /**
- * A package representing the update of objects in the game world.
+ * A package representing the update of objects in the game world,
+ * with the look directions and colors of objects that changed.
  */
- typedef Package2Obj<PackageType::UPDATE_OBJECTS, std::vector<UpdateObjectData>, std::vector<std::string>> UpdateObjects;
+ typedef Package3Obj<PackageType::UPDATE_OBJECTS, std::vector<UpdateObjectData>, std::vector<ObjectLookData>, std::vector<ObjectColorData>> UpdateObjects;
 
 /**
  * A package representing one objects action in the game world.
  */
 typedef Package2Obj<PackageType::OBJECT_ACTION, uint32_t, std::string> ObjectAction;
+
+/**
+ * A package offering a datagram channel, with the channel token and the server datagram port.
+ */
+typedef Package2Obj<PackageType::DATAGRAM_OFFER, uint32_t, uint16_t> DatagramOffer;
+
+/**
+ * A datagram sent by the client to open the offered datagram channel.
+ */
+typedef Signal<PackageType::DATAGRAM_HELLO> DatagramHello;
+
+/**
+ * A package confirming that the server has received datagrams from the client.
+ */
+typedef Signal<PackageType::DATAGRAM_READY> DatagramReady;
+
+/**
+ * A package asking the remote side to answer with a pong, with a sequence number.
+ */
+typedef Package1Obj<PackageType::PING, uint32_t> Ping;
+
+/**
+ * A package answering a ping, with the sequence number of the ping.
+ */
+typedef Package1Obj<PackageType::PONG, uint32_t> Pong;
+
+/**
+ * Compact encoding of UPDATE_OBJECTS, sent for every player on every server tick.
+ *
+ * Layout: version, object count, the objects as four vectors and an id each,
+ * look count, the looks as two vectors and an id each, color count and
+ * the colors as a vector and an id each.
+ */
+template <>
+struct PackageCodec<UpdateObjects>
+{
+	static const uint8_t version = 2;
+	static const size_t objectSize = 4 * Wire::vector3Size + sizeof(uint32_t);
+	static const size_t lookSize = 2 * Wire::vector3Size + sizeof(uint32_t);
+	static const size_t colorSize = Wire::vector3Size + sizeof(uint32_t);
+
+	static void write(const UpdateObjects& p_Package, std::vector<char>& p_Output)
+	{
+		const size_t size = 1 + 3 * sizeof(uint32_t)
+			+ p_Package.m_Object1.size() * objectSize
+			+ p_Package.m_Object2.size() * lookSize
+			+ p_Package.m_Object3.size() * colorSize;
+
+		WireWriter writer(p_Output);
+		writer.reserve(size);
+		writer.writeUint8(version);
+		writer.writeUint32((uint32_t)p_Package.m_Object1.size());
+		unsigned char* out = writer.append(p_Package.m_Object1.size() * objectSize);
+		for (const UpdateObjectData& data : p_Package.m_Object1)
+		{
+			Wire::storeVector3(out, data.m_Position);
+			Wire::storeVector3(out + 12, data.m_Velocity);
+			Wire::storeVector3(out + 24, data.m_Rotation);
+			Wire::storeVector3(out + 36, data.m_RotationVelocity);
+			Wire::storeUint32(out + 48, data.m_Id);
+			out += objectSize;
+		}
+
+		writer.writeUint32((uint32_t)p_Package.m_Object2.size());
+		out = writer.append(p_Package.m_Object2.size() * lookSize);
+		for (const ObjectLookData& look : p_Package.m_Object2)
+		{
+			Wire::storeVector3(out, look.m_Forward);
+			Wire::storeVector3(out + 12, look.m_Up);
+			Wire::storeUint32(out + 24, look.m_Id);
+			out += lookSize;
+		}
+
+		writer.writeUint32((uint32_t)p_Package.m_Object3.size());
+		out = writer.append(p_Package.m_Object3.size() * colorSize);
+		for (const ObjectColorData& color : p_Package.m_Object3)
+		{
+			Wire::storeVector3(out, color.m_Color);
+			Wire::storeUint32(out + 12, color.m_Id);
+			out += colorSize;
+		}
+	}
+
+	static void read(const char* p_Data, size_t p_Size, UpdateObjects& p_Package)
+	{
+		WireReader reader(p_Data, p_Size);
+		if (reader.readUint8() != version)
+		{
+			throw NetworkError("Unsupported update objects version", __LINE__, __FILE__);
+		}
+
+		uint32_t numRecords = 0;
+		const unsigned char* in = takeRecords(reader, objectSize, numRecords);
+		p_Package.m_Object1.resize(numRecords);
+		for (UpdateObjectData& data : p_Package.m_Object1)
+		{
+			data.m_Position = Wire::loadVector3(in);
+			data.m_Velocity = Wire::loadVector3(in + 12);
+			data.m_Rotation = Wire::loadVector3(in + 24);
+			data.m_RotationVelocity = Wire::loadVector3(in + 36);
+			data.m_Id = Wire::loadUint32(in + 48);
+			in += objectSize;
+		}
+
+		in = takeRecords(reader, lookSize, numRecords);
+		p_Package.m_Object2.resize(numRecords);
+		for (ObjectLookData& look : p_Package.m_Object2)
+		{
+			look.m_Forward = Wire::loadVector3(in);
+			look.m_Up = Wire::loadVector3(in + 12);
+			look.m_Id = Wire::loadUint32(in + 24);
+			in += lookSize;
+		}
+
+		in = takeRecords(reader, colorSize, numRecords);
+		p_Package.m_Object3.resize(numRecords);
+		for (ObjectColorData& color : p_Package.m_Object3)
+		{
+			color.m_Color = Wire::loadVector3(in);
+			color.m_Id = Wire::loadUint32(in + 12);
+			in += colorSize;
+		}
+	}
+
+	/**
+	 * Read a record count and take that many fixed size records.
+	 *
+	 * @param p_Reader the reader positioned at the record count.
+	 * @param p_RecordSize the encoded size of one record in bytes.
+	 * @param p_NumRecords set to the number of records.
+	 * @return the first byte of the records.
+	 */
+	static const unsigned char* takeRecords(WireReader& p_Reader, size_t p_RecordSize, uint32_t& p_NumRecords)
+	{
+		p_NumRecords = p_Reader.readUint32();
+		if (p_NumRecords > p_Reader.remaining() / p_RecordSize)
+		{
+			throw NetworkError("Package data ended unexpectedly", __LINE__, __FILE__);
+		}
+		return p_Reader.take(p_NumRecords * p_RecordSize);
+	}
+};
+
+/**
+ * Compact encoding of GAME_POSITIONS.
+ *
+ * Layout: position count, then the place, a time flag and the time of each position.
+ */
+template <>
+struct PackageCodec<GamePositions>
+{
+	static const size_t positionSize = sizeof(uint32_t) + 1 + sizeof(float);
+
+	static void write(const GamePositions& p_Package, std::vector<char>& p_Output)
+	{
+		WireWriter writer(p_Output);
+		writer.writeUint32((uint32_t)p_Package.m_Object1.size());
+		unsigned char* out = writer.append(p_Package.m_Object1.size() * positionSize);
+		for (const RacePositionData& position : p_Package.m_Object1)
+		{
+			Wire::storeUint32(out, position.m_Place);
+			out[4] = position.m_HasTime ? 1 : 0;
+			Wire::storeFloat(out + 5, position.m_Time);
+			out += positionSize;
+		}
+	}
+
+	static void read(const char* p_Data, size_t p_Size, GamePositions& p_Package)
+	{
+		WireReader reader(p_Data, p_Size);
+		const uint32_t numPositions = reader.readUint32();
+		if (numPositions > reader.remaining() / positionSize)
+		{
+			throw NetworkError("Package data ended unexpectedly", __LINE__, __FILE__);
+		}
+		const unsigned char* in = reader.take(numPositions * positionSize);
+		p_Package.m_Object1.resize(numPositions);
+		for (RacePositionData& position : p_Package.m_Object1)
+		{
+			position.m_Place = Wire::loadUint32(in);
+			position.m_HasTime = in[4] != 0;
+			position.m_Time = Wire::loadFloat(in + 5);
+			in += positionSize;
+		}
+	}
+};
+
+/**
+ * Compact encoding of PLAYER_CONTROL, sent by every client each frame.
+ *
+ * Layout: version and five vectors, always the same size.
+ */
+template <>
+struct PackageCodec<PlayerControl>
+{
+	static const uint8_t version = 1;
+	static const size_t size = 1 + 5 * Wire::vector3Size;
+
+	static void write(const PlayerControl& p_Package, std::vector<char>& p_Output)
+	{
+		const PlayerControlData& data = p_Package.m_Object1;
+
+		WireWriter writer(p_Output);
+		unsigned char* out = writer.append(size);
+		out[0] = version;
+		Wire::storeVector3(out + 1, data.m_Position);
+		Wire::storeVector3(out + 13, data.m_Velocity);
+		Wire::storeVector3(out + 25, data.m_Rotation);
+		Wire::storeVector3(out + 37, data.m_Forward);
+		Wire::storeVector3(out + 49, data.m_Up);
+	}
+
+	static void read(const char* p_Data, size_t p_Size, PlayerControl& p_Package)
+	{
+		if (p_Size != size)
+		{
+			throw NetworkError("Player control package has the wrong size", __LINE__, __FILE__);
+		}
+
+		const unsigned char* in = (const unsigned char*)p_Data;
+		if (in[0] != version)
+		{
+			throw NetworkError("Unsupported player control version", __LINE__, __FILE__);
+		}
+
+		PlayerControlData& data = p_Package.m_Object1;
+		data.m_Position = Wire::loadVector3(in + 1);
+		data.m_Velocity = Wire::loadVector3(in + 13);
+		data.m_Rotation = Wire::loadVector3(in + 25);
+		data.m_Forward = Wire::loadVector3(in + 37);
+		data.m_Up = Wire::loadVector3(in + 49);
+	}
+};
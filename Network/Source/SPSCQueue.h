@@ -0,0 +1,151 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/**
+ * Unbounded lock-free queue for exactly one producer thread and one
+ * consumer thread. The consumer takes everything queued so far in one
+ * call. Nodes taken by the consumer are reused by the producer, so a
+ * queue that has reached its working size no longer allocates.
+ *
+ * @param T the type of the queued values, must be default constructible and movable.
+ */
+template <typename T>
+class SPSCQueue
+{
+private:
+	struct Node
+	{
+		std::atomic<Node*> m_Next;
+		T m_Value;
+
+		Node()
+			:	m_Next(nullptr)
+		{
+		}
+	};
+
+	/**
+	 * Size of the padding keeping the consumer and producer ends on separate cache lines.
+	 */
+	static const size_t cacheLineSize = 64;
+
+	// Consumer end, points to the last taken node, which is never read again.
+	std::atomic<Node*> m_Head;
+	char m_ConsumerPadding[cacheLineSize];
+
+	// Producer end. Nodes from m_First up to m_HeadCopy have been taken and can be reused.
+	Node* m_Tail;
+	Node* m_First;
+	Node* m_HeadCopy;
+	char m_ProducerPadding[cacheLineSize];
+
+public:
+	/**
+	 * Constructor.
+	 */
+	SPSCQueue()
+	{
+		Node* stub = new Node;
+		m_Head.store(stub, std::memory_order_relaxed);
+		m_Tail = stub;
+		m_First = stub;
+		m_HeadCopy = stub;
+	}
+
+	/**
+	 * Destructor, deletes any values still queued.
+	 */
+	~SPSCQueue()
+	{
+		Node* node = m_First;
+		while (node)
+		{
+			Node* next = node->m_Next.load(std::memory_order_relaxed);
+			delete node;
+			node = next;
+		}
+	}
+
+	/**
+	 * Add a value to the back of the queue. May only be called by the producer thread.
+	 *
+	 * @param p_Value the value to move into the queue.
+	 */
+	void push(T p_Value)
+	{
+		Node* node = allocateNode();
+		node->m_Value = std::move(p_Value);
+		node->m_Next.store(nullptr, std::memory_order_relaxed);
+
+		m_Tail->m_Next.store(node, std::memory_order_release);
+		m_Tail = node;
+	}
+
+	/**
+	 * Move every value queued so far to the back of a container, oldest first.
+	 * May only be called by the consumer thread.
+	 *
+	 * @param p_Out a container supporting push_back.
+	 * @return the number of values taken.
+	 */
+	template <typename Container>
+	size_t takeAll(Container& p_Out)
+	{
+		Node* head = m_Head.load(std::memory_order_relaxed);
+		size_t numTaken = 0;
+
+		Node* next = head->m_Next.load(std::memory_order_acquire);
+		while (next)
+		{
+			p_Out.push_back(std::move(next->m_Value));
+			head = next;
+			++numTaken;
+
+			next = head->m_Next.load(std::memory_order_acquire);
+		}
+
+		if (numTaken > 0)
+		{
+			// Hands the taken nodes back to the producer.
+			m_Head.store(head, std::memory_order_release);
+		}
+		return numTaken;
+	}
+
+	/**
+	 * Check if anything is queued. May only be called by the consumer thread.
+	 *
+	 * @return true if there is nothing to take.
+	 */
+	bool empty() const
+	{
+		return m_Head.load(std::memory_order_relaxed)->m_Next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	SPSCQueue(const SPSCQueue&);
+	SPSCQueue& operator=(const SPSCQueue&);
+
+	Node* allocateNode()
+	{
+		if (m_First == m_HeadCopy)
+		{
+			m_HeadCopy = m_Head.load(std::memory_order_acquire);
+		}
+
+		if (m_First != m_HeadCopy)
+		{
+			Node* node = m_First;
+			m_First = m_First->m_Next.load(std::memory_order_relaxed);
+			return node;
+		}
+
+		return new Node;
+	}
+};
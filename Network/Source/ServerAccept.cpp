@@ -13,7 +13,9 @@ ServerAccept::ServerAccept(boost::asio::io_service& p_IO_Service, unsigned short
 			m_PackagePrototypes(p_Prototypes),
 			m_IO_Service(p_IO_Service),
 			m_ClientConnected(nullptr),
-			m_ClientDisconnected(nullptr)
+			m_ClientDisconnected(nullptr),
+			m_UseDatagrams(false),
+			m_TokenRandom(std::random_device()())
 {
 	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Creating server acceptor");
 }
@@ -32,6 +34,20 @@ void ServerAccept::startServer(unsigned int p_NumThreads)
 {
 	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Starting server acceptor");
 
+	if (m_UseDatagrams)
+	{
+		try
+		{
+			m_Datagrams.reset(new DatagramSocket(m_IO_Service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), m_PortNumber)));
+			m_Datagrams->startReceiving();
+		}
+		catch (boost::system::system_error& err)
+		{
+			NetworkLogger::log(NetworkLogger::Level::WARNING, std::string("Datagram channels disabled: ") + err.what());
+			m_Datagrams.reset();
+		}
+	}
+
 	try
 	{
 		m_Acceptor.async_accept(m_AcceptSocket, std::bind( &ServerAccept::handleAccept, this, std::placeholders::_1));
@@ -56,6 +72,11 @@ void ServerAccept::stopServer()
 		m_ConnectedClients.clear();
 	}
 
+	if (m_Datagrams)
+	{
+		m_Datagrams->close();
+	}
+
 	m_Running = false;
 	m_IO_Service.stop();
 
@@ -64,6 +85,12 @@ void ServerAccept::stopServer()
 		thread.join();
 	}
 	m_WorkerThreads.clear();
+	m_Datagrams.reset();
+}
+
+void ServerAccept::setDatagramsEnabled(bool p_Enabled)
+{
+	m_UseDatagrams = p_Enabled;
 }
 
 void ServerAccept::setConnectedCallback(INetwork::clientConnectedCallback_t p_ConnectCallback, void* p_UserData)
@@ -98,6 +125,11 @@ void ServerAccept::handleAccept( const boost::system::error_code& error)
 
 	clientConnection->setDisconnectedCallback(std::bind(&ServerAccept::handleDisconnectCallback, this, clientConnection.get()));
 
+	if (m_Datagrams)
+	{
+		clientConnection->offerDatagramChannel(m_Datagrams->createChannel(createDatagramToken()), m_Datagrams->getLocalPort());
+	}
+
 	if (m_ClientConnected)
 	{
 		m_ClientConnected(clientConnection.get(), m_ClientConnectedUserData);
@@ -167,6 +199,29 @@ void ServerAccept::handleDisconnectCallback(ConnectionController* p_Connection)
 	m_IO_Service.post(std::bind(&ServerAccept::removeClient, this, p_Connection));
 }
 
+ConnectionMetrics ServerAccept::getMetrics()
+{
+	ConnectionMetrics metrics = ConnectionMetrics();
+
+	std::unique_lock<std::mutex> lock(m_ClientLock);
+	for (auto& client : m_ConnectedClients)
+	{
+		addConnectionMetrics(metrics, client->getMetrics());
+	}
+
+	return metrics;
+}
+
+uint32_t ServerAccept::createDatagramToken()
+{
+	uint32_t token = 0;
+	while (token == 0)
+	{
+		token = m_TokenRandom();
+	}
+	return token;
+}
+
 void ServerAccept::removeClient(ConnectionController* p_Connection)
 {
 	NetworkLogger::log(NetworkLogger::Level::DEBUG_L, "Removing client connection from server");
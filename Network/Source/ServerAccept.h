@@ -9,12 +9,14 @@
 
 #include "Connection.h"
 #include "ConnectionController.h"
+#include "DatagramSocket.h"
 #include "Packages.h"
 
 #include <atomic>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <mutex>
+#include <random>
 
 /**
  * Represents the server part of the network.
@@ -45,6 +47,10 @@ private:
 	std::mutex m_ClientLock;
 	std::vector<ConnectionController::ptr> m_ConnectedClients;
 
+	bool m_UseDatagrams;
+	DatagramSocket::ptr m_Datagrams;
+	std::mt19937 m_TokenRandom;
+
 public:
 	/**
 	 * Constructor.
@@ -85,6 +91,15 @@ public:
 	 */
 	void stopServer();
 
+	/**
+	 * Enable datagram channels. When enabled, every client is offered a
+	 * datagram channel on the server port for frequent state packages.
+	 * Must be called before the server is started.
+	 *
+	 * @param p_Enabled true to offer datagram channels, disabled by default.
+	 */
+	void setDatagramsEnabled(bool p_Enabled);
+
 	/**
 	 * Set a callback for when a new client has connected to the server.
 	 *
@@ -105,6 +120,13 @@ public:
 	 */
 	void setDisconnectedCallback(INetwork::clientDisconnectedCallback_t p_DisconnectCallback, void* p_UserData);
 
+	/**
+	 * Get the combined metrics of every connected client.
+	 *
+	 * @return the metrics of all client connections.
+	 */
+	ConnectionMetrics getMetrics();
+
 	/**
 	* Check if there has occured an error with the acceptor.
 	*
@@ -118,4 +140,5 @@ private:
 	void IO_Run();
 	void handleDisconnectCallback(ConnectionController* p_Connection);
 	void removeClient(ConnectionController* p_Connection);
+	uint32_t createDatagramToken();
 };
\ No newline at end of file
@@ -0,0 +1,444 @@
+#include "Snapshot.h"
+
+#include "NetworkLogger.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+	const uint8_t snapshotVersion = 2;
+
+	bool lessById(const QuantizedObject& p_Left, const QuantizedObject& p_Right)
+	{
+		return p_Left.m_Id < p_Right.m_Id;
+	}
+
+	int32_t quantize(float p_Value, float p_Scale)
+	{
+		const double scaled = std::floor((double)p_Value * p_Scale + 0.5);
+		if (scaled > INT_MAX)
+			return INT_MAX;
+		if (scaled < INT_MIN)
+			return INT_MIN;
+		return (int32_t)scaled;
+	}
+
+	float dequantize(int32_t p_Value, float p_Scale)
+	{
+		return (float)p_Value / p_Scale;
+	}
+
+	uint32_t zigzag(int32_t p_Value)
+	{
+		return ((uint32_t)p_Value << 1) ^ (uint32_t)(p_Value >> 31);
+	}
+
+	int32_t unzigzag(uint32_t p_Value)
+	{
+		return (int32_t)(p_Value >> 1) ^ -(int32_t)(p_Value & 1);
+	}
+
+	QuantizedObject quantizeObject(const UpdateObjectData& p_Data, float p_Scale)
+	{
+		const Vector3* groups[QuantizedObject::numGroups] =
+		{
+			&p_Data.m_Position,
+			&p_Data.m_Velocity,
+			&p_Data.m_Rotation,
+			&p_Data.m_RotationVelocity,
+		};
+
+		QuantizedObject object;
+		object.m_Id = p_Data.m_Id;
+		for (unsigned int i = 0; i < QuantizedObject::numGroups; ++i)
+		{
+			object.m_Values[i * 3 + 0] = quantize(groups[i]->x, p_Scale);
+			object.m_Values[i * 3 + 1] = quantize(groups[i]->y, p_Scale);
+			object.m_Values[i * 3 + 2] = quantize(groups[i]->z, p_Scale);
+		}
+		return object;
+	}
+
+	UpdateObjectData dequantizeObject(const QuantizedObject& p_Object, float p_Scale)
+	{
+		Vector3 groups[QuantizedObject::numGroups];
+		for (unsigned int i = 0; i < QuantizedObject::numGroups; ++i)
+		{
+			groups[i] = Vector3(
+				dequantize(p_Object.m_Values[i * 3 + 0], p_Scale),
+				dequantize(p_Object.m_Values[i * 3 + 1], p_Scale),
+				dequantize(p_Object.m_Values[i * 3 + 2], p_Scale));
+		}
+
+		UpdateObjectData data;
+		data.m_Position = groups[0];
+		data.m_Velocity = groups[1];
+		data.m_Rotation = groups[2];
+		data.m_RotationVelocity = groups[3];
+		data.m_Id = p_Object.m_Id;
+		return data;
+	}
+
+	uint8_t changeMask(const QuantizedObject& p_Object, const QuantizedObject* p_Baseline)
+	{
+		uint8_t mask = 0;
+		for (unsigned int i = 0; i < QuantizedObject::numGroups; ++i)
+		{
+			for (unsigned int j = i * 3; j < i * 3 + 3; ++j)
+			{
+				const int32_t base = p_Baseline ? p_Baseline->m_Values[j] : 0;
+				if (p_Object.m_Values[j] != base)
+				{
+					mask |= 1 << i;
+					break;
+				}
+			}
+		}
+		return mask;
+	}
+
+	bool sameVector(const Vector3& p_Left, const Vector3& p_Right)
+	{
+		return p_Left.x == p_Right.x && p_Left.y == p_Right.y && p_Left.z == p_Right.z;
+	}
+
+	bool sameLook(const ObjectLookData& p_Left, const ObjectLookData& p_Right)
+	{
+		return p_Left.m_Id == p_Right.m_Id
+			&& sameVector(p_Left.m_Forward, p_Right.m_Forward)
+			&& sameVector(p_Left.m_Up, p_Right.m_Up);
+	}
+
+	bool sameColor(const ObjectColorData& p_Left, const ObjectColorData& p_Right)
+	{
+		return p_Left.m_Id == p_Right.m_Id && sameVector(p_Left.m_Color, p_Right.m_Color);
+	}
+
+	/**
+	 * Find the records that are not part of the baseline.
+	 */
+	template <typename Record, typename Equal>
+	std::vector<const Record*> findNewRecords(const std::vector<Record>& p_Records,
+		const std::vector<Record>* p_Baseline, Equal p_Equal)
+	{
+		std::vector<const Record*> newRecords;
+		for (const Record& record : p_Records)
+		{
+			bool acknowledged = false;
+			if (p_Baseline)
+			{
+				for (const Record& base : *p_Baseline)
+				{
+					if (p_Equal(record, base))
+					{
+						acknowledged = true;
+						break;
+					}
+				}
+			}
+
+			if (!acknowledged)
+			{
+				newRecords.push_back(&record);
+			}
+		}
+		return newRecords;
+	}
+
+	const QuantizedObject* findObject(const std::vector<QuantizedObject>& p_Objects, uint32_t p_Id)
+	{
+		QuantizedObject key;
+		key.m_Id = p_Id;
+		std::vector<QuantizedObject>::const_iterator it = std::lower_bound(p_Objects.begin(), p_Objects.end(), key, lessById);
+		if (it == p_Objects.end() || it->m_Id != p_Id)
+		{
+			return nullptr;
+		}
+		return &*it;
+	}
+}
+
+SnapshotEncoder::SnapshotEncoder()
+	:	m_NextSequence(1),
+		m_AckedSequence(0),
+		m_Precision(0.01f)
+{
+}
+
+void SnapshotEncoder::setPrecision(float p_Precision)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	m_Precision = p_Precision;
+	m_History.clear();
+	m_AckedSequence = 0;
+}
+
+void SnapshotEncoder::encode(const UpdateObjectData* p_Objects, unsigned int p_NumObjects,
+	const ObjectLookData* p_Looks, unsigned int p_NumLooks,
+	const ObjectColorData* p_Colors, unsigned int p_NumColors, std::vector<char>& p_Output)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	const float scale = 1.f / m_Precision;
+
+	SnapshotState state;
+	state.m_Sequence = m_NextSequence++;
+	state.m_Objects.reserve(p_NumObjects);
+	for (unsigned int i = 0; i < p_NumObjects; ++i)
+	{
+		state.m_Objects.push_back(quantizeObject(p_Objects[i], scale));
+	}
+	std::sort(state.m_Objects.begin(), state.m_Objects.end(), lessById);
+	state.m_Looks.assign(p_Looks, p_Looks + p_NumLooks);
+	state.m_Colors.assign(p_Colors, p_Colors + p_NumColors);
+
+	const SnapshotState* baseline = findState(m_AckedSequence);
+	static const std::vector<QuantizedObject> noObjects;
+	const std::vector<QuantizedObject>& baseObjects = baseline ? baseline->m_Objects : noObjects;
+
+	std::vector<std::pair<const QuantizedObject*, const QuantizedObject*>> changed;
+	std::vector<uint32_t> removed;
+	size_t baseIndex = 0;
+	for (const QuantizedObject& object : state.m_Objects)
+	{
+		while (baseIndex < baseObjects.size() && baseObjects[baseIndex].m_Id < object.m_Id)
+		{
+			removed.push_back(baseObjects[baseIndex++].m_Id);
+		}
+
+		const QuantizedObject* base = nullptr;
+		if (baseIndex < baseObjects.size() && baseObjects[baseIndex].m_Id == object.m_Id)
+		{
+			base = &baseObjects[baseIndex++];
+		}
+
+		if (!base || changeMask(object, base) != 0)
+		{
+			changed.push_back(std::make_pair(&object, base));
+		}
+	}
+	for (; baseIndex < baseObjects.size(); ++baseIndex)
+	{
+		removed.push_back(baseObjects[baseIndex].m_Id);
+	}
+
+	WireWriter writer(p_Output);
+	writer.writeUint8(snapshotVersion);
+	writer.writeUint32(state.m_Sequence);
+	writer.writeUint32(baseline ? baseline->m_Sequence : 0);
+	writer.writeFloat(m_Precision);
+
+	writer.writeVarUint32((uint32_t)changed.size());
+	for (const auto& change : changed)
+	{
+		const QuantizedObject& object = *change.first;
+		const uint8_t mask = changeMask(object, change.second);
+
+		writer.writeVarUint32(object.m_Id);
+		writer.writeUint8(mask);
+		for (unsigned int i = 0; i < QuantizedObject::numGroups; ++i)
+		{
+			if (!(mask & (1 << i)))
+				continue;
+
+			for (unsigned int j = i * 3; j < i * 3 + 3; ++j)
+			{
+				const int32_t base = change.second ? change.second->m_Values[j] : 0;
+				writer.writeVarUint32(zigzag(object.m_Values[j] - base));
+			}
+		}
+	}
+
+	writer.writeVarUint32((uint32_t)removed.size());
+	for (uint32_t id : removed)
+	{
+		writer.writeVarUint32(id);
+	}
+
+	const std::vector<const ObjectLookData*> newLooks =
+		findNewRecords(state.m_Looks, baseline ? &baseline->m_Looks : nullptr, sameLook);
+	writer.writeVarUint32((uint32_t)newLooks.size());
+	for (const ObjectLookData* look : newLooks)
+	{
+		writer.writeVarUint32(look->m_Id);
+		writer.writeVector3(look->m_Forward);
+		writer.writeVector3(look->m_Up);
+	}
+
+	const std::vector<const ObjectColorData*> newColors =
+		findNewRecords(state.m_Colors, baseline ? &baseline->m_Colors : nullptr, sameColor);
+	writer.writeVarUint32((uint32_t)newColors.size());
+	for (const ObjectColorData* color : newColors)
+	{
+		writer.writeVarUint32(color->m_Id);
+		writer.writeVector3(color->m_Color);
+	}
+
+	m_History.push_back(std::move(state));
+	if (m_History.size() > maxHistory)
+	{
+		m_History.pop_front();
+	}
+}
+
+void SnapshotEncoder::acknowledge(uint32_t p_Sequence)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	if (p_Sequence <= m_AckedSequence || p_Sequence >= m_NextSequence)
+	{
+		return;
+	}
+
+	m_AckedSequence = p_Sequence;
+	while (!m_History.empty() && m_History.front().m_Sequence < m_AckedSequence)
+	{
+		m_History.pop_front();
+	}
+}
+
+uint32_t SnapshotEncoder::getAckedSequence()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_AckedSequence;
+}
+
+const SnapshotState* SnapshotEncoder::findState(uint32_t p_Sequence) const
+{
+	if (p_Sequence == 0)
+	{
+		return nullptr;
+	}
+
+	for (const SnapshotState& state : m_History)
+	{
+		if (state.m_Sequence == p_Sequence)
+		{
+			return &state;
+		}
+	}
+	return nullptr;
+}
+
+std::unique_ptr<UpdateObjects> SnapshotDecoder::decode(const char* p_Data, size_t p_Size, uint32_t& p_Sequence)
+{
+	WireReader reader(p_Data, p_Size);
+	if (reader.readUint8() != snapshotVersion)
+	{
+		throw NetworkError("Unsupported snapshot version", __LINE__, __FILE__);
+	}
+
+	SnapshotState state;
+	state.m_Sequence = reader.readUint32();
+	p_Sequence = state.m_Sequence;
+	const uint32_t baselineSequence = reader.readUint32();
+	const float precision = reader.readFloat();
+	if (!(precision > 0.f))
+	{
+		throw NetworkError("Invalid snapshot precision", __LINE__, __FILE__);
+	}
+	const float scale = 1.f / precision;
+
+	if (baselineSequence != 0)
+	{
+		const SnapshotState* baseline = findState(baselineSequence);
+		if (!baseline)
+		{
+			NetworkLogger::log(NetworkLogger::Level::WARNING, "Snapshot " + std::to_string(state.m_Sequence)
+				+ " refers to unknown baseline " + std::to_string(baselineSequence) + ", dropping it");
+			return std::unique_ptr<UpdateObjects>();
+		}
+		state.m_Objects = baseline->m_Objects;
+	}
+
+	const uint32_t numChanged = reader.readVarUint32();
+	for (uint32_t i = 0; i < numChanged; ++i)
+	{
+		QuantizedObject key;
+		key.m_Id = reader.readVarUint32();
+		std::vector<QuantizedObject>::iterator object = std::lower_bound(state.m_Objects.begin(), state.m_Objects.end(), key, lessById);
+		if (object == state.m_Objects.end() || object->m_Id != key.m_Id)
+		{
+			std::fill(key.m_Values, key.m_Values + QuantizedObject::numGroups * 3, 0);
+			object = state.m_Objects.insert(object, key);
+		}
+
+		const uint8_t mask = reader.readUint8();
+		for (unsigned int group = 0; group < QuantizedObject::numGroups; ++group)
+		{
+			if (!(mask & (1 << group)))
+				continue;
+
+			for (unsigned int j = group * 3; j < group * 3 + 3; ++j)
+			{
+				object->m_Values[j] += unzigzag(reader.readVarUint32());
+			}
+		}
+	}
+
+	const uint32_t numRemoved = reader.readVarUint32();
+	for (uint32_t i = 0; i < numRemoved; ++i)
+	{
+		QuantizedObject key;
+		key.m_Id = reader.readVarUint32();
+		std::vector<QuantizedObject>::iterator object = std::lower_bound(state.m_Objects.begin(), state.m_Objects.end(), key, lessById);
+		if (object != state.m_Objects.end() && object->m_Id == key.m_Id)
+		{
+			state.m_Objects.erase(object);
+		}
+	}
+
+	std::unique_ptr<UpdateObjects> package(new UpdateObjects);
+	const uint32_t numLooks = reader.readVarUint32();
+	for (uint32_t i = 0; i < numLooks; ++i)
+	{
+		ObjectLookData look;
+		look.m_Id = reader.readVarUint32();
+		look.m_Forward = reader.readVector3();
+		look.m_Up = reader.readVector3();
+		package->m_Object2.push_back(look);
+	}
+
+	const uint32_t numColors = reader.readVarUint32();
+	for (uint32_t i = 0; i < numColors; ++i)
+	{
+		ObjectColorData color;
+		color.m_Id = reader.readVarUint32();
+		color.m_Color = reader.readVector3();
+		package->m_Object3.push_back(color);
+	}
+
+	package->m_Object1.reserve(state.m_Objects.size());
+	for (const QuantizedObject& object : state.m_Objects)
+	{
+		package->m_Object1.push_back(dequantizeObject(object, scale));
+	}
+
+	// The sender only builds on acknowledged snapshots, and acknowledgements only move forward.
+	while (!m_History.empty() && m_History.front().m_Sequence < baselineSequence)
+	{
+		m_History.pop_front();
+	}
+	m_History.push_back(std::move(state));
+	if (m_History.size() > SnapshotEncoder::maxHistory)
+	{
+		m_History.pop_front();
+	}
+
+	return package;
+}
+
+const SnapshotState* SnapshotDecoder::findState(uint32_t p_Sequence) const
+{
+	for (const SnapshotState& state : m_History)
+	{
+		if (state.m_Sequence == p_Sequence)
+		{
+			return &state;
+		}
+	}
+	return nullptr;
+}
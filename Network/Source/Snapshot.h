@@ -0,0 +1,164 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include "Packages.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Quantized state of one replicated object. The values are position,
+ * velocity, rotation and rotation velocity, three components each,
+ * stored as multiples of the snapshot precision.
+ */
+struct QuantizedObject
+{
+	/**
+	 * Number of value groups, one bit each in the change mask.
+	 */
+	static const unsigned int numGroups = 4;
+
+	uint32_t m_Id;
+	int32_t m_Values[numGroups * 3];
+};
+
+/**
+ * The object states of one snapshot, sorted by id.
+ */
+struct SnapshotState
+{
+	uint32_t m_Sequence;
+	std::vector<QuantizedObject> m_Objects;
+	std::vector<ObjectLookData> m_Looks;
+	std::vector<ObjectColorData> m_Colors;
+};
+
+/**
+ * Encodes object updates for one receiver as deltas against the last
+ * snapshot the receiver has acknowledged. Values are quantized before
+ * comparison, so changes smaller than the precision are not sent.
+ * When the acknowledged snapshot is no longer available, a full
+ * snapshot is sent instead.
+ *
+ * Thread safe, acknowledgements usually arrive on the network thread.
+ */
+class SnapshotEncoder
+{
+public:
+	/**
+	 * Number of unacknowledged snapshots kept as potential baselines.
+	 */
+	static const size_t maxHistory = 64;
+
+private:
+	std::mutex m_Lock;
+	std::deque<SnapshotState> m_History;
+	uint32_t m_NextSequence;
+	uint32_t m_AckedSequence;
+	float m_Precision;
+
+public:
+	/**
+	 * Constructor.
+	 */
+	SnapshotEncoder();
+
+	/**
+	 * Set the quantization step used for all values. Changing the
+	 * precision forces the next snapshot to be a full snapshot.
+	 *
+	 * @param p_Precision the smallest difference that is replicated, larger than 0.
+	 */
+	void setPrecision(float p_Precision);
+
+	/**
+	 * Encode a snapshot of the current object states.
+	 *
+	 * @param p_Objects the states of all replicated objects.
+	 * @param p_NumObjects the number of objects.
+	 * @param p_Looks look directions, only sent if not already acknowledged.
+	 * @param p_NumLooks the number of look directions.
+	 * @param p_Colors color changes, only sent if not already acknowledged.
+	 * @param p_NumColors the number of color changes.
+	 * @param p_Output the vector to append the encoded snapshot to.
+	 */
+	void encode(const UpdateObjectData* p_Objects, unsigned int p_NumObjects,
+		const ObjectLookData* p_Looks, unsigned int p_NumLooks,
+		const ObjectColorData* p_Colors, unsigned int p_NumColors, std::vector<char>& p_Output);
+
+	/**
+	 * Mark a snapshot as received, making it the baseline for following snapshots.
+	 *
+	 * @param p_Sequence the sequence number of the received snapshot.
+	 */
+	void acknowledge(uint32_t p_Sequence);
+
+	/**
+	 * Get the sequence number of the last acknowledged snapshot.
+	 *
+	 * @return the sequence number, or 0 if none has been acknowledged.
+	 */
+	uint32_t getAckedSequence();
+
+private:
+	const SnapshotState* findState(uint32_t p_Sequence) const;
+};
+
+/**
+ * Rebuilds the full object states from snapshots encoded by a SnapshotEncoder.
+ *
+ * Not thread safe, all snapshots are expected to arrive on the same thread.
+ */
+class SnapshotDecoder
+{
+private:
+	std::deque<SnapshotState> m_History;
+
+public:
+	/**
+	 * Decode a snapshot.
+	 *
+	 * @param p_Data the first byte of the encoded snapshot.
+	 * @param p_Size the size of the encoded snapshot in bytes.
+	 * @param p_Sequence set to the sequence number of the snapshot, to be acknowledged.
+	 * @return an update package with the state of every object in the snapshot
+	 *			and the looks and colors that changed, or an empty pointer if the
+	 *			baseline of the snapshot is not available.
+	 */
+	std::unique_ptr<UpdateObjects> decode(const char* p_Data, size_t p_Size, uint32_t& p_Sequence);
+
+private:
+	const SnapshotState* findState(uint32_t p_Sequence) const;
+};
+
+/**
+ * A package acknowledging a received object snapshot.
+ */
+typedef Package1Obj<PackageType::SNAPSHOT_ACK, uint32_t> SnapshotAck;
+
+/**
+ * Compact encoding of SNAPSHOT_ACK, sent for every received snapshot.
+ */
+template <>
+struct PackageCodec<SnapshotAck>
+{
+	static const size_t size = sizeof(uint32_t);
+
+	static void write(const SnapshotAck& p_Package, std::vector<char>& p_Output)
+	{
+		WireWriter writer(p_Output);
+		writer.writeUint32(p_Package.m_Object1);
+	}
+
+	static void read(const char* p_Data, size_t p_Size, SnapshotAck& p_Package)
+	{
+		WireReader reader(p_Data, p_Size);
+		p_Package.m_Object1 = reader.readUint32();
+	}
+};
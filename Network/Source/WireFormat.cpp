@@ -0,0 +1,133 @@
+#include "WireFormat.h"
+
+#include <NetworkExceptions.h>
+
+WireWriter::WireWriter(std::vector<char>& p_Output)
+	:	m_Output(p_Output)
+{
+}
+
+void WireWriter::reserve(size_t p_Size)
+{
+	m_Output.reserve(m_Output.size() + p_Size);
+}
+
+unsigned char* WireWriter::append(size_t p_Size)
+{
+	const size_t position = m_Output.size();
+	m_Output.resize(position + p_Size);
+	return (unsigned char*)m_Output.data() + position;
+}
+
+void WireWriter::writeUint8(uint8_t p_Value)
+{
+	m_Output.push_back((char)p_Value);
+}
+
+void WireWriter::writeUint16(uint16_t p_Value)
+{
+	Wire::storeUint16(append(2), p_Value);
+}
+
+void WireWriter::writeUint32(uint32_t p_Value)
+{
+	Wire::storeUint32(append(4), p_Value);
+}
+
+void WireWriter::writeFloat(float p_Value)
+{
+	Wire::storeFloat(append(4), p_Value);
+}
+
+void WireWriter::writeVector3(const Vector3& p_Value)
+{
+	Wire::storeVector3(append(Wire::vector3Size), p_Value);
+}
+
+void WireWriter::writeVarUint32(uint32_t p_Value)
+{
+	while (p_Value >= 0x80)
+	{
+		m_Output.push_back((char)((p_Value & 0x7f) | 0x80));
+		p_Value >>= 7;
+	}
+	m_Output.push_back((char)p_Value);
+}
+
+void WireWriter::writeString(const std::string& p_Value)
+{
+	writeUint32((uint32_t)p_Value.size());
+	m_Output.insert(m_Output.end(), p_Value.begin(), p_Value.end());
+}
+
+WireReader::WireReader(const char* p_Data, size_t p_Size)
+	:	m_Data(p_Data),
+		m_Size(p_Size),
+		m_Position(0)
+{
+}
+
+const unsigned char* WireReader::take(size_t p_Size)
+{
+	if (p_Size > remaining())
+	{
+		throw NetworkError("Package data ended unexpectedly", __LINE__, __FILE__);
+	}
+
+	const unsigned char* value = (const unsigned char*)m_Data + m_Position;
+	m_Position += p_Size;
+	return value;
+}
+
+uint8_t WireReader::readUint8()
+{
+	return *take(1);
+}
+
+uint16_t WireReader::readUint16()
+{
+	return Wire::loadUint16(take(2));
+}
+
+uint32_t WireReader::readUint32()
+{
+	return Wire::loadUint32(take(4));
+}
+
+float WireReader::readFloat()
+{
+	return Wire::loadFloat(take(4));
+}
+
+Vector3 WireReader::readVector3()
+{
+	return Wire::loadVector3(take(Wire::vector3Size));
+}
+
+uint32_t WireReader::readVarUint32()
+{
+	uint32_t value = 0;
+	for (unsigned int shift = 0; shift < 35; shift += 7)
+	{
+		const uint8_t byte = readUint8();
+		value |= (uint32_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			return value;
+		}
+	}
+
+	throw NetworkError("Malformed variable length value", __LINE__, __FILE__);
+}
+
+std::string WireReader::readString()
+{
+	const uint32_t length = readUint32();
+	const char* characters = (const char*)take(length);
+	return std::string(characters, length);
+}
+
+size_t WireReader::remaining() const
+{
+	return m_Size - m_Position;
+}
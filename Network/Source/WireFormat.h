@@ -0,0 +1,179 @@
+/**
+ * File comment.
+ */
+
+#pragma once
+
+#include <CommonTypes.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Functions storing and loading values in a fixed little-endian layout,
+ * independent of the host byte order and structure padding.
+ */
+namespace Wire
+{
+	/**
+	 * Encoded size of a Vector3 in bytes.
+	 */
+	static const size_t vector3Size = 3 * sizeof(float);
+
+	inline void storeUint16(unsigned char* p_Out, uint16_t p_Value)
+	{
+		p_Out[0] = (unsigned char)(p_Value & 0xff);
+		p_Out[1] = (unsigned char)(p_Value >> 8);
+	}
+
+	inline void storeUint32(unsigned char* p_Out, uint32_t p_Value)
+	{
+		p_Out[0] = (unsigned char)(p_Value & 0xff);
+		p_Out[1] = (unsigned char)((p_Value >> 8) & 0xff);
+		p_Out[2] = (unsigned char)((p_Value >> 16) & 0xff);
+		p_Out[3] = (unsigned char)(p_Value >> 24);
+	}
+
+	inline void storeFloat(unsigned char* p_Out, float p_Value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &p_Value, sizeof(bits));
+		storeUint32(p_Out, bits);
+	}
+
+	inline void storeVector3(unsigned char* p_Out, const Vector3& p_Value)
+	{
+		storeFloat(p_Out, p_Value.x);
+		storeFloat(p_Out + 4, p_Value.y);
+		storeFloat(p_Out + 8, p_Value.z);
+	}
+
+	inline uint16_t loadUint16(const unsigned char* p_In)
+	{
+		return (uint16_t)(p_In[0] | (p_In[1] << 8));
+	}
+
+	inline uint32_t loadUint32(const unsigned char* p_In)
+	{
+		return (uint32_t)p_In[0]
+			| ((uint32_t)p_In[1] << 8)
+			| ((uint32_t)p_In[2] << 16)
+			| ((uint32_t)p_In[3] << 24);
+	}
+
+	inline float loadFloat(const unsigned char* p_In)
+	{
+		const uint32_t bits = loadUint32(p_In);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	inline Vector3 loadVector3(const unsigned char* p_In)
+	{
+		return Vector3(loadFloat(p_In), loadFloat(p_In + 4), loadFloat(p_In + 8));
+	}
+}
+
+/**
+ * Appends values to a byte vector in the wire layout.
+ */
+class WireWriter
+{
+private:
+	std::vector<char>& m_Output;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_Output the vector to append to, must outlive the writer.
+	 */
+	explicit WireWriter(std::vector<char>& p_Output);
+
+	/**
+	 * Make room for at least a number of additional bytes.
+	 *
+	 * @param p_Size the number of bytes about to be written.
+	 */
+	void reserve(size_t p_Size);
+
+	/**
+	 * Grow the output by a block of bytes to fill with the Wire store functions.
+	 * Lets fixed size records be written without a size check per value.
+	 *
+	 * @param p_Size the size of the block.
+	 * @return the first byte of the block, valid until the output grows again.
+	 */
+	unsigned char* append(size_t p_Size);
+
+	void writeUint8(uint8_t p_Value);
+	void writeUint16(uint16_t p_Value);
+	void writeUint32(uint32_t p_Value);
+	void writeFloat(float p_Value);
+	void writeVector3(const Vector3& p_Value);
+
+	/**
+	 * Write an unsigned value using as few bytes as possible,
+	 * seven bits per byte with the high bit marking that more bytes follow.
+	 *
+	 * @param p_Value the value to write.
+	 */
+	void writeVarUint32(uint32_t p_Value);
+
+	/**
+	 * Write a string as a 32 bit length followed by the characters.
+	 *
+	 * @param p_Value the string to write.
+	 */
+	void writeString(const std::string& p_Value);
+
+private:
+	WireWriter& operator=(const WireWriter&);
+};
+
+/**
+ * Reads values written by a WireWriter from a block of memory.
+ *
+ * Throws NetworkError if the data ends before a value is complete.
+ */
+class WireReader
+{
+private:
+	const char* m_Data;
+	size_t m_Size;
+	size_t m_Position;
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param p_Data the first byte to read, must outlive the reader.
+	 * @param p_Size the number of bytes available.
+	 */
+	WireReader(const char* p_Data, size_t p_Size);
+
+	/**
+	 * Consume a block of bytes to read with the Wire load functions.
+	 *
+	 * @param p_Size the size of the block.
+	 * @return the first byte of the block.
+	 */
+	const unsigned char* take(size_t p_Size);
+
+	uint8_t readUint8();
+	uint16_t readUint16();
+	uint32_t readUint32();
+	float readFloat();
+	Vector3 readVector3();
+	uint32_t readVarUint32();
+	std::string readString();
+
+	/**
+	 * @return the number of bytes not yet read.
+	 */
+	size_t remaining() const;
+};
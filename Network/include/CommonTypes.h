@@ -42,6 +42,17 @@ enum class PackageType : uint16_t
 	THROW_SPELL,
 	START_COUNTDOWN,
 	DONE_COUNTDOWN,
+	OBJECT_SNAPSHOT,
+	SNAPSHOT_ACK,
+	DATAGRAM_OFFER,
+	DATAGRAM_HELLO,
+	DATAGRAM_READY,
+	LEVEL_INFO,
+	LEVEL_REQUEST,
+	LEVEL_CHUNK,
+	LEVEL_CHUNK_ACK,
+	PING,
+	PONG,
 };
 
 struct ObjectInstance
@@ -59,6 +70,36 @@ struct UpdateObjectData
 	uint32_t m_Id;
 };
 
+/**
+ * The look direction of an object, sent along with object updates.
+ */
+struct ObjectLookData
+{
+	Vector3 m_Forward;
+	Vector3 m_Up;
+	uint32_t m_Id;
+};
+
+/**
+ * A new color of an object, sent along with object updates.
+ */
+struct ObjectColorData
+{
+	Vector3 m_Color;
+	uint32_t m_Id;
+};
+
+/**
+ * The place of a player in the race, and optionally the time
+ * difference to the leading player.
+ */
+struct RacePositionData
+{
+	uint32_t m_Place;
+	float m_Time;
+	bool m_HasTime;
+};
+
 struct PlayerControlData
 {
 	Vector3 m_Position;
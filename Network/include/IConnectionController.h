@@ -4,6 +4,20 @@
 #pragma once
 
 #include <CommonTypes.h>
+#include <NetworkMetrics.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * A package encoded once, ready to be sent on any number of connections.
+ * Opaque outside of the network library.
+ */
+class PackageFrame;
+/**
+ * Shared, immutable handle to an encoded package.
+ */
+typedef std::shared_ptr<const PackageFrame> SharedFrame;
 
 /**
  * Interface for using a network connnection.
@@ -13,6 +27,11 @@
 class IConnectionController
 {
 public:
+	/**
+	 * Callback for packages ready to be taken with getNumPackages.
+	 */
+	typedef void (*packagesReceivedCallback_t)(IConnectionController* p_Connection, void* p_UserData);
+
 	/**
 	 *
 	 */
@@ -33,8 +52,11 @@ public:
 	virtual bool hasError() const = 0;
 
 	/**
-	 * Get the number of packages currently stored. Use with caution,
-	 * as it is updated asynchronously.
+	 * Get the number of packages currently stored. Packages received since
+	 * the last call are taken into storage as one batch, after which the
+	 * stored packages only change through clearPackages.
+	 *
+	 * The stored packages must only be accessed from one thread at a time.
 	 *
 	 * @return the number of packages waiting.
 	 */
@@ -58,6 +80,59 @@ public:
 	 *			Should not be larger than the number of stored packages.
 	 */
 	virtual void clearPackages(unsigned int p_NumPackages) = 0;
+	/**
+	 * Set a callback to get notified when new packages have been received,
+	 * as an alternative to polling getNumPackages.
+	 *
+	 * The callback is called from a network thread and should not do more
+	 * than waking the thread handling the packages. Once the callback has
+	 * been replaced, the previous callback is no longer running.
+	 *
+	 * @param p_ReceivedCallback a callback to handle received packages. Null to disable callback.
+	 * @param p_UserData user defined data to be passed unmodified to the callback.
+	 */
+	virtual void setPackagesReceivedCallback(packagesReceivedCallback_t p_ReceivedCallback, void* p_UserData) = 0;
+	/**
+	 * Serialize a received package, for example to record it.
+	 *
+	 * @param p_Package a valid reference to a package.
+	 * @param p_Output a vector to append the serialized package to.
+	 */
+	virtual void writePackageData(Package p_Package, std::vector<char>& p_Output) = 0;
+	/**
+	 * Handle a serialized package as if it had been received from the
+	 * remote side, for example to replay a recorded package.
+	 *
+	 * @param p_Type the type of the package.
+	 * @param p_Data the serialized package, as written by writePackageData.
+	 * @param p_Size the size of the serialized package in bytes.
+	 */
+	virtual void receivePackageData(PackageType p_Type, const char* p_Data, size_t p_Size) = 0;
+
+	/**
+	 * Send a ping to measure the round trip time. The remote side answers
+	 * automatically. A ping sent before the previous one was answered
+	 * replaces it.
+	 */
+	virtual void sendPing() = 0;
+
+	/**
+	 * Get the traffic measured on the connection so far.
+	 *
+	 * Safe to call from any thread.
+	 *
+	 * @return the connection metrics.
+	 */
+	virtual ConnectionMetrics getMetrics() const = 0;
+
+	/**
+	 * Send a package that has already been encoded. The encoded data is
+	 * shared, not copied, so broadcasting a frame to many connections
+	 * only encodes the package once.
+	 *
+	 * @param p_Frame a frame returned by one of the encode functions of any connection.
+	 */
+	virtual void sendFrame(const SharedFrame& p_Frame) = 0;
 
 	/**
 	 * Get the type of a package.
@@ -74,6 +149,14 @@ public:
 	 * @param p_NumInstance the number of instances in the array
 	 */
 	virtual void sendCreateObjects(const ObjectInstance* p_Instances, unsigned int p_NumInstances) = 0;
+	/**
+	 * Encode a Create Objects package to be sent with sendFrame.
+	 *
+	 * @param p_Instances array of object instances, containing null-terminated descriptions and actor ids
+	 * @param p_NumInstance the number of instances in the array
+	 * @return the encoded package
+	 */
+	virtual SharedFrame encodeCreateObjects(const ObjectInstance* p_Instances, unsigned int p_NumInstances) = 0;
 
 	/**
 	 * Get the number of objects in the package.
@@ -95,12 +178,29 @@ public:
 	/**
 	 * Send an Update Objects package.
 	 *
+	 * Updates containing objects are replicated as snapshots: only values that
+	 * changed since the last update the receiver acknowledged are sent, and the
+	 * receiver gets the full state of every object back. Looks and colors are
+	 * only sent when they are not part of the acknowledged update. Updates
+	 * without objects are sent as they are.
+	 *
 	 * @param p_ObjectData array of object updates to send
 	 * @param p_NumObjects the number of object updates in the array
-	 * @param p_ExtraData array of null-terminated string with extra data
-	 * @param p_NumExtraData the number of extra data strings
+	 * @param p_Looks array of object look directions
+	 * @param p_NumLooks the number of look directions in the array
+	 * @param p_Colors array of object color changes
+	 * @param p_NumColors the number of color changes in the array
+	 */
+	virtual void sendUpdateObjects(const UpdateObjectData* p_ObjectData, unsigned int p_NumObjects,
+		const ObjectLookData* p_Looks, unsigned int p_NumLooks,
+		const ObjectColorData* p_Colors, unsigned int p_NumColors) = 0;
+	/**
+	 * Set the precision of replicated object updates. Values are rounded to
+	 * multiples of the precision, smaller changes are not sent.
+	 *
+	 * @param p_Precision the quantization step, larger than 0. Defaults to 0.01.
 	 */
-	virtual void sendUpdateObjects(const UpdateObjectData* p_ObjectData, unsigned int p_NumObjects, const char** p_ExtraData, unsigned int p_NumExtraData) = 0;
+	virtual void setUpdatePrecision(float p_Precision) = 0;
 
 	/**
 	 * Get the number of object updates in the package.
@@ -119,21 +219,36 @@ public:
 	virtual const UpdateObjectData* getUpdateObjectData(Package p_Package) = 0;
 
 	/**
-	 * Get the number of extra data in the package.
+	 * Get the number of look directions in the package.
 	 *
 	 * @param p_Package a valid reference to a package with the UpdateObjects type.
-	 * @return the number of extra data strings in the package
+	 * @return the number of look directions in the package
 	 */
-	virtual unsigned int getNumUpdateObjectExtraData(Package p_Package) = 0;
+	virtual unsigned int getNumUpdateObjectLooks(Package p_Package) = 0;
 
 	/**
-	 * Get an extra data string from the package.
+	 * Get the array of look directions in the package.
 	 *
 	 * @param p_Package a valid reference to a package with the UpdateObjects type.
-	 * @param p_ExtraData the index of the extra data to retreive
-	 * @return a null-terminated string containing any extra data
+	 * @return an array of look directions
 	 */
-	virtual const char* getUpdateObjectExtraData(Package p_Package, unsigned int p_ExtraData) = 0;
+	virtual const ObjectLookData* getUpdateObjectLooks(Package p_Package) = 0;
+
+	/**
+	 * Get the number of color changes in the package.
+	 *
+	 * @param p_Package a valid reference to a package with the UpdateObjects type.
+	 * @return the number of color changes in the package
+	 */
+	virtual unsigned int getNumUpdateObjectColors(Package p_Package) = 0;
+
+	/**
+	 * Get the array of color changes in the package.
+	 *
+	 * @param p_Package a valid reference to a package with the UpdateObjects type.
+	 * @return an array of color changes
+	 */
+	virtual const ObjectColorData* getUpdateObjectColors(Package p_Package) = 0;
 
 	/**
 	 * Send a Remove Objects package.
@@ -142,6 +257,14 @@ public:
 	 * @param p_NumObjects the number of objects in the array
 	 */
 	virtual void sendRemoveObjects(const uint32_t* p_Objects, unsigned int p_NumObjects) = 0;
+	/**
+	 * Encode a Remove Objects package to be sent with sendFrame.
+	 *
+	 * @param p_Objects array of object ids to remove
+	 * @param p_NumObjects the number of ids in the array
+	 * @return the encoded package
+	 */
+	virtual SharedFrame encodeRemoveObjects(const uint32_t* p_Objects, unsigned int p_NumObjects) = 0;
 
 	/**
 	 * Get the number of objects in the package.
@@ -166,6 +289,14 @@ public:
 	 * @param p_Action a null-terminated string describing the action
 	 */
 	virtual void sendObjectAction(uint32_t p_ObjectId, const char* p_Action) = 0;
+	/**
+	 * Encode an Object Action package to be sent with sendFrame.
+	 *
+	 * @param p_ObjectId the id of the target object
+	 * @param p_Action a null-terminated string describing the action
+	 * @return the encoded package
+	 */
+	virtual SharedFrame encodeObjectAction(uint32_t p_ObjectId, const char* p_Action) = 0;
 
 	/**
 	 * Get the id of the object targeted by the package.
@@ -294,6 +425,14 @@ public:
 	 * @param p_Size is the size och the binary stream in bytes.
 	 */
 	virtual void sendLevelData(const char* p_Stream, size_t p_Size) = 0;
+	/**
+	 * Encode a Level Data package to be sent with sendFrame.
+	 *
+	 * @param p_Stream is a binary stream with level information.
+	 * @param p_Size is the size och the binary stream in bytes.
+	 * @return the encoded package
+	 */
+	virtual SharedFrame encodeLevelData(const char* p_Stream, size_t p_Size) = 0;
 
 	/**
 	 * Send information about the current checkpoint to a specific player id.
@@ -313,13 +452,13 @@ public:
 	/**
 	 * Sends information about player position in the race.
 	 *
-	 * @param p_ExtraData, information about the race position.
-	 * @param p_NumExtraData, how much information that is written in the extra data.
+	 * @param p_Positions, array of race positions.
+	 * @param p_NumPositions, the number of race positions in the array.
 	 */
-	virtual void sendRacePosition(const char** p_ExtraData, unsigned int p_NumExtraData) = 0;
+	virtual void sendRacePosition(const RacePositionData* p_Positions, unsigned int p_NumPositions) = 0;
 
 	/**
-	 * Get the number of extra data that consists in the package.
+	 * Get the number of race positions in the package.
 	 *
 	 * @param p_Package, the information that is unpacked.
 	 * @return a unsigned int size.
@@ -330,10 +469,9 @@ public:
 	 * Unpackes all the information about race positions in the game.
 	 *
 	 * @param p_Package, is the package that is unpacked.
-	 * @param p_ExtraData, is the number of information that is unpacked.
-	 * @return const char pointer stream with the information written in xml.
+	 * @return an array of race positions.
 	 */
-	virtual const char* getRacePositionsData(Package p_Package, unsigned int p_ExtraData) = 0;
+	virtual const RacePositionData* getRacePositionsData(Package p_Package) = 0;
 
 	/**
 	 * Send information about who won and what place you got.
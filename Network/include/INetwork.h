@@ -68,6 +68,16 @@ public:
 	 */
 	virtual void startServer(unsigned int p_NumThreads) = 0;
 
+	/**
+	 * Enable datagram channels on the server. Clients are offered a datagram
+	 * channel on the same port number, used for frequent state packages such
+	 * as player control and object updates, while everything else stays on
+	 * the reliable connection. Must be called before the server is started.
+	 *
+	 * @param p_Enabled true to offer datagram channels, disabled by default.
+	 */
+	virtual void setDatagramsEnabled(bool p_Enabled) = 0;
+
 	/**
 	 * Set a callback to get notified when a client has connected.
 	 *
@@ -95,6 +105,22 @@ public:
 	 */
 	virtual void turnOffServer() = 0;
 
+	/**
+	 * Get the combined traffic of every client connected to the server,
+	 * and of the connection to a server if connected as a client.
+	 *
+	 * @return the metrics of all connections.
+	 */
+	virtual ConnectionMetrics getMetrics() = 0;
+
+	/**
+	 * Get a printable name of a package type.
+	 *
+	 * @param p_Type the package type.
+	 * @return a null-terminated name, or "UNKNOWN" for values outside of the package types.
+	 */
+	__declspec(dllexport) static const char* getPackageTypeName(PackageType p_Type);
+
 	/**
 	 * Clear sub resources allocated by the network and delete the library. 
 	 */
@@ -128,6 +154,27 @@ public:
 	 */
 	virtual IConnectionController* getConnectionToServer() = 0;
 
+	/**
+	 * Create a connection that is not connected to anything, to run code
+	 * using connections without sockets. Packages sent on the connection
+	 * are discarded, and packages are only received through
+	 * IConnectionController::receivePackageData.
+	 *
+	 * Requires initialize to have been called.
+	 *
+	 * @return a controller for the new connection, owned by the network.
+	 */
+	virtual IConnectionController* createOfflineConnection() = 0;
+
+	/**
+	 * Set a directory to cache levels received from servers in. Levels are
+	 * identified by content hash, so a level already in the cache is not
+	 * downloaded again. Applies to connections made after the call.
+	 *
+	 * @param p_Directory an existing directory, or null to disable the cache.
+	 */
+	virtual void setLevelCacheDirectory(const char* p_Directory) = 0;
+
 	/**
 	 * Set the function to handle log messages.
 	 *
@@ -0,0 +1,48 @@
+/**
+ * File comment.
+ */
+#pragma once
+
+#include <CommonTypes.h>
+
+/**
+ * Traffic of a single package type on a connection.
+ */
+struct PackageTypeMetrics
+{
+	uint64_t m_PackagesSent;
+	uint64_t m_BytesSent;			/// Package data in bytes, excluding transport headers
+	uint64_t m_PackagesReceived;
+	uint64_t m_BytesReceived;		/// Package data in bytes, excluding transport headers
+	double m_EncodeSeconds;			/// Time spent serializing the packages before sending
+	double m_DecodeSeconds;			/// Time spent deserializing the received packages
+};
+
+/**
+ * Measurements of the traffic on one or more connections.
+ *
+ * Sent packages encoded once and shared between connections,
+ * are counted as sent on each connection but encoded once.
+ */
+struct ConnectionMetrics
+{
+	/**
+	 * The number of package types, the size of the per type array.
+	 */
+	static const unsigned int numPackageTypes = (unsigned int)PackageType::PONG + 1;
+
+	/**
+	 * Traffic per package type, indexed by the package type value.
+	 */
+	PackageTypeMetrics m_Types[numPackageTypes];
+
+	uint32_t m_NumConnections;		/// The number of measured connections
+	double m_Seconds;				/// Seconds since the oldest measured connection was created
+	uint64_t m_SocketWrites;		/// Writes on the reliable connection, each with one or more packages
+	uint64_t m_SocketBytes;			/// Bytes written on the reliable connection, including headers
+	uint64_t m_MaxQueuedPackages;	/// The most packages waiting for the reliable connection at once
+	uint64_t m_MaxQueuedBytes;		/// The most bytes waiting for the reliable connection at once
+	uint32_t m_NumRoundTrips;		/// The number of answered pings
+	float m_RoundTripTime;			/// Smoothed round trip time in seconds, combined weighted by answered pings
+	float m_RoundTripVariation;		/// Smoothed deviation of the round trip time in seconds
+};
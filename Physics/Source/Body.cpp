@@ -116,6 +116,15 @@ void Body::addImpulse(DirectX::XMFLOAT4 p_Impulse)
 	XMStoreFloat4(&m_Velocity, vVelocity);
 }
 
+void Body::setHandle(BodyHandle p_Handle)
+{
+	m_Handle = p_Handle;
+	for (auto& volume : m_Volumes)
+	{
+		volume->setBodyHandle(m_Handle);
+	}
+}
+
 void Body::addVolume(BoundingVolume::ptr p_Volume)
 {
 	p_Volume->setBodyHandle(m_Handle);
@@ -173,6 +182,14 @@ void Body::updateBoundingVolumePosition(DirectX::XMFLOAT4 p_Position)
 	m_SurroundingSphere.setPosition(XMLoadFloat4(&m_Position));
 }
 
+void Body::translateVolumes(XMVECTOR const &p_Offset)
+{
+	for(auto &v : m_Volumes)
+		v->translate(p_Offset);
+
+	m_SurroundingSphere.setPosition(XMLoadFloat4(&m_Position));
+}
+
 XMFLOAT4 Body::calculateAcceleration()
 {
 	XMFLOAT4 acc;	// m/s^2
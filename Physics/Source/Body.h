@@ -7,6 +7,8 @@
 
 class Body
 {
+	friend class BodyIntegrator;
+
 protected:
 	typedef unsigned int BodyHandle;
 
@@ -76,6 +78,11 @@ public:
 	*/
 	void update(float p_DeltaTime);
 	/**
+	* Moves the body's BoundingVolumes by an offset, after m_Position has already been moved.
+	* @p_Offset, relative position in m.
+	*/
+	void translateVolumes(DirectX::XMVECTOR const &p_Offset);
+	/**
 	* Updates the body's BoundingVolumes position with relative coordinates.
 	* @p_Position, relative position in cm.
 	*/
@@ -206,6 +213,11 @@ public:
 	* @return m_Handle;
 	*/
 	virtual BodyHandle getHandle() const { return m_Handle; }
+	/**
+	* Replace the handle of the body and its volumes, used when the owner hands out its own handles.
+	* @p_Handle, the new handle.
+	*/
+	void setHandle(BodyHandle p_Handle);
 	/*
 	* reset the BodyHandleCounter. Only use when clearing the body list in physics
 	*/
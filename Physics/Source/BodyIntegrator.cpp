@@ -0,0 +1,141 @@
+#include "BodyIntegrator.h"
+
+using namespace DirectX;
+
+namespace
+{
+	XMVECTOR load(const std::vector<float>& p_Array, size_t p_Index)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&p_Array[p_Index]));
+	}
+
+	void store(std::vector<float>& p_Array, size_t p_Index, FXMVECTOR p_Value)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&p_Array[p_Index]), p_Value);
+	}
+}
+
+void BodyIntegrator::integrate(const std::vector<Body*>& p_Bodies, float p_DeltaTime)
+{
+	// Round up to whole batches, the padding lanes hold massless bodies at rest.
+	const size_t batchCount = (p_Bodies.size() + 3) & ~(size_t)3;
+	resize(batchCount);
+
+	gather(p_Bodies);
+	integrateBatches(batchCount, p_DeltaTime);
+	scatter(p_Bodies);
+}
+
+void BodyIntegrator::resize(size_t p_Size)
+{
+	std::vector<float>* arrays[] =
+	{
+		&m_PositionX, &m_PositionY, &m_PositionZ,
+		&m_OffsetX, &m_OffsetY, &m_OffsetZ,
+		&m_VelocityX, &m_VelocityY, &m_VelocityZ,
+		&m_LastAccX, &m_LastAccY, &m_LastAccZ,
+		&m_NewAccX, &m_NewAccY, &m_NewAccZ,
+		&m_AvgAccX, &m_AvgAccY, &m_AvgAccZ,
+		&m_ForceX, &m_ForceY, &m_ForceZ,
+		&m_Mass, &m_Gravity,
+	};
+
+	for (std::vector<float>* array : arrays)
+	{
+		array->assign(p_Size, 0.f);
+	}
+}
+
+void BodyIntegrator::gather(const std::vector<Body*>& p_Bodies)
+{
+	for (size_t i = 0; i < p_Bodies.size(); ++i)
+	{
+		const Body& body = *p_Bodies[i];
+		if (body.m_IsImmovable)
+			continue;
+
+		m_PositionX[i] = body.m_Position.x;
+		m_PositionY[i] = body.m_Position.y;
+		m_PositionZ[i] = body.m_Position.z;
+		m_VelocityX[i] = body.m_Velocity.x;
+		m_VelocityY[i] = body.m_Velocity.y;
+		m_VelocityZ[i] = body.m_Velocity.z;
+		m_AvgAccX[i] = body.m_AvgAcceleration.x;
+		m_AvgAccY[i] = body.m_AvgAcceleration.y;
+		m_AvgAccZ[i] = body.m_AvgAcceleration.z;
+		m_ForceX[i] = body.m_NetForce.x;
+		m_ForceY[i] = body.m_NetForce.y;
+		m_ForceZ[i] = body.m_NetForce.z;
+		m_Mass[i] = body.m_Mass;
+		m_Gravity[i] = body.m_Gravity;
+	}
+}
+
+void BodyIntegrator::integrateBatches(size_t p_Count, float p_DeltaTime)
+{
+	const XMVECTOR deltaTime = XMVectorReplicate(p_DeltaTime);
+	const XMVECTOR deltaTimeSq = XMVectorReplicate(p_DeltaTime * p_DeltaTime);
+	const XMVECTOR half = XMVectorReplicate(0.5f);
+	const XMVECTOR zero = XMVectorZero();
+
+	for (size_t i = 0; i < p_Count; i += 4)
+	{
+		// Same operations as Body::update, one body per lane.
+		const XMVECTOR lastX = load(m_AvgAccX, i);
+		const XMVECTOR lastY = load(m_AvgAccY, i);
+		const XMVECTOR lastZ = load(m_AvgAccZ, i);
+
+		const XMVECTOR relX = load(m_VelocityX, i) * deltaTime + (half * lastX) * deltaTimeSq;
+		const XMVECTOR relY = load(m_VelocityY, i) * deltaTime + (half * lastY) * deltaTimeSq;
+		const XMVECTOR relZ = load(m_VelocityZ, i) * deltaTime + (half * lastZ) * deltaTimeSq;
+
+		store(m_OffsetX, i, relX);
+		store(m_OffsetY, i, relY);
+		store(m_OffsetZ, i, relZ);
+		store(m_PositionX, i, load(m_PositionX, i) + relX);
+		store(m_PositionY, i, load(m_PositionY, i) + relY);
+		store(m_PositionZ, i, load(m_PositionZ, i) + relZ);
+
+		const XMVECTOR mass = load(m_Mass, i);
+		const XMVECTOR massless = XMVectorEqual(mass, zero);
+		const XMVECTOR newX = XMVectorSelect(XMVectorDivide(load(m_ForceX, i), mass), zero, massless);
+		const XMVECTOR newY = XMVectorSelect(XMVectorDivide(load(m_ForceY, i), mass) - load(m_Gravity, i), zero, massless);
+		const XMVECTOR newZ = XMVectorSelect(XMVectorDivide(load(m_ForceZ, i), mass), zero, massless);
+
+		const XMVECTOR avgX = (lastX + newX) * half;
+		const XMVECTOR avgY = (lastY + newY) * half;
+		const XMVECTOR avgZ = (lastZ + newZ) * half;
+
+		store(m_VelocityX, i, load(m_VelocityX, i) + avgX * deltaTime);
+		store(m_VelocityY, i, load(m_VelocityY, i) + avgY * deltaTime);
+		store(m_VelocityZ, i, load(m_VelocityZ, i) + avgZ * deltaTime);
+
+		store(m_LastAccX, i, lastX);
+		store(m_LastAccY, i, lastY);
+		store(m_LastAccZ, i, lastZ);
+		store(m_NewAccX, i, newX);
+		store(m_NewAccY, i, newY);
+		store(m_NewAccZ, i, newZ);
+		store(m_AvgAccX, i, avgX);
+		store(m_AvgAccY, i, avgY);
+		store(m_AvgAccZ, i, avgZ);
+	}
+}
+
+void BodyIntegrator::scatter(const std::vector<Body*>& p_Bodies)
+{
+	for (size_t i = 0; i < p_Bodies.size(); ++i)
+	{
+		Body& body = *p_Bodies[i];
+		if (body.m_IsImmovable)
+			continue;
+
+		body.m_Position = XMFLOAT4(m_PositionX[i], m_PositionY[i], m_PositionZ[i], body.m_Position.w);
+		body.m_Velocity = XMFLOAT4(m_VelocityX[i], m_VelocityY[i], m_VelocityZ[i], body.m_Velocity.w);
+		body.m_LastAcceleration = XMFLOAT4(m_LastAccX[i], m_LastAccY[i], m_LastAccZ[i], body.m_AvgAcceleration.w);
+		body.m_NewAcceleration = XMFLOAT4(m_NewAccX[i], m_NewAccY[i], m_NewAccZ[i], 0.f);
+		body.m_AvgAcceleration = XMFLOAT4(m_AvgAccX[i], m_AvgAccY[i], m_AvgAccZ[i], body.m_AvgAcceleration.w * 0.5f);
+
+		body.translateVolumes(XMVectorSet(m_OffsetX[i], m_OffsetY[i], m_OffsetZ[i], 0.f));
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Body.h"
+
+#include <vector>
+
+/**
+ * Batched version of Body::update. Gathers the kinematic state of the movable bodies
+ * into one array per component and advances four bodies at a time with vector math,
+ * then writes the state back and translates the bodies' volumes.
+ */
+class BodyIntegrator
+{
+private:
+	std::vector<float> m_PositionX, m_PositionY, m_PositionZ;		// m
+	std::vector<float> m_OffsetX, m_OffsetY, m_OffsetZ;			// m
+	std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;		// m/s
+	std::vector<float> m_LastAccX, m_LastAccY, m_LastAccZ;			// m/s^2
+	std::vector<float> m_NewAccX, m_NewAccY, m_NewAccZ;			// m/s^2
+	std::vector<float> m_AvgAccX, m_AvgAccY, m_AvgAccZ;			// m/s^2
+	std::vector<float> m_ForceX, m_ForceY, m_ForceZ;				// kg*m/s^2
+	std::vector<float> m_Mass;										// kg
+	std::vector<float> m_Gravity;									// m/s^2
+
+public:
+	/**
+	 * Advance a number of bodies one step, with the same result as calling Body::update
+	 * on each of them, within float tolerance.
+	 *
+	 * @param p_Bodies the bodies to update, immovable bodies are skipped
+	 * @param p_DeltaTime the step length in seconds
+	 */
+	void integrate(const std::vector<Body*>& p_Bodies, float p_DeltaTime);
+
+private:
+	void resize(size_t p_Size);
+	void gather(const std::vector<Body*>& p_Bodies);
+	void integrateBatches(size_t p_Count, float p_DeltaTime);
+	void scatter(const std::vector<Body*>& p_Bodies);
+};
@@ -1,6 +1,9 @@
 #include "Collision.h"
 #include "PhysicsExceptions.h"
 #include "PhysicsLogger.h"
+
+#include <algorithm>
+
 #define EPSILON XMVectorGetX(g_XMEpsilon)
 using namespace DirectX;
 
@@ -115,6 +118,26 @@ bool Collision::surroundingSphereVsSphere(Sphere const &p_Sphere1, Sphere const
 	return false;
 }
 
+HitData Collision::mirrorHitData(HitData const &p_Hit, BoundingVolume const &p_Volume1, BoundingVolume const &p_Volume2)
+{
+	HitData mirrored = p_Hit;
+	if(!p_Hit.intersect)
+		return mirrored;
+
+	//Volumes of different types are always tested in the same order, whichever one is the collider.
+	if(p_Volume1.getType() != p_Volume2.getType())
+		return mirrored;
+
+	mirrored.colNorm = p_Hit.colNorm * -1.f;
+
+	if(p_Hit.colType == Type::SPHEREVSSPHERE)
+	{
+		mirrored.colPos = mirrored.colNorm * (((Sphere&)p_Volume1).getRadius() * 100.f);
+	}
+
+	return mirrored;
+}
+
 HitData Collision::sphereVsSphere(Sphere const &p_Sphere1, Sphere const &p_Sphere2 )
 {
 	HitData hit;
@@ -478,8 +501,9 @@ HitData Collision::HullVsSphere(Hull const &p_Hull, Sphere const &p_Sphere)
 
 	float distance = FLT_MAX;
 	XMVECTOR closestPoint = g_XMZero;
-	unsigned int nrTriangles = p_Hull.getTriangleListSize();
-	for(unsigned int i = 0; i < nrTriangles; i++)
+	std::vector<unsigned int> candidates;
+	p_Hull.findTrianglesNearSphere(XMSpherePos, p_Sphere.getRadius(), candidates);
+	for(unsigned int i : candidates)
 	{
 		XMVECTOR point = p_Hull.findClosestPointOnTriangle(XMSpherePos, i);
 		XMVECTOR v = point - spherePos;
@@ -725,7 +749,9 @@ HitData Collision::SATBoxVsHull(OBB const &p_OBB, Hull const &p_Hull)
 	//Stores the minimum translation vector for all triangles hit in a hull
 	std::vector<XMFLOAT4> MTVs;
 
-	for(unsigned int i = 0; i < p_Hull.getTriangleListSize(); i++)
+	std::vector<unsigned int> candidates;
+	p_Hull.findTrianglesNearSphere(p_OBB.getSphere().getPosition(), p_OBB.getSphere().getRadius(), candidates);
+	for(unsigned int i : candidates)
 	{
 		//Triangle Vertices U0, U1 and U2.
 		Triangle triangle = p_Hull.getTriangleInWorldCoord(i);
@@ -1011,17 +1037,28 @@ float Collision::raySphereIntersect(const Sphere &p_Sphere, const XMFLOAT4 &p_Ra
 	return t;
 }
 
-float Collision::rayTriangleIntersect(const Hull &p_Hull, const XMFLOAT4 &p_RayDirection, const XMFLOAT4 &p_RayOrigin)
+float Collision::rayTriangleIntersect(const Hull &p_Hull, const XMFLOAT4 &p_RayDirection, const XMFLOAT4 &p_RayOrigin,
+	XMFLOAT4* p_Normal)
 {
-	XMVECTOR RayDir = XMLoadFloat4(&p_RayDirection);
-	XMVECTOR RayOrigin = XMLoadFloat4(&p_RayOrigin);
+	// Move the ray into the space of the shared mesh instead of transforming every triangle.
+	// The direction is not renormalized, so the distance along the ray is the same in both spaces.
+	XMMATRIX toMesh = XMLoadFloat4x4(&p_Hull.getInverseTransform());
+	XMVECTOR RayDir = XMVector3TransformNormal(XMLoadFloat4(&p_RayDirection), toMesh);
+	XMVECTOR RayOrigin = XMVector3TransformNormal(XMLoadFloat4(&p_RayOrigin) - XMLoadFloat4(&p_Hull.getPosition()), toMesh);
+	const HullMesh& mesh = *p_Hull.getMesh();
 	float dist = FLT_MAX;
-
-	for(unsigned int i = 0; i < p_Hull.getTriangleListSize(); i++)
+	XMVECTOR hitNormal = g_XMZero;
+
+	XMFLOAT3 localOrigin, localDirection;
+	XMStoreFloat3(&localOrigin, RayOrigin);
+	XMStoreFloat3(&localDirection, RayDir);
+	std::vector<unsigned int> candidates;
+	mesh.getBVH().findRayCandidates(localOrigin, localDirection, candidates);
+	for(unsigned int i : candidates)
 	{
 		float tempDist = 0.f;
 		//Triangle Vertices 
-		Triangle triangle = p_Hull.getTriangleInWorldCoord(i);
+		const Triangle& triangle = mesh.getTriangleAt(i);
 		const XMVECTOR p0 = Vector4ToXMVECTOR(&triangle.corners[0]);
 		const XMVECTOR p1 = Vector4ToXMVECTOR(&triangle.corners[1]);
 		const XMVECTOR p2 = Vector4ToXMVECTOR(&triangle.corners[2]);
@@ -1052,11 +1089,179 @@ float Collision::rayTriangleIntersect(const Hull &p_Hull, const XMFLOAT4 &p_RayD
 		if(t > 0.f && t < dist)
 		{
 			dist = t;
+			hitNormal = XMVector3Cross(e1, e2);
 		}
 	}
 
 	if(dist == FLT_MAX)
 		return -1.f;
-	else
-		return dist;
+
+	if(p_Normal)
+	{
+		// Normals go back to world space with the inverse transpose of the mesh transform.
+		XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(hitNormal, XMMatrixTranspose(toMesh)));
+		if(XMVectorGetX(XMVector3Dot(normal, XMLoadFloat4(&p_RayDirection))) > 0.f)
+			normal = -normal;
+
+		XMStoreFloat4(p_Normal, normal);
+	}
+
+	return dist;
+}
+
+namespace
+{
+	struct SlabHit
+	{
+		float enter;
+		float exit;
+		int enterAxis;
+		int exitAxis;
+		float enterSign;
+		float exitSign;
+	};
+
+	/**
+	 * Clip a ray against the three slabs of a box, in the box's own coordinates.
+	 * @return false if the ray misses the box or the box is behind the ray
+	 */
+	bool rayVsSlabs(const float p_Origin[3], const float p_Direction[3], const float p_Min[3], const float p_Max[3], SlabHit& p_Hit)
+	{
+		p_Hit.enter = -FLT_MAX;
+		p_Hit.exit = FLT_MAX;
+		p_Hit.enterAxis = p_Hit.exitAxis = 0;
+		p_Hit.enterSign = p_Hit.exitSign = 0.f;
+
+		for(int i = 0; i < 3; i++)
+		{
+			if(fabs(p_Direction[i]) < EPSILON)
+			{
+				if(p_Origin[i] < p_Min[i] || p_Origin[i] > p_Max[i])
+					return false;
+				continue;
+			}
+
+			const float inverse = 1.f / p_Direction[i];
+			float t0 = (p_Min[i] - p_Origin[i]) * inverse;
+			float t1 = (p_Max[i] - p_Origin[i]) * inverse;
+			float sign0 = -1.f;
+			float sign1 = 1.f;
+			if(t0 > t1)
+			{
+				std::swap(t0, t1);
+				std::swap(sign0, sign1);
+			}
+
+			if(t0 > p_Hit.enter)
+			{
+				p_Hit.enter = t0;
+				p_Hit.enterAxis = i;
+				p_Hit.enterSign = sign0;
+			}
+			if(t1 < p_Hit.exit)
+			{
+				p_Hit.exit = t1;
+				p_Hit.exitAxis = i;
+				p_Hit.exitSign = sign1;
+			}
+
+			if(p_Hit.enter > p_Hit.exit)
+				return false;
+		}
+
+		return p_Hit.exit >= 0.f;
+	}
+
+	float rayVsBox(const float p_Origin[3], const float p_Direction[3], const float p_Min[3], const float p_Max[3], XMFLOAT3& p_LocalNormal)
+	{
+		SlabHit hit;
+		if(!rayVsSlabs(p_Origin, p_Direction, p_Min, p_Max, hit))
+			return -1.f;
+
+		const bool inside = hit.enter < 0.f;
+		const int axis = inside ? hit.exitAxis : hit.enterAxis;
+		float* normal = &p_LocalNormal.x;
+		normal[0] = normal[1] = normal[2] = 0.f;
+		normal[axis] = p_Direction[axis] > 0.f ? -1.f : 1.f;
+
+		return inside ? hit.exit : hit.enter;
+	}
+}
+
+bool Collision::rayVsAABBIntersect(XMFLOAT4 p_Min, XMFLOAT4 p_Max, const XMFLOAT4 &p_RayDirection, const XMFLOAT4 &p_RayOrigin, float p_MaxDistance)
+{
+	SlabHit hit;
+	if(!rayVsSlabs(&p_RayOrigin.x, &p_RayDirection.x, &p_Min.x, &p_Max.x, hit))
+		return false;
+
+	return hit.enter <= p_MaxDistance;
+}
+
+float Collision::rayVsBoundingVolume(BoundingVolume const &p_Volume, const XMFLOAT4 &p_RayDirection, const XMFLOAT4 &p_RayOrigin, XMFLOAT4 &p_Normal)
+{
+	const XMVECTOR rayDir = XMLoadFloat4(&p_RayDirection);
+	const XMVECTOR rayOrigin = XMLoadFloat4(&p_RayOrigin);
+
+	switch(p_Volume.getType())
+	{
+	case BoundingVolume::Type::SPHERE:
+		{
+			const Sphere& sphere = (const Sphere&)p_Volume;
+			const float dist = raySphereIntersect(sphere, p_RayDirection, p_RayOrigin);
+			if(dist < 0.f)
+				return -1.f;
+
+			const XMFLOAT4 spherePos = sphere.getPosition();
+			XMVECTOR normal = XMVector3Normalize(rayOrigin + rayDir * dist - XMLoadFloat4(&spherePos));
+			if(XMVectorGetX(XMVector3Dot(normal, rayDir)) > 0.f)
+				normal = -normal;
+
+			XMStoreFloat4(&p_Normal, normal);
+			return dist;
+		}
+
+	case BoundingVolume::Type::AABBOX:
+		{
+			const AABB& aabb = (const AABB&)p_Volume;
+			const XMFLOAT4 min = aabb.getMin();
+			const XMFLOAT4 max = aabb.getMax();
+			XMFLOAT3 normal;
+			const float dist = rayVsBox(&p_RayOrigin.x, &p_RayDirection.x, &min.x, &max.x, normal);
+			p_Normal = XMFLOAT4(normal.x, normal.y, normal.z, 0.f);
+			return dist;
+		}
+
+	case BoundingVolume::Type::OBB:
+		{
+			const OBB& obb = (const OBB&)p_Volume;
+			const XMFLOAT4X4 axesData = obb.getAxes();
+			const XMMATRIX axes = XMLoadFloat4x4(&axesData);
+			const XMFLOAT4 center = obb.getPosition();
+			const XMFLOAT4 extents = obb.getExtents();
+			const XMVECTOR relOrigin = rayOrigin - XMLoadFloat4(&center);
+
+			float origin[3], direction[3];
+			for(int i = 0; i < 3; i++)
+			{
+				origin[i] = XMVectorGetX(XMVector3Dot(relOrigin, axes.r[i]));
+				direction[i] = XMVectorGetX(XMVector3Dot(rayDir, axes.r[i]));
+			}
+			const float max[3] = { extents.x, extents.y, extents.z };
+			const float min[3] = { -extents.x, -extents.y, -extents.z };
+
+			XMFLOAT3 localNormal;
+			const float dist = rayVsBox(origin, direction, min, max, localNormal);
+			if(dist < 0.f)
+				return -1.f;
+
+			XMStoreFloat4(&p_Normal, XMVector3TransformNormal(XMLoadFloat3(&localNormal), axes));
+			return dist;
+		}
+
+	case BoundingVolume::Type::HULL:
+		return rayTriangleIntersect((const Hull&)p_Volume, p_RayDirection, p_RayOrigin, &p_Normal);
+
+	default:
+		return -1.f;
+	}
 }
\ No newline at end of file
@@ -33,6 +33,13 @@ public:
 	
 	static bool Collision::surroundingSphereVsSphere(Sphere const &p_Sphere1, Sphere const &p_Sphere2);
 
+	/**
+	* Turn the result of boundingVolumeVsBoundingVolume(p_Volume1, p_Volume2) into the result
+	* of boundingVolumeVsBoundingVolume(p_Volume2, p_Volume1) without testing the volumes again.
+	* @return HitData, see HitData definition.
+	*/
+	static HitData mirrorHitData(HitData const &p_Hit, BoundingVolume const &p_Volume1, BoundingVolume const &p_Volume2);
+
 	/**
 	* Sphere versus Sphere collision
 	* @return HitData, see HitData definition.
@@ -107,7 +114,32 @@ public:
 	 * @param, p_RayOrigin origin of the ray in world space
 	 * @returns true if there an intersection otherwise false
 	 */
-	static float Collision::rayTriangleIntersect(const Hull &p_Hull, const DirectX::XMFLOAT4 &p_RayDirection, const DirectX::XMFLOAT4 &p_RayOrigin);
+	static float Collision::rayTriangleIntersect(const Hull &p_Hull, const DirectX::XMFLOAT4 &p_RayDirection, const DirectX::XMFLOAT4 &p_RayOrigin,
+		DirectX::XMFLOAT4* p_Normal = nullptr);
+
+	/**
+	 * Check if a ray passes through a box before it has travelled a distance.
+	 * @param, p_Min the box min corner in world space
+	 * @param, p_Max the box max corner in world space
+	 * @param, p_RayDirection direction of the ray in world space
+	 * @param, p_RayOrigin origin of the ray in world space
+	 * @param, p_MaxDistance the length of the ray, in multiples of the direction's length
+	 * @returns true if the ray starts inside or enters the box within the distance
+	 */
+	static bool rayVsAABBIntersect(DirectX::XMFLOAT4 p_Min, DirectX::XMFLOAT4 p_Max, const DirectX::XMFLOAT4 &p_RayDirection,
+		const DirectX::XMFLOAT4 &p_RayOrigin, float p_MaxDistance);
+
+	/**
+	 * Find where a ray hits a bounding volume of any type. A ray starting inside
+	 * a volume hits it where it leaves it, like raySphereIntersect.
+	 * @param, p_Volume the volume to test against
+	 * @param, p_RayDirection direction of the ray in world space
+	 * @param, p_RayOrigin origin of the ray in world space
+	 * @param, p_Normal set to the normalized surface normal at the hit, facing against the ray
+	 * @returns the distance along the ray in multiples of the direction's length, or a negative value on a miss
+	 */
+	static float rayVsBoundingVolume(BoundingVolume const &p_Volume, const DirectX::XMFLOAT4 &p_RayDirection,
+		const DirectX::XMFLOAT4 &p_RayOrigin, DirectX::XMFLOAT4 &p_Normal);
 
 private:
 	static HitData SATBoxVsBox(OBB const &p_OBB, BoundingVolume const &p_vol);
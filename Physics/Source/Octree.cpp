@@ -3,8 +3,22 @@
 #include "Collision.h"
 #include "Sphere.h"
 
+#include <algorithm>
+
 using namespace DirectX;
 
+namespace
+{
+	bool sphereInsideSphere(const Sphere& p_Inner, const Sphere& p_Outer)
+	{
+		const XMFLOAT4 innerPos = p_Inner.getPosition();
+		const XMFLOAT4 outerPos = p_Outer.getPosition();
+		const float distance = XMVectorGetX(XMVector3Length(XMLoadFloat4(&innerPos) - XMLoadFloat4(&outerPos)));
+
+		return distance + p_Inner.getRadius() <= p_Outer.getRadius();
+	}
+}
+
 Octree::Node::Node(const DirectX::XMFLOAT4& p_MinPos, const DirectX::XMFLOAT4& p_MaxPos) :
 	m_IsLeaf(true),
 	m_MinPos(p_MinPos),
@@ -30,6 +44,12 @@ const DirectX::XMFLOAT4& Octree::Node::getMaxPos() const
 	return m_MaxPos;
 }
 
+bool Octree::Node::isEmpty() const
+{
+	// Emptied subtrees are merged into leaves, so an empty node is always an empty leaf.
+	return m_IsLeaf && m_NumBodies == 0 && m_LargeBodies.empty();
+}
+
 size_t Octree::Node::getBodyCount() const
 {
 	size_t count = m_NumBodies + m_LargeBodies.size();
@@ -119,6 +139,73 @@ void Octree::Node::removeBody(BodyHandle p_Body, const Sphere* p_Sphere)
 		{
 			childNode->removeBody(p_Body, p_Sphere);
 		}
+
+		mergeChildren();
+	}
+}
+
+void Octree::Node::updateBody(BodyHandle p_Body, Sphere& p_Bounds, const Sphere& p_NewBounds)
+{
+	if (!m_IsLeaf)
+	{
+		for (auto& childNode : m_Children)
+		{
+			if (Collision::SphereInsideAABB(childNode->m_MinPos, childNode->m_MaxPos, p_Bounds) &&
+				Collision::SphereInsideAABB(childNode->m_MinPos, childNode->m_MaxPos, p_NewBounds))
+			{
+				childNode->updateBody(p_Body, p_Bounds, p_NewBounds);
+				return;
+			}
+		}
+	}
+
+	// Neither the old nor the new bounds reach outside this node, so nothing above it is affected.
+	removeBody(p_Body, &p_Bounds);
+	p_Bounds = p_NewBounds;
+	addBody(Volume(p_Body, &p_Bounds));
+}
+
+Octree::Node::uPtr Octree::Node::takeOnlyChild()
+{
+	if (m_IsLeaf || !m_LargeBodies.empty())
+		return Node::uPtr();
+
+	Node::uPtr* onlyChild = nullptr;
+	for (auto& childNode : m_Children)
+	{
+		if (childNode->isEmpty())
+			continue;
+
+		if (onlyChild)
+			return Node::uPtr();
+
+		onlyChild = &childNode;
+	}
+
+	if (!onlyChild)
+		return Node::uPtr();
+
+	return std::move(*onlyChild);
+}
+
+void Octree::Node::gatherStatistics(Statistics& p_Statistics, size_t p_Depth) const
+{
+	p_Statistics.depth = std::max(p_Statistics.depth, p_Depth);
+	++p_Statistics.nodeCount;
+	p_Statistics.largeBodies += m_LargeBodies.size();
+
+	if (m_IsLeaf)
+	{
+		++p_Statistics.leafCount;
+		p_Statistics.bodyReferences += m_NumBodies;
+		p_Statistics.maxBodiesPerLeaf = std::max(p_Statistics.maxBodiesPerLeaf, m_NumBodies);
+	}
+	else
+	{
+		for (const auto& childNode : m_Children)
+		{
+			childNode->gatherStatistics(p_Statistics, p_Depth + 1);
+		}
 	}
 }
 
@@ -179,17 +266,60 @@ bool Octree::Node::isLarge(const Volume& p_Body)
 	return Collision::AABBInsideSphere(m_MinPos, m_MaxPos, *p_Body.sphere);
 }
 
-Octree::Octree()
+void Octree::Node::mergeChildren()
+{
+	// Merge when the children together hold at most half a leaf, so that a node
+	// does not keep expanding and merging when a single body moves back and forth.
+	std::array<Volume, bodiesPerLeaf> merged;
+	size_t numMerged = 0;
+
+	for (const auto& childNode : m_Children)
+	{
+		if (!childNode->m_IsLeaf || !childNode->m_LargeBodies.empty())
+			return;
+
+		for (size_t i = 0; i < childNode->m_NumBodies; ++i)
+		{
+			const Volume& body = childNode->m_Bodies[i];
+			auto mergedEnd = merged.begin() + numMerged;
+			if (std::find_if(merged.begin(), mergedEnd,
+				[&body] (const Volume& p_Merged) { return p_Merged.handle == body.handle; }) != mergedEnd)
+			{
+				continue;
+			}
+
+			if (numMerged == bodiesPerLeaf / 2)
+				return;
+
+			merged[numMerged] = body;
+			++numMerged;
+		}
+	}
+
+	m_Bodies = merged;
+	m_NumBodies = numMerged;
+	for (auto& childNode : m_Children)
+	{
+		childNode.reset();
+	}
+	m_IsLeaf = true;
+}
+
+Octree::Octree() :
+	m_Looseness(0.25f)
 {
 }
 
 void Octree::reset()
 {
 	m_RootNode.reset();
+	m_Bounds.clear();
 }
 
 void Octree::addBody(BodyHandle p_Body, const Sphere* p_Sphere)
 {
+	p_Sphere = storeBounds(p_Body, *p_Sphere);
+
 	if (!m_RootNode)
 	{
 		const XMFLOAT4 center = p_Sphere->getPosition();
@@ -208,12 +338,52 @@ void Octree::addBody(BodyHandle p_Body, const Sphere* p_Sphere)
 	m_RootNode->addBody(Volume(p_Body, p_Sphere));
 }
 
-void Octree::removeBody(BodyHandle p_Body, const Sphere* p_Sphere)
+void Octree::removeBody(BodyHandle p_Body)
 {
-	if (!m_RootNode)
+	auto bounds = m_Bounds.find(p_Body);
+	if (bounds == m_Bounds.end())
 		return;
 
-	m_RootNode->removeBody(p_Body, p_Sphere);
+	m_RootNode->removeBody(p_Body, &bounds->second);
+	m_Bounds.erase(bounds);
+
+	shrink();
+}
+
+void Octree::updateBody(BodyHandle p_Body, const Sphere* p_Sphere)
+{
+	auto bounds = m_Bounds.find(p_Body);
+	if (bounds == m_Bounds.end())
+	{
+		addBody(p_Body, p_Sphere);
+		return;
+	}
+
+	if (sphereInsideSphere(*p_Sphere, bounds->second))
+		return;
+
+	const Sphere newBounds(p_Sphere->getRadius() * (1.f + m_Looseness), p_Sphere->getPosition());
+	if (Collision::SphereInsideAABB(getMinPos(), getMaxPos(), newBounds))
+	{
+		m_RootNode->updateBody(p_Body, bounds->second, newBounds);
+	}
+	else
+	{
+		m_RootNode->removeBody(p_Body, &bounds->second);
+		bounds->second = newBounds;
+
+		while (!Collision::SphereInsideAABB(getMinPos(), getMaxPos(), newBounds))
+		{
+			increaseSize(newBounds.getPosition());
+		}
+
+		m_RootNode->addBody(Volume(p_Body, &bounds->second));
+	}
+}
+
+void Octree::setLooseness(float p_Looseness)
+{
+	m_Looseness = p_Looseness;
 }
 
 const DirectX::XMFLOAT4& Octree::getMinPos() const
@@ -246,6 +416,21 @@ size_t Octree::getBodyCount() const
 	return m_RootNode->getBodyCount();
 }
 
+Octree::Statistics Octree::getStatistics() const
+{
+	Statistics statistics;
+	if (!m_RootNode)
+		return statistics;
+
+	m_RootNode->gatherStatistics(statistics, 1);
+	if (statistics.leafCount > 0)
+	{
+		statistics.averageBodiesPerLeaf = (float)statistics.bodyReferences / statistics.leafCount;
+	}
+
+	return statistics;
+}
+
 void Octree::increaseSize(const DirectX::XMFLOAT4& p_Target)
 {
 	const XMFLOAT4& currentMin = getMinPos();
@@ -302,3 +487,26 @@ void Octree::increaseSize(const DirectX::XMFLOAT4& p_Target)
 	newRoot->swapRoot(m_RootNode, index);
 	std::swap(m_RootNode, newRoot);
 }
+
+void Octree::shrink()
+{
+	if (m_RootNode->isEmpty())
+	{
+		m_RootNode.reset();
+		return;
+	}
+
+	Node::uPtr onlyChild;
+	while ((onlyChild = m_RootNode->takeOnlyChild()))
+	{
+		std::swap(m_RootNode, onlyChild);
+	}
+}
+
+const Sphere* Octree::storeBounds(BodyHandle p_Body, const Sphere& p_Bounds)
+{
+	Sphere& bounds = m_Bounds[p_Body];
+	bounds = p_Bounds;
+
+	return &bounds;
+}
@@ -4,6 +4,7 @@
 #include "Sphere.h"
 
 #include <array>
+#include <unordered_map>
 #include <vector>
 
 class Octree
@@ -11,6 +12,31 @@ class Octree
 public:
 	typedef unsigned int BodyHandle;
 
+	/**
+	 * Shape of the tree, for tuning the leaf size and the looseness.
+	 */
+	struct Statistics
+	{
+		size_t depth;
+		size_t nodeCount;
+		size_t leafCount;
+		size_t bodyReferences; // Bodies in more than one leaf are counted once for each
+		size_t largeBodies;
+		size_t maxBodiesPerLeaf;
+		float averageBodiesPerLeaf;
+
+		Statistics() :
+			depth(0),
+			nodeCount(0),
+			leafCount(0),
+			bodyReferences(0),
+			largeBodies(0),
+			maxBodiesPerLeaf(0),
+			averageBodiesPerLeaf(0.f)
+		{
+		}
+	};
+
 private:
 	struct Volume
 	{
@@ -56,11 +82,16 @@ private:
 		const DirectX::XMFLOAT4& getMinPos() const;
 		const DirectX::XMFLOAT4& getMaxPos() const;
 
+		bool isEmpty() const;
 		size_t getBodyCount() const;
 
 		void addBody(const Volume& p_Body);
 		void addBodyIfIntersect(const Volume& p_Body);
 		void removeBody(BodyHandle p_Body, const Sphere* p_Sphere);
+		void updateBody(BodyHandle p_Body, Sphere& p_Bounds, const Sphere& p_NewBounds);
+
+		Node::uPtr takeOnlyChild();
+		void gatherStatistics(Statistics& p_Statistics, size_t p_Depth) const;
 
 		template <typename OutIt>
 		void findPotentialIntersections(const Sphere* p_Sphere, OutIt p_Output) const
@@ -89,14 +120,45 @@ private:
 			}
 		}
 
+		template <typename OutIt>
+		void findPotentialRayIntersections(const DirectX::XMFLOAT4& p_RayDirection, const DirectX::XMFLOAT4& p_RayOrigin,
+			float p_MaxDistance, OutIt p_Output) const
+		{
+			if (!Collision::rayVsAABBIntersect(m_MinPos, m_MaxPos, p_RayDirection, p_RayOrigin, p_MaxDistance))
+				return;
+
+			for (const auto& largeBody : m_LargeBodies)
+			{
+				*p_Output++ = largeBody.handle;
+			}
+
+			if (m_IsLeaf)
+			{
+				for (size_t i = 0; i < m_NumBodies; ++i)
+				{
+					*p_Output++ = m_Bodies[i].handle;
+				}
+			}
+			else
+			{
+				for (const auto& childNode : m_Children)
+				{
+					childNode->findPotentialRayIntersections(p_RayDirection, p_RayOrigin, p_MaxDistance, p_Output);
+				}
+			}
+		}
+
 	private:
 		void expand();
 		void createChildren();
 		void addToChildren(const Volume& p_Body);
 		bool isLarge(const Volume& p_Body);
+		void mergeChildren();
 	};
 
 	Node::uPtr m_RootNode;
+	std::unordered_map<BodyHandle, Sphere> m_Bounds; // The bounds each body is stored with
+	float m_Looseness;
 
 public:
 	Octree();
@@ -104,12 +166,26 @@ public:
 	void reset();
 
 	void addBody(BodyHandle p_Body, const Sphere* p_Sphere);
-	void removeBody(BodyHandle p_Body, const Sphere* p_Sphere);
+	void removeBody(BodyHandle p_Body);
+	/**
+	 * Update the tree after a body has moved or changed size. Nothing is done as long as the
+	 * body stays within the bounds it is stored with, otherwise it is stored again with
+	 * loose bounds, starting from the smallest node containing both the old and new bounds.
+	 */
+	void updateBody(BodyHandle p_Body, const Sphere* p_Sphere);
+
+	/**
+	 * Set how much larger than the body a moved body is stored as.
+	 *
+	 * @param p_Looseness the margin added to the radius, relative to the radius
+	 */
+	void setLooseness(float p_Looseness);
 
 	const DirectX::XMFLOAT4& getMinPos() const;
 	const DirectX::XMFLOAT4& getMaxPos() const;
 
 	size_t getBodyCount() const;
+	Statistics getStatistics() const;
 
 	template <typename OutIt>
 	void findPotentialIntersections(const Sphere* p_Sphere, OutIt p_Output) const
@@ -120,6 +196,23 @@ public:
 		m_RootNode->findPotentialIntersections(p_Sphere, p_Output);
 	}
 
+	/**
+	 * Find the bodies stored in the nodes a ray passes through. Bodies may be reported more than once.
+	 *
+	 * @param p_MaxDistance the length of the ray, in multiples of the direction's length
+	 */
+	template <typename OutIt>
+	void findPotentialRayIntersections(const DirectX::XMFLOAT4& p_RayDirection, const DirectX::XMFLOAT4& p_RayOrigin,
+		float p_MaxDistance, OutIt p_Output) const
+	{
+		if (!m_RootNode)
+			return;
+
+		m_RootNode->findPotentialRayIntersections(p_RayDirection, p_RayOrigin, p_MaxDistance, p_Output);
+	}
+
 private:
 	void increaseSize(const DirectX::XMFLOAT4& p_Target);
+	void shrink();
+	const Sphere* storeBounds(BodyHandle p_Body, const Sphere& p_Bounds);
 };
@@ -3,11 +3,16 @@
 #include "PhysicsLogger.h"
 #include "PhysicsExceptions.h"
 
+#include <algorithm>
+
 using namespace DirectX;
 
 Physics::Physics(void)
-	: m_GlobalGravity(30.f)
-{}
+	: m_GlobalGravity(30.f),
+	  m_BatchedIntegration(false)
+{
+	setNumWorkerThreads(1);
+}
 
 Physics::~Physics()
 {
@@ -32,13 +37,7 @@ void IPhysics::deletePhysics(IPhysics* p_Physics)
 
 Body* Physics::findBody(BodyHandle p_Body)
 {
-	auto findRes = m_Bodies.find(p_Body);
-	if (findRes == m_Bodies.end())
-	{
-		return nullptr;
-	}
-
-	return &findRes->second;
+	return m_Bodies.find(p_Body);
 }
 
 void Physics::initialize(bool p_IsServer, float p_Timestep)
@@ -69,51 +68,195 @@ void Physics::update(float p_DeltaTime, unsigned p_MaxSteps)
 
 		m_LeftOverTime -= m_Timestep;
 
+		m_StepBodies.clear();
 		for(BodyHandle movableBodyHandle : m_MovableBodies)
 		{
-			Body& b = *findBody(movableBodyHandle);
+			m_StepBodies.push_back(findBody(movableBodyHandle));
+		}
+
+		if (m_BatchedIntegration)
+		{
+			m_Integrator.integrate(m_StepBodies, m_Timestep);
+		}
+		else
+		{
+			for (Body* body : m_StepBodies)
+			{
+				body->update(m_Timestep);
+			}
+		}
 
-			b.update(m_Timestep);
+		m_MovableOnGround.clear();
+		for(Body* body : m_StepBodies)
+		{
+			m_MovableOnGround.push_back(std::make_pair(body->getHandle(), false));
+		}
 
-			b.setLanded(false);
+		// Each task only moves its own movable body, the static bodies are only read.
+		m_MovableHits.resize(m_StepBodies.size());
+		m_WorkerPool->run(m_StepBodies.size(), [this] (size_t p_Movable, unsigned int p_Worker)
+		{
+			staticCollisionCheck(p_Movable, p_Worker);
+		});
 
-			bool isOnGround = false;
+		for (auto& hits : m_MovableHits)
+		{
+			m_HitDatas.insert(m_HitDatas.end(), hits.begin(), hits.end());
+			hits.clear();
+		}
 
-			m_Octree.findPotentialIntersections(
-				b.getSurroundingSphere(),
-					std::inserter(m_PotentialIntersections, m_PotentialIntersections.end()));
+		movablePairsCollisionCheck();
 
-			for (const auto& potentialIntersection : m_PotentialIntersections)
+		if(!m_IsServer)
+		{
+			for (const auto& onGround : m_MovableOnGround)
 			{
-				if(b.getHandle() == potentialIntersection)
-					continue;
-
-				Body& b2 = *findBody(potentialIntersection);
-				
-				singleCollisionCheck(b, b2, isOnGround);
+				Body& b = *findBody(onGround.first);
+				b.setOnSomething(onGround.second);
+				b.setInAir(!onGround.second);
 			}
-			m_PotentialIntersections.clear();
+		}
+	}
+}
 
-			for (BodyHandle otherMovableHandle : m_MovableBodies)
-			{
-				if (b.getHandle() == otherMovableHandle)
-					continue;
+void Physics::setBatchedIntegration(bool p_Enabled)
+{
+	m_BatchedIntegration = p_Enabled;
+}
 
-				Body& b2 = *findBody(otherMovableHandle);
+void Physics::setNumWorkerThreads(unsigned int p_NumThreads)
+{
+	if (p_NumThreads == 0)
+		p_NumThreads = 1;
 
-				singleCollisionCheck(b, b2, isOnGround);
-			}
+	if (m_WorkerPool && m_WorkerPool->getWorkerCount() == p_NumThreads)
+		return;
 
-			if(!m_IsServer)
-			{
-				b.setOnSomething(isOnGround);
-				b.setInAir(!isOnGround);
-			}
+	m_WorkerPool.reset(new WorkerPool(p_NumThreads));
+	m_WorkerCandidates.resize(m_WorkerPool->getWorkerCount());
+}
+
+void Physics::staticCollisionCheck(size_t p_Movable, unsigned int p_Worker)
+{
+	Body& b = *m_StepBodies[p_Movable];
+	std::vector<BodyHandle>& candidates = m_WorkerCandidates[p_Worker];
+
+	b.setLanded(false);
+
+	m_Octree.findPotentialIntersections(b.getSurroundingSphere(), std::back_inserter(candidates));
+
+	// Visit the candidates in handle order, regardless of how the octree found them.
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	bool& isOnGround = m_MovableOnGround[p_Movable].second;
+	for (BodyHandle potentialIntersection : candidates)
+	{
+		if(b.getHandle() == potentialIntersection)
+			continue;
+
+		Body& b2 = *findBody(potentialIntersection);
+
+		singleCollisionCheck(b, b2, isOnGround, m_MovableHits[p_Movable]);
+	}
+	candidates.clear();
+}
+
+void Physics::movablePairsCollisionCheck()
+{
+	m_MovableBroadphase.findOverlappingPairs(m_MovablePairs);
+
+	if (m_WorkerPool->getWorkerCount() < 2)
+	{
+		for (const auto& movablePair : m_MovablePairs)
+		{
+			pairCollisionCheck(*findBody(movablePair.first), m_MovableOnGround[movableIndex(movablePair.first)].second,
+				*findBody(movablePair.second), m_MovableOnGround[movableIndex(movablePair.second)].second, m_HitDatas);
+		}
+		return;
+	}
+
+	// Pairs in different islands share no bodies and can be resolved in parallel,
+	// the pairs within an island are resolved in the same order as the serial loop.
+	buildIslands();
+
+	m_PairHits.resize(m_MovablePairs.size());
+	m_WorkerPool->run(m_IslandStarts.size() - 1, [this] (size_t p_Island, unsigned int)
+	{
+		for (size_t i = m_IslandStarts[p_Island]; i < m_IslandStarts[p_Island + 1]; ++i)
+		{
+			const size_t pairIndex = m_IslandPairs[i];
+			const SweepAndPrune::BodyPair& movablePair = m_MovablePairs[pairIndex];
+			pairCollisionCheck(*findBody(movablePair.first), m_MovableOnGround[movableIndex(movablePair.first)].second,
+				*findBody(movablePair.second), m_MovableOnGround[movableIndex(movablePair.second)].second, m_PairHits[pairIndex]);
+		}
+	});
+
+	for (auto& hits : m_PairHits)
+	{
+		m_HitDatas.insert(m_HitDatas.end(), hits.begin(), hits.end());
+		hits.clear();
+	}
+}
+
+void Physics::buildIslands()
+{
+	const size_t numMovables = m_MovableOnGround.size();
+	m_IslandRoots.resize(numMovables);
+	for (size_t i = 0; i < numMovables; ++i)
+	{
+		m_IslandRoots[i] = i;
+	}
+
+	for (const auto& movablePair : m_MovablePairs)
+	{
+		const size_t root1 = findIslandRoot(movableIndex(movablePair.first));
+		const size_t root2 = findIslandRoot(movableIndex(movablePair.second));
+		m_IslandRoots[std::max(root1, root2)] = std::min(root1, root2);
+	}
+
+	// Number the islands in order of their first pair, then bucket the pairs.
+	static const size_t noIsland = (size_t)-1;
+	std::vector<size_t> islandIds(numMovables, noIsland);
+	std::vector<size_t> pairIslands;
+	pairIslands.reserve(m_MovablePairs.size());
+	m_IslandStarts.assign(1, 0);
+	for (const auto& movablePair : m_MovablePairs)
+	{
+		size_t& island = islandIds[findIslandRoot(movableIndex(movablePair.first))];
+		if (island == noIsland)
+		{
+			island = m_IslandStarts.size() - 1;
+			m_IslandStarts.push_back(0);
 		}
+		pairIslands.push_back(island);
+		++m_IslandStarts[island + 1];
+	}
+
+	for (size_t i = 1; i < m_IslandStarts.size(); ++i)
+	{
+		m_IslandStarts[i] += m_IslandStarts[i - 1];
+	}
+
+	std::vector<size_t> fill(m_IslandStarts.begin(), m_IslandStarts.end() - 1);
+	m_IslandPairs.resize(m_MovablePairs.size());
+	for (size_t i = 0; i < pairIslands.size(); ++i)
+	{
+		m_IslandPairs[fill[pairIslands[i]]++] = i;
 	}
 }
 
-void Physics::singleCollisionCheck(Body& p_Collider, Body& p_Victim, bool& p_IsOnGround)
+size_t Physics::findIslandRoot(size_t p_Movable)
+{
+	while (m_IslandRoots[p_Movable] != p_Movable)
+	{
+		m_IslandRoots[p_Movable] = m_IslandRoots[m_IslandRoots[p_Movable]];
+		p_Movable = m_IslandRoots[p_Movable];
+	}
+	return p_Movable;
+}
+
+void Physics::singleCollisionCheck(Body& p_Collider, Body& p_Victim, bool& p_IsOnGround, std::vector<HitData>& p_Hits)
 {
 	if (!Collision::surroundingSphereVsSphere(*p_Collider.getSurroundingSphere(), *p_Victim.getSurroundingSphere()))
 		return;
@@ -129,28 +272,59 @@ void Physics::singleCollisionCheck(Body& p_Collider, Body& p_Victim, bool& p_IsO
 				if(isCameraPlayerCollision(p_Collider, p_Victim))
 					break;
 
-				if(k == 0 && hit.colType == Type::HULLVSSPHERE)
-				{
-					XMFLOAT4 fBodyPos = p_Collider.getPosition();
-					XMFLOAT4 fVictimPos = p_Victim.getPosition();
-					Sphere s = ((Hull*)p_Victim.getVolume(l))->getSphere();
-					float r  = ((Sphere*)p_Collider.getVolume(0))->getRadius();
-					if((s.getRadius() < 1.55f && fVictimPos.y > fBodyPos.y - 0.35f && fVictimPos.y < fBodyPos.y))
-					{
-						//PhysicsLogger::log(PhysicsLogger::Level::INFO, "StepSize");
-						setBodyForceCollisionNormal(p_Collider.getHandle(), p_Victim.getHandle(), true);
-					}
-					else
-						handleCollision(hit, p_Collider, k, p_Victim, l, p_IsOnGround);
-				}
-				else
-					handleCollision(hit, p_Collider, k, p_Victim, l, p_IsOnGround);
+				handleStepOrCollision(hit, p_Collider, k, p_Victim, l, p_IsOnGround, p_Hits);
 			}
 		}
 	}
 }
 
-void Physics::handleCollision(HitData p_Hit, Body& p_Collider, int p_ColliderVolumeId, Body& p_Victim, int p_VictimVolumeID, bool &p_IsOnGround)
+void Physics::pairCollisionCheck(Body& p_Body1, bool& p_IsOnGround1, Body& p_Body2, bool& p_IsOnGround2, std::vector<HitData>& p_Hits)
+{
+	if (!Collision::surroundingSphereVsSphere(*p_Body1.getSurroundingSphere(), *p_Body2.getSurroundingSphere()))
+		return;
+
+	for(unsigned int k = 0; k < p_Body1.getVolumeListSize(); k++)
+	{
+		for(unsigned int l = 0; l < p_Body2.getVolumeListSize(); l++)
+		{
+			const BoundingVolume& volume1 = *p_Body1.getVolume(k);
+			const BoundingVolume& volume2 = *p_Body2.getVolume(l);
+			HitData hit = Collision::boundingVolumeVsBoundingVolume(volume1, volume2);
+
+			if(hit.intersect)
+			{
+				if(isCameraPlayerCollision(p_Body1, p_Body2))
+					break;
+
+				//If the first body was moved out of the second one, the second body no longer collides with it.
+				if(!handleStepOrCollision(hit, p_Body1, k, p_Body2, l, p_IsOnGround1, p_Hits))
+					handleStepOrCollision(Collision::mirrorHitData(hit, volume1, volume2), p_Body2, l, p_Body1, k, p_IsOnGround2, p_Hits);
+			}
+		}
+	}
+}
+
+bool Physics::handleStepOrCollision(const HitData& p_Hit, Body& p_Collider, int p_ColliderVolumeId, Body& p_Victim, int p_VictimVolumeID, bool &p_IsOnGround, std::vector<HitData>& p_Hits)
+{
+	//A small hull just below the center of the collider sphere is stepped onto instead of pushed against.
+	if(p_ColliderVolumeId == 0 && p_Hit.colType == Type::HULLVSSPHERE
+		&& p_Collider.getVolume(0)->getType() == BoundingVolume::Type::SPHERE)
+	{
+		XMFLOAT4 fBodyPos = p_Collider.getPosition();
+		XMFLOAT4 fVictimPos = p_Victim.getPosition();
+		Sphere s = ((Hull*)p_Victim.getVolume(p_VictimVolumeID))->getSphere();
+		if((s.getRadius() < 1.55f && fVictimPos.y > fBodyPos.y - 0.35f && fVictimPos.y < fBodyPos.y))
+		{
+			//PhysicsLogger::log(PhysicsLogger::Level::INFO, "StepSize");
+			setBodyForceCollisionNormal(p_Collider.getHandle(), p_Victim.getHandle(), true);
+			return false;
+		}
+	}
+
+	return handleCollision(p_Hit, p_Collider, p_ColliderVolumeId, p_Victim, p_VictimVolumeID, p_IsOnGround, p_Hits);
+}
+
+bool Physics::handleCollision(HitData p_Hit, Body& p_Collider, int p_ColliderVolumeId, Body& p_Victim, int p_VictimVolumeID, bool &p_IsOnGround, std::vector<HitData>& p_Hits)
 {
 	Body& b = p_Collider;
 	Body& b1 = p_Victim;
@@ -158,7 +332,7 @@ void Physics::handleCollision(HitData p_Hit, Body& p_Collider, int p_ColliderVol
 	p_Hit.IDInBody = p_ColliderVolumeId;
 	p_Hit.collisionVictim = b1.getHandle();
 	p_Hit.isEdge = b1.getIsEdge();
-	m_HitDatas.push_back(p_Hit);
+	p_Hits.push_back(p_Hit);
 
 	if(!m_IsServer)
 	{
@@ -198,8 +372,24 @@ void Physics::handleCollision(HitData p_Hit, Body& p_Collider, int p_ColliderVol
 			XMStoreFloat4(&tempPos, temp);
 
 			b.setPosition(tempPos);
+
+			return true;
 		}
 	}
+
+	return false;
+}
+
+size_t Physics::movableIndex(BodyHandle p_Body) const
+{
+	// Filled in the order of m_MovableBodies, which is sorted by slot index rather than handle value.
+	auto it = std::lower_bound(m_MovableOnGround.begin(), m_MovableOnGround.end(), p_Body,
+		[] (const std::pair<BodyHandle, bool>& p_OnGround, BodyHandle p_Handle)
+		{
+			return SlotMap<Body>::getIndex(p_OnGround.first) < SlotMap<Body>::getIndex(p_Handle);
+		});
+
+	return it - m_MovableOnGround.begin();
 }
 
 void Physics::applyForce(BodyHandle p_Body, Vector3 p_Force)
@@ -271,6 +461,11 @@ void Physics::addSphereToBody(BodyHandle p_BodyHandle, Vector3 p_Position, float
 	Sphere* sphere = new Sphere(p_Radius / 100.f, tempPosition);
 
 	body->addVolume(BoundingVolume::ptr(sphere));
+
+	if (body->getIsImmovable())
+	{
+		m_Octree.updateBody(body->getHandle(), body->getSurroundingSphere());
+	}
 }
 
 void Physics::addOBBToBody(BodyHandle p_BodyHandle, Vector3 p_CenterPos, Vector3 p_Extents) 
@@ -287,39 +482,23 @@ void Physics::addOBBToBody(BodyHandle p_BodyHandle, Vector3 p_CenterPos, Vector3
 	OBB* obb = new OBB(tempPosition, tempExt);
 
 	body->addVolume(BoundingVolume::ptr(obb));
-}
 
-BodyHandle Physics::createBVInstance(const char* p_VolumeID)
-{
-	std::vector<BVLoader::BoundingVolume> tempBV;
-	for(auto& bv : m_TemplateBVList)
+	if (body->getIsImmovable())
 	{
-		if(strcmp(bv.first.c_str(), p_VolumeID) == 0)
-		{
-			tempBV = bv.second;
-			break;
-		}
+		m_Octree.updateBody(body->getHandle(), body->getSurroundingSphere());
 	}
+}
 
-	if(tempBV.empty())
+BodyHandle Physics::createBVInstance(const char* p_VolumeID)
+{
+	auto bv = m_TemplateBVList.find(p_VolumeID);
+	if(bv == m_TemplateBVList.end())
 	{	
 		PhysicsLogger::log(PhysicsLogger::Level::ERROR_L, "Bounding Volume from template is empty");
 		return (BodyHandle)0;
 	}
 
-	std::vector<Triangle> triangles;
-	Triangle triangle;
-
-	for(unsigned i = 0; i < tempBV.size() / 3; i++)
-	{
-		triangle.corners[0] = tempBV[i * 3].m_Postition;
-		triangle.corners[1] = tempBV[i * 3 + 1].m_Postition;
-		triangle.corners[2] = tempBV[i * 3 + 2].m_Postition;
-
-		triangles.push_back(triangle);
-	}
-
-	Hull *hull = new Hull(triangles);
+	Hull *hull = new Hull(bv->second);
 
 	return createBody(1.f, hull, true, false);
 
@@ -327,21 +506,21 @@ BodyHandle Physics::createBVInstance(const char* p_VolumeID)
 
 void Physics::releaseBody(BodyHandle p_Body)
 {
-	auto findIt = m_Bodies.find(p_Body);
-	if (findIt == m_Bodies.end())
+	Body* removedBody = findBody(p_Body);
+	if (!removedBody)
 		return;
 
-	Body& removedBody = findIt->second;
-	if (removedBody.getIsImmovable())
+	if (removedBody->getIsImmovable())
 	{
-		m_Octree.removeBody(p_Body, removedBody.getSurroundingSphere());
+		m_Octree.removeBody(p_Body);
 	}
 	else
 	{
-		m_MovableBodies.erase(p_Body);
+		m_MovableBodies.erase(std::find(m_MovableBodies.begin(), m_MovableBodies.end(), p_Body));
+		m_MovableBroadphase.removeBody(p_Body);
 	}
 
-	m_Bodies.erase(findIt);
+	m_Bodies.erase(p_Body);
 }
 
 bool Physics::createBV(const char* p_VolumeID, const char* p_FilePath)
@@ -367,36 +546,51 @@ bool Physics::createBV(const char* p_VolumeID, const char* p_FilePath)
 		tempBV[i].m_Postition.z *= 0.01f; 
 	}
 
-	m_TemplateBVList.push_back(std::pair<std::string, std::vector<BVLoader::BoundingVolume>>(p_VolumeID, tempBV));
+	std::vector<Triangle> triangles;
+	triangles.reserve(tempBV.size() / 3);
+
+	for(unsigned i = 0; i < tempBV.size() / 3; i++)
+	{
+		triangles.push_back(Triangle(tempBV[i * 3].m_Postition, tempBV[i * 3 + 1].m_Postition, tempBV[i * 3 + 2].m_Postition));
+	}
+
+	m_TemplateBVList[p_VolumeID] = std::make_shared<HullMesh>(std::move(triangles));
 	m_BVLoader.clear();
 	//PhysicsLogger::log(PhysicsLogger::Level::INFO, "CreateBV success");
 	return true;
 }
 
-bool Physics::releaseBV(const char* p_VolumeID)
+bool Physics::copyBV(const char* p_VolumeID, const IPhysics* p_Source)
 {
-	for(auto bv = m_TemplateBVList.begin(); bv != m_TemplateBVList.end(); bv++)
+	const Physics* source = static_cast<const Physics*>(p_Source);
+
+	auto bv = source->m_TemplateBVList.find(p_VolumeID);
+	if (bv == source->m_TemplateBVList.end())
 	{
-		const char* temp = bv->first.c_str();
-		if(strcmp(temp, p_VolumeID) == 0)
-		{
-			m_TemplateBVList.erase(bv);
-			return true;
-		}
+		PhysicsLogger::log(PhysicsLogger::Level::ERROR_L, "Bounding Volume to copy does not exist");
+		return false;
 	}
 
-	return false;
+	m_TemplateBVList[p_VolumeID] = bv->second;
+	return true;
+}
+
+bool Physics::releaseBV(const char* p_VolumeID)
+{
+	// Bodies already created from the template keep the mesh alive until they are released.
+	return m_TemplateBVList.erase(p_VolumeID) > 0;
 }
 
 void Physics::releaseAllBoundingVolumes(void)
 {
-	std::swap(m_Bodies, std::map<BodyHandle, Body>());
+	m_Bodies.clear();
 
 	Body::resetBodyHandleCounter();
 	m_sphereBoundingVolume.clear();
 
 	m_Octree.reset();
 	m_MovableBodies.clear();
+	m_MovableBroadphase.reset();
 }
 
 void Physics::setBodyScale(BodyHandle p_BodyHandle, Vector3 p_Scale)
@@ -405,25 +599,21 @@ void Physics::setBodyScale(BodyHandle p_BodyHandle, Vector3 p_Scale)
 	if(!body)
 		throw PhysicsException("Error! Trying to set scale to a a non existing body! BodyHandle =" + std::to_string(p_BodyHandle), __LINE__, __FILE__);
 	
-	if (body->getIsImmovable())
-	{
-		m_Octree.removeBody(body->getHandle(), body->getSurroundingSphere());
-	}
-
 	XMVECTOR scale = Vector3ToXMVECTOR(&p_Scale, 0.f);
 
 	body->getVolume()->scale(scale);
 
 	if (body->getIsImmovable())
 	{
-		m_Octree.addBody(body->getHandle(), body->getSurroundingSphere());
+		m_Octree.updateBody(body->getHandle(), body->getSurroundingSphere());
 	}
 }
 
 BodyHandle Physics::createBody(float p_Mass, BoundingVolume* p_BoundingVolume, bool p_IsImmovable, bool p_IsEdge)
 {
-	Body b(p_Mass, BoundingVolume::ptr(p_BoundingVolume), p_IsImmovable, p_IsEdge);
-	Body& insertedBody = m_Bodies[b.getHandle()] = std::move(b);
+	const BodyHandle handle = m_Bodies.insert(Body(p_Mass, BoundingVolume::ptr(p_BoundingVolume), p_IsImmovable, p_IsEdge));
+	Body& insertedBody = *m_Bodies.find(handle);
+	insertedBody.setHandle(handle);
 	insertedBody.setGravity(m_GlobalGravity);
 
 	if (p_IsImmovable)
@@ -432,7 +622,10 @@ BodyHandle Physics::createBody(float p_Mass, BoundingVolume* p_BoundingVolume, b
 	}
 	else
 	{
-		m_MovableBodies.insert(insertedBody.getHandle());
+		m_MovableBodies.insert(std::upper_bound(m_MovableBodies.begin(), m_MovableBodies.end(), handle,
+			[] (BodyHandle p_Left, BodyHandle p_Right) { return SlotMap<Body>::getIndex(p_Left) < SlotMap<Body>::getIndex(p_Right); }),
+			handle);
+		m_MovableBroadphase.addBody(insertedBody.getHandle(), insertedBody.getSurroundingSphere());
 	}
 
 	return insertedBody.getHandle();
@@ -592,11 +785,6 @@ void Physics::setBodyPosition( BodyHandle p_Body, Vector3 p_Position)
 	if(!body)
 		throw PhysicsException("Error! Trying to set position on non existing body! BodyHandle =" + std::to_string(p_Body), __LINE__, __FILE__);
 
-	if (body->getIsImmovable())
-	{
-		m_Octree.removeBody(body->getHandle(), body->getSurroundingSphere());
-	}
-
 	Vector3 convPosition = p_Position * 0.01f;	// m
 	XMFLOAT4 tempPosition = Vector3ToXMFLOAT4(&convPosition, 1.f);	// m
 
@@ -604,7 +792,7 @@ void Physics::setBodyPosition( BodyHandle p_Body, Vector3 p_Position)
 
 	if (body->getIsImmovable())
 	{
-		m_Octree.addBody(body->getHandle(), body->getSurroundingSphere());
+		m_Octree.updateBody(body->getHandle(), body->getSurroundingSphere());
 	}
 }
 
@@ -614,17 +802,12 @@ void Physics::setBodyVolumePosition( BodyHandle p_Body, unsigned p_Volume, Vecto
 	if(!body)
 		throw PhysicsException("Error! Trying to set volume position on non existing body! BodyHandle =" + std::to_string(p_Body), __LINE__, __FILE__);
 	
-	if (body->getIsImmovable())
-	{
-		m_Octree.removeBody(body->getHandle(), body->getSurroundingSphere());
-	}
-
 	Vector3 convPosition = p_Position * 0.01f;	// m
 	body->setVolumePosition(p_Volume, Vector3ToXMVECTOR(&convPosition, 1.f));
 
 	if (body->getIsImmovable())
 	{
-		m_Octree.addBody(body->getHandle(), body->getSurroundingSphere());
+		m_Octree.updateBody(body->getHandle(), body->getSurroundingSphere());
 	}
 }
 
@@ -760,16 +943,11 @@ void Physics::setRotation(BodyHandle p_Body, XMMATRIX& p_Rotation)
 	if(!body)
 		throw PhysicsException("Error! Trying to set rotation on non existing body! BodyHandle =" + std::to_string(p_Body), __LINE__, __FILE__);
 	
-	if (body->getIsImmovable())
-	{
-		m_Octree.removeBody(body->getHandle(), body->getSurroundingSphere());
-	}
-
 	body->setRotation(p_Rotation);
 
 	if (body->getIsImmovable())
 	{
-		m_Octree.addBody(body->getHandle(), body->getSurroundingSphere());
+		m_Octree.updateBody(body->getHandle(), body->getSurroundingSphere());
 	}
 }
 
@@ -864,38 +1042,261 @@ BodyHandle Physics::rayCast(const XMFLOAT4 &p_RayDirection, const XMFLOAT4 &p_Ra
 	rayOriginConv.y *= 0.01f;
 	rayOriginConv.z *= 0.01f;
 
-	float dist = FLT_MAX;
-	BodyHandle closestBody = (BodyHandle)-1;
+	// Only the first volume of hulls and spheres, as the client has always picked with.
+	return castRay(p_RayDirection, rayOriginConv, FLT_MAX, m_WorkerCandidates[0], true).body;
+}
 
-	for(auto& body : m_Bodies)
+void Physics::rayCast(const RayQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits)
+{
+	m_WorkerPool->run(p_NumQueries, [&] (size_t p_Index, unsigned int p_Worker)
 	{
-		const Body &b = body.second;
-		if(!b.getIsImmovable())
-			continue;
-		if(b.getIsEdge())
+		const RayQuery& query = p_Queries[p_Index];
+		XMFLOAT4 direction = Vector3ToXMFLOAT4(&query.direction, 0.f);
+		XMStoreFloat4(&direction, XMVector3Normalize(XMLoadFloat4(&direction)));
+		const Vector3 convOrigin = query.origin * 0.01f;	// m
+
+		p_Hits[p_Index] = castRay(direction, Vector3ToXMFLOAT4(&convOrigin, 1.f), query.maxDistance * 0.01f, m_WorkerCandidates[p_Worker]);
+	});
+}
+
+void Physics::sphereOverlap(const SphereQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits)
+{
+	m_WorkerPool->run(p_NumQueries, [&] (size_t p_Index, unsigned int p_Worker)
+	{
+		const SphereQuery& query = p_Queries[p_Index];
+		const Vector3 convCenter = query.center * 0.01f;	// m
+		const Sphere sphere(query.radius * 0.01f, Vector3ToXMFLOAT4(&convCenter, 1.f));
+
+		std::vector<BodyHandle>& candidates = m_WorkerCandidates[p_Worker];
+		m_Octree.findPotentialIntersections(&sphere, std::back_inserter(candidates));
+		filterQueryCandidates(candidates);
+
+		QueryHit hit;
+		overlapSphere(sphere, candidates, hit);
+		p_Hits[p_Index] = hit;
+		candidates.clear();
+	});
+}
+
+void Physics::sweptSphere(const SweptSphereQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits)
+{
+	m_WorkerPool->run(p_NumQueries, [&] (size_t p_Index, unsigned int p_Worker)
+	{
+		p_Hits[p_Index] = sweepSphere(p_Queries[p_Index], m_WorkerCandidates[p_Worker]);
+	});
+}
+
+QueryHit Physics::castRay(const XMFLOAT4& p_RayDirection, const XMFLOAT4& p_RayOrigin, float p_MaxDistance,
+	std::vector<BodyHandle>& p_Candidates, bool p_HullsAndSpheresOnly)
+{
+	m_Octree.findPotentialRayIntersections(p_RayDirection, p_RayOrigin, p_MaxDistance, std::back_inserter(p_Candidates));
+	filterQueryCandidates(p_Candidates);
+
+	const QueryHit result = rayVsCandidates(p_RayDirection, p_RayOrigin, p_MaxDistance, p_Candidates, p_HullsAndSpheresOnly);
+	p_Candidates.clear();
+
+	return result;
+}
+
+QueryHit Physics::rayVsCandidates(const XMFLOAT4& p_RayDirection, const XMFLOAT4& p_RayOrigin, float p_MaxDistance,
+	const std::vector<BodyHandle>& p_Candidates, bool p_HullsAndSpheresOnly)
+{
+	QueryHit result;
+	float dist = FLT_MAX;	// m
+
+	for (BodyHandle candidate : p_Candidates)
+	{
+		Body& b = *findBody(candidate);
+		const unsigned int numVolumes = p_HullsAndSpheresOnly ? std::min(b.getVolumeListSize(), 1u) : b.getVolumeListSize();
+		for (unsigned int i = 0; i < numVolumes; ++i)
+		{
+			const BoundingVolume::Type type = b.getVolume(i)->getType();
+			if (p_HullsAndSpheresOnly && type != BoundingVolume::Type::HULL && type != BoundingVolume::Type::SPHERE)
+				continue;
+
+			XMFLOAT4 normal;
+			const float tempDist = Collision::rayVsBoundingVolume(*b.getVolume(i), p_RayDirection, p_RayOrigin, normal);
+			if (tempDist > 0.f && tempDist < dist && tempDist <= p_MaxDistance)
+			{
+				dist = tempDist;
+				result.body = candidate;
+				result.normal = XMFLOAT4ToVector3(&normal);
+			}
+		}
+	}
+
+	if (result.body != 0)
+	{
+		XMFLOAT4 point;
+		XMStoreFloat4(&point, (XMLoadFloat4(&p_RayOrigin) + XMLoadFloat4(&p_RayDirection) * dist) * 100.f);
+		result.point = XMFLOAT4ToVector3(&point);
+		result.distance = dist * XMVectorGetX(XMVector3Length(XMLoadFloat4(&p_RayDirection))) * 100.f;
+	}
+
+	return result;
+}
+
+bool Physics::overlapSphere(const Sphere& p_Sphere, const std::vector<BodyHandle>& p_Candidates, QueryHit& p_Hit)
+{
+	float deepest = -1.f;	// m
+
+	for (BodyHandle candidate : p_Candidates)
+	{
+		Body& b = *findBody(candidate);
+		if (!Collision::surroundingSphereVsSphere(*b.getSurroundingSphere(), p_Sphere))
 			continue;
-		
-		float tempDist;
-		const BoundingVolume* volume = b.getVolume();
-		if (volume->getType() == BoundingVolume::Type::HULL)
-			tempDist = Collision::rayTriangleIntersect((Hull&)*volume, p_RayDirection, rayOriginConv);
-		else if(volume->getType() == BoundingVolume::Type::SPHERE)
-			tempDist = Collision::raySphereIntersect((Sphere&)*volume, p_RayDirection, rayOriginConv);
-
-		
-		if(tempDist > 0.f && tempDist < dist)
+
+		for (unsigned int i = 0; i < b.getVolumeListSize(); ++i)
+		{
+			// The normal pushes the first volume out of the second, so it points out of the body.
+			const HitData hit = Collision::boundingVolumeVsBoundingVolume(p_Sphere, *b.getVolume(i));
+			if (hit.intersect && hit.colLength > deepest)
+			{
+				deepest = hit.colLength;
+				p_Hit.body = candidate;
+				p_Hit.normal = Vector3(hit.colNorm.x, hit.colNorm.y, hit.colNorm.z);
+			}
+		}
+	}
+
+	if (deepest < 0.f)
+		return false;
+
+	const XMFLOAT4 center = p_Sphere.getPosition();
+	const XMVECTOR normal = XMVectorSet(p_Hit.normal.x, p_Hit.normal.y, p_Hit.normal.z, 0.f);
+	XMFLOAT4 point;
+	XMStoreFloat4(&point, (XMLoadFloat4(&center) - normal * (p_Sphere.getRadius() - deepest)) * 100.f);
+	p_Hit.point = XMFLOAT4ToVector3(&point);
+	p_Hit.distance = deepest * 100.f;
+
+	return true;
+}
+
+QueryHit Physics::sweepSphere(const SweptSphereQuery& p_Query, std::vector<BodyHandle>& p_Candidates)
+{
+	const float radius = p_Query.radius * 0.01f;	// m
+	const Vector3 convStart = p_Query.start * 0.01f;	// m
+	const Vector3 convEnd = p_Query.end * 0.01f;	// m
+	const XMVECTOR start = Vector3ToXMVECTOR(&convStart, 1.f);
+	const XMVECTOR path = Vector3ToXMVECTOR(&convEnd, 1.f) - start;
+	const float length = XMVectorGetX(XMVector3Length(path));	// m
+
+	// Also true for NaN.
+	if (!(length <= FLT_MAX) || !(radius <= FLT_MAX))
+		return QueryHit();
+
+	if (radius <= 0.f)
+	{
+		if (length <= 0.f)
+			return QueryHit();
+
+		XMFLOAT4 rayDirection, rayOrigin;
+		XMStoreFloat4(&rayDirection, path);
+		XMStoreFloat4(&rayOrigin, start);
+		return castRay(rayDirection, rayOrigin, 1.f, p_Candidates);
+	}
+
+	XMFLOAT4 middle;
+	XMStoreFloat4(&middle, start + path * 0.5f);
+	const Sphere bounds(length * 0.5f + radius, middle);
+	m_Octree.findPotentialIntersections(&bounds, std::back_inserter(p_Candidates));
+	filterQueryCandidates(p_Candidates);
+
+	SweepPath sweep;
+	XMStoreFloat4(&sweep.start, start);
+	XMStoreFloat4(&sweep.path, path);
+	sweep.length = length;
+	sweep.radius = radius;
+
+	QueryHit hit;
+	float touching = -1.f;
+	if (overlapSphere(Sphere(radius, sweep.at(0.f)), p_Candidates, hit))
+	{
+		touching = 0.f;
+	}
+	else if (length > 0.f)
+	{
+		// The ratio is compared as a float, as it overflows for tiny radii.
+		const float steps = ceilf(length / radius * sweepStepsPerRadius);
+		unsigned int numSteps = maxSweepSteps;
+		if (steps < (float)maxSweepSteps)
+			numSteps = std::max((unsigned int)steps, 1u);
+		for (unsigned int i = 0; i < numSteps && touching < 0.f; ++i)
 		{
-			dist = tempDist;
-			closestBody = b.getHandle();
+			touching = sweepInterval(sweep, (float)i / numSteps, (float)(i + 1) / numSteps, sweepIntervalDepth, p_Candidates, hit);
 		}
 	}
+	p_Candidates.clear();
 
-	if(dist == FLT_MAX)
+	if (touching < 0.f)
+		return QueryHit();
+
+	hit.distance = touching * length * 100.f;
+	return hit;
+}
+
+float Physics::sweepInterval(const SweepPath& p_Sweep, float p_Begin, float p_End, unsigned int p_Depth,
+	const std::vector<BodyHandle>& p_Candidates, QueryHit& p_Hit)
+{
+	// Every sphere centered on the path between the ends is inside one sphere at the middle,
+	// wider by half the interval. Only intervals where that sphere touches something are split.
+	const float halfLength = (p_End - p_Begin) * 0.5f * p_Sweep.length;	// m
+	const float coverRadius = p_Sweep.radius + halfLength;
+	QueryHit coverHit;
+	if (!overlapSphere(Sphere(coverRadius, p_Sweep.at((p_Begin + p_End) * 0.5f)), p_Candidates, coverHit))
+		return -1.f;
+
+	if (p_Depth > 0)
+	{
+		const float middle = (p_Begin + p_End) * 0.5f;
+		const float touching = sweepInterval(p_Sweep, p_Begin, middle, p_Depth - 1, p_Candidates, p_Hit);
+		return touching >= 0.f ? touching : sweepInterval(p_Sweep, middle, p_End, p_Depth - 1, p_Candidates, p_Hit);
+	}
+
+	// Find a point in the interval where the sphere touches, either at the end or where
+	// the center passes through a thin surface. A touch only grazing the sphere between
+	// those may be missed, by at most the length of the interval.
+	float touching = p_End;
+	if (!overlapSphere(Sphere(p_Sweep.radius, p_Sweep.at(p_End)), p_Candidates, p_Hit))
 	{
-		return 0;
+		XMFLOAT4 rayDirection;
+		XMStoreFloat4(&rayDirection, XMLoadFloat4(&p_Sweep.path) * (p_End - p_Begin));
+		const QueryHit rayHit = rayVsCandidates(rayDirection, p_Sweep.at(p_Begin), 1.f, p_Candidates, false);
+		if (rayHit.body == 0)
+			return -1.f;
+
+		touching = p_Begin + rayHit.distance * 0.01f / p_Sweep.length;
+		if (!overlapSphere(Sphere(p_Sweep.radius, p_Sweep.at(touching)), p_Candidates, p_Hit))
+			return -1.f;
 	}
 
-	return closestBody;
+	// The start of the interval is free, bisect to the first touch.
+	float free = p_Begin;
+	for (unsigned int i = 0; i < sweepRefineSteps; ++i)
+	{
+		const float t = (free + touching) * 0.5f;
+		QueryHit midHit;
+		if (overlapSphere(Sphere(p_Sweep.radius, p_Sweep.at(t)), p_Candidates, midHit))
+		{
+			touching = t;
+			p_Hit = midHit;
+		}
+		else
+		{
+			free = t;
+		}
+	}
+
+	return touching;
+}
+
+void Physics::filterQueryCandidates(std::vector<BodyHandle>& p_Candidates)
+{
+	// Visit the bodies in handle order, so ties go to the same body on every run.
+	std::sort(p_Candidates.begin(), p_Candidates.end());
+	p_Candidates.erase(std::unique(p_Candidates.begin(), p_Candidates.end()), p_Candidates.end());
+	p_Candidates.erase(std::remove_if(p_Candidates.begin(), p_Candidates.end(),
+		[this] (BodyHandle p_Body) { return findBody(p_Body)->getIsEdge(); }), p_Candidates.end());
 }
 
 bool Physics::validBody(BodyHandle p_BodyHandle)
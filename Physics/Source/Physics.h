@@ -1,31 +1,68 @@
 #pragma once
 #include "IPhysics.h"
 #include "Body.h"
+#include "BodyIntegrator.h"
 #include "BVLoader.h"
 #include "Octree.h"
+#include "SlotMap.h"
+#include "SweepAndPrune.h"
+#include "WorkerPool.h"
 
 #include <map>
-#include <set>
+#include <memory>
 
 class Physics : public IPhysics
 {
 public:
 private:
+	static const unsigned int sweepStepsPerRadius = 2;
+	static const unsigned int maxSweepSteps = 1024;
+	static const unsigned int sweepIntervalDepth = 3;
+	static const unsigned int sweepRefineSteps = 10;
+
+	struct SweepPath
+	{
+		DirectX::XMFLOAT4 start;	// m
+		DirectX::XMFLOAT4 path;		// m, from the start to the end
+		float length;				// m
+		float radius;				// m
+
+		DirectX::XMFLOAT4 at(float p_Fraction) const
+		{
+			DirectX::XMFLOAT4 position;
+			DirectX::XMStoreFloat4(&position, DirectX::XMLoadFloat4(&start) + DirectX::XMLoadFloat4(&path) * p_Fraction);
+			return position;
+		}
+	};
+
 	float m_GlobalGravity;
 	float m_Timestep;
 	float m_LeftOverTime;
 	std::vector<HitData> m_HitDatas;
 	BVLoader m_BVLoader;
 	bool m_LoadBVSphereTemplateOnce;
-	std::vector<std::pair<std::string, std::vector<BVLoader::BoundingVolume>>> m_TemplateBVList;
+	std::map<std::string, HullMesh::ptr> m_TemplateBVList;
 	std::vector<BVLoader::BoundingVolume> m_sphereBoundingVolume;
 	bool m_IsServer;
 	std::vector<DirectX::XMFLOAT3> m_BoxTriangleIndex;
 
-	std::map<BodyHandle, Body> m_Bodies;
+	SlotMap<Body> m_Bodies;
 	Octree m_Octree;
-	std::set<BodyHandle> m_PotentialIntersections;
-	std::set<BodyHandle> m_MovableBodies;
+	std::vector<BodyHandle> m_MovableBodies; // Sorted in memory order
+	SweepAndPrune m_MovableBroadphase;
+	std::vector<SweepAndPrune::BodyPair> m_MovablePairs;
+	std::vector<std::pair<BodyHandle, bool>> m_MovableOnGround;
+	BodyIntegrator m_Integrator;
+	bool m_BatchedIntegration;
+	std::vector<Body*> m_StepBodies;
+
+	std::unique_ptr<WorkerPool> m_WorkerPool;
+	std::vector<std::vector<BodyHandle>> m_WorkerCandidates; // Scratch space for the octree queries, one per worker
+	std::vector<std::vector<HitData>> m_MovableHits; // Hits against static bodies, one per movable body
+	std::vector<std::vector<HitData>> m_PairHits; // Hits between movable bodies, one per pair
+	std::vector<size_t> m_IslandRoots; // Union-find over the movable bodies, indexed like m_MovableOnGround
+	std::vector<size_t> m_IslandPairs; // Pair indices grouped by island, in pair order within each island
+	std::vector<size_t> m_IslandStarts; // Offset into m_IslandPairs for each island, plus an end marker
 
 public:
 	Physics();
@@ -34,6 +71,8 @@ public:
 	void initialize(bool p_IsServer, float p_Timestep) override;
 
 	void update(float p_DeltaTime, unsigned p_MaxSteps) override;
+	void setBatchedIntegration(bool p_Enabled) override;
+	void setNumWorkerThreads(unsigned int p_NumThreads) override;
 	void applyForce(BodyHandle p_Body, Vector3 p_Force) override;
 	void applyImpulse(BodyHandle p_Body, Vector3 p_Impulse) override;
 
@@ -46,6 +85,7 @@ public:
 
 	BodyHandle createBVInstance(const char* p_VolumeID) override;
 	bool createBV(const char* m_ModelID, const char* m_FilePath) override;
+	bool copyBV(const char* p_VolumeID, const IPhysics* p_Source) override;
 
 	bool releaseBV(const char* p_ModelID) override; 
 	void releaseBody(BodyHandle p_Body) override;
@@ -92,6 +132,9 @@ public:
 	float getTimestep() const override;
 
 	BodyHandle rayCast(const DirectX::XMFLOAT4 &p_RayDirection, const DirectX::XMFLOAT4 &p_RayOrigin) override;
+	void rayCast(const RayQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits) override;
+	void sphereOverlap(const SphereQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits) override;
+	void sweptSphere(const SweptSphereQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits) override;
 
 private:
 	Body* findBody(BodyHandle p_Body);
@@ -104,9 +147,27 @@ private:
 
 	void setRotation(BodyHandle p_Body, DirectX::XMMATRIX& p_Rotation);
 
-	void singleCollisionCheck(Body& p_Collider, Body& p_Victim, bool& p_IsOnGround);
-	void handleCollision(HitData p_Hit, Body& p_Collider, int p_ColliderVolumeId, Body& p_Victim, int p_VictimVolumeID, bool &p_IsOnGround);
+	void staticCollisionCheck(size_t p_Movable, unsigned int p_Worker);
+	void movablePairsCollisionCheck();
+	void buildIslands();
+	size_t findIslandRoot(size_t p_Movable);
+
+	void singleCollisionCheck(Body& p_Collider, Body& p_Victim, bool& p_IsOnGround, std::vector<HitData>& p_Hits);
+	void pairCollisionCheck(Body& p_Body1, bool& p_IsOnGround1, Body& p_Body2, bool& p_IsOnGround2, std::vector<HitData>& p_Hits);
+	bool handleStepOrCollision(const HitData& p_Hit, Body& p_Collider, int p_ColliderVolumeId, Body& p_Victim, int p_VictimVolumeID, bool &p_IsOnGround, std::vector<HitData>& p_Hits);
+	bool handleCollision(HitData p_Hit, Body& p_Collider, int p_ColliderVolumeId, Body& p_Victim, int p_VictimVolumeID, bool &p_IsOnGround, std::vector<HitData>& p_Hits);
+	size_t movableIndex(BodyHandle p_Body) const;
 
 	bool isCameraPlayerCollision(Body const &p_Collider, Body const &p_Victim);
+
+	QueryHit castRay(const DirectX::XMFLOAT4& p_RayDirection, const DirectX::XMFLOAT4& p_RayOrigin, float p_MaxDistance,
+		std::vector<BodyHandle>& p_Candidates, bool p_HullsAndSpheresOnly = false);
+	QueryHit rayVsCandidates(const DirectX::XMFLOAT4& p_RayDirection, const DirectX::XMFLOAT4& p_RayOrigin, float p_MaxDistance,
+		const std::vector<BodyHandle>& p_Candidates, bool p_HullsAndSpheresOnly);
+	bool overlapSphere(const Sphere& p_Sphere, const std::vector<BodyHandle>& p_Candidates, QueryHit& p_Hit);
+	QueryHit sweepSphere(const SweptSphereQuery& p_Query, std::vector<BodyHandle>& p_Candidates);
+	float sweepInterval(const SweepPath& p_Sweep, float p_Begin, float p_End, unsigned int p_Depth,
+		const std::vector<BodyHandle>& p_Candidates, QueryHit& p_Hit);
+	void filterQueryCandidates(std::vector<BodyHandle>& p_Candidates);
 };
 
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "PhysicsExceptions.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Handle indexed storage with O(1) lookup. Values are stored in fixed size chunks,
+ * so they never move once inserted and pointers to them stay valid until they are erased.
+ * A handle holds the slot index and a generation counter, which makes handles to erased
+ * values invalid even after the slot has been reused. A slot whose generation counter
+ * has run out is retired instead of reused, so a handle is never handed out twice.
+ */
+template <typename T>
+class SlotMap
+{
+public:
+	typedef unsigned int Handle;
+
+private:
+	static const unsigned int m_IndexBits = 20;
+	static const unsigned int m_IndexMask = (1u << m_IndexBits) - 1;
+	static const unsigned int m_GenerationMask = 0xffffffffu >> m_IndexBits;
+	static const unsigned int m_ChunkSize = 256;
+
+	struct Slot
+	{
+		unsigned int generation;
+		bool used;
+
+		Slot() :
+			generation(0),
+			used(false)
+		{
+		}
+	};
+
+	typedef std::vector<T> Chunk;
+
+	std::vector<std::unique_ptr<Chunk>> m_Chunks;
+	std::vector<Slot> m_Slots;
+	std::vector<unsigned int> m_FreeSlots;
+	size_t m_Size;
+
+public:
+	/**
+	 * Iterates over the used slots in memory order.
+	 */
+	class iterator
+	{
+	private:
+		SlotMap* m_Map;
+		unsigned int m_Index;
+
+	public:
+		iterator(SlotMap* p_Map, unsigned int p_Index) :
+			m_Map(p_Map),
+			m_Index(p_Index)
+		{
+			skipUnused();
+		}
+
+		T& operator*() const
+		{
+			return m_Map->getSlotValue(m_Index);
+		}
+
+		T* operator->() const
+		{
+			return &m_Map->getSlotValue(m_Index);
+		}
+
+		iterator& operator++()
+		{
+			++m_Index;
+			skipUnused();
+			return *this;
+		}
+
+		bool operator==(const iterator& p_Other) const
+		{
+			return m_Index == p_Other.m_Index;
+		}
+
+		bool operator!=(const iterator& p_Other) const
+		{
+			return m_Index != p_Other.m_Index;
+		}
+
+		/**
+		 * Get the handle of the value the iterator points to.
+		 */
+		Handle getHandle() const
+		{
+			return m_Map->makeHandle(m_Index);
+		}
+
+	private:
+		void skipUnused()
+		{
+			while (m_Index < m_Map->m_Slots.size() && !m_Map->m_Slots[m_Index].used)
+				++m_Index;
+		}
+	};
+
+	SlotMap() :
+		m_Size(0)
+	{
+	}
+
+	/**
+	 * Store a value, reusing an erased slot if there is one.
+	 *
+	 * @param p_Value the value to move into the map
+	 * @return the handle of the stored value, never 0
+	 * @throws PhysicsException if all slot indices are in use or retired
+	 */
+	Handle insert(T&& p_Value)
+	{
+		unsigned int index;
+		if (!m_FreeSlots.empty())
+		{
+			index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			getSlotValue(index) = std::move(p_Value);
+		}
+		else
+		{
+			index = m_Slots.size();
+			if (index >= m_IndexMask)
+			{
+				throw PhysicsException("Out of slot map handles, " + std::to_string(index) + " slots in use or retired", __LINE__, __FILE__);
+			}
+			if (index % m_ChunkSize == 0)
+			{
+				m_Chunks.push_back(std::unique_ptr<Chunk>(new Chunk()));
+				m_Chunks.back()->reserve(m_ChunkSize);
+			}
+			m_Chunks.back()->push_back(std::move(p_Value));
+			m_Slots.push_back(Slot());
+		}
+
+		m_Slots[index].used = true;
+		++m_Size;
+
+		return makeHandle(index);
+	}
+
+	/**
+	 * Destroy the value of a handle. The slot is kept for later inserts unless
+	 * its generation counter has run out, but the handle and all its copies become invalid.
+	 *
+	 * @return true if the handle was valid
+	 */
+	bool erase(Handle p_Handle)
+	{
+		if (!find(p_Handle))
+			return false;
+
+		const unsigned int index = getIndex(p_Handle);
+		getSlotValue(index) = T();
+		m_Slots[index].used = false;
+		if (m_Slots[index].generation < m_GenerationMask)
+		{
+			++m_Slots[index].generation;
+			m_FreeSlots.push_back(index);
+		}
+		--m_Size;
+
+		return true;
+	}
+
+	/**
+	 * Find the value of a handle.
+	 *
+	 * @return the value or nullptr if the handle is invalid or has been erased
+	 */
+	T* find(Handle p_Handle)
+	{
+		const unsigned int index = getIndex(p_Handle);
+		if (p_Handle == 0 || index >= m_Slots.size())
+			return nullptr;
+
+		const Slot& slot = m_Slots[index];
+		if (!slot.used || slot.generation != (p_Handle >> m_IndexBits))
+			return nullptr;
+
+		return &getSlotValue(index);
+	}
+
+	const T* find(Handle p_Handle) const
+	{
+		return const_cast<SlotMap*>(this)->find(p_Handle);
+	}
+
+	/**
+	 * Destroy all values and forget all slots, the next handle handed out will be the same as for an empty map.
+	 */
+	void clear()
+	{
+		m_Chunks.clear();
+		m_Slots.clear();
+		m_FreeSlots.clear();
+		m_Size = 0;
+	}
+
+	size_t size() const
+	{
+		return m_Size;
+	}
+
+	bool empty() const
+	{
+		return m_Size == 0;
+	}
+
+	iterator begin()
+	{
+		return iterator(this, 0);
+	}
+
+	iterator end()
+	{
+		return iterator(this, m_Slots.size());
+	}
+
+	/**
+	 * Get the slot index of a handle, handles sorted by index are sorted in memory order.
+	 */
+	static unsigned int getIndex(Handle p_Handle)
+	{
+		return (p_Handle & m_IndexMask) - 1;
+	}
+
+private:
+	Handle makeHandle(unsigned int p_Index) const
+	{
+		return (m_Slots[p_Index].generation << m_IndexBits) | (p_Index + 1);
+	}
+
+	T& getSlotValue(unsigned int p_Index)
+	{
+		return (*m_Chunks[p_Index / m_ChunkSize])[p_Index % m_ChunkSize];
+	}
+};
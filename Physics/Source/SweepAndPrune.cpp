@@ -0,0 +1,120 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	bool endpointLess(float p_Value1, bool p_IsMin1, float p_Value2, bool p_IsMin2)
+	{
+		if (p_Value1 != p_Value2)
+			return p_Value1 < p_Value2;
+
+		// Touching bounds count as overlapping, so starts go before ends.
+		return p_IsMin1 && !p_IsMin2;
+	}
+}
+
+SweepAndPrune::SweepAndPrune()
+{
+}
+
+void SweepAndPrune::reset()
+{
+	m_Endpoints.clear();
+	m_Active.clear();
+}
+
+void SweepAndPrune::addBody(BodyHandle p_Body, const Sphere* p_Sphere)
+{
+	m_Endpoints.push_back(Endpoint(p_Body, p_Sphere, true));
+	m_Endpoints.push_back(Endpoint(p_Body, p_Sphere, false));
+}
+
+void SweepAndPrune::removeBody(BodyHandle p_Body)
+{
+	m_Endpoints.erase(std::remove_if(m_Endpoints.begin(), m_Endpoints.end(),
+		[p_Body] (const Endpoint& p_Endpoint) { return p_Endpoint.handle == p_Body; }),
+		m_Endpoints.end());
+}
+
+size_t SweepAndPrune::getBodyCount() const
+{
+	return m_Endpoints.size() / 2;
+}
+
+void SweepAndPrune::findOverlappingPairs(std::vector<BodyPair>& p_Pairs)
+{
+	p_Pairs.clear();
+
+	updateEndpoints();
+
+	m_Active.clear();
+	for (const auto& endpoint : m_Endpoints)
+	{
+		if (endpoint.isMin)
+		{
+			for (const Endpoint* active : m_Active)
+			{
+				if (!overlapYZ(active->sphere, endpoint.sphere))
+					continue;
+
+				if (active->handle < endpoint.handle)
+					p_Pairs.push_back(BodyPair(active->handle, endpoint.handle));
+				else
+					p_Pairs.push_back(BodyPair(endpoint.handle, active->handle));
+			}
+
+			m_Active.push_back(&endpoint);
+		}
+		else
+		{
+			for (size_t i = 0; i < m_Active.size(); ++i)
+			{
+				if (m_Active[i]->handle == endpoint.handle)
+				{
+					m_Active[i] = m_Active.back();
+					m_Active.pop_back();
+					break;
+				}
+			}
+		}
+	}
+
+	std::sort(p_Pairs.begin(), p_Pairs.end());
+}
+
+void SweepAndPrune::updateEndpoints()
+{
+	for (auto& endpoint : m_Endpoints)
+	{
+		const float center = endpoint.sphere->getPosition().x;
+		const float radius = endpoint.sphere->getRadius();
+		endpoint.value = endpoint.isMin ? center - radius : center + radius;
+	}
+
+	// Insertion sort, the order rarely changes much between two steps.
+	for (size_t i = 1; i < m_Endpoints.size(); ++i)
+	{
+		const Endpoint moving = m_Endpoints[i];
+		size_t j = i;
+		while (j > 0 && endpointLess(moving.value, moving.isMin, m_Endpoints[j - 1].value, m_Endpoints[j - 1].isMin))
+		{
+			m_Endpoints[j] = m_Endpoints[j - 1];
+			--j;
+		}
+		m_Endpoints[j] = moving;
+	}
+}
+
+bool SweepAndPrune::overlapYZ(const Sphere* p_Sphere1, const Sphere* p_Sphere2)
+{
+	const XMFLOAT4& pos1 = p_Sphere1->getPosition();
+	const XMFLOAT4& pos2 = p_Sphere2->getPosition();
+	const float radiusSum = p_Sphere1->getRadius() + p_Sphere2->getRadius();
+
+	return fabs(pos1.y - pos2.y) <= radiusSum &&
+		fabs(pos1.z - pos2.z) <= radiusSum;
+}
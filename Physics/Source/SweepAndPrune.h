@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Sphere.h"
+
+#include <utility>
+#include <vector>
+
+/**
+ * Broadphase for movable bodies. Keeps the bounds of every added body as
+ * sorted endpoints along the x axis and incrementally re-sorts them each step,
+ * which is close to linear since bodies move only a little between steps.
+ */
+class SweepAndPrune
+{
+public:
+	typedef unsigned int BodyHandle;
+	typedef std::pair<BodyHandle, BodyHandle> BodyPair;
+
+private:
+	struct Endpoint
+	{
+		float value;
+		BodyHandle handle;
+		const Sphere* sphere;
+		bool isMin;
+
+		Endpoint() :
+			value(0.f),
+			handle(0),
+			sphere(nullptr),
+			isMin(true)
+		{
+		}
+
+		Endpoint(BodyHandle p_Handle, const Sphere* p_Sphere, bool p_IsMin) :
+			value(0.f),
+			handle(p_Handle),
+			sphere(p_Sphere),
+			isMin(p_IsMin)
+		{
+		}
+	};
+
+	std::vector<Endpoint> m_Endpoints;
+	std::vector<const Endpoint*> m_Active;
+
+public:
+	SweepAndPrune();
+
+	void reset();
+
+	/**
+	 * Add a body to the broadphase.
+	 *
+	 * @param p_Body the handle reported in overlapping pairs
+	 * @param p_Sphere the sphere bounding the body, must stay valid until the body is removed
+	 */
+	void addBody(BodyHandle p_Body, const Sphere* p_Sphere);
+	void removeBody(BodyHandle p_Body);
+
+	size_t getBodyCount() const;
+
+	/**
+	 * Re-sort the endpoints from the current sphere positions and find all bodies
+	 * whose bounds overlap. Each pair is reported once with the lowest handle first,
+	 * and pairs are ordered by handle.
+	 *
+	 * @param p_Pairs cleared and filled with the overlapping pairs
+	 */
+	void findOverlappingPairs(std::vector<BodyPair>& p_Pairs);
+
+private:
+	void updateEndpoints();
+	static bool overlapYZ(const Sphere* p_Sphere1, const Sphere* p_Sphere2);
+};
@@ -0,0 +1,126 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(unsigned int p_NumThreads)
+	: m_Task(nullptr),
+	  m_TaskCount(0),
+	  m_BusyThreads(0),
+	  m_Generation(0),
+	  m_Stopping(false)
+{
+	m_NextIndex = 0;
+
+	for (unsigned int i = 1; i < p_NumThreads; ++i)
+	{
+		m_Threads.push_back(std::thread(&WorkerPool::threadMain, this, i));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Stopping = true;
+	}
+	m_WorkAvailable.notify_all();
+
+	for (auto& thread : m_Threads)
+	{
+		thread.join();
+	}
+}
+
+unsigned int WorkerPool::getWorkerCount() const
+{
+	return m_Threads.size() + 1;
+}
+
+void WorkerPool::run(size_t p_Count, const Task& p_Task)
+{
+	if (m_Threads.empty() || p_Count < 2)
+	{
+		for (size_t i = 0; i < p_Count; ++i)
+		{
+			p_Task(i, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Task = &p_Task;
+		m_TaskCount = p_Count;
+		m_NextIndex = 0;
+		m_BusyThreads = m_Threads.size();
+		++m_Generation;
+	}
+	m_WorkAvailable.notify_all();
+
+	work(0);
+
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock(m_Lock);
+		while (m_BusyThreads > 0)
+		{
+			m_WorkDone.wait(lock);
+		}
+		m_Task = nullptr;
+		std::swap(error, m_Error);
+	}
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+void WorkerPool::threadMain(unsigned int p_Worker)
+{
+	unsigned int seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Lock);
+			while (!m_Stopping && m_Generation == seenGeneration)
+			{
+				m_WorkAvailable.wait(lock);
+			}
+
+			if (m_Stopping)
+				return;
+
+			seenGeneration = m_Generation;
+		}
+
+		work(p_Worker);
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (--m_BusyThreads == 0)
+		{
+			m_WorkDone.notify_one();
+		}
+	}
+}
+
+void WorkerPool::work(unsigned int p_Worker)
+{
+	size_t index;
+	while ((index = m_NextIndex++) < m_TaskCount)
+	{
+		try
+		{
+			(*m_Task)(index, p_Worker);
+		}
+		catch (...)
+		{
+			// An exception must not leave a worker thread, pass it to run instead.
+			std::lock_guard<std::mutex> lock(m_Lock);
+			if (!m_Error)
+			{
+				m_Error = std::current_exception();
+			}
+			m_NextIndex = m_TaskCount;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of threads that run indexed tasks in parallel. The thread calling run
+ * takes part in the work as worker 0, so a pool without extra threads runs everything inline.
+ */
+class WorkerPool
+{
+public:
+	/**
+	 * A task is called once for every index, together with the id of the worker running it,
+	 * which can be used to pick per worker scratch data.
+	 */
+	typedef std::function<void (size_t p_Index, unsigned int p_Worker)> Task;
+
+private:
+	std::vector<std::thread> m_Threads;
+	std::mutex m_Lock;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_WorkDone;
+
+	const Task* m_Task;
+	size_t m_TaskCount;
+	std::atomic<size_t> m_NextIndex;
+	unsigned int m_BusyThreads;
+	unsigned int m_Generation;
+	bool m_Stopping;
+	std::exception_ptr m_Error;
+
+public:
+	/**
+	 * @param p_NumThreads the total number of workers, including the calling thread
+	 */
+	explicit WorkerPool(unsigned int p_NumThreads);
+	~WorkerPool();
+
+	/**
+	 * @return the number of workers, worker ids are below this number
+	 */
+	unsigned int getWorkerCount() const;
+
+	/**
+	 * Call a task for every index in [0, p_Count) and wait for all of them to finish.
+	 * The order the indices are run in is not specified.
+	 *
+	 * If a task throws, the indices not yet started are skipped and the first
+	 * exception is rethrown on the calling thread once every worker is done.
+	 */
+	void run(size_t p_Count, const Task& p_Task);
+
+private:
+	void threadMain(unsigned int p_Worker);
+	void work(unsigned int p_Worker);
+};
@@ -109,6 +109,12 @@ public:
 		m_Sphere.setPosition(p_newPosition);
 	}
 
+	void translate(DirectX::XMVECTOR const &p_Offset) override
+	{
+		BoundingVolume::translate(p_Offset);
+		calculateBounds();
+	}
+
 	/**
 	 * Sets a new size for AABB and recalculates.
 	 * @param p_Size, new size.
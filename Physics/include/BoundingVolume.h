@@ -38,6 +38,15 @@ public:
 	 * @param p_Position, move the BV in to this position.
 	 */
 	virtual void setPosition(DirectX::XMVECTOR const &p_Position) = 0;
+	/**
+	 * Moves the BoundingVolume without going through a translation matrix.
+	 * @param p_Offset, move the BV this much in relative coordinates, w should be 0.
+	 */
+	virtual void translate(DirectX::XMVECTOR const &p_Offset)
+	{
+		DirectX::XMVECTOR position = DirectX::XMLoadFloat4(&m_Position);
+		setPosition(DirectX::XMVectorAdd(position, p_Offset));
+	}
 	/**
 	 * Get the current position for the bounding volume.
 	 * @return the position of the bounding volume in m
@@ -1,6 +1,7 @@
 #pragma once
 #include "Sphere.h"
 #include "PhysicsTypes.h"
+#include "HullMesh.h"
 #include <DirectXMath.h>
 #include <vector>
 
@@ -8,7 +9,9 @@ class Hull : public BoundingVolume
 {
 private:
 	Sphere m_Sphere; //Sphere surrounding the hull
-	std::vector<Triangle> m_Triangles; //Triangles that make up the hull
+	HullMesh::ptr m_Mesh; //Triangles that make up the hull, shared between instances
+	DirectX::XMFLOAT4X4 m_Transform; //Scale and rotation from mesh space, the position is kept in m_Position
+	DirectX::XMFLOAT4X4 m_InverseTransform;
 	DirectX::XMFLOAT4	m_Scale;
 
 public:
@@ -20,15 +23,18 @@ public:
 	Hull(std::vector<Triangle> p_Triangles) :
 		BoundingVolume(&m_Sphere)
 	{
-		m_BodyHandle = 0;
-		m_Position = DirectX::XMFLOAT4(0.f, 0.f, 0.f, 1.f);
-		m_Triangles = p_Triangles;
-		m_Type = Type::HULL;
-		float radius = findFarthestDistanceOnTriangle();
-		m_Scale = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 0.f);
-		m_Sphere = Sphere( radius, m_Position );
-		m_CollisionResponse = true;
-		m_IDInBody = 0;
+		init(std::make_shared<HullMesh>(std::move(p_Triangles)));
+	}
+
+	/**
+	 * Constructor.
+	 * The hull is always created with origo as center position, call updatePosition to move the hull to its desired place.
+	 * @param p_Mesh, a shared mesh with the triangles that make up the hull
+	 */
+	explicit Hull(HullMesh::ptr p_Mesh) :
+		BoundingVolume(&m_Sphere)
+	{
+		init(std::move(p_Mesh));
 	}
 
 	/**
@@ -64,53 +70,21 @@ public:
 	}
 	
 	/**
-	 * Scales all the triangles in the hull
+	 * Scales the hull, the shared mesh is left untouched.
 	 * @param p_Scale is a vector3 with all the scale coordinates 
 	 */
 	void scale(DirectX::XMVECTOR const &p_Scale) override
 	{
-		DirectX::XMVECTOR c1, c2, c3;
-		DirectX::XMMATRIX m = DirectX::XMMatrixScalingFromVector(p_Scale);
 		DirectX::XMStoreFloat4(&m_Scale, p_Scale);
-		for(auto &tri : m_Triangles)
-		{
-			c1 = Vector4ToXMVECTOR(&tri.corners[0]);
-			c2 = Vector4ToXMVECTOR(&tri.corners[1]);
-			c3 = Vector4ToXMVECTOR(&tri.corners[2]);
-
-			c1 = DirectX::XMVector4Transform(c1, m);
-			c2 = DirectX::XMVector4Transform(c2, m);
-			c3 = DirectX::XMVector4Transform(c3, m);
-
-			tri.corners[0] = c1; 
-			tri.corners[1] = c2; 
-			tri.corners[2] = c3;
-		}
-		float radius = findFarthestDistanceOnTriangle();
-		m_Sphere.setRadius(radius);
-
+		appendTransform(DirectX::XMMatrixScalingFromVector(p_Scale));
 	}
 	/**
-	 * Rotates all the trangles in the hull
+	 * Rotates the hull, the shared mesh is left untouched.
 	 * @param p_Rotation matrix to rotate the triangles with.
 	 */
 	void setRotation(DirectX::XMMATRIX const &p_Rotation) override
 	{
-		DirectX::XMVECTOR c1, c2, c3;
-		for(auto& tri : m_Triangles)
-		{
-			c1 = Vector4ToXMVECTOR(&tri.corners[0]);
-			c2 = Vector4ToXMVECTOR(&tri.corners[1]);
-			c3 = Vector4ToXMVECTOR(&tri.corners[2]);
-
-			c1 = XMVector4Transform(c1, p_Rotation);
-			c2 = XMVector4Transform(c2, p_Rotation);
-			c3 = XMVector4Transform(c3, p_Rotation);
-
-			tri.corners[0] = c1;
-			tri.corners[1] = c2;
-			tri.corners[2] = c3;
-		}
+		appendTransform(p_Rotation);
 	}
 	/**
 	 * Get the sphere surrounding the hull.
@@ -127,16 +101,73 @@ public:
 	 */
 	const unsigned int getTriangleListSize() const
 	{
-		return m_Triangles.size();
+		return m_Mesh->getTriangleListSize();
 	}
 	/**
 	 * Gets a triangle from the hull
 	 * @param p_Index index of the triangle int the hulls triangle list
-	 * @return a triangle with local coordinates from the hulls triangle list at the specified index
+	 * @return a scaled and rotated triangle with local coordinates from the hulls triangle list at the specified index
+	 */
+	Triangle getTriangleAt(int p_Index) const
+	{
+		DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_Transform);
+		const Triangle& triangle = m_Mesh->getTriangleAt(p_Index);
+
+		Triangle result;
+		for (int i = 0; i < 3; i++)
+		{
+			result.corners[i] = DirectX::XMVector3Transform(Vector4ToXMVECTOR(&triangle.corners[i]), transform);
+		}
+		return result;
+	}
+	/**
+	 * Gets the mesh shared by all instances of the hull.
+	 * @return the triangles in mesh space
+	 */
+	const HullMesh::ptr& getMesh() const
+	{
+		return m_Mesh;
+	}
+	/**
+	 * Gets the scale and rotation from mesh space to world space, without the translation.
+	 */
+	const DirectX::XMFLOAT4X4& getTransform() const
+	{
+		return m_Transform;
+	}
+	/**
+	 * Gets the inverse of getTransform, to move world space directions into mesh space.
 	 */
-	const Triangle& getTriangleAt(int p_Index) const
+	const DirectX::XMFLOAT4X4& getInverseTransform() const
 	{
-		return m_Triangles.at(p_Index);
+		return m_InverseTransform;
+	}
+	/**
+	 * Finds the triangles that may be touched by a sphere, using the hierarchy of the shared mesh.
+	 * @param p_Center the center of the sphere in world coordinates
+	 * @param p_Radius the radius of the sphere
+	 * @param p_Result cleared and filled with the triangle indices in ascending order
+	 */
+	void findTrianglesNearSphere(DirectX::XMFLOAT4 const &p_Center, float p_Radius, std::vector<unsigned int> &p_Result) const
+	{
+		using DirectX::operator-;
+
+		//The sphere becomes an ellipsoid in mesh space, bound it by its extent along each mesh axis.
+		const DirectX::XMFLOAT4X4& inv = m_InverseTransform;
+		DirectX::XMVECTOR center = DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat4(&p_Center) - DirectX::XMLoadFloat4(&m_Position),
+			DirectX::XMLoadFloat4x4(&inv));
+		DirectX::XMFLOAT3 localCenter;
+		DirectX::XMStoreFloat3(&localCenter, center);
+
+		DirectX::XMFLOAT3 extents(
+			p_Radius * sqrtf(inv.m[0][0] * inv.m[0][0] + inv.m[1][0] * inv.m[1][0] + inv.m[2][0] * inv.m[2][0]),
+			p_Radius * sqrtf(inv.m[0][1] * inv.m[0][1] + inv.m[1][1] * inv.m[1][1] + inv.m[2][1] * inv.m[2][1]),
+			p_Radius * sqrtf(inv.m[0][2] * inv.m[0][2] + inv.m[1][2] * inv.m[1][2] + inv.m[2][2] * inv.m[2][2]));
+
+		m_Mesh->getBVH().findOverlapping(
+			DirectX::XMFLOAT3(localCenter.x - extents.x, localCenter.y - extents.y, localCenter.z - extents.z),
+			DirectX::XMFLOAT3(localCenter.x + extents.x, localCenter.y + extents.y, localCenter.z + extents.z),
+			p_Result);
 	}
 	/**
 	 * Gets the current scale of the Hull based on it's orginial scale, the default value of scale is XMFLOAT4(1.f, 1.f, 1.f, 0.f).
@@ -155,22 +186,10 @@ public:
 	 */
 	Triangle getTriangleInWorldCoord(unsigned int p_Index) const
 	{
-		//Triangle triangle;
-		//triangle = m_Triangles[p_Index];
+		DirectX::XMVECTOR a, b, c;
+		getCornersInWorldCoord(p_Index, a, b, c);
 
-		//triangle.corners[0] = triangle.corners[0] + m_Position;
-		//triangle.corners[1] = triangle.corners[1] + m_Position;
-		//triangle.corners[2] = triangle.corners[2] + m_Position;
-
-		//triangle.corners[0].w = 1.f;
-		//triangle.corners[1].w = 1.f;
-		//triangle.corners[2].w = 1.f;
-
-		//return triangle;
-
-		return Triangle(Vector4(m_Triangles[p_Index].corners[0].x + m_Position.x, m_Triangles[p_Index].corners[0].y + m_Position.y, m_Triangles[p_Index].corners[0].z + m_Position.z, 1.0f),
-			Vector4(m_Triangles[p_Index].corners[1].x + m_Position.x, m_Triangles[p_Index].corners[1].y + m_Position.y, m_Triangles[p_Index].corners[1].z + m_Position.z, 1.0f),
-			Vector4(m_Triangles[p_Index].corners[2].x + m_Position.x, m_Triangles[p_Index].corners[2].y + m_Position.y, m_Triangles[p_Index].corners[2].z + m_Position.z, 1.0f));
+		return Triangle(DirectX::XMVectorSetW(a, 1.f), DirectX::XMVectorSetW(b, 1.f), DirectX::XMVectorSetW(c, 1.f));
 	}
 
 		/**
@@ -183,18 +202,12 @@ public:
 	*/
 	DirectX::XMVECTOR findClosestPointOnTriangle(DirectX::XMFLOAT4 const &p_Point, int p_TriangleIndex) const
 	{
-		DirectX::XMVECTOR p = XMLoadFloat4(&m_Position);
-
 		using DirectX::operator-;
 		using DirectX::operator*;
 		using DirectX::operator+;
 
-		DirectX::XMVECTOR a = XMLoadFloat3(&m_Triangles[p_TriangleIndex].corners[0].xyz()) + p;
-		//a.m128_f32[3] = 1.f;
-		DirectX::XMVECTOR b = XMLoadFloat3(&m_Triangles[p_TriangleIndex].corners[1].xyz()) + p;
-		//b.m128_f32[3] = 1.f;
-		DirectX::XMVECTOR c = XMLoadFloat3(&m_Triangles[p_TriangleIndex].corners[2].xyz()) + p;
-		//c.m128_f32[3] = 1.f;
+		DirectX::XMVECTOR a, b, c;
+		getCornersInWorldCoord(p_TriangleIndex, a, b, c);
 		DirectX::XMVECTOR pos = DirectX::XMLoadFloat4(&p_Point);
 
 		DirectX::XMVECTOR ab = b - a;
@@ -266,51 +279,70 @@ public:
 		return a + ab * v + ac * w;
 	}
 private:
+	void init(HullMesh::ptr p_Mesh)
+	{
+		m_BodyHandle = 0;
+		m_Position = DirectX::XMFLOAT4(0.f, 0.f, 0.f, 1.f);
+		m_Mesh = std::move(p_Mesh);
+		m_Type = Type::HULL;
+		DirectX::XMStoreFloat4x4(&m_Transform, DirectX::XMMatrixIdentity());
+		DirectX::XMStoreFloat4x4(&m_InverseTransform, DirectX::XMMatrixIdentity());
+		float radius = findFarthestDistanceOnTriangle();
+		m_Scale = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 0.f);
+		m_Sphere = Sphere( radius, m_Position );
+		m_CollisionResponse = true;
+		m_IDInBody = 0;
+	}
+
+	/**
+	 * Applies a scale or rotation on top of the current transform, the same way
+	 * the triangles used to be transformed in place.
+	 */
+	void appendTransform(DirectX::XMMATRIX const &p_Transform)
+	{
+		DirectX::XMMATRIX transform = DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&m_Transform), p_Transform);
+		DirectX::XMStoreFloat4x4(&m_Transform, transform);
+		DirectX::XMStoreFloat4x4(&m_InverseTransform, DirectX::XMMatrixInverse(nullptr, transform));
+
+		m_Sphere.setRadius(findFarthestDistanceOnTriangle());
+	}
+
+	void getCornersInWorldCoord(unsigned int p_TriangleIndex, DirectX::XMVECTOR &p_A, DirectX::XMVECTOR &p_B, DirectX::XMVECTOR &p_C) const
+	{
+		using DirectX::operator+;
+
+		const Triangle& triangle = m_Mesh->getTriangleAt(p_TriangleIndex);
+		DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_Transform);
+		DirectX::XMVECTOR position = DirectX::XMLoadFloat4(&m_Position);
+
+		p_A = DirectX::XMVector3TransformNormal(Vector4ToXMVECTOR(&triangle.corners[0]), transform) + position;
+		p_B = DirectX::XMVector3TransformNormal(Vector4ToXMVECTOR(&triangle.corners[1]), transform) + position;
+		p_C = DirectX::XMVector3TransformNormal(Vector4ToXMVECTOR(&triangle.corners[2]), transform) + position;
+	}
+
 	float findFarthestDistanceOnTriangle() const
 	{
 		//The idea is that to find the furthest point away from the center
 		//get the length and set that to the spheres radius.
-		DirectX::XMVECTOR v, farthest, centerPos, corner;
-		centerPos = DirectX::XMVectorSet(0.f, 0.f, 0.f, 1.f);
+		DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_Transform);
 
 		float farthestDistance = 0.f;
 
-		for(auto& tri : m_Triangles)
+		for(unsigned int i = 0; i < m_Mesh->getTriangleListSize(); i++)
 		{
-			using DirectX::operator-;
-			corner = Vector4ToXMVECTOR(&tri.corners[0]);
-			v = corner - centerPos;
-			float c1 = DirectX::XMVector3Dot(v, v).m128_f32[0];
-			
-			if(c1 > farthestDistance)
-			{
-				farthestDistance = c1;
-				farthest = v;
-			}
-
-			corner = Vector4ToXMVECTOR(&tri.corners[1]);
-			v = corner - centerPos;
-			float c2 = DirectX::XMVector3Dot(v, v).m128_f32[0];
-
-			if(c2 > farthestDistance)
+			const Triangle& tri = m_Mesh->getTriangleAt(i);
+			for(int j = 0; j < 3; j++)
 			{
-				farthestDistance = c1;
-				farthest = v;
-			}
-
-			corner = Vector4ToXMVECTOR(&tri.corners[2]);
-			v = corner - centerPos;
-			float c3 = DirectX::XMVector3Dot(v, v).m128_f32[0];
+				DirectX::XMVECTOR v = DirectX::XMVector3TransformNormal(Vector4ToXMVECTOR(&tri.corners[j]), transform);
+				float distance = DirectX::XMVector3Dot(v, v).m128_f32[0];
 
-			if(c3 > farthestDistance)
-			{
-				farthestDistance = c3;
-				farthest = v;
+				if(distance > farthestDistance)
+				{
+					farthestDistance = distance;
+				}
 			}
-
 		}
 	
-		farthest.m128_f32[3] = 1.f;
 		return sqrtf(farthestDistance);
 	}
 };
\ No newline at end of file
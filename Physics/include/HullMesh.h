@@ -0,0 +1,58 @@
+#pragma once
+#include "PhysicsTypes.h"
+#include "TriangleBVH.h"
+#include <memory>
+#include <vector>
+
+/**
+ * Immutable triangle mesh shared by every hull instance created from the same bounding volume template.
+ * The triangles are stored in the local space of the mesh, each hull keeps its own transform.
+ * A bounding volume hierarchy over the triangles is built once when the mesh is created.
+ */
+class HullMesh
+{
+public:
+	typedef std::shared_ptr<const HullMesh> ptr;
+
+private:
+	std::vector<Triangle> m_Triangles;
+	TriangleBVH m_BVH;
+
+public:
+	/**
+	 * Constructor.
+	 * @param p_Triangles, the triangles of the mesh in local coordinates
+	 */
+	explicit HullMesh(std::vector<Triangle> p_Triangles) :
+		m_Triangles(std::move(p_Triangles)),
+		m_BVH(m_Triangles)
+	{
+	}
+
+	/**
+	 * Gets the number of triangles in the mesh
+	 * @return size of the triangle list
+	 */
+	unsigned int getTriangleListSize() const
+	{
+		return m_Triangles.size();
+	}
+
+	/**
+	 * Gets a triangle from the mesh
+	 * @param p_Index index of the triangle in the mesh triangle list
+	 * @return a triangle in local coordinates
+	 */
+	const Triangle& getTriangleAt(unsigned int p_Index) const
+	{
+		return m_Triangles[p_Index];
+	}
+
+	/**
+	 * Gets the hierarchy used to find the triangles near a query.
+	 */
+	const TriangleBVH& getBVH() const
+	{
+		return m_BVH;
+	}
+};
@@ -69,6 +69,15 @@ public:
 	 * @return true if the volume was successfully created, otherwise false
 	 */
 	virtual bool createBV(const char* p_VolumeID, const char* p_FilePath) = 0;
+	/**
+	 * Share a volume created in another physics instance, without loading it again.
+	 * The triangle mesh of the volume is never modified, so the instances can be used from different threads.
+	 *
+	 * @param p_VolumeID the identifier of the volume
+	 * @param p_Source the physics the volume was created in, must not be modified while copying
+	 * @return true if the source contained the volume, otherwise false
+	 */
+	virtual bool copyBV(const char* p_VolumeID, const IPhysics* p_Source) = 0;
 
 	/**
 	 * Add a boundingVolume Sphere to an existing body.
@@ -192,6 +201,24 @@ public:
 	 * @param p_MaxSteps the maximum amount of simulation steps to run
 	 */
 	virtual void update(float p_DeltaTime, unsigned p_MaxSteps) = 0;
+	/**
+	 * Choose how movable bodies are moved each step. The batched integrator updates
+	 * four bodies at a time and gives the same result within float tolerance. It is
+	 * off until measured to be faster for the scene, as it costs gathering and
+	 * scattering the body state each step.
+	 *
+	 * @param p_Enabled true to integrate in batches, false to update one body at a time (the default)
+	 */
+	virtual void setBatchedIntegration(bool p_Enabled) = 0;
+	/**
+	 * Choose how many threads run the collision checks. Each movable body is checked
+	 * against the static bodies on its own, and movable bodies touching each other are
+	 * grouped into islands that are resolved on their own. The hit data is merged in the
+	 * same order as the single threaded step, so the result does not depend on the thread count.
+	 *
+	 * @param p_NumThreads the number of threads to use, including the calling thread. 1 (the default) runs everything on the calling thread
+	 */
+	virtual void setNumWorkerThreads(unsigned int p_NumThreads) = 0;
 	/**
 	 * Apply a force on an object.
 	 *
@@ -326,10 +353,44 @@ public:
 	virtual float getTimestep() const = 0;
 
 	/**
-	 * Check if a ray intersects with a body.
+	 * Check if a ray intersects with a body. Only the first volume of static hull and sphere
+	 * bodies can be hit, use the batched rayCast to hit every volume type.
 	 * @param, p_RayDir direction of the ray in world space
 	 * @param, p_RayOrigin origin of the ray in world space
 	 * @returns the first body that intersects with the ray
 	 */
 	virtual BodyHandle rayCast(const DirectX::XMFLOAT4 &p_RayDirection, const DirectX::XMFLOAT4 &p_RayOrigin) = 0;
+
+	/**
+	 * Find where a batch of rays first hit the static bodies. Edge bodies are ignored.
+	 *
+	 * @param p_Queries the rays, the directions do not need to be normalized
+	 * @param p_NumQueries the number of rays
+	 * @param p_Hits receives one hit per ray, body is 0 for rays that hit nothing
+	 */
+	virtual void rayCast(const RayQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits) = 0;
+
+	/**
+	 * Find the static body each sphere in a batch overlaps the most. Edge bodies are ignored.
+	 * The normal points out of the body and distance is how deep the sphere overlaps it.
+	 *
+	 * @param p_Queries the spheres
+	 * @param p_NumQueries the number of spheres
+	 * @param p_Hits receives one hit per sphere, body is 0 for spheres that overlap nothing
+	 */
+	virtual void sphereOverlap(const SphereQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits) = 0;
+
+	/**
+	 * Find where a batch of moving spheres first touch the static bodies. Edge bodies are ignored.
+	 * The distance is how far the sphere can move from the start before it touches the body.
+	 * The path is split in steps of half the radius, at most 1024 of them, and only the steps near
+	 * a body are searched further, so the cost is bounded. A touch only grazing the sweep may be
+	 * missed, by well below a percent of the radius for paths shorter than 512 radii, and by up to
+	 * a sixteenth of a step on longer paths. Sweeps with an infinite or undefined length or radius hit nothing.
+	 *
+	 * @param p_Queries the swept spheres
+	 * @param p_NumQueries the number of swept spheres
+	 * @param p_Hits receives one hit per sweep, body is 0 for sweeps that hit nothing
+	 */
+	virtual void sweptSphere(const SweptSphereQuery* p_Queries, unsigned int p_NumQueries, QueryHit* p_Hits) = 0;
 };
\ No newline at end of file
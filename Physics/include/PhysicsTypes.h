@@ -1,6 +1,8 @@
 #pragma once
 #include "Utilities/XMFloatUtil.h"
 
+#include <cfloat>
+
 typedef unsigned int BodyHandle;
 
 enum class BoundingVolumeType
@@ -92,3 +94,74 @@ struct HitData
 		//IDInBody = 0;
 	}
 };
+
+/**
+ * A ray to test against the static bodies. Unless set, the ray has no maximum distance.
+ */
+struct RayQuery
+{
+	Vector3			origin;			// cm
+	Vector3			direction;
+	float			maxDistance;	// cm
+
+	RayQuery() : maxDistance(FLT_MAX) {}
+	RayQuery(Vector3 p_Origin, Vector3 p_Direction, float p_MaxDistance) :
+		origin(p_Origin),
+		direction(p_Direction),
+		maxDistance(p_MaxDistance)
+	{
+	}
+};
+
+/**
+ * A sphere to test for overlap with the static bodies.
+ */
+struct SphereQuery
+{
+	Vector3			center;	// cm
+	float			radius;	// cm
+
+	SphereQuery() : radius(0.f) {}
+	SphereQuery(Vector3 p_Center, float p_Radius) :
+		center(p_Center),
+		radius(p_Radius)
+	{
+	}
+};
+
+/**
+ * A sphere moving along a straight line, to test against the static bodies.
+ */
+struct SweptSphereQuery
+{
+	Vector3			start;	// cm
+	Vector3			end;	// cm
+	float			radius;	// cm
+
+	SweptSphereQuery() : radius(0.f) {}
+	SweptSphereQuery(Vector3 p_Start, Vector3 p_End, float p_Radius) :
+		start(p_Start),
+		end(p_End),
+		radius(p_Radius)
+	{
+	}
+};
+
+/**
+ * The result of a spatial query.
+ */
+struct QueryHit
+{
+	BodyHandle		body;		// 0 if nothing was hit
+	float			distance;	// cm, along the ray or sweep, or the overlap depth for sphere overlaps
+	Vector3			point;		// cm
+	Vector3			normal;
+
+	QueryHit() :
+		body(0),
+		distance(-1.f),
+		point(0.f, 0.f, 0.f),
+		normal(0.f, 0.f, 0.f)
+	{
+	}
+};
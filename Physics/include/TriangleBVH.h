@@ -0,0 +1,239 @@
+#pragma once
+#include "PhysicsTypes.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+/**
+ * Static bounding volume hierarchy over the triangles of a mesh. Built once when the mesh is loaded
+ * and used to find the few triangles that can touch a query, instead of testing all of them.
+ * All coordinates are in the local space of the mesh.
+ */
+class TriangleBVH
+{
+private:
+	struct Node
+	{
+		DirectX::XMFLOAT3 min;
+		DirectX::XMFLOAT3 max;
+		unsigned int first; //First triangle for leaves, second child for inner nodes. The first child follows the node.
+		unsigned int count; //Number of triangles, 0 for inner nodes
+	};
+
+	static const unsigned int m_MaxLeafSize = 4;
+
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_TriangleIndices;
+
+public:
+	TriangleBVH()
+	{
+	}
+
+	/**
+	 * Builds the hierarchy, splitting the triangles at the median of the longest axis.
+	 * @param p_Triangles the triangles of the mesh, the reported indices refer to this list
+	 */
+	explicit TriangleBVH(const std::vector<Triangle>& p_Triangles)
+	{
+		if (p_Triangles.empty())
+			return;
+
+		std::vector<DirectX::XMFLOAT3> centroids(p_Triangles.size());
+		m_TriangleIndices.resize(p_Triangles.size());
+		for (unsigned int i = 0; i < p_Triangles.size(); i++)
+		{
+			const Triangle& tri = p_Triangles[i];
+			centroids[i] = DirectX::XMFLOAT3((tri.corners[0].x + tri.corners[1].x + tri.corners[2].x) / 3.f,
+				(tri.corners[0].y + tri.corners[1].y + tri.corners[2].y) / 3.f,
+				(tri.corners[0].z + tri.corners[1].z + tri.corners[2].z) / 3.f);
+			m_TriangleIndices[i] = i;
+		}
+
+		m_Nodes.reserve(2 * p_Triangles.size() / m_MaxLeafSize + 1);
+		buildNode(p_Triangles, centroids, 0, p_Triangles.size());
+	}
+
+	/**
+	 * Finds the triangles in every leaf whose bounds overlap an axis aligned box.
+	 * Triangles close to the box may be reported, triangles touching it are never missed.
+	 * @param p_Min the lowest corner of the box
+	 * @param p_Max the highest corner of the box
+	 * @param p_Result cleared and filled with the triangle indices in ascending order
+	 */
+	void findOverlapping(const DirectX::XMFLOAT3& p_Min, const DirectX::XMFLOAT3& p_Max, std::vector<unsigned int>& p_Result) const
+	{
+		p_Result.clear();
+		if (m_Nodes.empty())
+			return;
+
+		unsigned int stack[64];
+		unsigned int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const unsigned int nodeIndex = stack[--stackSize];
+			const Node& node = m_Nodes[nodeIndex];
+			if (node.min.x > p_Max.x || node.max.x < p_Min.x ||
+				node.min.y > p_Max.y || node.max.y < p_Min.y ||
+				node.min.z > p_Max.z || node.max.z < p_Min.z)
+				continue;
+
+			if (node.count > 0)
+				p_Result.insert(p_Result.end(), m_TriangleIndices.begin() + node.first, m_TriangleIndices.begin() + node.first + node.count);
+			else
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+
+		std::sort(p_Result.begin(), p_Result.end());
+	}
+
+	/**
+	 * Finds the triangles in every leaf whose bounds are hit by a ray.
+	 * @param p_Origin the origin of the ray
+	 * @param p_Direction the direction of the ray, does not have to be normalized
+	 * @param p_Result cleared and filled with the triangle indices
+	 */
+	void findRayCandidates(const DirectX::XMFLOAT3& p_Origin, const DirectX::XMFLOAT3& p_Direction, std::vector<unsigned int>& p_Result) const
+	{
+		p_Result.clear();
+		if (m_Nodes.empty())
+			return;
+
+		const float origin[3] = { p_Origin.x, p_Origin.y, p_Origin.z };
+		const float direction[3] = { p_Direction.x, p_Direction.y, p_Direction.z };
+
+		unsigned int stack[64];
+		unsigned int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const unsigned int nodeIndex = stack[--stackSize];
+			const Node& node = m_Nodes[nodeIndex];
+			if (!rayHitsBox(origin, direction, node))
+				continue;
+
+			if (node.count > 0)
+				p_Result.insert(p_Result.end(), m_TriangleIndices.begin() + node.first, m_TriangleIndices.begin() + node.first + node.count);
+			else
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+	}
+
+	/**
+	 * Gets the number of nodes in the hierarchy, mostly useful for tests.
+	 */
+	unsigned int getNodeCount() const
+	{
+		return m_Nodes.size();
+	}
+
+private:
+	unsigned int buildNode(const std::vector<Triangle>& p_Triangles, const std::vector<DirectX::XMFLOAT3>& p_Centroids,
+		unsigned int p_First, unsigned int p_End)
+	{
+		const unsigned int nodeIndex = m_Nodes.size();
+		m_Nodes.push_back(Node());
+
+		DirectX::XMFLOAT3 boundsMin(FLT_MAX, FLT_MAX, FLT_MAX);
+		DirectX::XMFLOAT3 boundsMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		DirectX::XMFLOAT3 centroidMin(FLT_MAX, FLT_MAX, FLT_MAX);
+		DirectX::XMFLOAT3 centroidMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (unsigned int i = p_First; i < p_End; i++)
+		{
+			const Triangle& tri = p_Triangles[m_TriangleIndices[i]];
+			for (int j = 0; j < 3; j++)
+			{
+				growBounds(boundsMin, boundsMax, DirectX::XMFLOAT3(tri.corners[j].x, tri.corners[j].y, tri.corners[j].z));
+			}
+			growBounds(centroidMin, centroidMax, p_Centroids[m_TriangleIndices[i]]);
+		}
+
+		m_Nodes[nodeIndex].min = boundsMin;
+		m_Nodes[nodeIndex].max = boundsMax;
+
+		if (p_End - p_First <= m_MaxLeafSize)
+		{
+			m_Nodes[nodeIndex].first = p_First;
+			m_Nodes[nodeIndex].count = p_End - p_First;
+			return nodeIndex;
+		}
+
+		const float extents[3] = { centroidMax.x - centroidMin.x, centroidMax.y - centroidMin.y, centroidMax.z - centroidMin.z };
+		int axis = 0;
+		if (extents[1] > extents[axis])
+			axis = 1;
+		if (extents[2] > extents[axis])
+			axis = 2;
+
+		const unsigned int middle = (p_First + p_End) / 2;
+		std::nth_element(m_TriangleIndices.begin() + p_First, m_TriangleIndices.begin() + middle, m_TriangleIndices.begin() + p_End,
+			[&p_Centroids, axis] (unsigned int p_Left, unsigned int p_Right)
+			{
+				return getAxis(p_Centroids[p_Left], axis) < getAxis(p_Centroids[p_Right], axis);
+			});
+
+		buildNode(p_Triangles, p_Centroids, p_First, middle);
+		const unsigned int secondChild = buildNode(p_Triangles, p_Centroids, middle, p_End);
+
+		m_Nodes[nodeIndex].first = secondChild;
+		m_Nodes[nodeIndex].count = 0;
+		return nodeIndex;
+	}
+
+	static void growBounds(DirectX::XMFLOAT3& p_Min, DirectX::XMFLOAT3& p_Max, const DirectX::XMFLOAT3& p_Point)
+	{
+		p_Min.x = std::min(p_Min.x, p_Point.x);
+		p_Min.y = std::min(p_Min.y, p_Point.y);
+		p_Min.z = std::min(p_Min.z, p_Point.z);
+		p_Max.x = std::max(p_Max.x, p_Point.x);
+		p_Max.y = std::max(p_Max.y, p_Point.y);
+		p_Max.z = std::max(p_Max.z, p_Point.z);
+	}
+
+	static float getAxis(const DirectX::XMFLOAT3& p_Vector, int p_Axis)
+	{
+		return p_Axis == 0 ? p_Vector.x : (p_Axis == 1 ? p_Vector.y : p_Vector.z);
+	}
+
+	static bool rayHitsBox(const float p_Origin[3], const float p_Direction[3], const Node& p_Node)
+	{
+		const float boxMin[3] = { p_Node.min.x, p_Node.min.y, p_Node.min.z };
+		const float boxMax[3] = { p_Node.max.x, p_Node.max.y, p_Node.max.z };
+
+		float tMin = 0.f;
+		float tMax = FLT_MAX;
+		for (int i = 0; i < 3; i++)
+		{
+			if (fabs(p_Direction[i]) < 1e-12f)
+			{
+				if (p_Origin[i] < boxMin[i] || p_Origin[i] > boxMax[i])
+					return false;
+				continue;
+			}
+
+			const float invDirection = 1.f / p_Direction[i];
+			float t1 = (boxMin[i] - p_Origin[i]) * invDirection;
+			float t2 = (boxMax[i] - p_Origin[i]) * invDirection;
+			if (t1 > t2)
+				std::swap(t1, t2);
+
+			tMin = std::max(tMin, t1);
+			tMax = std::min(tMax, t2);
+			if (tMin > tMax)
+				return false;
+		}
+
+		return true;
+	}
+};
@@ -0,0 +1,226 @@
+#include "AssetCache.h"
+
+#include <AnimationLoader.h>
+#include <CommonExceptions.h>
+#include <Logger.h>
+#include <SpellFactory.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+AssetCache::AssetCache()
+	:	m_VolumeLibrary(nullptr),
+		m_NumLoads(0),
+		m_NumHits(0)
+{
+}
+
+AssetCache::~AssetCache()
+{
+	if (m_VolumeLibrary)
+	{
+		IPhysics::deletePhysics(m_VolumeLibrary);
+	}
+	m_VolumeLibrary = nullptr;
+}
+
+void AssetCache::initialize(const std::string& p_ResourceListPath)
+{
+	std::ifstream file(p_ResourceListPath, std::ifstream::in);
+	if (!file)
+	{
+		throw ResourceManagerException("Load resource file failed!", __LINE__, __FILE__);
+	}
+	m_ResourceTranslator.loadResourceList(file);
+
+	m_VolumeLibrary = IPhysics::createPhysics();
+	m_VolumeLibrary->setLogFunction(&Logger::logRaw);
+	m_VolumeLibrary->initialize(true, 1.f / 60.f);
+}
+
+const ResourceTranslator& AssetCache::getResourceTranslator() const
+{
+	return m_ResourceTranslator;
+}
+
+std::shared_ptr<const AssetCache::Level> AssetCache::getLevel(const std::string& p_FilePath)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	auto cached = m_Levels.find(p_FilePath);
+	if (cached != m_Levels.end())
+	{
+		++m_NumHits;
+		return cached->second;
+	}
+
+	std::ifstream file(p_FilePath, std::istream::in | std::istream::binary);
+	if (!file)
+	{
+		throw CommonException("Could not read level file: " + p_FilePath, __LINE__, __FILE__);
+	}
+
+	// The file is read once, both to be parsed and to be sent to the clients.
+	std::shared_ptr<Level> level(new Level);
+	level->m_Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	std::istringstream stream(level->m_Data);
+	level->m_Instances.readStreamData(stream);
+
+	Logger::log(Logger::Level::DEBUG_L, "Cached level " + p_FilePath);
+	++m_NumLoads;
+	m_Levels[p_FilePath] = level;
+
+	return level;
+}
+
+AnimationData::ptr AssetCache::getAnimation(const char* p_ResourceName, const char* p_FilePath)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	auto cached = m_Animations.find(p_ResourceName);
+	if (cached != m_Animations.end())
+	{
+		++m_NumHits;
+		return cached->second;
+	}
+
+	AnimationLoader loader;
+	loader.loadAnimationDataResource(p_ResourceName, p_FilePath);
+	AnimationData::ptr animation = loader.getAnimationData(p_ResourceName);
+
+	Logger::log(Logger::Level::DEBUG_L, std::string("Cached animation ") + p_ResourceName);
+	++m_NumLoads;
+	m_Animations[p_ResourceName] = animation;
+
+	return animation;
+}
+
+SpellDefinition::ptr AssetCache::getSpellDefinition(const char* p_ResourceName, const char* p_FilePath)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	auto cached = m_Spells.find(p_ResourceName);
+	if (cached != m_Spells.end())
+	{
+		++m_NumHits;
+		return cached->second;
+	}
+
+	SpellFactory factory;
+	SpellDefinition::ptr spell = factory.createSpellDefinition(p_ResourceName, p_FilePath);
+
+	Logger::log(Logger::Level::DEBUG_L, std::string("Cached spell ") + p_ResourceName);
+	++m_NumLoads;
+	m_Spells[p_ResourceName] = spell;
+
+	return spell;
+}
+
+bool AssetCache::attachVolume(const char* p_ResourceName, const char* p_FilePath, IPhysics* p_Physics)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	auto cached = m_Volumes.find(p_ResourceName);
+	if (cached != m_Volumes.end())
+	{
+		++m_NumHits;
+	}
+	else
+	{
+		if (!m_VolumeLibrary->createBV(p_ResourceName, p_FilePath))
+		{
+			return false;
+		}
+
+		Logger::log(Logger::Level::DEBUG_L, std::string("Cached bounding volume ") + p_ResourceName);
+		++m_NumLoads;
+		cached = m_Volumes.insert(std::make_pair(std::string(p_ResourceName), 0u)).first;
+	}
+
+	if (!p_Physics->copyBV(p_ResourceName, m_VolumeLibrary))
+	{
+		return false;
+	}
+
+	++cached->second;
+	return true;
+}
+
+bool AssetCache::detachVolume(const char* p_ResourceName, IPhysics* p_Physics)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	auto cached = m_Volumes.find(p_ResourceName);
+	if (cached == m_Volumes.end() || cached->second == 0)
+	{
+		return false;
+	}
+
+	--cached->second;
+	return p_Physics->releaseBV(p_ResourceName);
+}
+
+namespace
+{
+	template <typename Map>
+	unsigned int releaseUnshared(Map& p_Assets)
+	{
+		unsigned int numReleased = 0;
+		for (auto it = p_Assets.begin(); it != p_Assets.end(); )
+		{
+			// Only the cache itself refers to the asset. New references are
+			// only handed out by the cache while locked, so this can not change.
+			if (it->second.unique())
+			{
+				it = p_Assets.erase(it);
+				++numReleased;
+			}
+			else
+			{
+				++it;
+			}
+		}
+		return numReleased;
+	}
+}
+
+unsigned int AssetCache::releaseUnusedAssets()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	unsigned int numReleased = releaseUnshared(m_Levels) + releaseUnshared(m_Animations) + releaseUnshared(m_Spells);
+
+	for (auto it = m_Volumes.begin(); it != m_Volumes.end(); )
+	{
+		if (it->second == 0)
+		{
+			m_VolumeLibrary->releaseBV(it->first.c_str());
+			it = m_Volumes.erase(it);
+			++numReleased;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	Logger::log(Logger::Level::INFO, "Released " + std::to_string(numReleased) + " unused assets");
+
+	return numReleased;
+}
+
+AssetCache::Statistics AssetCache::getStatistics()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	Statistics stats;
+	stats.m_NumLevels = m_Levels.size();
+	stats.m_NumAnimations = m_Animations.size();
+	stats.m_NumSpells = m_Spells.size();
+	stats.m_NumVolumes = m_Volumes.size();
+	stats.m_NumLoads = m_NumLoads;
+	stats.m_NumHits = m_NumHits;
+
+	return stats;
+}
@@ -0,0 +1,155 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <AnimationData.h>
+#include <InstanceBinaryLoader.h>
+#include <ResourceTranslator.h>
+#include <SpellDefinition.h>
+
+#include <IPhysics.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Read only game assets loaded once and shared by all game rounds.
+ *
+ * Game rounds attach to the assets through their own resource managers
+ * instead of loading them again, making the start of a round cheap.
+ * Assets stay cached while unused, so later rounds of the same level
+ * also avoid loading, until they are explicitly released.
+ *
+ * All functions are safe to call from several game rounds at once.
+ */
+class AssetCache
+{
+public:
+	/**
+	 * A loaded level file.
+	 */
+	struct Level
+	{
+		InstanceBinaryLoader m_Instances;	/// The parsed level
+		std::string m_Data;					/// The unparsed level file, as sent to the clients
+	};
+
+	/**
+	 * The cached assets and how often they have been reused.
+	 */
+	struct Statistics
+	{
+		unsigned int m_NumLevels;
+		unsigned int m_NumAnimations;
+		unsigned int m_NumSpells;
+		unsigned int m_NumVolumes;
+		uint64_t m_NumLoads;		/// Assets loaded from file
+		uint64_t m_NumHits;			/// Assets found in the cache
+	};
+
+private:
+	std::mutex m_Lock;
+	ResourceTranslator m_ResourceTranslator;
+
+	std::map<std::string, std::shared_ptr<const Level>> m_Levels;
+	std::map<std::string, AnimationData::ptr> m_Animations;
+	std::map<std::string, SpellDefinition::ptr> m_Spells;
+
+	// Bounding volumes are loaded into a physics instance that is never
+	// simulated, then shared with the physics of each game round.
+	// Each volume is counted by the number of game rounds attached to it.
+	IPhysics* m_VolumeLibrary;
+	std::map<std::string, unsigned int> m_Volumes;
+
+	uint64_t m_NumLoads;
+	uint64_t m_NumHits;
+
+public:
+	/**
+	 * constructor.
+	 */
+	AssetCache();
+	/**
+	 * destructor.
+	 */
+	~AssetCache();
+
+	/**
+	 * Load the list of resources, mapping resource names to files.
+	 *
+	 * @param p_ResourceListPath the path to the resource list
+	 */
+	void initialize(const std::string& p_ResourceListPath);
+
+	/**
+	 * Get the loaded list of resources, for creating resource managers.
+	 *
+	 * @return the resource translator
+	 */
+	const ResourceTranslator& getResourceTranslator() const;
+
+	/**
+	 * Get a level, loading it if it is not cached.
+	 *
+	 * @param p_FilePath the path to the level file
+	 * @return the loaded level
+	 */
+	std::shared_ptr<const Level> getLevel(const std::string& p_FilePath);
+	/**
+	 * Get animation data, loading it if it is not cached.
+	 *
+	 * @param p_ResourceName the name of the animation resource
+	 * @param p_FilePath the path to the animation file
+	 * @return the loaded animation data
+	 */
+	AnimationData::ptr getAnimation(const char* p_ResourceName, const char* p_FilePath);
+	/**
+	 * Get a spell definition, loading it if it is not cached.
+	 *
+	 * @param p_ResourceName the name of the spell resource
+	 * @param p_FilePath the path to the spell file
+	 * @return the loaded spell definition
+	 */
+	SpellDefinition::ptr getSpellDefinition(const char* p_ResourceName, const char* p_FilePath);
+	/**
+	 * Make a bounding volume available in a physics instance, loading it
+	 * if it is not cached. Each attached volume must be detached.
+	 *
+	 * @param p_ResourceName the name of the volume resource
+	 * @param p_FilePath the path to the volume file
+	 * @param p_Physics the physics to share the volume with
+	 * @return true if the volume could be loaded, otherwise false
+	 */
+	bool attachVolume(const char* p_ResourceName, const char* p_FilePath, IPhysics* p_Physics);
+	/**
+	 * Remove a bounding volume from a physics instance.
+	 *
+	 * @param p_ResourceName the name of the volume resource
+	 * @param p_Physics the physics the volume was attached to
+	 * @return true if the volume was attached, otherwise false
+	 */
+	bool detachVolume(const char* p_ResourceName, IPhysics* p_Physics);
+
+	/**
+	 * Release all cached assets not used by any game round.
+	 *
+	 * @return the number of released assets
+	 */
+	unsigned int releaseUnusedAssets();
+
+	/**
+	 * Get the number of cached assets and how often they have been reused.
+	 *
+	 * @return the cache statistics
+	 */
+	Statistics getStatistics();
+
+private:
+	AssetCache(const AssetCache&);
+	AssetCache& operator=(const AssetCache&);
+};
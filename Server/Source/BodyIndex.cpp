@@ -0,0 +1,66 @@
+#include "BodyIndex.h"
+
+#include <EventData.h>
+
+void BodyIndex::addActor(const Actor::ptr& p_Actor, const std::shared_ptr<Player>& p_Player)
+{
+	Owner owner;
+	owner.m_Actor = p_Actor;
+	owner.m_Player = p_Player;
+
+	for (BodyHandle body : p_Actor->getBodyHandles())
+	{
+		m_Owners[body] = owner;
+	}
+}
+
+void BodyIndex::removeActor(const Actor::ptr& p_Actor)
+{
+	for (BodyHandle body : p_Actor->getBodyHandles())
+	{
+		m_Owners.erase(body);
+	}
+}
+
+void BodyIndex::changeBody(IEventData::Ptr p_Data)
+{
+	std::shared_ptr<ChangeBodyEventData> data = std::static_pointer_cast<ChangeBodyEventData>(p_Data);
+
+	auto it = m_Owners.find(data->getOldBody());
+	if (it == m_Owners.end())
+	{
+		// Not added yet, the actor is indexed by its current bodies when added.
+		return;
+	}
+
+	Owner owner = it->second;
+	m_Owners.erase(it);
+	m_Owners[data->getNewBody()] = owner;
+}
+
+Actor::ptr BodyIndex::findActor(BodyHandle p_Body) const
+{
+	auto it = m_Owners.find(p_Body);
+	if (it == m_Owners.end())
+	{
+		return Actor::ptr();
+	}
+
+	return it->second.m_Actor.lock();
+}
+
+std::shared_ptr<Player> BodyIndex::findPlayer(BodyHandle p_Body) const
+{
+	auto it = m_Owners.find(p_Body);
+	if (it == m_Owners.end())
+	{
+		return std::shared_ptr<Player>();
+	}
+
+	return it->second.m_Player.lock();
+}
+
+void BodyIndex::clear()
+{
+	m_Owners.clear();
+}
@@ -0,0 +1,74 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <Actor.h>
+#include <IEventData.h>
+
+#include <memory>
+#include <unordered_map>
+
+class Player;
+
+/**
+ * Keeps track of which actor, and which player, owns each physics body.
+ *
+ * Finding the actors of a collision is then a single lookup instead of a
+ * search through every actor and its bodies. Actors must be added and
+ * removed as they enter and leave the game, and bodies replaced by
+ * components are followed through ChangeBodyEventData.
+ */
+class BodyIndex
+{
+private:
+	struct Owner
+	{
+		Actor::wPtr m_Actor;
+		std::weak_ptr<Player> m_Player;
+	};
+
+	std::unordered_map<BodyHandle, Owner> m_Owners;
+
+public:
+	/**
+	 * Add all bodies of an actor.
+	 *
+	 * @param p_Actor the actor owning the bodies
+	 * @param p_Player the player controlling the actor, may be empty
+	 */
+	void addActor(const Actor::ptr& p_Actor, const std::shared_ptr<Player>& p_Player = std::shared_ptr<Player>());
+	/**
+	 * Remove all bodies of an actor.
+	 *
+	 * @param p_Actor the actor owning the bodies
+	 */
+	void removeActor(const Actor::ptr& p_Actor);
+	/**
+	 * Event listener moving the owner of a replaced body to the new body.
+	 *
+	 * @param p_Data a ChangeBodyEventData
+	 */
+	void changeBody(IEventData::Ptr p_Data);
+
+	/**
+	 * Find the actor owning a body.
+	 *
+	 * @param p_Body the body to look for
+	 * @return the owning actor, or empty if no added actor owns the body
+	 */
+	Actor::ptr findActor(BodyHandle p_Body) const;
+	/**
+	 * Find the player controlling the actor owning a body.
+	 *
+	 * @param p_Body the body to look for
+	 * @return the player, or empty if the body is not owned by a player actor
+	 */
+	std::shared_ptr<Player> findPlayer(BodyHandle p_Body) const;
+
+	/**
+	 * Remove all bodies.
+	 */
+	void clear();
+};
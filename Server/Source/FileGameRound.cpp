@@ -12,11 +12,20 @@ using namespace DirectX;
 
 static const float spawnEpsilon = 100.f;
 
+FileGameRound::FileGameRound()
+	:	m_Seed((uint32_t)std::chrono::system_clock::now().time_since_epoch().count())
+{
+}
+
 void FileGameRound::setup()
 {
-	m_FileLoader.reset(new InstanceBinaryLoader);
-	m_FileLoader->loadBinaryFile(m_FilePath);
-	m_Random.seed((unsigned long)std::chrono::system_clock::now().time_since_epoch().count());
+	m_Level = m_Assets->getLevel(m_FilePath);
+	m_Random.seed(m_Seed);
+
+	if (m_Recorder)
+	{
+		m_Recorder->recordRound(m_TypeName, m_FilePath, m_Seed, m_Players);
+	}
 
 	createPlayerActors();
 	createCheckpoints();
@@ -32,6 +41,11 @@ void FileGameRound::setFilePath(std::string p_Filepath)
 	m_FilePath = p_Filepath;
 }
 
+void FileGameRound::setRandomSeed(uint32_t p_Seed)
+{
+	m_Seed = p_Seed;
+}
+
 void FileGameRound::sendLevel()
 {
 	std::vector<std::string> descriptions;
@@ -50,9 +64,10 @@ void FileGameRound::sendLevel()
 		instances.push_back(inst);
 	}
 
-	std::string stream = m_FileLoader->getDataStream();
-	m_FileLoader.reset();
+	const std::string& stream = m_Level->m_Data;
 
+	SharedFrame createFrame;
+	SharedFrame levelFrame;
 	for (auto& player : m_Players)
 	{
 		User::ptr user = player->getUser().lock();
@@ -61,14 +76,24 @@ void FileGameRound::sendLevel()
 			Actor::ptr actor = player->getActor().lock();
 			if(actor)
 			{
-				user->getConnection()->sendCreateObjects(instances.data(), instances.size());
-				user->getConnection()->sendCurrentCheckpoint(player->getCurrentCheckpoint()->getPosition() + Vector3(0.f, spawnEpsilon, 0.f));
-				user->getConnection()->sendLevelData(stream.c_str(), stream.size());
-				user->getConnection()->sendNrOfCheckpoints(player->getNumberOfCheckpoints());
-				user->getConnection()->sendAssignPlayer(actor->getId());
+				IConnectionController* con = user->getConnection();
+				if (!createFrame)
+				{
+					createFrame = con->encodeCreateObjects(instances.data(), instances.size());
+					levelFrame = con->encodeLevelData(stream.c_str(), stream.size());
+				}
+
+				con->sendFrame(createFrame);
+				con->sendCurrentCheckpoint(player->getCurrentCheckpoint()->getPosition() + Vector3(0.f, spawnEpsilon, 0.f));
+				con->sendFrame(levelFrame);
+				con->sendNrOfCheckpoints(player->getNumberOfCheckpoints());
+				con->sendAssignPlayer(actor->getId());
 			}
 		}
 	}
+
+	// Not needed after sending, but stays cached for later game rounds.
+	m_Level.reset();
 }
 
 void FileGameRound::updateLogic(float p_DeltaTime)
@@ -83,8 +108,8 @@ void FileGameRound::updateLogic(float p_DeltaTime)
 		HitData hit = m_Physics->getHitDataAt(i);
 		if (m_Players.size() != 0)
 		{
-			Player::ptr player = findPlayer(hit.collider);
-			Actor::ptr victim = findActor(hit.collisionVictim);
+			Player::ptr player = m_BodyIndex.findPlayer(hit.collider);
+			Actor::ptr victim = m_BodyIndex.findActor(hit.collisionVictim);
 
 			if (player && victim)
 			{
@@ -133,22 +158,13 @@ void FileGameRound::handleExtraPackage(Player::ptr p_Player, Package p_Package)
 void FileGameRound::sendUpdates()
 {
 	std::vector<UpdateObjectData> data;
-	std::vector<std::string> extra;
-	std::vector<const char*> extraC;
+	std::vector<ObjectLookData> looks;
 	for (auto& player : m_Players)
 	{
 		data.push_back(getUpdateData(player));
-		extra.push_back(getExtraData(player));
-		extraC.push_back(extra.back().c_str());
-	}
-	for (auto& player : m_Players)
-	{
-		User::ptr user = player->getUser().lock();
-		if (user)
-		{
-			user->getConnection()->sendUpdateObjects(data.data(), data.size(), extraC.data(), extraC.size());
-		}
+		looks.push_back(getLookData(player));
 	}
+	sendObjectUpdates(data, looks);
 
 	const bool updatePositions = !m_SendHitData.empty();
 	for(const auto& hitData : m_SendHitData)
@@ -209,14 +225,10 @@ void FileGameRound::playerDisconnected(Player::ptr p_DisconnectedPlayer)
 
 	Actor::Id playerActorId = actor->getId();
 
-	for (auto& player : m_Players)
+	sendToAllPlayers([&] (IConnectionController* p_Connection)
 	{
-		User::ptr user = player->getUser().lock();
-		if (user)
-		{
-			user->getConnection()->sendRemoveObjects(&playerActorId, 1);
-		}
-	}
+		return p_Connection->encodeRemoveObjects(&playerActorId, 1);
+	});
 
 	auto playerPosition = std::find(m_PlayerPositionList.begin(), m_PlayerPositionList.end(), p_DisconnectedPlayer);
 	if (playerPosition != m_PlayerPositionList.end())
@@ -224,6 +236,7 @@ void FileGameRound::playerDisconnected(Player::ptr p_DisconnectedPlayer)
 		m_PlayerPositionList.erase(playerPosition);
 	}
 
+	m_BodyIndex.removeActor(actor);
 	auto it = std::find(m_Actors.begin(), m_Actors.end(), actor);
 	if (it != m_Actors.end())
 	{
@@ -262,81 +275,28 @@ UpdateObjectData FileGameRound::getUpdateData(const Player::ptr p_Player)
 	return data;
 }
 
-std::string FileGameRound::getExtraData(const Player::ptr p_Player)
+ObjectLookData FileGameRound::getLookData(const Player::ptr p_Player)
 {
 	Actor::ptr actor = p_Player->getActor().lock();
 
 	if (!actor)
-		return "";
-
-	tinyxml2::XMLPrinter printer;
-	printer.OpenElement("ObjectUpdate");
-	printer.PushAttribute("ActorId", actor->getId());
-	printer.PushAttribute("Type", "Look");
-	p_Player->getActor().lock()->getComponent<LookInterface>(LookInterface::m_ComponentId).lock()->serialize(printer);
-	printer.CloseElement();
-
-	return printer.CStr();
-}
-
-Player::ptr FileGameRound::findPlayer(BodyHandle p_Body)
-{
-	auto playerIt = std::find_if(m_Players.begin(), m_Players.end(),
-	[&p_Body] (Player::ptr p_Player)
 	{
-		Actor::ptr actor = p_Player->getActor().lock();
-		if (!actor)
-			return false;
-
-		for (auto& body : actor->getBodyHandles())
-		{
-			if (body == p_Body)
-			{
-				return true;
-			}
-		}
-
-		return false;
-	});
-
-	if (playerIt == m_Players.end())
-	{
-		return Player::ptr();
-	}
-	else
-	{
-		return *playerIt;
+		throw CommonException("Player missing actor", __LINE__, __FILE__);
 	}
-}
 
-Actor::ptr FileGameRound::findActor(BodyHandle p_Body)
-{
-	auto actorIt = std::find_if(m_Actors.begin(), m_Actors.end(),
-	[&p_Body] (Actor::ptr p_Actor)
-	{
-		if (!p_Actor)
-		{
-			return false;
-		}
+	ObjectLookData look;
+	look.m_Forward = Vector3(0.f, 0.f, 1.f);
+	look.m_Up = Vector3(0.f, 1.f, 0.f);
+	look.m_Id = actor->getId();
 
-		for (auto& body : p_Actor->getBodyHandles())
-		{
-			if (body == p_Body)
-			{
-				return true;
-			}
-		}
-		return false;
-	});
-
-	if (actorIt == m_Actors.end())
-	{
-		return Actor::ptr();
-	}
-	else
+	std::shared_ptr<LookInterface> lookInt = actor->getComponent<LookInterface>(LookInterface::m_ComponentId).lock();
+	if (lookInt)
 	{
-		return *actorIt;
+		look.m_Forward = lookInt->getLookForward();
+		look.m_Up = lookInt->getLookUp();
 	}
+
+	return look;
 }
 
 void FileGameRound::rearrangePlayerPosition()
@@ -383,7 +343,7 @@ unsigned int FileGameRound::countPlayersRacing() const
 
 void FileGameRound::createPlayerActors()
 {
-	const Vector3 basePos = Vector3(m_FileLoader->getCheckPointStart()) + Vector3(0.f, spawnEpsilon, 0.f);
+	const Vector3 basePos = Vector3(m_Level->m_Instances.getCheckPointStart()) + Vector3(0.f, spawnEpsilon, 0.f);
 	const float angle = 2 * PI / m_Players.size();
 	for (size_t i = 0; i < m_Players.size(); ++i)
 	{
@@ -401,6 +361,7 @@ void FileGameRound::createPlayerActors()
 			user->getCharacterName(), user->getCharacterStyle());
 		m_Players[i]->setActor(actor);
 		m_Actors.push_back(actor);
+		m_BodyIndex.addActor(actor, m_Players[i]);
 	}
 }
 
@@ -408,7 +369,7 @@ void FileGameRound::createCheckpoints()
 {
 	std::vector<InstanceBinaryLoader::CheckPointStruct> checkpoints;
 
-	for(const auto& checkpointGroup : m_FileLoader->getCheckPointData())
+	for(const auto& checkpointGroup : m_Level->m_Instances.getCheckPointData())
 	{
 		if (checkpointGroup.empty())
 			continue;
@@ -427,7 +388,7 @@ void FileGameRound::createCheckpoints()
 
 	std::vector<Actor::ptr> checkpointList;
 	std::uniform_real_distribution<float> circleDist(0.f, PI * 2.f);
-	checkpointList.push_back(m_ActorFactory->createCheckPointActor(m_FileLoader->getCheckPointEnd(), checkpointScale, circleDist(m_Random)));
+	checkpointList.push_back(m_ActorFactory->createCheckPointActor(m_Level->m_Instances.getCheckPointEnd(), checkpointScale, circleDist(m_Random)));
 	for (const auto& checkpoint : checkpoints)
 	{
 		checkpointList.push_back(m_ActorFactory->createCheckPointActor(checkpoint.m_Translation, checkpointScale, circleDist(m_Random)));
@@ -436,6 +397,7 @@ void FileGameRound::createCheckpoints()
 	for (const auto& checkpoint : checkpointList)
 	{
 		m_Actors.push_back(checkpoint);
+		m_BodyIndex.addActor(checkpoint);
 		for(auto& player : m_Players)
 		{
 			player->addCheckpoint(checkpoint);
@@ -451,14 +413,11 @@ void FileGameRound::sendPositionUpdate(const Player::ptr p_Player, const float*
 		return;
 	}
 
-	tinyxml2::XMLPrinter printer;
-	printer.OpenElement("RacePositions");
-	printer.PushAttribute("Place", getPlayerPos(p_Player));
-	if (p_Time)
-		printer.PushAttribute("Time", *p_Time);
-	printer.CloseElement();
-	const char* info = printer.CStr();
-	user->getConnection()->sendRacePosition(&info,1);
+	RacePositionData position;
+	position.m_Place = getPlayerPos(p_Player);
+	position.m_HasTime = p_Time != nullptr;
+	position.m_Time = p_Time ? *p_Time : 0.f;
+	user->getConnection()->sendRacePosition(&position, 1);
 }
 
 void FileGameRound::sendPositionUpdates() const
@@ -501,15 +460,10 @@ void FileGameRound::sendResultLists() const
 
 void FileGameRound::sendSelectNextCheckpoint(const Player::ptr p_Player, const User::ptr p_User) const
 {
-	tinyxml2::XMLPrinter printer;				
-
-	printer.OpenElement("ObjectUpdate");
-	printer.PushAttribute("ActorId", p_Player->getCurrentCheckpoint()->getId());
-	printer.PushAttribute("Type", "Color");
-	pushColor(printer, "SetColor", p_Player->getCurrentCheckpointColor());
-	printer.CloseElement();
-	const char* info = printer.CStr();
-	p_User->getConnection()->sendUpdateObjects(NULL, 0, &info, 1);
+	ObjectColorData color;
+	color.m_Color = p_Player->getCurrentCheckpointColor();
+	color.m_Id = p_Player->getCurrentCheckpoint()->getId();
+	p_User->getConnection()->sendUpdateObjects(NULL, 0, NULL, 0, &color, 1);
 
 	p_User->getConnection()->sendCurrentCheckpoint(p_Player->getCurrentCheckpoint()->getPosition());
 }
@@ -536,21 +490,10 @@ void FileGameRound::handleThrowSpell(const Player::ptr p_Player, Package p_Packa
 	spellInstance.m_Id = spellActor->getId();
 	spellInstance.m_Description = spellDescription.c_str();
 
-	for (auto& player : m_Players)
+	sendToAllPlayers([&] (IConnectionController* p_Connection)
 	{
-		if (player == p_Player)
-		{
-			continue;
-		}
-
-		User::ptr otherUser = player->getUser().lock();
-		if (!otherUser)
-		{
-			continue;
-		}
-
-		otherUser->getConnection()->sendCreateObjects(&spellInstance, 1);
-	}
+		return p_Connection->encodeCreateObjects(&spellInstance, 1);
+	}, p_Player);
 }
 
 void FileGameRound::handleObjectAction(const Player::ptr p_Player, Package p_Package, IConnectionController* p_Connection)
@@ -558,21 +501,10 @@ void FileGameRound::handleObjectAction(const Player::ptr p_Player, Package p_Pac
 	Actor::Id actor = p_Connection->getObjectActionId(p_Package);
 	const char* action = p_Connection->getObjectActionAction(p_Package);
 
-	for (auto& player : m_Players)
+	sendToAllPlayers([&] (IConnectionController* p_Connection)
 	{
-		if (player == p_Player)
-		{
-			continue;
-		}
-
-		User::ptr otherUser = player->getUser().lock();
-		if (!otherUser)
-		{
-			continue;
-		}
-
-		otherUser->getConnection()->sendObjectAction(actor, action);
-	}
+		return p_Connection->encodeObjectAction(actor, action);
+	}, p_Player);
 }
 
 void FileGameRound::replacePlayerActorWithFlyingCamera(Player::ptr p_Player, const User::ptr p_User)
@@ -589,31 +521,23 @@ void FileGameRound::replacePlayerActorWithFlyingCamera(Player::ptr p_Player, con
 	inst.m_Description = desc.c_str();
 	inst.m_Id = flyingCamera->getId();
 
-	for (auto& otherPlayer : m_Players)
+	sendToAllPlayers([&] (IConnectionController* p_Connection)
 	{
-		User::ptr otherUser = otherPlayer->getUser().lock();
-		if(!otherUser)
-		{
-			continue;
-		}
-		otherUser->getConnection()->sendCreateObjects(&inst, 1);
-	}
+		return p_Connection->encodeCreateObjects(&inst, 1);
+	});
 
 	p_User->getConnection()->sendAssignPlayer(inst.m_Id);
 
 	Actor::Id oldPlayerId = oldPlayerActor->getId();
 
-	for (auto& player : m_Players)
+	sendToAllPlayers([&] (IConnectionController* p_Connection)
 	{
-		User::ptr otherUser = player->getUser().lock();
-		if(!otherUser)
-		{
-			continue;
-		}
-		otherUser->getConnection()->sendRemoveObjects(&oldPlayerId, 1);
-	}
+		return p_Connection->encodeRemoveObjects(&oldPlayerId, 1);
+	});
 
 	p_Player->setActor(flyingCamera);
+	m_BodyIndex.addActor(flyingCamera, p_Player);
+	m_BodyIndex.removeActor(oldPlayerActor);
 
 	auto actorIt = std::find(m_Actors.begin(), m_Actors.end(), oldPlayerActor);
 	if (actorIt != m_Actors.end())
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "GameRound.h"
-#include "InstanceBinaryLoader.h"
 
 #include <DirectXMath.h>
 #include <random>
@@ -11,17 +10,26 @@ class FileGameRound : public GameRound
 {
 private:
 	std::string m_FilePath;
-	std::unique_ptr<InstanceBinaryLoader> m_FileLoader;
+	std::shared_ptr<const AssetCache::Level> m_Level;
 	std::vector<std::pair<Player::ptr, Actor::wPtr>> m_SendHitData;
 	std::vector<std::pair<std::string, float>> m_ResultList;
 	bool m_ResultListUpdated;
+	uint32_t m_Seed;
 	std::default_random_engine m_Random;
 	std::vector<Player::ptr> m_PlayerPositionList;
 
 	float m_Time;
 public:
+	FileGameRound();
+
 	void setup() override;
 	void setFilePath(std::string p_FilePath);
+	/**
+	 * Replace the random seed, which is otherwise taken from the clock.
+	 *
+	 * @param p_Seed the seed for placing the checkpoints
+	 */
+	void setRandomSeed(uint32_t p_Seed);
 
 private:
 	void sendLevel() override;
@@ -31,9 +39,7 @@ private:
 	void playerDisconnected(Player::ptr p_DisconnectedPlayer) override;
 
 	UpdateObjectData getUpdateData(const Player::ptr p_Player);
-	std::string getExtraData(const Player::ptr p_Player);
-	Player::ptr findPlayer(BodyHandle p_Body);
-	Actor::ptr findActor(BodyHandle p_Body);
+	ObjectLookData getLookData(const Player::ptr p_Player);
 
 	void rearrangePlayerPosition();
 	unsigned int getPlayerPos(Player::ptr p_Player) const;
@@ -4,6 +4,16 @@
 
 #include <algorithm>
 
+GameList::GameList()
+	:	m_Scheduler(std::chrono::milliseconds(20), 4)
+{
+}
+
+void GameList::start(unsigned int p_NumTickWorkers)
+{
+	m_Scheduler.start(p_NumTickWorkers);
+}
+
 void GameList::addGameRound(GameRound::ptr p_Game)
 {
 	std::lock_guard<std::mutex> lock(m_RunningGamesLock);
@@ -14,7 +24,7 @@ void GameList::addGameRound(GameRound::ptr p_Game)
 	{
 		p_Game->setOwningList(this);
 		p_Game->setup();
-		p_Game->start();
+		p_Game->start(m_Scheduler);
 	}
 	catch (CommonException& err)
 	{
@@ -32,9 +42,14 @@ void GameList::removeGameRound()
 
 void GameList::stopAllGames()
 {
-	std::lock_guard<std::mutex> lock(m_RunningGamesLock);
+	{
+		std::lock_guard<std::mutex> lock(m_RunningGamesLock);
+
+		m_RunningGames.clear();
+	}
 
-	m_RunningGames.clear();
+	// The released games remove themselves from the list, so it must not be locked.
+	m_Scheduler.stop();
 }
 
 std::vector<GameRound::ptr> GameList::getRunningGames()
@@ -5,12 +5,14 @@
 #pragma once
 
 #include "GameRound.h"
+#include "TickScheduler.h"
 
 #include <mutex>
 #include <vector>
 
 /**
- * List of active games with synchronized access.
+ * List of active games with synchronized access. The games are
+ * ticked by a scheduler shared between all games.
  */
 class GameList
 {
@@ -18,7 +20,22 @@ private:
 	std::mutex m_RunningGamesLock;
 	std::vector<GameRound::wPtr> m_RunningGames;
 
+	// Destroyed first, as releasing the games removes them from the list.
+	TickScheduler m_Scheduler;
+
 public:
+	/**
+	 * constructor.
+	 */
+	GameList();
+
+	/**
+	 * Start ticking the games.
+	 *
+	 * @param p_NumTickWorkers the number of threads shared by all games
+	 */
+	void start(unsigned int p_NumTickWorkers);
+
 	/**
 	 * Add and start a new game round.
 	 *
@@ -11,8 +11,11 @@
 GameRound::GameRound()
 	:	m_ParentList(nullptr),
 		m_ReturnLobby(nullptr),
+		m_Assets(nullptr),
 		m_Running(false),
-		m_Physics(nullptr)
+		m_Physics(nullptr),
+		m_Phase(Phase::STARTING),
+		m_CountdownTime(0.f)
 {
 }
 
@@ -20,10 +23,9 @@ GameRound::~GameRound()
 {
 	m_Running = false;
 
-	m_ParentList->removeGameRound();
-	if (m_RunThread.joinable())
+	if (m_ParentList)
 	{
-		m_RunThread.detach();
+		m_ParentList->removeGameRound();
 	}
 
 	m_Actors.clear();
@@ -34,6 +36,8 @@ GameRound::~GameRound()
 	m_ResourceManager->unregisterResourceType("spell");
 	m_SpellFactory.reset();
 
+	m_ResourceManager->unregisterResourceType("volume");
+
 	if (m_Physics)
 	{
 		IPhysics::deletePhysics(m_Physics);
@@ -41,30 +45,43 @@ GameRound::~GameRound()
 	m_Physics = nullptr;
 }
 
-void GameRound::initialize(ActorFactory::ptr p_ActorFactory, Lobby* p_ReturnLobby)
+void GameRound::initialize(ActorFactory::ptr p_ActorFactory, Lobby* p_ReturnLobby, AssetCache* p_Assets)
 {
 	m_ActorFactory = p_ActorFactory;
 	m_ReturnLobby = p_ReturnLobby;
+	m_Assets = p_Assets;
 
-	m_ResourceManager.reset(new ResourceManager(boost::filesystem::current_path()));
-	m_ResourceManager->loadDataFromFile("assets/Resources.xml");
+	m_ResourceManager.reset(new ResourceManager(boost::filesystem::current_path(), m_Assets->getResourceTranslator()));
 
 	m_Physics = IPhysics::createPhysics();
 	m_Physics->setLogFunction(&Logger::logRaw);
 	m_Physics->initialize(true, 1.f / 60.f);
 
 	m_EventManager.reset(new EventManager);
+	m_EventManager->addListener(EventListenerDelegate(&m_BodyIndex, &BodyIndex::changeBody), ChangeBodyEventData::sk_EventType);
 
 	m_AnimationLoader.reset(new AnimationLoader);
 	m_SpellFactory.reset(new SpellFactory);
 	
+	// The assets are loaded once by the asset cache, the game round only attaches to them.
 	using namespace std::placeholders;
+	AnimationLoader* animationLoader = m_AnimationLoader.get();
 	m_ResourceManager->registerFunction("animation",
-		std::bind(&AnimationLoader::loadAnimationDataResource, m_AnimationLoader.get(), _1, _2),
+		[p_Assets, animationLoader] (const char* p_ResourceName, const char* p_FilePath)
+		{
+			return animationLoader->addAnimationData(p_ResourceName, p_FilePath, p_Assets->getAnimation(p_ResourceName, p_FilePath));
+		},
 		std::bind(&AnimationLoader::releaseAnimationData, m_AnimationLoader.get(), _1));
+	SpellFactory* spellFactory = m_SpellFactory.get();
 	m_ResourceManager->registerFunction("spell",
-		std::bind(&SpellFactory::createSpellDefinition, m_SpellFactory.get(), _1, _2),
+		[p_Assets, spellFactory] (const char* p_ResourceName, const char* p_FilePath)
+		{
+			return spellFactory->addSpellDefinition(p_ResourceName, p_Assets->getSpellDefinition(p_ResourceName, p_FilePath));
+		},
 		std::bind(&SpellFactory::releaseSpellDefinition, m_SpellFactory.get(), _1));
+	m_ResourceManager->registerFunction("volume",
+		std::bind(&AssetCache::attachVolume, p_Assets, _1, _2, m_Physics),
+		std::bind(&AssetCache::detachVolume, p_Assets, _1, m_Physics));
 
 	m_ActorFactory->setEventManager(m_EventManager.get());
 	m_ActorFactory->setPhysics(m_Physics);
@@ -77,9 +94,39 @@ void GameRound::setOwningList(GameList* p_ParentList)
 	m_ParentList = p_ParentList;
 }
 
-void GameRound::start()
+void GameRound::recordInput(InputRecorder::ptr p_Recorder)
+{
+	m_Recorder = std::move(p_Recorder);
+}
+
+void GameRound::setPackagesHandledCallback(std::function<void()> p_Callback)
+{
+	m_PackagesHandled = p_Callback;
+}
+
+void GameRound::start(TickScheduler& p_Scheduler)
+{
+	Logger::log(Logger::Level::INFO, "Starting game round");
+	m_Running = true;
+
+	using namespace std::placeholders;
+	m_TickTask = p_Scheduler.addTask(std::bind(&GameRound::tick, shared_from_this(), _1));
+}
+
+void GameRound::startUnscheduled()
 {
-	m_RunThread = std::thread(&GameRound::run, shared_from_this());
+	Logger::log(Logger::Level::INFO, "Starting game round without scheduler");
+	m_Running = true;
+}
+
+TickStatistics GameRound::getTickStatistics() const
+{
+	if (!m_TickTask)
+	{
+		return TickStatistics();
+	}
+
+	return m_TickTask->getStatistics();
 }
 
 void GameRound::addNewPlayer(User::wPtr p_User)
@@ -119,41 +166,55 @@ void GameRound::handleExtraPackage(Player::ptr p_Player, Package p_Package)
 	Logger::log(Logger::Level::WARNING, msg);
 }
 
-void GameRound::run()
+bool GameRound::tick(float p_DeltaTime)
 {
-	Logger::log(Logger::Level::INFO, "Starting game round");
-	m_Running = true;
+	if (m_Recorder)
+	{
+		m_Recorder->recordTick(p_DeltaTime);
+	}
 
 	try
 	{
-		sendLevelAndWait();
-
-		if (m_Players.empty())
+		switch (m_Phase)
 		{
-			Logger::log(Logger::Level::INFO, "All clients disconnected before level loaded, aborting game round");
-			return;
-		}
+		case Phase::STARTING:
+			sendLevelToPlayers();
+			break;
 
-		Logger::log(Logger::Level::INFO, "Level loaded by clients, starting game");
+		case Phase::LOADING:
+			waitForLoadedLevel();
+			break;
 
-		runGame();
+		case Phase::COUNTDOWN:
+			countDown(p_DeltaTime);
+			break;
+
+		case Phase::PLAYING:
+			updateGame(p_DeltaTime);
+			break;
+		}
 	}
 	catch (std::exception& ex)
 	{
 		Logger::log(Logger::Level::FATAL, std::string("Unexpected exception stopped game: ") + ex.what());
+		m_Running = false;
 	}
 	catch (...)
 	{
 		Logger::log(Logger::Level::FATAL, "Unexpected exception stopped game round");
+		m_Running = false;
+	}
+
+	if (!m_Running)
+	{
+		Logger::log(Logger::Level::INFO, "Game round stopped");
 	}
 
-	Logger::log(Logger::Level::INFO, "Game round stopped");
+	return m_Running;
 }
 
-void GameRound::sendLevelAndWait()
+void GameRound::sendLevelToPlayers()
 {
-	bool allDoneLoading = false;
-
 	for (auto& player : m_Players)
 	{
 		User::ptr user = player->getUser().lock();
@@ -165,40 +226,32 @@ void GameRound::sendLevelAndWait()
 
 	sendLevel();
 
-	while (m_Running && !allDoneLoading)
-	{
-		allDoneLoading = true;
-
-		handlePackages();
+	m_Phase = Phase::LOADING;
+}
 
-		for (auto& player : m_Players)
-		{
-			User::ptr user = player->getUser().lock();
+void GameRound::waitForLoadedLevel()
+{
+	handlePackages();
 
-			if (!user)
-			{
-				continue;
-			}
+	for (auto& player : m_Players)
+	{
+		User::ptr user = player->getUser().lock();
 
-			if (user->getState() != User::State::WAITING_FOR_START)
-			{
-				allDoneLoading = false;
-				break;
-			}
+		if (user && user->getState() != User::State::WAITING_FOR_START)
+		{
+			return;
 		}
-
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	}
 
 	checkForDisconnectedUsers();
-}
 
-void GameRound::runGame()
-{
-	std::chrono::high_resolution_clock::time_point currentTime = std::chrono::high_resolution_clock::now();
-	std::chrono::high_resolution_clock::time_point previousTime;
-	float deltaTime = 0.001f;
+	if (m_Players.empty())
+	{
+		Logger::log(Logger::Level::INFO, "All clients disconnected before level loaded, aborting game round");
+		return;
+	}
+
+	Logger::log(Logger::Level::INFO, "Level loaded by clients, starting game");
 
 	for (auto& player : m_Players)
 	{
@@ -212,26 +265,23 @@ void GameRound::runGame()
 		user->getConnection()->sendStartCountdown();
 	}
 
-	typedef std::chrono::high_resolution_clock clock;
-	clock::time_point waitEnd = clock::now() + std::chrono::seconds(3);
-
-	while (clock::now() < waitEnd)
-	{
-		previousTime = currentTime;
-		currentTime = std::chrono::high_resolution_clock::now();
-		const clock::duration frameTime = currentTime - previousTime;
-
-		m_Physics->update(deltaTime, 2);
+	static const float countdownLength = 3.f;
+	m_CountdownTime = countdownLength;
+	m_Phase = Phase::COUNTDOWN;
+}
 
-		handlePackages();
-		checkForDisconnectedUsers();
-		updateLogic(deltaTime);
-		sendUpdates();
+void GameRound::countDown(float p_DeltaTime)
+{
+	// The world is held still during the countdown, only moving by a minimal time step.
+	static const float countdownTimeStep = 0.001f;
+	updateGame(countdownTimeStep);
 
-		static const std::chrono::milliseconds sleepDuration(20);
-		std::this_thread::sleep_for(sleepDuration - frameTime);
+	m_CountdownTime -= p_DeltaTime;
+	if (m_CountdownTime > 0.f)
+	{
+		return;
 	}
-	
+
 	for (auto& player : m_Players)
 	{
 		User::ptr user = player->getUser().lock();
@@ -244,24 +294,17 @@ void GameRound::runGame()
 		user->getConnection()->sendDoneCountdown();
 	}
 
-	while (m_Running)
-	{
-		previousTime = currentTime;
-		currentTime = std::chrono::high_resolution_clock::now();
-		const std::chrono::high_resolution_clock::duration frameTime = currentTime - previousTime;
-
-		deltaTime = std::chrono::duration_cast<std::chrono::duration<float>>(frameTime).count();
-
-		m_Physics->update(deltaTime, 2);
+	m_Phase = Phase::PLAYING;
+}
 
-		handlePackages();
-		checkForDisconnectedUsers();
-		updateLogic(deltaTime);
-		sendUpdates();
+void GameRound::updateGame(float p_DeltaTime)
+{
+	m_Physics->update(p_DeltaTime, 2);
 
-		static const std::chrono::milliseconds sleepDuration(20);
-		std::this_thread::sleep_for(sleepDuration - frameTime);
-	}
+	handlePackages();
+	checkForDisconnectedUsers();
+	updateLogic(p_DeltaTime);
+	sendUpdates();
 }
 
 void GameRound::checkForDisconnectedUsers()
@@ -274,6 +317,10 @@ void GameRound::checkForDisconnectedUsers()
 
 	for (auto removePlayer = split; removePlayer != m_Players.end(); ++removePlayer)
 	{
+		if (m_Recorder)
+		{
+			m_Recorder->recordLeave(*removePlayer);
+		}
 		playerDisconnected(*removePlayer);
 	}
 
@@ -285,6 +332,64 @@ void GameRound::checkForDisconnectedUsers()
 	}
 }
 
+void GameRound::sendObjectUpdates(const std::vector<UpdateObjectData>& p_Objects, const std::vector<ObjectLookData>& p_Looks)
+{
+	m_InterestManager.update(p_Objects);
+
+	std::vector<UpdateObjectData> relevant;
+	for (auto& player : m_Players)
+	{
+		User::ptr user = player->getUser().lock();
+		if (!user)
+		{
+			continue;
+		}
+
+		Actor::ptr actor = player->getActor().lock();
+		if (!actor)
+		{
+			// Without a view point there is nothing to filter against.
+			user->getConnection()->sendUpdateObjects(p_Objects.data(), p_Objects.size(), p_Looks.data(), p_Looks.size(), nullptr, 0);
+			continue;
+		}
+
+		Vector3 forward(0.f, 0.f, 0.f);
+		std::shared_ptr<LookInterface> lookInt = actor->getComponent<LookInterface>(LookInterface::m_ComponentId).lock();
+		if (lookInt)
+		{
+			forward = lookInt->getLookForward();
+		}
+
+		m_InterestManager.selectRelevant(player->getInterestState(), actor->getPosition(), forward, actor->getId(), relevant);
+		user->getConnection()->sendUpdateObjects(relevant.data(), relevant.size(), p_Looks.data(), p_Looks.size(), nullptr, 0);
+	}
+}
+
+void GameRound::sendToAllPlayers(const std::function<SharedFrame(IConnectionController*)>& p_Encode, Player::ptr p_Except)
+{
+	SharedFrame frame;
+	for (auto& player : m_Players)
+	{
+		if (player == p_Except)
+		{
+			continue;
+		}
+
+		User::ptr user = player->getUser().lock();
+		if (!user)
+		{
+			continue;
+		}
+
+		IConnectionController* con = user->getConnection();
+		if (!frame)
+		{
+			frame = p_Encode(con);
+		}
+		con->sendFrame(frame);
+	}
+}
+
 void GameRound::handlePackages()
 {
 	for(auto& player : m_Players)
@@ -304,6 +409,11 @@ void GameRound::handlePackages()
 			Package package = con->getPackage(i);
 			PackageType type = con->getPackageType(package);
 
+			if (m_Recorder)
+			{
+				m_Recorder->recordPackage(player, con, package);
+			}
+
 			switch (type)
 			{
 			case PackageType::PLAYER_CONTROL:
@@ -338,7 +448,10 @@ void GameRound::handlePackages()
 
 			case PackageType::LEAVE_GAME:
 				{
-					m_ReturnLobby->addFreeUser(user);
+					if (m_ReturnLobby)
+					{
+						m_ReturnLobby->addFreeUser(user);
+					}
 					player->releaseUser();
 				}
 				break;
@@ -351,4 +464,9 @@ void GameRound::handlePackages()
 
 		con->clearPackages(numPackages);
 	}
+
+	if (m_PackagesHandled)
+	{
+		m_PackagesHandled();
+	}
 }
\ No newline at end of file
@@ -5,12 +5,17 @@
 #pragma once
 
 #include "ActorFactory.h"
+#include "AssetCache.h"
+#include "BodyIndex.h"
+#include "InputRecorder.h"
+#include "InterestManager.h"
 #include "Player.h"
+#include "TickScheduler.h"
 
 #include <SpellFactory.h>
 
+#include <functional>
 #include <memory>
-#include <thread>
 #include <vector>
 
 class GameList;
@@ -19,7 +24,7 @@ class Lobby;
 /**
  * A game with game logic for one set of players.
  */
-class GameRound : std::enable_shared_from_this<GameRound>
+class GameRound : public std::enable_shared_from_this<GameRound>
 {
 public:
 	/**
@@ -34,7 +39,8 @@ public:
 protected:
 	GameList* m_ParentList;
 	Lobby* m_ReturnLobby;
-	std::thread m_RunThread;
+	AssetCache* m_Assets;
+	TickScheduler::TaskPtr m_TickTask;
 	bool m_Running;
 	std::string m_TypeName;
 
@@ -46,6 +52,9 @@ protected:
 	ActorFactory::ptr m_ActorFactory;
 	std::vector<Actor::ptr> m_Actors;
 	std::vector<Player::ptr> m_Players;
+	InterestManager m_InterestManager;
+	BodyIndex m_BodyIndex;
+	InputRecorder::ptr m_Recorder;
 
 public:
 	/**
@@ -61,24 +70,61 @@ public:
 	 * Initialize the game round.
 	 *
 	 * @param p_ActorFactory the factory to be used for any created actors
-	 * @param p_ReturnLobby the lobby where leaving users should be returned
+	 * @param p_ReturnLobby the lobby where leaving users should be returned, may be null
+	 * @param p_Assets the shared assets to attach to instead of loading them
 	 */
-	void initialize(ActorFactory::ptr p_ActorFactory, Lobby* p_ReturnLobby);
+	void initialize(ActorFactory::ptr p_ActorFactory, Lobby* p_ReturnLobby, AssetCache* p_Assets);
 	/**
 	 * Set the game list that should be notified when the game ends.
 	 *
 	 * @param p_ParentList the containing game list
 	 */
 	void setOwningList(GameList* p_ParentList);
+	/**
+	 * Record all input to the game round, to be able to replay it
+	 * with InputReplay. Should be called before setup.
+	 *
+	 * @param p_Recorder the recorder to write the input to
+	 */
+	void recordInput(InputRecorder::ptr p_Recorder);
+	/**
+	 * Set a function to call each tick once the packages are handled, right before
+	 * the round looks for players that have left. Used by InputReplay to let players
+	 * leave at the same point of the tick as they were recorded to.
+	 *
+	 * @param p_Callback the function to call, may be empty
+	 */
+	void setPackagesHandledCallback(std::function<void()> p_Callback);
 	/**
 	 * Finish the last setup, should be called somewhere right before start.
 	 */
 	virtual void setup() {}
 
 	/**
-	 * Start the game round asynchronously.
+	 * Start the game round asynchronously, ticked by a shared scheduler
+	 * until the game ends.
+	 *
+	 * @param p_Scheduler the scheduler to tick the game round on
+	 */
+	void start(TickScheduler& p_Scheduler);
+	/**
+	 * Start the game round without a scheduler, leaving it to the
+	 * caller to tick it, such as when replaying recorded input.
+	 */
+	void startUnscheduled();
+	/**
+	 * Run one tick of the game round. Called by the scheduler once started.
+	 *
+	 * @param p_DeltaTime the time since the last tick
+	 * @return true while the game round is running
 	 */
-	void start();
+	bool tick(float p_DeltaTime);
+	/**
+	 * Get the timing of the ticks of the game round.
+	 *
+	 * @return the tick statistics, empty if the game round has not been started
+	 */
+	TickStatistics getTickStatistics() const;
 
 	/**
 	 * Add player to the game. Should only be called before start.
@@ -128,6 +174,22 @@ protected:
 	 * Send any needed updates to all players.
 	 */
 	virtual void sendUpdates() {}
+	/**
+	 * Send object updates to all players, filtered by what is relevant
+	 * to each player. Unlike sendToAllPlayers, the update is encoded for
+	 * each player, as it is a delta against what that player has acknowledged.
+	 *
+	 * @param p_Objects the states of all replicated objects
+	 * @param p_Looks the look directions to send to every player
+	 */
+	void sendObjectUpdates(const std::vector<UpdateObjectData>& p_Objects, const std::vector<ObjectLookData>& p_Looks);
+	/**
+	 * Encode a package once and send it to all players.
+	 *
+	 * @param p_Encode encodes the package using any of the player connections
+	 * @param p_Except a player that should not receive the package, may be empty
+	 */
+	void sendToAllPlayers(const std::function<SharedFrame(IConnectionController*)>& p_Encode, Player::ptr p_Except = Player::ptr());
 	/**
 	 * Perform any neccesary action when a player disconnects.
 	 * <p>
@@ -139,9 +201,22 @@ protected:
 	virtual void playerDisconnected(Player::ptr p_DisconnectedPlayer) {}
 
 private:
-	void run();
-	void sendLevelAndWait();
-	void runGame();
+	enum class Phase
+	{
+		STARTING,	/// The level has not been sent
+		LOADING,	/// Waiting for the players to load the level
+		COUNTDOWN,	/// Counting down to the start of the game
+		PLAYING,
+	};
+
+	Phase m_Phase;
+	float m_CountdownTime;
+	std::function<void()> m_PackagesHandled;
+
+	void sendLevelToPlayers();
+	void waitForLoadedLevel();
+	void countDown(float p_DeltaTime);
+	void updateGame(float p_DeltaTime);
 	void checkForDisconnectedUsers();
 	void handlePackages();
 };
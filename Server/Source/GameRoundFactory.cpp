@@ -4,9 +4,16 @@
 #include "TestGameRound.h"
 #include "FileGameRound.h"
 
-GameRoundFactory::GameRoundFactory(Lobby* p_ReturnLobby)
+#include <Logger.h>
+
+#include <ctime>
+#include <sstream>
+
+GameRoundFactory::GameRoundFactory(Lobby* p_ReturnLobby, AssetCache* p_Assets)
 {
 	m_ReturnLobby = p_ReturnLobby;
+	m_Assets = p_Assets;
+	m_NumRecordedRounds = 0;
 }
 
 GameRound::ptr GameRoundFactory::createRound(const std::string& p_GameType)
@@ -19,7 +26,23 @@ GameRound::ptr GameRoundFactory::createRound(const std::string& p_GameType)
 		std::shared_ptr<FileGameRound> gameRound(new FileGameRound);
 		gameRound->setFilePath(level->second);
 		gameRound->setGameType(level->first);
-		gameRound->initialize(actorFactory, m_ReturnLobby);
+		gameRound->initialize(actorFactory, m_ReturnLobby, m_Assets);
+
+		if (!m_RecordDirectory.empty())
+		{
+			std::ostringstream filename;
+			filename << m_RecordDirectory << "/" << level->first << "-" << std::time(nullptr) << "-" << m_NumRecordedRounds++ << ".input";
+
+			try
+			{
+				gameRound->recordInput(InputRecorder::ptr(new InputRecorder(filename.str())));
+				Logger::log(Logger::Level::INFO, "Recording input to " + filename.str());
+			}
+			catch (ServerException& err)
+			{
+				Logger::log(Logger::Level::WARNING, err.what());
+			}
+		}
 
 		return gameRound;
 	}
@@ -33,3 +56,8 @@ void GameRoundFactory::addLevelPath(const std::string& p_GameType, const std::st
 {
 	m_Levels[p_GameType] = p_LevelPath;
 }
+
+void GameRoundFactory::setRecordDirectory(const std::string& p_Directory)
+{
+	m_RecordDirectory = p_Directory;
+}
@@ -19,16 +19,21 @@ class GameRoundFactory
 {
 private:
 	Lobby* m_ReturnLobby;
+	AssetCache* m_Assets;
 
 	std::map<std::string, std::string> m_Levels;
 
+	std::string m_RecordDirectory;
+	unsigned int m_NumRecordedRounds;
+
 public:
 	/**
 	 * constructor.
 	 *
 	 * @param p_ReturnLobby the lobby where game rounds should send leaving players
+	 * @param p_Assets the assets shared by the created game rounds
 	 */
-	explicit GameRoundFactory(Lobby* p_ReturnLobby);
+	GameRoundFactory(Lobby* p_ReturnLobby, AssetCache* p_Assets);
 
 	/**
 	 * Create a new round of a specific type.
@@ -45,4 +50,11 @@ public:
 	 * @param p_LevelPath the path to the level file describing a game round
 	 */
 	void addLevelPath(const std::string& p_GameType, const std::string& p_LevelPath);
+	/**
+	 * Record the input of all created game rounds, to be able to replay them.
+	 *
+	 * @param p_Directory an existing directory to write the input logs to,
+	 *			or empty to stop recording
+	 */
+	void setRecordDirectory(const std::string& p_Directory);
 };
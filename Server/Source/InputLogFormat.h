@@ -0,0 +1,40 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The format of the binary input logs written by InputRecorder and read
+ * by InputLogReader.
+ *
+ * The log starts with a header: the file id and version, the game type,
+ * the level path and random seed of the round, and the name, character
+ * and style of each player. Then follows one TICK record per tick, each
+ * followed by the packages handled and the players that left during
+ * that tick. Numbers are stored in the byte order of the recording
+ * machine, strings as a 32 bit length followed by the characters.
+ */
+namespace InputLog
+{
+	/**
+	 * The types of the records following the header.
+	 */
+	enum class Record : uint8_t
+	{
+		TICK,		/// The time since the last tick, float
+		PACKAGE,	/// Player index, package type, data size and the serialized package
+		LEAVE,		/// Player index
+	};
+
+	/**
+	 * Identifies input logs, "HBIL" as stored on little endian machines.
+	 */
+	static const uint32_t fileId = 0x4c494248;
+	/**
+	 * The version of the input log format.
+	 */
+	static const uint32_t fileVersion = 1;
+}
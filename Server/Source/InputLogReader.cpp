@@ -0,0 +1,131 @@
+#include "InputLogReader.h"
+
+#include "InputLogFormat.h"
+#include "ServerExceptions.h"
+
+namespace
+{
+	template <typename T>
+	T read(std::istream& p_Input)
+	{
+		T value;
+		if (!p_Input.read(reinterpret_cast<char*>(&value), sizeof(value)))
+		{
+			throw ServerException("Unexpected end of input log", __LINE__, __FILE__);
+		}
+		return value;
+	}
+
+	std::string readString(std::istream& p_Input)
+	{
+		std::string value(read<uint32_t>(p_Input), '\0');
+		if (!value.empty() && !p_Input.read(&value[0], value.size()))
+		{
+			throw ServerException("Unexpected end of input log", __LINE__, __FILE__);
+		}
+		return value;
+	}
+}
+
+InputLogReader::InputLogReader(std::istream& p_Input)
+	:	m_Input(p_Input),
+		m_Seed(0),
+		m_HasTick(false)
+{
+	uint32_t id = 0;
+	uint32_t version = 0;
+	m_Input.read(reinterpret_cast<char*>(&id), sizeof(id));
+	m_Input.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!m_Input || id != InputLog::fileId || version != InputLog::fileVersion)
+	{
+		throw ServerException("Not an input log of a supported version", __LINE__, __FILE__);
+	}
+
+	m_GameType = readString(m_Input);
+	m_LevelPath = readString(m_Input);
+	m_Seed = read<uint32_t>(m_Input);
+
+	m_Players.resize(read<uint16_t>(m_Input));
+	for (auto& player : m_Players)
+	{
+		player.username = readString(m_Input);
+		player.characterName = readString(m_Input);
+		player.characterStyle = readString(m_Input);
+	}
+
+	InputLog::Record record;
+	if (m_Input.read(reinterpret_cast<char*>(&record), sizeof(record)))
+	{
+		if (record != InputLog::Record::TICK)
+		{
+			throw ServerException("Corrupt input log", __LINE__, __FILE__);
+		}
+		m_HasTick = true;
+	}
+}
+
+const std::string& InputLogReader::getGameType() const
+{
+	return m_GameType;
+}
+
+const std::string& InputLogReader::getLevelPath() const
+{
+	return m_LevelPath;
+}
+
+uint32_t InputLogReader::getSeed() const
+{
+	return m_Seed;
+}
+
+const std::vector<InputLogReader::PlayerInfo>& InputLogReader::getPlayers() const
+{
+	return m_Players;
+}
+
+bool InputLogReader::readTick(Tick& p_Tick)
+{
+	if (!m_HasTick)
+	{
+		return false;
+	}
+
+	p_Tick.deltaTime = read<float>(m_Input);
+	p_Tick.packages.clear();
+	p_Tick.leaves.clear();
+
+	// Everything handled during a tick was recorded after the start of the tick.
+	m_HasTick = false;
+	InputLog::Record record;
+	while (m_Input.read(reinterpret_cast<char*>(&record), sizeof(record)))
+	{
+		if (record == InputLog::Record::TICK)
+		{
+			m_HasTick = true;
+			break;
+		}
+		else if (record == InputLog::Record::PACKAGE)
+		{
+			PackageRecord package;
+			package.player = read<uint16_t>(m_Input);
+			package.type = (PackageType)read<uint16_t>(m_Input);
+			package.data.resize(read<uint32_t>(m_Input));
+			if (!package.data.empty() && !m_Input.read(package.data.data(), package.data.size()))
+			{
+				throw ServerException("Unexpected end of input log", __LINE__, __FILE__);
+			}
+			p_Tick.packages.push_back(std::move(package));
+		}
+		else if (record == InputLog::Record::LEAVE)
+		{
+			p_Tick.leaves.push_back(read<uint16_t>(m_Input));
+		}
+		else
+		{
+			throw ServerException("Corrupt input log", __LINE__, __FILE__);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,85 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <INetwork.h>
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * Reads an input log written by InputRecorder, one tick at a time.
+ */
+class InputLogReader
+{
+public:
+	/**
+	 * A player as described in the header of the log.
+	 */
+	struct PlayerInfo
+	{
+		std::string username;
+		std::string characterName;
+		std::string characterStyle;
+	};
+
+	/**
+	 * A package handled by the game round.
+	 */
+	struct PackageRecord
+	{
+		uint16_t player;
+		PackageType type;
+		std::vector<char> data;
+	};
+
+	/**
+	 * Everything recorded during one tick, in the order it was handled.
+	 * The players in leaves were removed after the packages of the tick were handled.
+	 */
+	struct Tick
+	{
+		float deltaTime;
+		std::vector<PackageRecord> packages;
+		std::vector<uint16_t> leaves;
+	};
+
+private:
+	std::istream& m_Input;
+	std::string m_GameType;
+	std::string m_LevelPath;
+	uint32_t m_Seed;
+	std::vector<PlayerInfo> m_Players;
+	bool m_HasTick;
+
+public:
+	/**
+	 * constructor, reads the header of the log.
+	 *
+	 * @param p_Input the input log, opened in binary mode
+	 * @throws ServerException if the header is missing or of an unsupported version
+	 */
+	explicit InputLogReader(std::istream& p_Input);
+
+	const std::string& getGameType() const;
+	const std::string& getLevelPath() const;
+	uint32_t getSeed() const;
+	const std::vector<PlayerInfo>& getPlayers() const;
+
+	/**
+	 * Read the next tick of the log.
+	 *
+	 * @param p_Tick the tick to fill, its previous content is replaced
+	 * @return false if the log has ended
+	 * @throws ServerException if the log is corrupt or ends in the middle of a record
+	 */
+	bool readTick(Tick& p_Tick);
+
+private:
+	InputLogReader(const InputLogReader&);
+	InputLogReader& operator=(const InputLogReader&);
+};
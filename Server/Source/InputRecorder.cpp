@@ -0,0 +1,88 @@
+#include "InputRecorder.h"
+
+#include "ServerExceptions.h"
+
+#include <algorithm>
+
+InputRecorder::InputRecorder(const std::string& p_Filename)
+	:	m_File(p_Filename, std::ofstream::binary | std::ofstream::trunc)
+{
+	if (!m_File)
+	{
+		throw ServerException("Could not create input log: " + p_Filename, __LINE__, __FILE__);
+	}
+}
+
+void InputRecorder::recordRound(const std::string& p_GameType, const std::string& p_LevelPath, uint32_t p_Seed, const std::vector<Player::ptr>& p_Players)
+{
+	write(InputLog::fileId);
+	write(InputLog::fileVersion);
+	writeString(p_GameType);
+	writeString(p_LevelPath);
+	write(p_Seed);
+
+	write((uint16_t)p_Players.size());
+	for (const auto& player : p_Players)
+	{
+		m_Players.push_back(player.get());
+
+		User::ptr user = player->getUser().lock();
+		writeString(user ? user->getUsername() : std::string());
+		writeString(user ? user->getCharacterName() : std::string());
+		writeString(user ? user->getCharacterStyle() : std::string());
+	}
+}
+
+void InputRecorder::recordTick(float p_DeltaTime)
+{
+	write(InputLog::Record::TICK);
+	write(p_DeltaTime);
+}
+
+void InputRecorder::recordPackage(const Player::ptr& p_Player, IConnectionController* p_Connection, Package p_Package)
+{
+	uint16_t player;
+	if (!findPlayer(p_Player, player))
+	{
+		return;
+	}
+
+	m_PackageData.clear();
+	p_Connection->writePackageData(p_Package, m_PackageData);
+
+	write(InputLog::Record::PACKAGE);
+	write(player);
+	write((uint16_t)p_Connection->getPackageType(p_Package));
+	write((uint32_t)m_PackageData.size());
+	m_File.write(m_PackageData.data(), m_PackageData.size());
+}
+
+void InputRecorder::recordLeave(const Player::ptr& p_Player)
+{
+	uint16_t player;
+	if (!findPlayer(p_Player, player))
+	{
+		return;
+	}
+
+	write(InputLog::Record::LEAVE);
+	write(player);
+}
+
+bool InputRecorder::findPlayer(const Player::ptr& p_Player, uint16_t& p_Index) const
+{
+	auto it = std::find(m_Players.begin(), m_Players.end(), p_Player.get());
+	if (it == m_Players.end())
+	{
+		return false;
+	}
+
+	p_Index = (uint16_t)(it - m_Players.begin());
+	return true;
+}
+
+void InputRecorder::writeString(const std::string& p_String)
+{
+	write((uint32_t)p_String.size());
+	m_File.write(p_String.data(), p_String.size());
+}
@@ -0,0 +1,85 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include "InputLogFormat.h"
+#include "Player.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Records everything a game round depends on to a binary input log,
+ * so that the game round can be replayed offline by InputReplay.
+ * The format is described by InputLog.
+ */
+class InputRecorder
+{
+public:
+	/**
+	 * Unique pointer type.
+	 */
+	typedef std::unique_ptr<InputRecorder> ptr;
+
+private:
+	std::ofstream m_File;
+	std::vector<const Player*> m_Players;
+	std::vector<char> m_PackageData;
+
+public:
+	/**
+	 * constructor.
+	 *
+	 * @param p_Filename the input log to create, replacing any existing file
+	 */
+	explicit InputRecorder(const std::string& p_Filename);
+
+	/**
+	 * Write the header, describing what the game round was created from.
+	 * Must be written before any other records.
+	 *
+	 * @param p_GameType the type name of the game round
+	 * @param p_LevelPath the path to the level file
+	 * @param p_Seed the seed of the random number generator of the round
+	 * @param p_Players the players of the round, in the order they joined
+	 */
+	void recordRound(const std::string& p_GameType, const std::string& p_LevelPath, uint32_t p_Seed, const std::vector<Player::ptr>& p_Players);
+	/**
+	 * Record the start of a tick.
+	 *
+	 * @param p_DeltaTime the time since the last tick
+	 */
+	void recordTick(float p_DeltaTime);
+	/**
+	 * Record a package handled by the game round.
+	 *
+	 * @param p_Player the player that sent the package
+	 * @param p_Connection the connection the package was received on
+	 * @param p_Package a valid reference to the package
+	 */
+	void recordPackage(const Player::ptr& p_Player, IConnectionController* p_Connection, Package p_Package);
+	/**
+	 * Record that a player has left the game round.
+	 *
+	 * @param p_Player the player that left
+	 */
+	void recordLeave(const Player::ptr& p_Player);
+
+private:
+	InputRecorder(const InputRecorder&);
+	InputRecorder& operator=(const InputRecorder&);
+
+	bool findPlayer(const Player::ptr& p_Player, uint16_t& p_Index) const;
+
+	template <typename T>
+	void write(T p_Value)
+	{
+		m_File.write(reinterpret_cast<const char*>(&p_Value), sizeof(p_Value));
+	}
+	void writeString(const std::string& p_String);
+};
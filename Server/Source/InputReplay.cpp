@@ -0,0 +1,85 @@
+#include "InputReplay.h"
+
+#include "FileGameRound.h"
+#include "InputLogReader.h"
+#include "ServerExceptions.h"
+
+#include <Logger.h>
+
+#include <fstream>
+
+InputReplay::InputReplay(AssetCache* p_Assets, INetwork* p_Network)
+	:	m_Assets(p_Assets),
+		m_Network(p_Network)
+{
+}
+
+TickStatistics InputReplay::replay(const std::string& p_Filename)
+{
+	std::ifstream file(p_Filename, std::ifstream::binary);
+	if (!file)
+	{
+		throw ServerException("Could not read input log: " + p_Filename, __LINE__, __FILE__);
+	}
+
+	InputLogReader log(file);
+
+	std::shared_ptr<FileGameRound> gameRound(new FileGameRound);
+	gameRound->setFilePath(log.getLevelPath());
+	gameRound->setGameType(log.getGameType());
+	gameRound->setRandomSeed(log.getSeed());
+	gameRound->initialize(ActorFactory::ptr(new ActorFactory(0)), nullptr, m_Assets);
+
+	// The users are only kept alive by the replay, so that players can leave as recorded.
+	std::vector<User::ptr> users;
+	for (const auto& player : log.getPlayers())
+	{
+		User::ptr user(new User(m_Network->createOfflineConnection()));
+		user->setUsername(player.username);
+		user->setCharacterName(player.characterName);
+		user->setCharacterStyle(player.characterStyle);
+		user->setState(User::State::WAITING_FOR_GAME);
+
+		gameRound->addNewPlayer(user);
+		users.push_back(user);
+	}
+
+	Logger::log(Logger::Level::INFO, "Replaying " + log.getGameType() + " with " + std::to_string(users.size()) + " players from " + p_Filename);
+
+	// Players that left were removed after the packages of the tick were handled,
+	// so the packages they sent during that tick are still handled.
+	InputLogReader::Tick tick;
+	gameRound->setPackagesHandledCallback([&users, &tick] ()
+	{
+		for (uint16_t player : tick.leaves)
+		{
+			if (player < users.size())
+			{
+				users[player].reset();
+			}
+		}
+		tick.leaves.clear();
+	});
+
+	gameRound->setup();
+	gameRound->startUnscheduled();
+
+	TickStatistics statistics = TickStatistics();
+	bool running = true;
+	while (running && log.readTick(tick))
+	{
+		for (const auto& package : tick.packages)
+		{
+			if (package.player < users.size() && users[package.player])
+			{
+				users[package.player]->getConnection()->receivePackageData(package.type, package.data.data(), package.data.size());
+			}
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		running = gameRound->tick(tick.deltaTime);
+		statistics.addTick(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0.0);
+	}
+
+	return statistics;
+}
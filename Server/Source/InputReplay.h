@@ -0,0 +1,46 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include "AssetCache.h"
+#include "TickScheduler.h"
+
+#include <INetwork.h>
+
+#include <string>
+
+/**
+ * Replays an input log written by InputRecorder into a new game round,
+ * without sockets or a scheduler. The ticks are run back to back as
+ * fast as possible, making a repeatable benchmark of the physics and
+ * game logic of a recorded game round.
+ */
+class InputReplay
+{
+private:
+	AssetCache* m_Assets;
+	INetwork* m_Network;
+
+public:
+	/**
+	 * constructor.
+	 *
+	 * @param p_Assets the assets to load the game round from
+	 * @param p_Network an initialized network, used for offline connections only
+	 */
+	InputReplay(AssetCache* p_Assets, INetwork* p_Network);
+
+	/**
+	 * Replay a recorded game round until the input log ends or all players have left.
+	 *
+	 * @param p_Filename the input log to replay
+	 * @return the timing of the replayed ticks
+	 */
+	TickStatistics replay(const std::string& p_Filename);
+
+private:
+	InputReplay(const InputReplay&);
+	InputReplay& operator=(const InputReplay&);
+};
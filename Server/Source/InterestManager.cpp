@@ -0,0 +1,166 @@
+#include "InterestManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	bool lessById(const std::pair<uint32_t, float>& p_Left, const std::pair<uint32_t, float>& p_Right)
+	{
+		return p_Left.first < p_Right.first;
+	}
+}
+
+InterestManager::Settings::Settings()
+	:	relevantDistance(15000.f),
+		fullRateDistance(3000.f),
+		viewConeCos(0.5f),
+		outOfViewFactor(0.25f),
+		minPriority(0.1f)
+{
+}
+
+InterestManager::InterestManager()
+	:	m_Objects(nullptr)
+{
+}
+
+void InterestManager::setSettings(const Settings& p_Settings)
+{
+	m_Settings = p_Settings;
+	m_Grid.clear();
+}
+
+const InterestManager::Settings& InterestManager::getSettings() const
+{
+	return m_Settings;
+}
+
+void InterestManager::update(const std::vector<UpdateObjectData>& p_Objects)
+{
+	m_Objects = &p_Objects;
+
+	// Keep the cell vectors around between ticks, unless the grid has grown stale.
+	if (m_Grid.size() > 4 * p_Objects.size() + 16)
+	{
+		m_Grid.clear();
+	}
+	for (auto& cell : m_Grid)
+	{
+		cell.second.clear();
+	}
+
+	for (uint32_t i = 0; i < p_Objects.size(); ++i)
+	{
+		const Vector3& position = p_Objects[i].m_Position;
+		m_Grid[cellKey(cellCoordinate(position.x), cellCoordinate(position.y), cellCoordinate(position.z))].push_back(i);
+	}
+}
+
+void InterestManager::selectRelevant(ClientState& p_Client, const Vector3& p_ViewPosition, const Vector3& p_ViewForward,
+	uint32_t p_ViewerId, std::vector<UpdateObjectData>& p_Selected)
+{
+	p_Selected.clear();
+	if (!m_Objects)
+	{
+		return;
+	}
+	const std::vector<UpdateObjectData>& objects = *m_Objects;
+
+	// The grid cells are as large as the relevant distance, so the neighbouring cells cover every candidate.
+	m_Candidates.clear();
+	const int centerX = cellCoordinate(p_ViewPosition.x);
+	const int centerY = cellCoordinate(p_ViewPosition.y);
+	const int centerZ = cellCoordinate(p_ViewPosition.z);
+	for (int x = centerX - 1; x <= centerX + 1; ++x)
+	{
+		for (int y = centerY - 1; y <= centerY + 1; ++y)
+		{
+			for (int z = centerZ - 1; z <= centerZ + 1; ++z)
+			{
+				auto cell = m_Grid.find(cellKey(x, y, z));
+				if (cell != m_Grid.end())
+				{
+					m_Candidates.insert(m_Candidates.end(), cell->second.begin(), cell->second.end());
+				}
+			}
+		}
+	}
+	for (uint32_t i = 0; i < objects.size(); ++i)
+	{
+		if (objects[i].m_Id == p_ViewerId)
+		{
+			m_Candidates.push_back(i);
+		}
+	}
+	std::sort(m_Candidates.begin(), m_Candidates.end());
+	m_Candidates.erase(std::unique(m_Candidates.begin(), m_Candidates.end()), m_Candidates.end());
+
+	const float forwardLength = std::sqrt(p_ViewForward.x * p_ViewForward.x
+		+ p_ViewForward.y * p_ViewForward.y + p_ViewForward.z * p_ViewForward.z);
+	const float relevantSq = m_Settings.relevantDistance * m_Settings.relevantDistance;
+	const float fullRateSq = m_Settings.fullRateDistance * m_Settings.fullRateDistance;
+	const float falloff = std::max(m_Settings.relevantDistance - m_Settings.fullRateDistance, 1.f);
+
+	p_Client.m_NextPriorities.clear();
+	for (uint32_t index : m_Candidates)
+	{
+		const UpdateObjectData& object = objects[index];
+		const float dx = object.m_Position.x - p_ViewPosition.x;
+		const float dy = object.m_Position.y - p_ViewPosition.y;
+		const float dz = object.m_Position.z - p_ViewPosition.z;
+		const float distanceSq = dx * dx + dy * dy + dz * dz;
+
+		if (object.m_Id == p_ViewerId || distanceSq <= fullRateSq)
+		{
+			p_Selected.push_back(object);
+			continue;
+		}
+		if (distanceSq > relevantSq)
+		{
+			continue;
+		}
+
+		const float distance = std::sqrt(distanceSq);
+		float priority = (m_Settings.relevantDistance - distance) / falloff;
+		if (forwardLength > 0.f)
+		{
+			const float facing = (dx * p_ViewForward.x + dy * p_ViewForward.y + dz * p_ViewForward.z) / (distance * forwardLength);
+			if (facing < m_Settings.viewConeCos)
+			{
+				priority *= m_Settings.outOfViewFactor;
+			}
+		}
+		priority = std::max(priority, m_Settings.minPriority);
+
+		const std::pair<uint32_t, float> key(object.m_Id, 0.f);
+		auto previous = std::lower_bound(p_Client.m_Priorities.begin(), p_Client.m_Priorities.end(), key, lessById);
+		float accumulated = priority;
+		if (previous != p_Client.m_Priorities.end() && previous->first == object.m_Id)
+		{
+			accumulated += previous->second;
+		}
+
+		if (accumulated >= 1.f)
+		{
+			p_Selected.push_back(object);
+			accumulated -= 1.f;
+		}
+		p_Client.m_NextPriorities.push_back(std::make_pair(object.m_Id, accumulated));
+	}
+
+	// Objects that left the relevant area lose their accumulated priority.
+	std::sort(p_Client.m_NextPriorities.begin(), p_Client.m_NextPriorities.end(), lessById);
+	p_Client.m_Priorities.swap(p_Client.m_NextPriorities);
+}
+
+uint64_t InterestManager::cellKey(int p_X, int p_Y, int p_Z)
+{
+	static const uint64_t mask = (1 << 21) - 1;
+	return (((uint64_t)p_X & mask) << 42) | (((uint64_t)p_Y & mask) << 21) | ((uint64_t)p_Z & mask);
+}
+
+int InterestManager::cellCoordinate(float p_Value) const
+{
+	return (int)std::floor(p_Value / m_Settings.relevantDistance);
+}
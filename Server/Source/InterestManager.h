@@ -0,0 +1,128 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <CommonTypes.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Decides which replicated objects are relevant to each client.
+ * <p>
+ * Objects close to the viewer are sent every tick. Objects further away
+ * build up priority each tick, faster when inside the view cone, and are
+ * sent when enough has accumulated. Objects beyond the relevant distance
+ * are not sent at all. Lookups go through a uniform grid rebuilt each tick.
+ */
+class InterestManager
+{
+public:
+	/**
+	 * Tunable relevancy parameters. Distances are in cm.
+	 */
+	struct Settings
+	{
+		/**
+		 * Objects further away than this are never sent.
+		 */
+		float relevantDistance;
+		/**
+		 * Objects closer than this are sent every tick.
+		 */
+		float fullRateDistance;
+		/**
+		 * Cosine of the half angle of the view cone.
+		 */
+		float viewConeCos;
+		/**
+		 * Priority multiplier for objects outside the view cone.
+		 */
+		float outOfViewFactor;
+		/**
+		 * Smallest priority added per tick for a relevant object,
+		 * guarantees an update at least every 1 / minPriority ticks.
+		 */
+		float minPriority;
+
+		/**
+		 * Constructor setting defaults.
+		 */
+		Settings();
+	};
+
+	/**
+	 * Per client relevancy state, owned by the player.
+	 */
+	class ClientState
+	{
+	private:
+		friend class InterestManager;
+
+		std::vector<std::pair<uint32_t, float>> m_Priorities;
+		std::vector<std::pair<uint32_t, float>> m_NextPriorities;
+	};
+
+private:
+	Settings m_Settings;
+	const std::vector<UpdateObjectData>* m_Objects;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> m_Grid;
+	std::vector<uint32_t> m_Candidates;
+
+public:
+	/**
+	 * constructor.
+	 */
+	InterestManager();
+
+	/**
+	 * Change the relevancy parameters.
+	 *
+	 * @param p_Settings the new settings
+	 */
+	void setSettings(const Settings& p_Settings);
+	/**
+	 * Get the current relevancy parameters.
+	 *
+	 * @return the current settings
+	 */
+	const Settings& getSettings() const;
+
+	/**
+	 * Set the objects to filter this tick and rebuild the spatial lookup.
+	 *
+	 * @param p_Objects the states of all replicated objects, must stay
+	 *			unchanged until the last selectRelevant call of the tick
+	 */
+	void update(const std::vector<UpdateObjectData>& p_Objects);
+
+	/**
+	 * Select the objects to send to one client this tick.
+	 *
+	 * @param p_Client the relevancy state of the client, updated
+	 * @param p_ViewPosition the position the client views the world from
+	 * @param p_ViewForward the direction the client looks in, zero if unknown
+	 * @param p_ViewerId id of the client's own object, always selected
+	 * @param p_Selected cleared and filled with the selected objects, in update order
+	 */
+	void selectRelevant(ClientState& p_Client, const Vector3& p_ViewPosition, const Vector3& p_ViewForward,
+		uint32_t p_ViewerId, std::vector<UpdateObjectData>& p_Selected);
+
+	/**
+	 * Pack the coordinates of a grid cell into a lookup key.
+	 * The coordinates wrap around every 2^21 cells.
+	 *
+	 * @param p_X the cell coordinate along x
+	 * @param p_Y the cell coordinate along y
+	 * @param p_Z the cell coordinate along z
+	 * @return the key of the cell
+	 */
+	static uint64_t cellKey(int p_X, int p_Y, int p_Z);
+
+private:
+	int cellCoordinate(float p_Value) const;
+};
@@ -4,13 +4,29 @@
 #include <Logger.h>
 
 #include <algorithm>
+#include <limits>
 
-Lobby::Lobby(Server* p_Server)
+Lobby::Lobby(Server* p_Server, AssetCache* p_Assets)
 	:	m_Server(p_Server),
-		m_GameFactory(this)
+		m_GameFactory(this, p_Assets),
+		m_JoinStatistics()
 {
 }
 
+Lobby::~Lobby()
+{
+	std::lock_guard<std::mutex> lock(m_UserLock);
+
+	for (auto& wUser : m_FreeUsers)
+	{
+		User::ptr user = wUser.lock();
+		if (user)
+		{
+			user->getConnection()->setPackagesReceivedCallback(nullptr, nullptr);
+		}
+	}
+}
+
 void Lobby::checkFreeUsers(float p_DeltaTime)
 {
 	std::lock_guard<std::mutex> lock(m_UserLock);
@@ -21,7 +37,13 @@ void Lobby::checkFreeUsers(float p_DeltaTime)
 		[] (User::wPtr p_User)
 		{
 			User::ptr user = p_User.lock();
-			return !user || user->getState() != User::State::LOBBY;
+			if (user && user->getState() != User::State::LOBBY)
+			{
+				// The game round handles the packages from now on.
+				user->getConnection()->setPackagesReceivedCallback(nullptr, nullptr);
+				return true;
+			}
+			return !user;
 		});
 	m_FreeUsers.erase(removeIt, m_FreeUsers.end());
 
@@ -39,6 +61,22 @@ void Lobby::checkFreeUsers(float p_DeltaTime)
 	}
 }
 
+float Lobby::getTimeToNextStart()
+{
+	std::lock_guard<std::mutex> lock(m_UserLock);
+
+	float timeLeft = std::numeric_limits<float>::max();
+	for (const auto& level : m_Levels)
+	{
+		if (!level.m_JoinedUsers.empty())
+		{
+			timeLeft = std::min(timeLeft, level.m_TimeoutLength - level.m_WaitedTime);
+		}
+	}
+
+	return std::max(timeLeft, 0.f);
+}
+
 void Lobby::addAvailableLevel(const std::string& p_LevelName,
 							  const std::string& p_LevelPath,
 							  unsigned int p_MaxPlayers,
@@ -66,7 +104,24 @@ void Lobby::addFreeUser(User::wPtr p_User)
 
 		std::lock_guard<std::mutex> lock(m_UserLock);
 		m_FreeUsers.push_back(p_User);
+
+		user->getConnection()->setPackagesReceivedCallback(&Lobby::packagesReceived, this);
 	}
+
+	// Handle anything the user sent before joining the lobby.
+	m_Server->wakeUp();
+}
+
+void Lobby::recordGames(const std::string& p_Directory)
+{
+	std::lock_guard<std::mutex> lock(m_UserLock);
+	m_GameFactory.setRecordDirectory(p_Directory);
+}
+
+Lobby::JoinStatistics Lobby::getJoinStatistics()
+{
+	std::lock_guard<std::mutex> lock(m_UserLock);
+	return m_JoinStatistics;
 }
 
 void Lobby::joinLevel(User::ptr p_User, const std::string& p_LevelName)
@@ -77,6 +132,7 @@ void Lobby::joinLevel(User::ptr p_User, const std::string& p_LevelName)
 		{
 			level.m_JoinedUsers.push_back(p_User);
 			p_User->setState(User::State::WAITING_FOR_GAME);
+			p_User->setJoinTime(std::chrono::steady_clock::now());
 
 			if (level.m_JoinedUsers.size() >= level.m_MaxPlayers)
 			{
@@ -90,11 +146,29 @@ void Lobby::joinLevel(User::ptr p_User, const std::string& p_LevelName)
 
 void Lobby::startLevel(AvailableLevel& p_Level)
 {
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double maxWait = 0.0;
+
 	GameRound::ptr game = m_GameFactory.createRound(p_Level.m_LevelName);
 	for (auto& player : p_Level.m_JoinedUsers)
 	{
+		User::ptr user = player.lock();
+		if (user)
+		{
+			const double wait = std::chrono::duration_cast<std::chrono::duration<double>>(now - user->getJoinTime()).count();
+			++m_JoinStatistics.m_NumStarted;
+			m_JoinStatistics.m_TotalWait += wait;
+			maxWait = std::max(maxWait, wait);
+		}
+
 		game->addNewPlayer(player);
 	}
+	m_JoinStatistics.m_MaxWait = std::max(m_JoinStatistics.m_MaxWait, maxWait);
+	m_JoinStatistics.m_LastWait = maxWait;
+
+	Logger::log(Logger::Level::INFO, "Starting \"" + p_Level.m_LevelName + "\" with "
+		+ std::to_string(p_Level.m_JoinedUsers.size()) + " players, "
+		+ std::to_string((int)(maxWait * 1000.0)) + " ms after the first joined");
 
 	p_Level.m_JoinedUsers.clear();
 	p_Level.m_WaitedTime = 0.f;
@@ -138,9 +212,10 @@ void Lobby::handlePackagesForOneUser(User::wPtr p_User)
 				user->setUsername(username);
 				user->setCharacterName(characterName);
 				user->setCharacterStyle(characterStyle);
-				joinLevel(user, levelName);
 
+				// Joining may start the game, which reads the packages from then on.
 				con->clearPackages(i + 1);
+				joinLevel(user, levelName);
 				return;
 			}
 
@@ -171,3 +246,8 @@ void Lobby::handlePackagesForOneUser(User::wPtr p_User)
 
 	con->clearPackages(numPackages);
 }
+
+void Lobby::packagesReceived(IConnectionController* p_Connection, void* p_UserData)
+{
+	static_cast<Lobby*>(p_UserData)->m_Server->wakeUp();
+}
@@ -7,6 +7,7 @@
 #include "GameRoundFactory.h"
 #include "User.h"
 
+#include <cstdint>
 #include <mutex>
 #include <vector>
 
@@ -30,6 +31,17 @@ public:
 		float m_WaitedTime;
 	};
 
+	/**
+	 * The time from users joining a game until the game started.
+	 */
+	struct JoinStatistics
+	{
+		uint64_t m_NumStarted;		/// Users that have had their game started
+		double m_TotalWait;			/// Seconds from joining to the game starting, summed over the users
+		double m_MaxWait;			/// Longest time a user waited
+		double m_LastWait;			/// Longest time a user of the last started game waited
+	};
+
 private:
 	Server* m_Server;
 
@@ -37,14 +49,20 @@ private:
 	std::mutex m_UserLock;
 	std::vector<User::wPtr> m_FreeUsers;
 	GameRoundFactory m_GameFactory;
+	JoinStatistics m_JoinStatistics;
 
 public:
 	/**
 	 * constructor.
 	 *
 	 * @param p_Server the owning server that handles started games
+	 * @param p_Assets the assets shared by all started games
+	 */
+	Lobby(Server* p_Server, AssetCache* p_Assets);
+	/**
+	 * destructor.
 	 */
-	explicit Lobby(Server* p_Server);
+	~Lobby();
 
 	/**
 	 * Deal with any users in the lobby, checking if they join a game, and stuff.
@@ -52,6 +70,13 @@ public:
 	 * @param p_DeltaTime the time since last check
 	 */
 	void checkFreeUsers(float p_DeltaTime);
+	/**
+	 * Get the time until the first level with joined users times out and
+	 * is started, if no user sends anything before then.
+	 *
+	 * @return the time left in seconds
+	 */
+	float getTimeToNextStart();
 
 	/**
 	 * Add a new level to the list of available levels.
@@ -69,10 +94,24 @@ public:
 	 * @param p_User the user to add
 	 */
 	void addFreeUser(User::wPtr p_User);
+	/**
+	 * Record the input of all started games, to be able to replay them.
+	 *
+	 * @param p_Directory an existing directory to write the input logs to,
+	 *			or empty to stop recording
+	 */
+	void recordGames(const std::string& p_Directory);
+	/**
+	 * Get how long users have waited from joining until their game started.
+	 *
+	 * @return the join statistics
+	 */
+	JoinStatistics getJoinStatistics();
 
 private:
 	void joinLevel(User::ptr p_User, const std::string& p_LevelName);
 	void startLevel(AvailableLevel& p_Level);
 	void handlePackages();
 	void handlePackagesForOneUser(User::wPtr p_User);
+	static void packagesReceived(IConnectionController* p_Connection, void* p_UserData);
 };
@@ -0,0 +1,228 @@
+#include "MetricsReport.h"
+
+#include <INetwork.h>
+
+#include <iomanip>
+
+namespace
+{
+	PackageTypeMetrics getTraffic(const ConnectionMetrics& p_Metrics)
+	{
+		PackageTypeMetrics traffic = PackageTypeMetrics();
+		for (const PackageTypeMetrics& type : p_Metrics.m_Types)
+		{
+			traffic.m_PackagesSent += type.m_PackagesSent;
+			traffic.m_BytesSent += type.m_BytesSent;
+			traffic.m_PackagesReceived += type.m_PackagesReceived;
+			traffic.m_BytesReceived += type.m_BytesReceived;
+			traffic.m_EncodeSeconds += type.m_EncodeSeconds;
+			traffic.m_DecodeSeconds += type.m_DecodeSeconds;
+		}
+		return traffic;
+	}
+
+	bool hasTraffic(const PackageTypeMetrics& p_Type)
+	{
+		return p_Type.m_PackagesSent > 0 || p_Type.m_PackagesReceived > 0;
+	}
+
+	double perSecond(uint64_t p_Value, const ConnectionMetrics& p_Metrics)
+	{
+		return p_Metrics.m_Seconds > 0.0 ? p_Value / p_Metrics.m_Seconds : 0.0;
+	}
+
+	std::string escapeJSON(const std::string& p_String)
+	{
+		std::string escaped;
+		for (char c : p_String)
+		{
+			switch (c)
+			{
+			case '"':	escaped += "\\\""; break;
+			case '\\':	escaped += "\\\\"; break;
+			case '\n':	escaped += "\\n"; break;
+			case '\r':	escaped += "\\r"; break;
+			case '\t':	escaped += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20)
+				{
+					static const char hexDigits[] = "0123456789abcdef";
+					escaped += "\\u00";
+					escaped += hexDigits[(c >> 4) & 0xf];
+					escaped += hexDigits[c & 0xf];
+				}
+				else
+				{
+					escaped += c;
+				}
+				break;
+			}
+		}
+		return escaped;
+	}
+
+	std::string escapeCSV(const std::string& p_String)
+	{
+		if (p_String.find_first_of(",\"\n") == std::string::npos)
+		{
+			return p_String;
+		}
+
+		std::string escaped("\"");
+		for (char c : p_String)
+		{
+			if (c == '"')
+			{
+				escaped += '"';
+			}
+			escaped += c;
+		}
+		return escaped + '"';
+	}
+
+	void writeConnectionCSV(std::ostream& p_Out, const std::string& p_Name, const ConnectionMetrics& p_Metrics)
+	{
+		for (unsigned int i = 0; i < ConnectionMetrics::numPackageTypes; ++i)
+		{
+			const PackageTypeMetrics& type = p_Metrics.m_Types[i];
+			if (!hasTraffic(type))
+			{
+				continue;
+			}
+
+			p_Out << escapeCSV(p_Name) << ',' << INetwork::getPackageTypeName((PackageType)i) << ','
+				<< type.m_PackagesSent << ',' << type.m_BytesSent << ','
+				<< type.m_PackagesReceived << ',' << type.m_BytesReceived << ','
+				<< type.m_EncodeSeconds * 1000.0 << ',' << type.m_DecodeSeconds * 1000.0 << ','
+				<< p_Metrics.m_Seconds << ',' << p_Metrics.m_RoundTripTime * 1000.f << ','
+				<< p_Metrics.m_RoundTripVariation * 1000.f << ',' << p_Metrics.m_NumRoundTrips << ','
+				<< p_Metrics.m_MaxQueuedPackages << ',' << p_Metrics.m_MaxQueuedBytes << std::endl;
+		}
+	}
+
+	void writeConnectionJSON(std::ostream& p_Out, const std::string& p_Name, const ConnectionMetrics& p_Metrics)
+	{
+		p_Out << "{\"name\":\"" << escapeJSON(p_Name) << "\""
+			<< ",\"connections\":" << p_Metrics.m_NumConnections
+			<< ",\"seconds\":" << p_Metrics.m_Seconds
+			<< ",\"socketWrites\":" << p_Metrics.m_SocketWrites
+			<< ",\"socketBytes\":" << p_Metrics.m_SocketBytes
+			<< ",\"maxQueuedPackages\":" << p_Metrics.m_MaxQueuedPackages
+			<< ",\"maxQueuedBytes\":" << p_Metrics.m_MaxQueuedBytes
+			<< ",\"roundTrips\":" << p_Metrics.m_NumRoundTrips
+			<< ",\"roundTripMs\":" << p_Metrics.m_RoundTripTime * 1000.f
+			<< ",\"roundTripVariationMs\":" << p_Metrics.m_RoundTripVariation * 1000.f
+			<< ",\"types\":{";
+
+		bool first = true;
+		for (unsigned int i = 0; i < ConnectionMetrics::numPackageTypes; ++i)
+		{
+			const PackageTypeMetrics& type = p_Metrics.m_Types[i];
+			if (!hasTraffic(type))
+			{
+				continue;
+			}
+
+			p_Out << (first ? "" : ",") << "\"" << INetwork::getPackageTypeName((PackageType)i) << "\":{"
+				<< "\"packagesSent\":" << type.m_PackagesSent
+				<< ",\"bytesSent\":" << type.m_BytesSent
+				<< ",\"packagesReceived\":" << type.m_PackagesReceived
+				<< ",\"bytesReceived\":" << type.m_BytesReceived
+				<< ",\"encodeMs\":" << type.m_EncodeSeconds * 1000.0
+				<< ",\"decodeMs\":" << type.m_DecodeSeconds * 1000.0
+				<< "}";
+			first = false;
+		}
+
+		p_Out << "}}";
+	}
+}
+
+MetricsReport::MetricsReport(const ConnectionMetrics& p_Total)
+	:	m_Total(p_Total)
+{
+}
+
+void MetricsReport::addConnection(const std::string& p_Name, const ConnectionMetrics& p_Metrics)
+{
+	m_Connections.push_back(std::make_pair(p_Name, p_Metrics));
+}
+
+void MetricsReport::printConnections(std::ostream& p_Out) const
+{
+	for (const auto& connection : m_Connections)
+	{
+		const ConnectionMetrics& metrics = connection.second;
+		const PackageTypeMetrics traffic = getTraffic(metrics);
+
+		p_Out << std::left << std::setw(20) << connection.first << std::right << std::fixed << std::setprecision(1);
+		if (metrics.m_NumRoundTrips > 0)
+		{
+			p_Out << " rtt " << metrics.m_RoundTripTime * 1000.f << " ms";
+		}
+		else
+		{
+			p_Out << " rtt -";
+		}
+		p_Out << ", out " << perSecond(traffic.m_BytesSent, metrics) / 1024.0 << " kB/s"
+			<< ", in " << perSecond(traffic.m_BytesReceived, metrics) / 1024.0 << " kB/s"
+			<< ", max queue " << metrics.m_MaxQueuedPackages << std::endl;
+	}
+}
+
+void MetricsReport::printPackageTypes(std::ostream& p_Out) const
+{
+	p_Out << m_Total.m_NumConnections << " connections" << std::fixed << std::setprecision(1);
+	if (m_Total.m_NumRoundTrips > 0)
+	{
+		p_Out << ", rtt " << m_Total.m_RoundTripTime * 1000.f << " ms";
+	}
+	p_Out << ", max queue " << m_Total.m_MaxQueuedPackages << " packages, " << m_Total.m_MaxQueuedBytes << " bytes" << std::endl;
+
+	for (unsigned int i = 0; i < ConnectionMetrics::numPackageTypes; ++i)
+	{
+		const PackageTypeMetrics& type = m_Total.m_Types[i];
+		if (!hasTraffic(type))
+		{
+			continue;
+		}
+
+		p_Out << "  " << std::left << std::setw(22) << INetwork::getPackageTypeName((PackageType)i) << std::right
+			<< " sent " << type.m_PackagesSent << " (" << type.m_BytesSent << " B)"
+			<< ", received " << type.m_PackagesReceived << " (" << type.m_BytesReceived << " B)"
+			<< ", encode " << type.m_EncodeSeconds * 1000.0 << " ms"
+			<< ", decode " << type.m_DecodeSeconds * 1000.0 << " ms" << std::endl;
+	}
+}
+
+void MetricsReport::writeCSV(std::ostream& p_Out) const
+{
+	// Times in milliseconds with microsecond resolution.
+	p_Out << std::fixed << std::setprecision(3);
+	p_Out << "connection,package_type,packages_sent,bytes_sent,packages_received,bytes_received,encode_ms,decode_ms,"
+		"seconds,rtt_ms,rtt_variation_ms,round_trips,max_queued_packages,max_queued_bytes" << std::endl;
+
+	for (const auto& connection : m_Connections)
+	{
+		writeConnectionCSV(p_Out, connection.first, connection.second);
+	}
+	writeConnectionCSV(p_Out, "total", m_Total);
+}
+
+void MetricsReport::writeJSON(std::ostream& p_Out) const
+{
+	p_Out << std::fixed << std::setprecision(3);
+	p_Out << "{\"total\":";
+	writeConnectionJSON(p_Out, "total", m_Total);
+
+	p_Out << ",\"connections\":[";
+	for (size_t i = 0; i < m_Connections.size(); ++i)
+	{
+		if (i > 0)
+		{
+			p_Out << ",";
+		}
+		writeConnectionJSON(p_Out, m_Connections[i].first, m_Connections[i].second);
+	}
+	p_Out << "]}" << std::endl;
+}
@@ -0,0 +1,69 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <NetworkMetrics.h>
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Presents the network metrics of the server, per connection and
+ * combined, for the console and as files for external dashboards.
+ */
+class MetricsReport
+{
+private:
+	std::vector<std::pair<std::string, ConnectionMetrics>> m_Connections;
+	ConnectionMetrics m_Total;
+
+public:
+	/**
+	 * constructor.
+	 *
+	 * @param p_Total the combined metrics of all connections.
+	 */
+	explicit MetricsReport(const ConnectionMetrics& p_Total);
+
+	/**
+	 * Add the metrics of a single connection.
+	 *
+	 * @param p_Name the name identifying the connection, such as the user name.
+	 * @param p_Metrics the metrics of the connection.
+	 */
+	void addConnection(const std::string& p_Name, const ConnectionMetrics& p_Metrics);
+
+	/**
+	 * Print one line per connection with the round trip time,
+	 * the traffic rates and the deepest write queue.
+	 *
+	 * @param p_Out the stream to print to.
+	 */
+	void printConnections(std::ostream& p_Out) const;
+
+	/**
+	 * Print the combined traffic of every package type that has been sent or received.
+	 *
+	 * @param p_Out the stream to print to.
+	 */
+	void printPackageTypes(std::ostream& p_Out) const;
+
+	/**
+	 * Write one line per connection and package type with comma separated
+	 * values, after a header line. The combined metrics are named "total".
+	 *
+	 * @param p_Out the stream to write to.
+	 */
+	void writeCSV(std::ostream& p_Out) const;
+
+	/**
+	 * Write every connection and the combined metrics as a JSON object.
+	 *
+	 * @param p_Out the stream to write to.
+	 */
+	void writeJSON(std::ostream& p_Out) const;
+};
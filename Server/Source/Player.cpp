@@ -78,4 +78,9 @@ void Player::clockPosition(float p_Time)
 unsigned int Player::getNumberOfCheckpoints()
 {
 	return m_CheckpointSystem.getNrOfCheckpoints();
-}
\ No newline at end of file
+}
+
+InterestManager::ClientState& Player::getInterestState()
+{
+	return m_InterestState;
+}
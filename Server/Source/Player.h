@@ -9,6 +9,7 @@
 #include <Actor.h>
 #include <Utilities/Util.h>
 #include "CheckpointSystem.h"
+#include "InterestManager.h"
 
 /**
  * Player contains game specific information as well as the client user.
@@ -21,6 +22,7 @@ private:
 	CheckpointSystem m_CheckpointSystem;
 	unsigned int m_NrOfCheckpointsTaken;
 	std::vector<float> m_ClockTime;
+	InterestManager::ClientState m_InterestState;
 
 public:
 
@@ -125,4 +127,11 @@ public:
 	 * @return unsigned int number of checkpoints.
 	 */
 	unsigned int getNumberOfCheckpoints();
+
+	/**
+	 * Get the state used to decide which objects are relevant to the player.
+	 *
+	 * @return the player's relevancy state
+	 */
+	InterestManager::ClientState& getInterestState();
 };
@@ -2,21 +2,30 @@
 
 #include <Logger.h>
 
+#include <algorithm>
+#include <sstream>
+
 Server::Server()
 	:	m_RemoveBox(false),
-		m_PulseObject(false)
+		m_PulseObject(false),
+		m_Running(false),
+		m_WakeRequested(false)
 {
 }
 
-void Server::initialize()
+void Server::initialize(unsigned int p_NumTickWorkers, bool p_EnableDatagrams)
 {
 	m_Running = false;
 
-	m_Lobby.reset(new Lobby(this));
+	m_Games.start(p_NumTickWorkers);
+
+	m_Assets.initialize("assets/Resources.xml");
+	m_Lobby.reset(new Lobby(this, &m_Assets));
 	addGamesFromFile("assets/levels/levelList.xml");
 	m_Network = INetwork::createNetwork();
 	m_Network->initialize();
 	m_Network->createServer(31415);
+	m_Network->setDatagramsEnabled(p_EnableDatagrams);
 	m_Network->setClientConnectedCallback(&Server::clientConnected, this);
 	m_Network->setClientDisconnectedCallback(&Server::clientDisconnected, this);
 	m_Network->startServer(3);
@@ -30,17 +39,21 @@ void Server::run()
 
 void Server::shutdown()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_WakeLock);
+		m_Running = false;
+	}
+	m_WakeCondition.notify_all();
+	m_UpdateThread.join();
+
 	std::lock_guard<std::mutex> lock(m_UserLock);
 
-	m_Running = false;
-	
 	m_Network->setClientConnectedCallback(nullptr, nullptr);
 	m_Network->setClientDisconnectedCallback(nullptr, nullptr);
 
-	m_Lobby.reset();
 	m_Games.stopAllGames();
+	m_Lobby.reset();
 
-	m_UpdateThread.join();
 	INetwork::deleteNetwork(m_Network);
 }
 
@@ -58,26 +71,67 @@ std::vector<std::string> Server::getUserNames()
 	return names;
 }
 
+MetricsReport Server::getNetworkMetrics()
+{
+	MetricsReport report(m_Network->getMetrics());
+
+	std::lock_guard<std::mutex> lock(m_UserLock);
+
+	for (auto& user : m_Users)
+	{
+		report.addConnection(user->getUsername(), user->getConnection()->getMetrics());
+	}
+
+	return report;
+}
+
 std::vector<std::string> Server::getGameDescriptions()
 {
 	std::vector<std::string> descriptions;
 
 	for (const auto& game : m_Games.getRunningGames())
 	{
-		descriptions.push_back("Game \"" + game->getGameType() + "\" with " + std::to_string(game->getPlayers().size()) + " players");
+		std::ostringstream description;
+		description << "Game \"" << game->getGameType() << "\" with " << game->getPlayers().size() << " players, ";
+		game->getTickStatistics().print(description);
+
+		descriptions.push_back(description.str());
 	}
 
 	return descriptions;
 }
 
+Lobby::JoinStatistics Server::getJoinStatistics()
+{
+	return m_Lobby->getJoinStatistics();
+}
+
+AssetCache::Statistics Server::getAssetStatistics()
+{
+	return m_Assets.getStatistics();
+}
+
+unsigned int Server::releaseUnusedAssets()
+{
+	return m_Assets.releaseUnusedAssets();
+}
+
+void Server::recordGames(const std::string& p_Directory)
+{
+	Logger::log(Logger::Level::INFO, "Recording the input of new games to " + p_Directory);
+	m_Lobby->recordGames(p_Directory);
+}
+
 void Server::sendTestData()
 {
 	m_RemoveBox = true;
+	wakeUp();
 }
 
 void Server::sendPulseObject()
 {
 	m_PulseObject = true;
+	wakeUp();
 }
 
 void Server::addNewGame(GameRound::ptr p_Game)
@@ -85,6 +139,15 @@ void Server::addNewGame(GameRound::ptr p_Game)
 	m_Games.addGameRound(p_Game);
 }
 
+void Server::wakeUp()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_WakeLock);
+		m_WakeRequested = true;
+	}
+	m_WakeCondition.notify_one();
+}
+
 void Server::clientConnected(IConnectionController* p_Connection, void* p_UserData)
 {
 	Logger::log(Logger::Level::INFO, "Client connected");
@@ -162,11 +225,20 @@ void Server::updateClients()
 	std::chrono::high_resolution_clock::time_point currentTime = std::chrono::high_resolution_clock::now();
 	std::chrono::high_resolution_clock::time_point previousTime;
 	float deltaTime = 0.001f;
+	float timeToPing = 0.f;
 
 	while (m_Running)
 	{
 		m_Lobby->checkFreeUsers(deltaTime);
 
+		timeToPing -= deltaTime;
+		if (timeToPing <= 0.f)
+		{
+			static const float pingInterval = 1.f;
+			pingClients();
+			timeToPing = pingInterval;
+		}
+
 		if (m_RemoveBox)
 		{
 			removeLastBox();
@@ -178,15 +250,32 @@ void Server::updateClients()
 			pulse();
 			m_PulseObject = false;
 		}
-		
+
+		// Nothing is polled while idle. The lobby wakes the thread when its users
+		// send packages, otherwise it sleeps until a level times out or it is time to ping.
+		const float timeToWake = std::min(timeToPing, m_Lobby->getTimeToNextStart());
+		{
+			std::unique_lock<std::mutex> lock(m_WakeLock);
+			m_WakeCondition.wait_for(lock, std::chrono::duration<float>(timeToWake),
+				[this] () { return m_WakeRequested || !m_Running; });
+			m_WakeRequested = false;
+		}
+
 		previousTime = currentTime;
 		currentTime = std::chrono::high_resolution_clock::now();
 		const std::chrono::high_resolution_clock::duration frameTime = currentTime - previousTime;
 
 		deltaTime = std::chrono::duration_cast<std::chrono::duration<float>>(frameTime).count();
+	}
+}
+
+void Server::pingClients()
+{
+	std::lock_guard<std::mutex> lock(m_UserLock);
 
-		static const std::chrono::milliseconds sleepDuration(20);
-		std::this_thread::sleep_for(sleepDuration - frameTime);
+	for (auto& user : m_Users)
+	{
+		user->getConnection()->sendPing();
 	}
 }
 
@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include "AssetCache.h"
 #include "GameList.h"
 #include "Lobby.h"
+#include "MetricsReport.h"
 #include "User.h"
 
 #include <INetwork.h>
 
 #include <tinyxml2/tinyxml2.h>
 
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -24,6 +27,7 @@ class Server
 private:
 	INetwork* m_Network;
 
+	AssetCache m_Assets;
 	std::unique_ptr<Lobby> m_Lobby;
 	GameList m_Games;
 
@@ -36,6 +40,10 @@ private:
 	
 	bool m_Running;
 	std::thread m_UpdateThread;
+	// The update thread sleeps until woken or until its next timed work.
+	std::mutex m_WakeLock;
+	std::condition_variable m_WakeCondition;
+	bool m_WakeRequested;
 
 public:
 	/**
@@ -45,8 +53,11 @@ public:
 
 	/**
 	 * Initialize the server and start listening for clients.
+	 *
+	 * @param p_NumTickWorkers the number of threads to run the games on
+	 * @param p_EnableDatagrams true to offer clients a datagram channel for frequent state packages
 	 */
-	void initialize();
+	void initialize(unsigned int p_NumTickWorkers, bool p_EnableDatagrams);
 	/**
 	 * Start the server logic for managing clients.
 	 */
@@ -62,12 +73,43 @@ public:
 	 * @return a list of user names
 	 */
 	std::vector<std::string> getUserNames();
+	/**
+	 * Get the network metrics of every connected user and of the whole server.
+	 *
+	 * @return a report with one connection per user
+	 */
+	MetricsReport getNetworkMetrics();
 	/**
 	 * Get the descriptions for all running games.
 	 *
 	 * @return game descriptions
 	 */
 	std::vector<std::string> getGameDescriptions();
+	/**
+	 * Get how long users have waited from joining until their game started.
+	 *
+	 * @return the join statistics of the lobby
+	 */
+	Lobby::JoinStatistics getJoinStatistics();
+	/**
+	 * Get the number of assets shared by the games and how often they have been reused.
+	 *
+	 * @return the asset cache statistics
+	 */
+	AssetCache::Statistics getAssetStatistics();
+	/**
+	 * Release the shared assets not used by any running game.
+	 *
+	 * @return the number of released assets
+	 */
+	unsigned int releaseUnusedAssets();
+	/**
+	 * Record the input of all games started from now on, to be able to
+	 * replay them with InputReplay.
+	 *
+	 * @param p_Directory an existing directory to write the input logs to
+	 */
+	void recordGames(const std::string& p_Directory);
 	/**
 	 * Send some test data.
 	 */
@@ -83,6 +125,13 @@ public:
 	 * @param p_Game the game to run
 	 */
 	void addNewGame(GameRound::ptr p_Game);
+	/**
+	 * Wake the server logic for managing clients, for example
+	 * when users in the lobby have sent packages.
+	 *
+	 * Safe to call from any thread.
+	 */
+	void wakeUp();
 
 private:
 	static void clientConnected(IConnectionController* p_Connection, void* p_UserData);
@@ -91,5 +140,6 @@ private:
 	void removeLastBox();
 	void pulse();
 	void updateClients();
+	void pingClients();
 	void addGamesFromFile(const std::string& p_Filename);
 };
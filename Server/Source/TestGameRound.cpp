@@ -2,7 +2,6 @@
 
 #include <Components.h>
 #include <Logger.h>
-#include <XMLHelper.h>
 
 #include <algorithm>
 #include <sstream>
@@ -50,6 +49,7 @@ void TestGameRound::sendLevel()
 		instances.push_back(inst);
 	}
 
+	SharedFrame createFrame;
 	for(auto& player : m_Players)
 	{
 		User::ptr user = player->getUser().lock();
@@ -58,7 +58,12 @@ void TestGameRound::sendLevel()
 			Actor::ptr actor = player->getActor().lock();
 			if (actor)
 			{
-				user->getConnection()->sendCreateObjects(instances.data(), instances.size());
+				if (!createFrame)
+				{
+					createFrame = user->getConnection()->encodeCreateObjects(instances.data(), instances.size());
+				}
+
+				user->getConnection()->sendFrame(createFrame);
 				user->getConnection()->sendLevelData("", 0);
 				user->getConnection()->sendAssignPlayer(actor->getId());
 			}
@@ -77,8 +82,7 @@ void TestGameRound::updateLogic(float p_DeltaTime)
 void TestGameRound::sendUpdates()
 {
 	std::vector<UpdateObjectData> data;
-	std::vector<std::string> extra;
-	std::vector<const char*> extraC;
+	std::vector<ObjectLookData> looks;
 
 	for (auto& box : m_Boxes)
 	{
@@ -92,18 +96,10 @@ void TestGameRound::sendUpdates()
 	for (auto& player : m_Players)
 	{
 		data.push_back(getUpdateData(player));
-		extra.push_back(getExtraData(player));
-		extraC.push_back(extra.back().c_str());
+		looks.push_back(getLookData(player));
 	}
 
-	for (auto& player : m_Players)
-	{
-		User::ptr user = player->getUser().lock();
-		if (user)
-		{
-			user->getConnection()->sendUpdateObjects(data.data(), data.size(), extraC.data(), extraC.size());
-		}
-	}
+	sendObjectUpdates(data, looks);
 }
 
 void TestGameRound::playerDisconnected(Player::ptr p_DisconnectedPlayer)
@@ -116,14 +112,10 @@ void TestGameRound::playerDisconnected(Player::ptr p_DisconnectedPlayer)
 
 	uint32_t playerActorId = actor->getId();
 
-	for (auto& player : m_Players)
+	sendToAllPlayers([&] (IConnectionController* p_Connection)
 	{
-		User::ptr user = player->getUser().lock();
-		if (user)
-		{
-			user->getConnection()->sendRemoveObjects(&playerActorId, 1);
-		}
-	}
+		return p_Connection->encodeRemoveObjects(&playerActorId, 1);
+	});
 }
 
 UpdateObjectData TestGameRound::getUpdateData(const Actor::ptr p_Box)
@@ -181,14 +173,26 @@ UpdateObjectData TestGameRound::getUpdateData(const Player::ptr p_Player)
 	return data;
 }
 
-std::string TestGameRound::getExtraData(const Player::ptr p_Player)
+ObjectLookData TestGameRound::getLookData(const Player::ptr p_Player)
 {
-	tinyxml2::XMLPrinter printer;
-	printer.OpenElement("ObjectUpdate");
-	printer.PushAttribute("ActorId", p_Player->getActor().lock()->getId());
-	printer.PushAttribute("Type", "Look");
-	p_Player->getActor().lock()->getComponent<LookInterface>(LookInterface::m_ComponentId).lock()->serialize(printer);
-	printer.CloseElement();
-
-	return printer.CStr();
+	Actor::ptr actor = p_Player->getActor().lock();
+
+	if (!actor)
+	{
+		throw CommonException("Player missing actor", __LINE__, __FILE__);
+	}
+
+	ObjectLookData look;
+	look.m_Forward = Vector3(0.f, 0.f, 1.f);
+	look.m_Up = Vector3(0.f, 1.f, 0.f);
+	look.m_Id = actor->getId();
+
+	std::shared_ptr<LookInterface> lookInt = actor->getComponent<LookInterface>(LookInterface::m_ComponentId).lock();
+	if (lookInt)
+	{
+		look.m_Forward = lookInt->getLookForward();
+		look.m_Up = lookInt->getLookUp();
+	}
+
+	return look;
 }
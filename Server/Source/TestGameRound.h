@@ -22,5 +22,5 @@ private:
 	
 	UpdateObjectData getUpdateData(const Actor::ptr p_Box);
 	UpdateObjectData getUpdateData(const Player::ptr p_Player);
-	std::string getExtraData(const Player::ptr p_Player);
+	ObjectLookData getLookData(const Player::ptr p_Player);
 };
@@ -0,0 +1,333 @@
+#include "TickScheduler.h"
+
+#include <Logger.h>
+
+#include <algorithm>
+#include <iomanip>
+
+double TickStatistics::getBucketLimit(unsigned int p_Bucket)
+{
+	static const double limits[numBuckets - 1] = { 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1 };
+	return p_Bucket < numBuckets - 1 ? limits[p_Bucket] : -1.0;
+}
+
+void TickStatistics::addTick(double p_TickTime, double p_StartDelay)
+{
+	unsigned int bucket = 0;
+	while (bucket < numBuckets - 1 && p_TickTime > getBucketLimit(bucket))
+	{
+		++bucket;
+	}
+
+	++m_NumTicks;
+	++m_Buckets[bucket];
+	m_TotalTime += p_TickTime;
+	if (p_TickTime > m_MaxTime)
+	{
+		m_MaxTime = p_TickTime;
+	}
+	m_TotalStartDelay += p_StartDelay;
+	if (p_StartDelay > m_MaxStartDelay)
+	{
+		m_MaxStartDelay = p_StartDelay;
+	}
+}
+
+void TickStatistics::print(std::ostream& p_Out) const
+{
+	const double meanTime = m_NumTicks > 0 ? m_TotalTime / m_NumTicks : 0.0;
+
+	p_Out << std::fixed << std::setprecision(2)
+		<< m_NumTicks << " ticks, " << m_NumOverruns << " overruns"
+		<< ", tick mean " << meanTime * 1000.0 << " ms, max " << m_MaxTime * 1000.0 << " ms"
+		<< ", max start delay " << m_MaxStartDelay * 1000.0 << " ms" << std::endl
+		<< "  tick times";
+	for (unsigned int i = 0; i < numBuckets; ++i)
+	{
+		const double limit = getBucketLimit(i);
+		if (limit < 0.0)
+		{
+			p_Out << std::setprecision(0) << ", >" << getBucketLimit(i - 1) * 1000.0 << " ms: ";
+		}
+		else
+		{
+			p_Out << std::setprecision(0) << (i > 0 ? ", " : " ") << "<=" << limit * 1000.0 << " ms: ";
+		}
+		p_Out << m_Buckets[i];
+	}
+}
+
+TickScheduler::Task::Task(tickFunction_t p_Tick)
+	:	m_Tick(p_Tick),
+		m_State((int)State::IDLE),
+		m_Slot(0),
+		m_LastTick(0),
+		m_QueuedTick(0),
+		m_Statistics()
+{
+}
+
+TickStatistics TickScheduler::Task::getStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_StatisticsLock);
+	return m_Statistics;
+}
+
+bool TickScheduler::Task::isFinished() const
+{
+	return m_State == (int)State::FINISHED;
+}
+
+void TickScheduler::Task::addTick(std::chrono::steady_clock::time_point p_Start, std::chrono::steady_clock::time_point p_End)
+{
+	typedef std::chrono::duration<double> seconds;
+	const double tickTime = std::chrono::duration_cast<seconds>(p_End - p_Start).count();
+	const double startDelay = p_Start > m_Deadline ? std::chrono::duration_cast<seconds>(p_Start - m_Deadline).count() : 0.0;
+
+	std::lock_guard<std::mutex> lock(m_StatisticsLock);
+	m_Statistics.addTick(tickTime, startDelay);
+}
+
+void TickScheduler::Task::addOverrun()
+{
+	std::lock_guard<std::mutex> lock(m_StatisticsLock);
+	++m_Statistics.m_NumOverruns;
+}
+
+TickScheduler::TickScheduler(std::chrono::milliseconds p_TickLength, unsigned int p_NumSlots)
+	:	m_TickLength(p_TickLength),
+		m_NumSlots(p_NumSlots > 0 ? p_NumSlots : 1),
+		m_Slots(p_NumSlots > 0 ? p_NumSlots : 1),
+		m_Running(false)
+{
+}
+
+TickScheduler::~TickScheduler()
+{
+	stop();
+}
+
+void TickScheduler::start(unsigned int p_NumWorkers)
+{
+	if (m_TimerThread.joinable())
+	{
+		return;
+	}
+
+	Logger::log(Logger::Level::INFO, "Starting tick scheduler with " + std::to_string(p_NumWorkers) + " workers");
+
+	m_Running = true;
+	for (unsigned int i = 0; i < (p_NumWorkers > 0 ? p_NumWorkers : 1); ++i)
+	{
+		m_Workers.push_back(std::thread(&TickScheduler::runWorker, this));
+	}
+	m_TimerThread = std::thread(&TickScheduler::runTimer, this);
+}
+
+void TickScheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> taskLock(m_TaskLock);
+		std::lock_guard<std::mutex> queueLock(m_QueueLock);
+		m_Running = false;
+	}
+	m_TimerCondition.notify_all();
+	m_QueueCondition.notify_all();
+
+	if (m_TimerThread.joinable())
+	{
+		m_TimerThread.join();
+	}
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+
+	std::vector<TaskPtr> remaining;
+	{
+		std::lock_guard<std::mutex> lock(m_TaskLock);
+		for (auto& slot : m_Slots)
+		{
+			remaining.insert(remaining.end(), slot.begin(), slot.end());
+			slot.clear();
+		}
+		remaining.insert(remaining.end(), m_AddedTasks.begin(), m_AddedTasks.end());
+		m_AddedTasks.clear();
+	}
+	m_Queue.clear();
+
+	// Releasing the tick functions may release what the tasks tick, so no locks are held.
+	for (auto& task : remaining)
+	{
+		finishTask(task);
+	}
+}
+
+TickScheduler::TaskPtr TickScheduler::addTask(tickFunction_t p_Tick)
+{
+	TaskPtr task(new Task(p_Tick));
+
+	std::lock_guard<std::mutex> lock(m_TaskLock);
+	m_AddedTasks.push_back(task);
+
+	return task;
+}
+
+unsigned int TickScheduler::getNumTasks()
+{
+	std::lock_guard<std::mutex> lock(m_TaskLock);
+
+	unsigned int numTasks = m_AddedTasks.size();
+	for (const auto& slot : m_Slots)
+	{
+		for (const auto& task : slot)
+		{
+			if (!task->isFinished())
+			{
+				++numTasks;
+			}
+		}
+	}
+
+	return numTasks;
+}
+
+void TickScheduler::runTimer()
+{
+	const Clock::time_point startTime = Clock::now();
+	const Clock::duration slotLength = m_TickLength / m_NumSlots;
+
+	// Counts slot deadlines since the start; every m_NumSlots positions make up one tick.
+	uint64_t position = 0;
+
+	std::unique_lock<std::mutex> lock(m_TaskLock);
+	while (m_Running)
+	{
+		const uint64_t tick = position / m_NumSlots + 1;
+		const unsigned int slot = (unsigned int)(position % m_NumSlots);
+		const Clock::time_point deadline = startTime + m_TickLength * (tick - 1) + m_TickLength * slot / m_NumSlots;
+
+		while (m_Running && Clock::now() < deadline)
+		{
+			m_TimerCondition.wait_until(lock, deadline);
+		}
+		if (!m_Running)
+		{
+			break;
+		}
+
+		// New tasks go to the slot with the fewest tasks.
+		for (auto& task : m_AddedTasks)
+		{
+			unsigned int emptiest = 0;
+			for (unsigned int i = 1; i < m_NumSlots; ++i)
+			{
+				if (m_Slots[i].size() < m_Slots[emptiest].size())
+				{
+					emptiest = i;
+				}
+			}
+			task->m_Slot = emptiest;
+			m_Slots[emptiest].push_back(task);
+		}
+		m_AddedTasks.clear();
+
+		std::vector<TaskPtr>& tasks = m_Slots[slot];
+		tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [] (const TaskPtr& p_Task) { return p_Task->isFinished(); }), tasks.end());
+
+		for (auto& task : tasks)
+		{
+			int expected = (int)Task::State::IDLE;
+			if (task->m_State.compare_exchange_strong(expected, (int)Task::State::QUEUED))
+			{
+				task->m_QueuedTick = tick;
+				task->m_Deadline = deadline;
+
+				std::lock_guard<std::mutex> queueLock(m_QueueLock);
+				m_Queue.push_back(task);
+				m_QueueCondition.notify_one();
+			}
+			else if (expected != (int)Task::State::FINISHED)
+			{
+				task->addOverrun();
+			}
+		}
+
+		++position;
+
+		// After a long stall, continue from the current time instead of rushing through every missed deadline.
+		// The missed time is still passed on to the tasks, as their time step covers every tick since the last.
+		const Clock::time_point now = Clock::now();
+		if (now - deadline > m_TickLength)
+		{
+			position = (uint64_t)((now - startTime) / slotLength);
+		}
+	}
+}
+
+void TickScheduler::runWorker()
+{
+	while (true)
+	{
+		TaskPtr task;
+		{
+			std::unique_lock<std::mutex> lock(m_QueueLock);
+			while (m_Running && m_Queue.empty())
+			{
+				m_QueueCondition.wait(lock);
+			}
+			if (!m_Running)
+			{
+				return;
+			}
+
+			task = m_Queue.front();
+			m_Queue.pop_front();
+		}
+
+		tickTask(task);
+	}
+}
+
+void TickScheduler::tickTask(const TaskPtr& p_Task)
+{
+	p_Task->m_State = (int)Task::State::RUNNING;
+
+	// The time step is a whole number of ticks, so simulations do not drift with the wall clock.
+	const uint64_t numTicks = p_Task->m_LastTick == 0 ? 1 : p_Task->m_QueuedTick - p_Task->m_LastTick;
+	p_Task->m_LastTick = p_Task->m_QueuedTick;
+	const float deltaTime = std::chrono::duration_cast<std::chrono::duration<float>>(m_TickLength * numTicks).count();
+
+	const Clock::time_point start = Clock::now();
+	bool keepTicking = false;
+	try
+	{
+		keepTicking = p_Task->m_Tick(deltaTime);
+	}
+	catch (std::exception& err)
+	{
+		Logger::log(Logger::Level::FATAL, std::string("Unexpected exception in scheduled tick: ") + err.what());
+	}
+	catch (...)
+	{
+		Logger::log(Logger::Level::FATAL, "Unexpected exception in scheduled tick");
+	}
+	p_Task->addTick(start, Clock::now());
+
+	if (keepTicking)
+	{
+		p_Task->m_State = (int)Task::State::IDLE;
+	}
+	else
+	{
+		finishTask(p_Task);
+	}
+}
+
+void TickScheduler::finishTask(const TaskPtr& p_Task)
+{
+	tickFunction_t released;
+	released.swap(p_Task->m_Tick);
+	p_Task->m_State = (int)Task::State::FINISHED;
+}
@@ -0,0 +1,211 @@
+/**
+ * Stuff.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/**
+ * Timing of the ticks of a single scheduled task.
+ */
+struct TickStatistics
+{
+	/**
+	 * The number of tick duration buckets.
+	 */
+	static const unsigned int numBuckets = 8;
+
+	uint64_t m_NumTicks;
+	uint64_t m_NumOverruns;				/// Deadlines skipped because the previous tick had not finished
+	uint64_t m_Buckets[numBuckets];		/// Number of ticks by duration, see getBucketLimit
+	double m_TotalTime;					/// Seconds spent ticking
+	double m_MaxTime;					/// Seconds spent in the longest tick
+	double m_TotalStartDelay;			/// Seconds between the deadlines and the ticks starting
+	double m_MaxStartDelay;				/// Longest time between a deadline and the tick starting
+
+	/**
+	 * Get the upper limit of the tick durations in a bucket.
+	 *
+	 * @param p_Bucket the index of the bucket.
+	 * @return the limit in seconds, or a negative value for the last, unlimited bucket.
+	 */
+	static double getBucketLimit(unsigned int p_Bucket);
+
+	/**
+	 * Count a tick.
+	 *
+	 * @param p_TickTime the seconds spent ticking.
+	 * @param p_StartDelay the seconds between the deadline and the tick starting.
+	 */
+	void addTick(double p_TickTime, double p_StartDelay);
+
+	/**
+	 * Print the statistics on two lines, without a trailing line break.
+	 *
+	 * @param p_Out the stream to print to.
+	 */
+	void print(std::ostream& p_Out) const;
+};
+
+/**
+ * Runs tasks at a fixed tick rate on a shared pool of worker threads.
+ *
+ * Deadlines are kept on a fixed grid from the start of the scheduler, so
+ * the tick rate does not drift with the time spent ticking. To spread the
+ * load, each tick period is split into slots like a timer wheel and tasks
+ * are placed in the slot with the fewest tasks. A task is never ticked
+ * by two workers at once; a deadline that passes while the task is still
+ * ticking is skipped and counted as an overrun.
+ */
+class TickScheduler
+{
+public:
+	/**
+	 * Function called once per tick, with the time in seconds since the
+	 * last tick. Returns false when the task is done and should be removed.
+	 */
+	typedef std::function<bool(float)> tickFunction_t;
+
+	/**
+	 * A scheduled task.
+	 */
+	class Task
+	{
+	private:
+		friend class TickScheduler;
+
+		enum class State
+		{
+			IDLE,		/// Waiting for the next deadline
+			QUEUED,		/// Waiting for a worker
+			RUNNING,	/// Being ticked by a worker
+			FINISHED,	/// Done, to be removed
+		};
+
+		tickFunction_t m_Tick;
+		std::atomic<int> m_State;
+		unsigned int m_Slot;
+		uint64_t m_LastTick;
+		uint64_t m_QueuedTick;
+		std::chrono::steady_clock::time_point m_Deadline;
+
+		mutable std::mutex m_StatisticsLock;
+		TickStatistics m_Statistics;
+
+	public:
+		/**
+		 * constructor.
+		 *
+		 * @param p_Tick the function to tick.
+		 */
+		explicit Task(tickFunction_t p_Tick);
+
+		/**
+		 * Get the timing of the ticks so far.
+		 *
+		 * @return the tick statistics.
+		 */
+		TickStatistics getStatistics() const;
+
+		/**
+		 * Check if the task is done and has been removed from the scheduler.
+		 *
+		 * @return true if the task is finished.
+		 */
+		bool isFinished() const;
+
+	private:
+		Task(const Task&);
+		Task& operator=(const Task&);
+
+		void addTick(std::chrono::steady_clock::time_point p_Start, std::chrono::steady_clock::time_point p_End);
+		void addOverrun();
+	};
+
+	/**
+	 * Shared pointer to a task.
+	 */
+	typedef std::shared_ptr<Task> TaskPtr;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	const Clock::duration m_TickLength;
+	const unsigned int m_NumSlots;
+
+	std::mutex m_TaskLock;
+	std::condition_variable m_TimerCondition;
+	std::vector<std::vector<TaskPtr>> m_Slots;
+	std::vector<TaskPtr> m_AddedTasks;
+
+	std::mutex m_QueueLock;
+	std::condition_variable m_QueueCondition;
+	std::deque<TaskPtr> m_Queue;
+
+	bool m_Running;
+	std::thread m_TimerThread;
+	std::vector<std::thread> m_Workers;
+
+public:
+	/**
+	 * constructor.
+	 *
+	 * @param p_TickLength the time between the ticks of each task.
+	 * @param p_NumSlots the number of evenly spread points in each tick period that tasks can be ticked at.
+	 */
+	TickScheduler(std::chrono::milliseconds p_TickLength, unsigned int p_NumSlots);
+
+	/**
+	 * destructor, stops the scheduler.
+	 */
+	~TickScheduler();
+
+	/**
+	 * Start ticking tasks.
+	 *
+	 * @param p_NumWorkers the number of threads to tick tasks on, at least 1.
+	 */
+	void start(unsigned int p_NumWorkers);
+
+	/**
+	 * Stop ticking and wait for the workers to finish. Remaining tasks
+	 * are removed and their tick functions released.
+	 */
+	void stop();
+
+	/**
+	 * Add a task to be ticked from the next free deadline of its slot.
+	 * Safe to call from any thread, including from a tick.
+	 *
+	 * @param p_Tick the function to call every tick.
+	 * @return the scheduled task.
+	 */
+	TaskPtr addTask(tickFunction_t p_Tick);
+
+	/**
+	 * Get the number of tasks being ticked.
+	 *
+	 * @return the number of tasks.
+	 */
+	unsigned int getNumTasks();
+
+private:
+	TickScheduler(const TickScheduler&);
+	TickScheduler& operator=(const TickScheduler&);
+
+	void runTimer();
+	void runWorker();
+	void tickTask(const TaskPtr& p_Task);
+	static void finishTask(const TaskPtr& p_Task);
+};
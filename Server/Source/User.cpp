@@ -52,3 +52,13 @@ void User::setCharacterStyle(const std::string& p_Style)
 {
 	m_CharacterStyle = p_Style;
 }
+
+std::chrono::steady_clock::time_point User::getJoinTime() const
+{
+	return m_JoinTime;
+}
+
+void User::setJoinTime(std::chrono::steady_clock::time_point p_JoinTime)
+{
+	m_JoinTime = p_JoinTime;
+}
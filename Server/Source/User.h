@@ -6,6 +6,7 @@
 
 #include <IConnectionController.h>
 
+#include <chrono>
 #include <functional>
 #include <memory>
 
@@ -43,6 +44,7 @@ private:
 	std::string m_Username;
 	std::string m_CharacterName;
 	std::string m_CharacterStyle;
+	std::chrono::steady_clock::time_point m_JoinTime;
 
 public:
 	/**
@@ -112,4 +114,17 @@ public:
 	 * @param p_Style the name of the style to use
 	 */
 	void setCharacterStyle(const std::string& p_Style);
+
+	/**
+	 * Get when the user last asked to join a game.
+	 *
+	 * @return the time of joining
+	 */
+	std::chrono::steady_clock::time_point getJoinTime() const;
+	/**
+	 * Set when the user asked to join a game.
+	 *
+	 * @param p_JoinTime the time of joining
+	 */
+	void setJoinTime(std::chrono::steady_clock::time_point p_JoinTime);
 };
@@ -1,12 +1,16 @@
 #include <Logger.h>
 #include <TweakSettings.h>
 
+#include "InputReplay.h"
 #include "Server.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
 
 Server server;
 
@@ -16,8 +20,13 @@ void printHelp()
 		"  help     Print this message\n"
 		"  send     Send data to client\n"
 		"  pulse    Pulse an object\n"
-		"  list     List all the connected clients\n"
-		"  games    List all running games\n"
+		"  list     List all the connected clients with their network metrics\n"
+		"  games    List all running games with their tick times and the time from join to start\n"
+		"  metrics  Print the traffic of each package type\n"
+		"  metrics csv <file>   Write network metrics as comma separated values\n"
+		"  metrics json <file>  Write network metrics as JSON\n"
+		"  assets   Print the assets shared by the games\n"
+		"  assets release       Release the shared assets not used by any game\n"
 		"  exit     Shutdown the server\n";
 
 	std::cout << helpMessage;
@@ -25,10 +34,34 @@ void printHelp()
 
 void listUsers()
 {
-	for (const auto& user : server.getUserNames())
+	server.getNetworkMetrics().printConnections(std::cout);
+}
+
+void writeMetrics(const std::string& p_Format, const std::string& p_Filename)
+{
+	const MetricsReport report = server.getNetworkMetrics();
+	if (p_Format.empty())
 	{
-		std::cout << user << std::endl;
+		report.printPackageTypes(std::cout);
+		return;
 	}
+
+	if ((p_Format != "csv" && p_Format != "json") || p_Filename.empty())
+	{
+		std::cout << "Usage: metrics [csv|json <file>]" << std::endl;
+		return;
+	}
+
+	std::ofstream file(p_Filename, std::ofstream::trunc);
+	if (p_Format == "csv")
+		report.writeCSV(file);
+	else
+		report.writeJSON(file);
+
+	if (file)
+		std::cout << "Wrote network metrics to " << p_Filename << std::endl;
+	else
+		std::cout << "Could not write " << p_Filename << std::endl;
 }
 
 void listGames()
@@ -37,6 +70,30 @@ void listGames()
 	{
 		std::cout << game << std::endl;
 	}
+
+	const Lobby::JoinStatistics join = server.getJoinStatistics();
+	const double meanWait = join.m_NumStarted > 0 ? join.m_TotalWait / join.m_NumStarted : 0.0;
+	std::cout << join.m_NumStarted << " players started, join to start mean "
+		<< (int)(meanWait * 1000.0) << " ms, max " << (int)(join.m_MaxWait * 1000.0) << " ms, last game "
+		<< (int)(join.m_LastWait * 1000.0) << " ms" << std::endl;
+}
+
+void printAssets(const std::string& p_Option)
+{
+	if (p_Option == "release")
+	{
+		server.releaseUnusedAssets();
+	}
+	else if (!p_Option.empty())
+	{
+		std::cout << "Usage: assets [release]" << std::endl;
+		return;
+	}
+
+	const AssetCache::Statistics stats = server.getAssetStatistics();
+	std::cout << stats.m_NumLevels << " levels, " << stats.m_NumAnimations << " animations, "
+		<< stats.m_NumSpells << " spells, " << stats.m_NumVolumes << " bounding volumes" << std::endl
+		<< stats.m_NumLoads << " loaded from file, " << stats.m_NumHits << " reused" << std::endl;
 }
 
 void printUnknownCommand()
@@ -44,6 +101,78 @@ void printUnknownCommand()
 	std::cout << "Unknown command. Use 'help' for available commands." << std::endl;
 }
 
+bool hasFlag(int argc, char* argv[], const std::string& p_Flag)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string(argv[i]) == p_Flag)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string getOption(int argc, char* argv[], const std::string& p_Option)
+{
+	std::string value;
+
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		if (std::string(argv[i]) == p_Option)
+		{
+			value = argv[i + 1];
+		}
+	}
+
+	return value;
+}
+
+unsigned int getNumTickWorkers(int argc, char* argv[])
+{
+	unsigned int numWorkers = std::thread::hardware_concurrency();
+
+	const std::string option = getOption(argc, argv, "--tick-workers");
+	if (!option.empty())
+	{
+		numWorkers = (unsigned int)std::strtoul(option.c_str(), nullptr, 10);
+	}
+
+	return numWorkers > 0 ? numWorkers : 1;
+}
+
+int replayInput(const std::string& p_Filename)
+{
+	AssetCache assets;
+	INetwork* network = INetwork::createNetwork();
+	int result = 0;
+
+	try
+	{
+		assets.initialize("assets/Resources.xml");
+		network->initialize();
+
+		InputReplay replay(&assets, network);
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const TickStatistics stats = replay.replay(p_Filename);
+		const double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cout << "Replayed " << p_Filename << " in " << totalTime << " s, ";
+		stats.print(std::cout);
+		std::cout << std::endl;
+	}
+	catch (std::exception& err)
+	{
+		Logger::log(Logger::Level::FATAL, err.what());
+		result = 1;
+	}
+
+	INetwork::deleteNetwork(network);
+
+	return result;
+}
+
 int main(int argc, char* argv[])
 {
 	std::ofstream logFile("serverLogFile.txt", std::ofstream::trunc);
@@ -54,7 +183,23 @@ int main(int argc, char* argv[])
 
 	TweakSettings::initializeMaster();
 
-	server.initialize();
+	// Replay recorded input as a benchmark instead of running the server.
+	const std::string replayFile = getOption(argc, argv, "--replay");
+	if (!replayFile.empty())
+	{
+		const int result = replayInput(replayFile);
+		TweakSettings::shutdown();
+		return result;
+	}
+
+	server.initialize(getNumTickWorkers(argc, argv), hasFlag(argc, argv, "--datagrams"));
+
+	const std::string recordDirectory = getOption(argc, argv, "--record");
+	if (!recordDirectory.empty())
+	{
+		server.recordGames(recordDirectory);
+	}
+
 	server.run();
 
 	std::string input;
@@ -64,7 +209,13 @@ int main(int argc, char* argv[])
 		if (!std::getline(std::cin, input))
 			break;
 
+		// Only the command and its options are case insensitive, not file names.
+		std::istringstream words(input);
+		std::string format;
+		std::string filename;
+		words >> input >> format >> filename;
 		std::transform(input.begin(), input.end(), input.begin(), ::tolower);
+		std::transform(format.begin(), format.end(), format.begin(), ::tolower);
 
 		if (input == "exit")
 			break;
@@ -76,6 +227,10 @@ int main(int argc, char* argv[])
 			listUsers();
 		else if (input == "games")
 			listGames();
+		else if (input == "metrics")
+			writeMetrics(format, filename);
+		else if (input == "assets")
+			printAssets(format);
 		else if (input == "pulse")
 			server.sendPulseObject();
 		else